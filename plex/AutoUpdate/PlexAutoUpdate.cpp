@@ -11,6 +11,7 @@
 #include "FileSystem/PlexDirectory.h"
 #include "FileItem.h"
 #include "PlexJobs.h"
+#include "PlexDownloadState.h"
 #include "File.h"
 #include "Directory.h"
 #include "utils/URIUtils.h"
@@ -254,7 +255,18 @@ bool CPlexAutoUpdate::NeedDownload(const std::string& localFile, const std::stri
     return false;
 #endif
 
-  if (CFile::Exists(localFile, false) && PlexUtils::GetSHA1SumFromURL(CURL(localFile)) == expectedHash)
+  if (!CFile::Exists(localFile, false))
+    return true;
+
+  // a finished download knows its hash already, only files from before that need to be read again
+  CPlexDownloadState state(localFile);
+  std::string hash;
+  if (state.Load())
+    hash = state.IsComplete() ? state.GetHash() : "";
+  else
+    hash = PlexUtils::GetSHA1SumFromURL(CURL(localFile));
+
+  if (hash == expectedHash)
   {
     CLog::Log(LOGDEBUG, "CPlexAutoUpdate::DownloadUpdate we already have %s with correct SHA", localFile.c_str());
     return false;
@@ -464,14 +476,19 @@ void CPlexAutoUpdate::ProcessDownloads()
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 void CPlexAutoUpdate::OnJobComplete(unsigned int jobID, bool success, CJob *job)
 {
+  // the other download of this update failed already
+  if (!m_downloadItem)
+    return;
+
   CPlexDownloadFileJob *fj = static_cast<CPlexDownloadFileJob*>(job);
   if (fj && success)
   {
     if (fj->m_destination == m_localManifest)
     {
-      if (NeedDownload(m_localManifest, m_downloadPackage->GetProperty("manifestHash").asString(), true))
+      if (fj->m_hash != m_downloadPackage->GetProperty("manifestHash").asString())
       {
         CLog::Log(LOGWARNING, "CPlexAutoUpdate::OnJobComplete failed to download manifest, SHA mismatch. Retrying in %d seconds", m_searchFrequency);
+        DownloadFailed(m_localManifest);
         return;
       }
 
@@ -480,9 +497,10 @@ void CPlexAutoUpdate::OnJobComplete(unsigned int jobID, bool success, CJob *job)
     }
     else if (fj->m_destination == m_localBinary)
     {
-      if (NeedDownload(m_localBinary, m_downloadPackage->GetProperty("fileHash").asString(), false))
+      if (fj->m_hash != m_downloadPackage->GetProperty("fileHash").asString())
       {
         CLog::Log(LOGWARNING, "CPlexAutoUpdate::OnJobComplete failed to download update, SHA mismatch. Retrying in %d seconds", m_searchFrequency);
+        DownloadFailed(m_localBinary);
         return;
       }
 
@@ -495,7 +513,7 @@ void CPlexAutoUpdate::OnJobComplete(unsigned int jobID, bool success, CJob *job)
   else if (!success)
   {
     CLog::Log(LOGWARNING, "CPlexAutoUpdate::OnJobComplete failed to run a download job, will retry in %d milliseconds.", m_searchFrequency);
-    g_plexApplication.timer->SetTimeout(m_searchFrequency, this);
+    DownloadFailed("");
     return;
   }
 
@@ -503,6 +521,22 @@ void CPlexAutoUpdate::OnJobComplete(unsigned int jobID, bool success, CJob *job)
     ProcessDownloads();
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexAutoUpdate::DownloadFailed(const std::string& corruptFile)
+{
+  // what was downloaded doesn't hash right, so there is nothing to continue from
+  if (!corruptFile.empty())
+  {
+    CFile::Delete(corruptFile);
+    CFile::Delete(CPlexDownloadState::GetStatePath(corruptFile));
+  }
+
+  // an interrupted download continues where it stopped when the update is found again
+  m_downloadItem.reset();
+  m_isDownloading = false;
+  g_plexApplication.timer->SetTimeout(m_searchFrequency, this);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 void CPlexAutoUpdate::OnJobProgress(unsigned int jobID, unsigned int progress, unsigned int total, const CJob *job)
 {
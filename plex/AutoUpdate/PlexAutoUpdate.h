@@ -78,6 +78,7 @@ class CPlexAutoUpdate : public IJobCallback, public IPlexGlobalTimeout
 
     CFileItemPtr GetPackage(CFileItemPtr updateItem);
     bool NeedDownload(const std::string& localFile, const std::string& expectedHash, bool isManifest);
+    void DownloadFailed(const std::string& corruptFile);
     bool RenameLocalBinary();
     int m_percentage;
 
@@ -0,0 +1,432 @@
+#include "PlexSearchIndex.h"
+#include "FileItem.h"
+#include "PlexTypes.h"
+#include "URL.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+
+#include <algorithm>
+#include <ctype.h>
+#include <iterator>
+
+namespace
+{
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// orders the words by the prefix they are looked up with, so upper_bound finds the end of a range
+struct PrefixLess
+{
+  bool operator()(const std::string& prefix, const std::pair<std::string, unsigned int>& word) const
+  {
+    return word.first.compare(0, prefix.size(), prefix) > 0;
+  }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct Match
+{
+  int rank;
+  size_t length;
+  unsigned int id;
+
+  bool operator<(const Match& other) const
+  {
+    if (rank != other.rank)
+      return rank < other.rank;
+    if (length != other.length)
+      return length < other.length;
+    return id < other.id;
+  }
+};
+
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CPlexSearchIndex::CPlexSearchIndex(unsigned int maxItems) : m_maxItems(maxItems), m_removed(0)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexSearchIndex::GetWords(const std::string& text, std::vector<std::string>& words)
+{
+  words.clear();
+
+  std::string word;
+  for (size_t i = 0; i <= text.size(); i++)
+  {
+    unsigned char c = i < text.size() ? text[i] : ' ';
+    if (c == '\'')
+      continue;
+
+    // multibyte utf-8 characters are kept as they are
+    if (isalnum(c) || c >= 0x80)
+    {
+      word += tolower(c);
+    }
+    else if (!word.empty())
+    {
+      words.push_back(word);
+      word.clear();
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexSearchIndex::IsIndexed(int type)
+{
+  switch (type)
+  {
+    case PLEX_DIR_TYPE_MOVIE:
+    case PLEX_DIR_TYPE_SHOW:
+    case PLEX_DIR_TYPE_EPISODE:
+    case PLEX_DIR_TYPE_ARTIST:
+    case PLEX_DIR_TYPE_ALBUM:
+    case PLEX_DIR_TYPE_TRACK:
+    case PLEX_DIR_TYPE_CLIP:
+      return true;
+    default:
+      return false;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexSearchIndex::AddItems(const std::string& source, const CFileItemList& list)
+{
+  std::vector<Result> items;
+  for (int i = 0; i < list.Size(); i++)
+  {
+    CFileItemPtr item = list.Get(i);
+    if (!item || !IsIndexed(item->GetPlexDirectoryType()))
+      continue;
+
+    CURL url(item->GetPath());
+    if (url.GetProtocol() != "plexserver")
+      continue;
+
+    Result result;
+    result.path = item->GetPath();
+    result.title = item->GetLabel();
+    result.server = url.GetHostName();
+    // building the url of lazy art costs a server lookup, it waits until the result is shown
+    result.thumbArt = item->GetLazyArt("thumb");
+    if (!result.thumbArt)
+      result.thumb = item->GetArt("thumb");
+    result.sectionUUID = item->GetProperty("librarySectionUUID").asString();
+    result.key = item->GetProperty("unprocessed_key").asString();
+    result.type = item->GetPlexDirectoryType();
+    result.folder = item->m_bIsFolder;
+    items.push_back(result);
+  }
+
+  // listings without library items don't need to replace anything either
+  CSingleLock lk(m_lock);
+  if (items.empty() && m_sources.find(source) == m_sources.end())
+    return;
+  lk.Leave();
+
+  AddItems(source, items);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexSearchIndex::AddItems(const std::string& source, const std::vector<Result>& items)
+{
+  CSingleLock lk(m_lock);
+
+  std::vector<unsigned int> ids;
+  ids.reserve(items.size());
+  for (size_t i = 0; i < items.size(); i++)
+    ids.push_back(AddEntry(items[i]));
+
+  // the items are referenced by the new listing before the old one lets go of them
+  std::vector<unsigned int>& sourceIds = m_sources[source];
+  sourceIds.swap(ids);
+  for (size_t i = 0; i < ids.size(); i++)
+    Release(ids[i]);
+
+  m_sourceOrder.remove(source);
+  if (sourceIds.empty())
+    m_sources.erase(source);
+  else
+    m_sourceOrder.push_back(source);
+
+  RemoveOldest();
+  Compact();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexSearchIndex::RemoveOldest()
+{
+  // the newest source stays, even if it's larger than the index is allowed to be on its own
+  while (m_ids.size() > m_maxItems && m_sourceOrder.size() > 1)
+  {
+    std::string source = m_sourceOrder.front();
+    CLog::Log(LOGDEBUG, "CPlexSearchIndex::RemoveOldest %d items, dropping %s", (int)m_ids.size(), source.c_str());
+    RemoveSource(m_sources.find(source));
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexSearchIndex::RemoveSource(std::map<std::string, std::vector<unsigned int> >::iterator it)
+{
+  for (size_t i = 0; i < it->second.size(); i++)
+    Release(it->second[i]);
+
+  m_sourceOrder.remove(it->first);
+  m_sources.erase(it);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexSearchIndex::RemoveSource(const std::string& source)
+{
+  CSingleLock lk(m_lock);
+
+  std::map<std::string, std::vector<unsigned int> >::iterator it = m_sources.find(source);
+  if (it == m_sources.end())
+    return;
+
+  RemoveSource(it);
+  Compact();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexSearchIndex::RemoveServer(const std::string& server)
+{
+  CSingleLock lk(m_lock);
+
+  std::map<std::string, std::vector<unsigned int> >::iterator it = m_sources.begin();
+  while (it != m_sources.end())
+  {
+    std::vector<unsigned int> kept;
+    for (size_t i = 0; i < it->second.size(); i++)
+    {
+      unsigned int id = it->second[i];
+      if (m_entries[id].result.server == server)
+        Release(id);
+      else
+        kept.push_back(id);
+    }
+
+    if (kept.empty())
+    {
+      m_sourceOrder.remove(it->first);
+      m_sources.erase(it++);
+    }
+    else
+      (it++)->second.swap(kept);
+  }
+
+  CLog::Log(LOGDEBUG, "CPlexSearchIndex::RemoveServer removed %s, %d items left", server.c_str(), (int)m_ids.size());
+  Compact();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexSearchIndex::Clear()
+{
+  CSingleLock lk(m_lock);
+  m_entries.clear();
+  m_free.clear();
+  m_ids.clear();
+  m_sources.clear();
+  m_sourceOrder.clear();
+  m_words.clear();
+  m_newWords.clear();
+  m_removed = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+unsigned int CPlexSearchIndex::GetSize() const
+{
+  CSingleLock lk(m_lock);
+  return m_ids.size();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+unsigned int CPlexSearchIndex::AddEntry(const Result& result)
+{
+  std::vector<std::string> words;
+  GetWords(result.title, words);
+
+  std::string normalized;
+  for (size_t i = 0; i < words.size(); i++)
+    normalized += " " + words[i];
+
+  unsigned int id;
+  std::map<std::string, unsigned int>::iterator it = m_ids.find(result.path);
+  if (it != m_ids.end())
+  {
+    id = it->second;
+    Entry& entry = m_entries[id];
+    entry.refs++;
+    entry.result = result;
+
+    // the words of the old title stay behind, but Matches() won't accept them anymore
+    if (entry.words == normalized)
+      return id;
+    entry.words = normalized;
+  }
+  else
+  {
+    if (m_free.empty())
+    {
+      id = m_entries.size();
+      m_entries.push_back(Entry());
+    }
+    else
+    {
+      id = m_free.back();
+      m_free.pop_back();
+    }
+
+    Entry& entry = m_entries[id];
+    entry.result = result;
+    entry.words = normalized;
+    entry.refs = 1;
+    m_ids[result.path] = id;
+  }
+
+  std::sort(words.begin(), words.end());
+  words.erase(std::unique(words.begin(), words.end()), words.end());
+  for (size_t i = 0; i < words.size(); i++)
+    m_newWords.push_back(Word(words[i], id));
+
+  return id;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexSearchIndex::Release(unsigned int id)
+{
+  Entry& entry = m_entries[id];
+  if (entry.refs == 0 || --entry.refs > 0)
+    return;
+
+  m_ids.erase(entry.result.path);
+  entry.result = Result();
+  entry.words.clear();
+  m_removed++;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexSearchIndex::SortWords()
+{
+  if (m_newWords.empty())
+    return;
+
+  std::sort(m_newWords.begin(), m_newWords.end());
+  if (m_words.empty())
+  {
+    m_words.swap(m_newWords);
+    return;
+  }
+
+  WordList words;
+  words.reserve(m_words.size() + m_newWords.size());
+  std::merge(m_words.begin(), m_words.end(), m_newWords.begin(), m_newWords.end(), std::back_inserter(words));
+  m_words.swap(words);
+  m_newWords.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexSearchIndex::Compact()
+{
+  // removed entries are skipped by queries until they make up half of the index
+  if (m_removed == 0 || m_removed < m_entries.size() / 2)
+    return;
+
+  SortWords();
+
+  WordList words;
+  words.reserve(m_words.size());
+  for (WordList::const_iterator it = m_words.begin(); it != m_words.end(); ++it)
+  {
+    if (m_entries[it->second].refs > 0)
+      words.push_back(*it);
+  }
+  m_words.swap(words);
+
+  // no word points to a removed entry anymore, so they can be reused
+  m_free.clear();
+  for (unsigned int id = 0; id < m_entries.size(); id++)
+  {
+    if (m_entries[id].refs == 0)
+      m_free.push_back(id);
+  }
+  m_removed = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexSearchIndex::Matches(const Entry& entry, const std::vector<std::string>& words) const
+{
+  if (entry.refs == 0)
+    return false;
+
+  for (size_t i = 0; i < words.size(); i++)
+  {
+    if (entry.words.find(" " + words[i]) == std::string::npos)
+      return false;
+  }
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexSearchIndex::Query(const std::string& query, unsigned int maxResults, std::vector<Result>& results,
+                             const std::set<std::string>* servers)
+{
+  results.clear();
+
+  std::vector<std::string> words;
+  GetWords(query, words);
+  if (words.empty() || maxResults == 0)
+    return;
+
+  std::string normalized;
+  for (size_t i = 0; i < words.size(); i++)
+    normalized += " " + words[i];
+
+  CSingleLock lk(m_lock);
+  SortWords();
+
+  // only the entries with the rarest of the query words need to be looked at
+  const WordList& sorted = m_words;
+  WordList::const_iterator first = sorted.end(), last = sorted.end();
+  for (size_t i = 0; i < words.size(); i++)
+  {
+    WordList::const_iterator lower = std::lower_bound(sorted.begin(), sorted.end(), Word(words[i], 0));
+    WordList::const_iterator upper = std::upper_bound(lower, sorted.end(), words[i], PrefixLess());
+    if (i == 0 || upper - lower < last - first)
+    {
+      first = lower;
+      last = upper;
+    }
+  }
+
+  std::vector<unsigned int> ids;
+  ids.reserve(last - first);
+  for (WordList::const_iterator it = first; it != last; ++it)
+    ids.push_back(it->second);
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+  std::vector<Match> matches;
+  for (size_t i = 0; i < ids.size(); i++)
+  {
+    const Entry& entry = m_entries[ids[i]];
+    if (!Matches(entry, words))
+      continue;
+    if (servers && servers->find(entry.result.server) == servers->end())
+      continue;
+
+    // titles starting with what was typed come first, then the shortest
+    Match match;
+    match.rank = entry.words.compare(0, normalized.size(), normalized) == 0 ? 0 : 1;
+    match.length = entry.words.size();
+    match.id = ids[i];
+    matches.push_back(match);
+  }
+
+  size_t count = std::min((size_t)maxResults, matches.size());
+  std::partial_sort(matches.begin(), matches.begin() + count, matches.end());
+
+  results.reserve(count);
+  for (size_t i = 0; i < count; i++)
+    results.push_back(m_entries[matches[i].id].result);
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <boost/shared_ptr.hpp>
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "threads/CriticalSection.h"
+
+class CFileItemList;
+class CGUIListItemArt;
+typedef boost::shared_ptr<const CGUIListItemArt> CGUIListItemArtPtr;
+
+// listings are dropped from the index, oldest first, once it has more items than this
+#define PLEX_SEARCH_INDEX_MAX_ITEMS 50000
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// In memory index over the titles of the library items that have already been fetched, so the
+// search window can show matches on every keystroke instead of waiting for the servers.
+//
+// Every directory listing is added under its url, adding the same listing again replaces what
+// it had added before. Titles are split into lower case words and a query matches when each of
+// its words is the start of a word in the title. The words are kept in one sorted array so a
+// query is a binary search per word, words added since the last query are sorted in when the
+// next query comes.
+//
+// Results only keep what it takes to show and open the item again, not the item of the listing,
+// so the index doesn't hold on to the listings it was filled from. The thumb is kept as the
+// listing's lazy art where it has one, its url is only built for the results that are shown.
+//
+// Once there are more than maxItems items, the listings added longest ago are dropped until
+// there's room again, but never the one just added.
+//
+class CPlexSearchIndex
+{
+public:
+  struct Result
+  {
+    Result() : type(0), folder(false) {}
+
+    std::string path;
+    std::string title;
+    std::string server;
+    std::string thumb;        // if the item had a plain url
+    CGUIListItemArtPtr thumbArt;
+    std::string sectionUUID;  // librarySectionUUID and unprocessed_key, to play it
+    std::string key;
+    int type;
+    bool folder;
+  };
+
+  CPlexSearchIndex(unsigned int maxItems = PLEX_SEARCH_INDEX_MAX_ITEMS);
+
+  // adds the library items of a listing, replacing what the listing added before
+  void AddItems(const std::string& source, const CFileItemList& list);
+
+  // same for items that were already picked out of a listing, path identifies an item across listings
+  void AddItems(const std::string& source, const std::vector<Result>& items);
+  void RemoveSource(const std::string& source);
+  void RemoveServer(const std::string& server);
+  void Clear();
+
+  // best matches first, only from the given servers unless servers is NULL
+  void Query(const std::string& query, unsigned int maxResults, std::vector<Result>& results,
+             const std::set<std::string>* servers = NULL);
+
+  unsigned int GetSize() const;
+
+  static void GetWords(const std::string& text, std::vector<std::string>& words);
+  static bool IsIndexed(int type);
+
+private:
+  struct Entry
+  {
+    Result result;
+    std::string words;      // the normalized title
+    unsigned int refs;      // number of listings the item is in, 0 once removed
+  };
+
+  typedef std::pair<std::string, unsigned int> Word;
+  typedef std::vector<Word> WordList;
+
+  unsigned int AddEntry(const Result& result);
+  void RemoveSource(std::map<std::string, std::vector<unsigned int> >::iterator it);
+  void RemoveOldest();
+  void Release(unsigned int id);
+  void SortWords();
+  void Compact();
+  bool Matches(const Entry& entry, const std::vector<std::string>& words) const;
+
+  std::vector<Entry> m_entries;
+  std::vector<unsigned int> m_free;
+  std::map<std::string, unsigned int> m_ids;
+  std::map<std::string, std::vector<unsigned int> > m_sources;
+  std::list<std::string> m_sourceOrder;   // the sources, added longest ago first
+  unsigned int m_maxItems;
+
+  WordList m_words;
+  WordList m_newWords;
+  unsigned int m_removed;   // entries released since the words were last compacted
+
+  mutable CCriticalSection m_lock;
+};
+
+typedef boost::shared_ptr<CPlexSearchIndex> CPlexSearchIndexPtr;
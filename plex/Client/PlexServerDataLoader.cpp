@@ -7,6 +7,7 @@
 #include "Application.h"
 
 #include "PlexTypes.h"
+#include "Client/PlexSearchIndex.h"
 
 #include <boost/foreach.hpp>
 
@@ -78,6 +79,9 @@ void CPlexServerDataLoader::RemoveServer(const CPlexServerPtr& server)
   if (m_servers.find(server->GetUUID()) != m_servers.end())
     m_servers.erase(server->GetUUID());
 
+  if (g_plexApplication.searchIndex)
+    g_plexApplication.searchIndex->RemoveServer(server->GetUUID());
+
   CGUIMessage msg(GUI_MSG_NOTIFY_ALL, PLEX_DATA_LOADER, 0, GUI_MSG_PLEX_SERVER_DATA_UNLOADED);
   msg.SetStringParam(server->GetUUID());
   g_windowManager.SendThreadMessage(msg);
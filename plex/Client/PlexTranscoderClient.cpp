@@ -27,6 +27,7 @@
 #include "AdvancedSettings.h"
 #include "Client/PlexTranscoderClientRPi.h"
 #include "log.h"
+#include "Utility/PlexTracer.h"
 
 #include <map>
 
@@ -252,6 +253,8 @@ std::string CPlexTranscoderClient::GetPrettyBitrate(int rawbitrate)
 ///////////////////////////////////////////////////////////////////////////////
 bool CPlexTranscoderClient::ShouldTranscode(CPlexServerPtr server, const CFileItem& item)
 {
+  PLEX_TRACE_SPAN("should transcode");
+
   if (!item.IsVideo())
     return false;
 
@@ -283,6 +286,8 @@ bool CPlexTranscoderClient::ShouldTranscode(CPlexServerPtr server, const CFileIt
 typedef std::pair<std::string, std::string> stringPair;
 CURL CPlexTranscoderClient::GetTranscodeURL(CPlexServerPtr server, const CFileItem& item)
 {
+  PLEX_TRACE_SPAN("transcode url");
+
   bool isLocal = server->GetActiveConnection()->IsLocal();
 
   CURL tURL;
@@ -18,6 +18,7 @@
 #include "Client/PlexConnection.h"
 #include "dialogs/GUIDialogKaiToast.h"
 #include "PlexMediaDecisionEngine.h"
+#include "Utility/PlexTracer.h"
 #include "linux/RBP.h"
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -70,6 +71,8 @@ CPlexTranscoderClientRPi::CPlexTranscoderClientRPi()
 ///////////////////////////////////////////////////////////////////////////////
 bool CPlexTranscoderClientRPi::ShouldTranscode(CPlexServerPtr server, const CFileItem& item)
 {
+  PLEX_TRACE_SPAN("should transcode");
+
   if (!item.IsVideo())
     return false;
 
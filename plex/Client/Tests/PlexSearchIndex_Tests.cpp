@@ -0,0 +1,330 @@
+#include "PlexTest.h"
+#include "Client/PlexSearchIndex.h"
+#include "FileItem.h"
+#include "PlexTypes.h"
+#include "utils/TimeUtils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static CPlexSearchIndex::Result makeResult(const std::string& path, const std::string& title,
+                                           const std::string& server = "abc123", int type = PLEX_DIR_TYPE_MOVIE)
+{
+  CPlexSearchIndex::Result result;
+  result.path = "plexserver://" + server + path;
+  result.title = title;
+  result.server = server;
+  result.type = type;
+  return result;
+}
+
+static std::vector<std::string> titles(const std::vector<CPlexSearchIndex::Result>& results)
+{
+  std::vector<std::string> titles;
+  for (size_t i = 0; i < results.size(); i++)
+    titles.push_back(results[i].title);
+  return titles;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexSearchIndex, words)
+{
+  std::vector<std::string> words;
+  CPlexSearchIndex::GetWords("Schindler's List (1993)", words);
+  ASSERT_EQ(3, words.size());
+  EXPECT_EQ("schindlers", words[0]);
+  EXPECT_EQ("list", words[1]);
+  EXPECT_EQ("1993", words[2]);
+
+  CPlexSearchIndex::GetWords(" -- ", words);
+  EXPECT_TRUE(words.empty());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexSearchIndex, prefixQuery)
+{
+  CPlexSearchIndex index;
+  std::vector<CPlexSearchIndex::Result> items;
+  items.push_back(makeResult("/library/metadata/1", "The Dark Knight"));
+  items.push_back(makeResult("/library/metadata/2", "The Dark Knight Rises"));
+  items.push_back(makeResult("/library/metadata/3", "Dark City"));
+  items.push_back(makeResult("/library/metadata/4", "Knight and Day"));
+  index.AddItems("plexserver://abc123/library/sections/1/all", items);
+
+  std::vector<CPlexSearchIndex::Result> results;
+  index.Query("dar", 10, results);
+  ASSERT_EQ(3, results.size());
+
+  // titles starting with the query first, then the shortest
+  EXPECT_EQ("Dark City", results[0].title);
+  EXPECT_EQ("The Dark Knight", results[1].title);
+  EXPECT_EQ("The Dark Knight Rises", results[2].title);
+
+  // every word has to match the start of a word
+  index.Query("KNIGHT da", 10, results);
+  ASSERT_EQ(3, results.size());
+  EXPECT_EQ("Knight and Day", results[0].title);
+
+  index.Query("ark", 10, results);
+  EXPECT_TRUE(results.empty());
+
+  index.Query("the", 1, results);
+  ASSERT_EQ(1, results.size());
+  EXPECT_EQ("The Dark Knight", results[0].title);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexSearchIndex, replaceSource)
+{
+  CPlexSearchIndex index;
+  std::vector<CPlexSearchIndex::Result> all, recent;
+  all.push_back(makeResult("/library/metadata/1", "Alien"));
+  all.push_back(makeResult("/library/metadata/2", "Aliens"));
+  recent.push_back(makeResult("/library/metadata/2", "Aliens"));
+  index.AddItems("all", all);
+  index.AddItems("recent", recent);
+  EXPECT_EQ(2, index.GetSize());
+
+  // listing the section again without Alien drops it, Aliens is still in the other listing
+  all.clear();
+  all.push_back(makeResult("/library/metadata/3", "Alien 3"));
+  index.AddItems("all", all);
+
+  std::vector<CPlexSearchIndex::Result> results;
+  index.Query("alien", 10, results);
+  std::vector<std::string> found = titles(results);
+  ASSERT_EQ(2, found.size());
+  EXPECT_EQ("Aliens", found[0]);
+  EXPECT_EQ("Alien 3", found[1]);
+
+  index.RemoveSource("all");
+  index.Query("alien", 10, results);
+  ASSERT_EQ(1, results.size());
+  EXPECT_EQ("Aliens", results[0].title);
+
+  // a renamed item is only found under its new title
+  recent.clear();
+  recent.push_back(makeResult("/library/metadata/2", "Aliens (Special Edition)"));
+  index.AddItems("recent", recent);
+  index.Query("spec", 10, results);
+  EXPECT_EQ(1, results.size());
+  index.Query("aliens special", 10, results);
+  EXPECT_EQ(1, results.size());
+  index.Query("edition alien", 10, results);
+  EXPECT_EQ(1, results.size());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexSearchIndex, servers)
+{
+  CPlexSearchIndex index;
+  std::vector<CPlexSearchIndex::Result> items;
+  items.push_back(makeResult("/library/metadata/1", "Up", "owned"));
+  items.push_back(makeResult("/library/metadata/1", "Up", "shared"));
+  index.AddItems("mixed", items);
+
+  std::set<std::string> servers;
+  servers.insert("owned");
+
+  std::vector<CPlexSearchIndex::Result> results;
+  index.Query("up", 10, results, &servers);
+  ASSERT_EQ(1, results.size());
+  EXPECT_EQ("owned", results[0].server);
+
+  index.RemoveServer("owned");
+  EXPECT_EQ(1, index.GetSize());
+  index.Query("up", 10, results);
+  ASSERT_EQ(1, results.size());
+  EXPECT_EQ("shared", results[0].server);
+
+  // removed entries are reused once the index is compacted
+  index.RemoveServer("shared");
+  EXPECT_EQ(0, index.GetSize());
+  index.AddItems("mixed", items);
+  index.Query("up", 10, results);
+  EXPECT_EQ(2, results.size());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexSearchIndex, benchmark)
+{
+  // 100k titles of two to four words out of a 3000 word vocabulary
+  srand(1);
+  std::vector<std::string> vocabulary;
+  for (int i = 0; i < 3000; i++)
+  {
+    std::string word;
+    int length = 3 + rand() % 7;
+    for (int j = 0; j < length; j++)
+      word += (char)('a' + rand() % 26);
+    word[0] = toupper(word[0]);
+    vocabulary.push_back(word);
+  }
+
+  CPlexSearchIndex index(100000);
+  std::vector<CPlexSearchIndex::Result> items;
+  for (int i = 0; i < 100000; i++)
+  {
+    std::string title;
+    int count = 2 + rand() % 3;
+    for (int j = 0; j < count; j++)
+      title += (j ? " " : "") + vocabulary[rand() % vocabulary.size()];
+
+    char path[64];
+    sprintf(path, "/library/metadata/%d", i);
+    items.push_back(makeResult(path, title));
+
+    // sections come in pages
+    if (items.size() == 5000)
+    {
+      char source[64];
+      sprintf(source, "section?start=%d", i);
+      index.AddItems(source, items);
+      items.clear();
+    }
+  }
+  EXPECT_EQ(100000, index.GetSize());
+
+  // type-ahead: every prefix of a title, the first query also sorts the words in
+  double total = 0, worst = 0;
+  int queries = 0;
+  std::vector<CPlexSearchIndex::Result> results;
+  for (int i = 0; i < 50; i++)
+  {
+    const std::string& word = vocabulary[rand() % vocabulary.size()];
+    std::string typed;
+    for (size_t j = 0; j < word.size(); j++)
+    {
+      typed += word[j];
+      int64_t start = CurrentHostCounter();
+      index.Query(typed, 50, results);
+      double ms = (CurrentHostCounter() - start) * 1000.0 / CurrentHostFrequency();
+
+      EXPECT_FALSE(results.empty());
+      if (queries > 0)
+      {
+        total += ms;
+        if (ms > worst)
+          worst = ms;
+      }
+      queries++;
+    }
+  }
+
+  printf("query latency over %d titles: average %.3fms, worst %.3fms over %d queries\n",
+         index.GetSize(), total / (queries - 1), worst, queries - 1);
+  EXPECT_LT(total / (queries - 1), 50.0);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexSearchIndex, listing)
+{
+  CFileItemList list;
+  CFileItemPtr movie(new CFileItem("plexserver://abc123/library/metadata/1", false));
+  movie->SetLabel("Heat");
+  movie->SetPlexDirectoryType(PLEX_DIR_TYPE_MOVIE);
+  movie->SetArt("thumb", "plexserver://abc123/library/metadata/1/thumb/1");
+  movie->SetProperty("librarySectionUUID", "section1");
+  movie->SetProperty("unprocessed_key", "/library/metadata/1");
+  list.Add(movie);
+
+  // neither library items nor from a server
+  CFileItemPtr dir(new CFileItem("plexserver://abc123/library/sections/1/all", true));
+  dir->SetLabel("Heat Wave");
+  dir->SetPlexDirectoryType(PLEX_DIR_TYPE_DIRECTORY);
+  list.Add(dir);
+  CFileItemPtr local(new CFileItem("/media/heat.mkv", false));
+  local->SetLabel("Heat");
+  local->SetPlexDirectoryType(PLEX_DIR_TYPE_MOVIE);
+  list.Add(local);
+
+  CPlexSearchIndex index;
+  index.AddItems("plexserver://abc123/library/sections/1/all", list);
+  EXPECT_EQ(1, index.GetSize());
+
+  // what's needed to show and play the item is copied, the listing isn't kept
+  long uses = movie.use_count();
+  list.Clear();
+  EXPECT_EQ(uses - 1, movie.use_count());
+
+  std::vector<CPlexSearchIndex::Result> results;
+  index.Query("heat", 10, results);
+  ASSERT_EQ(1, results.size());
+  EXPECT_EQ("plexserver://abc123/library/metadata/1", results[0].path);
+  EXPECT_EQ("Heat", results[0].title);
+  EXPECT_EQ("abc123", results[0].server);
+  EXPECT_EQ("plexserver://abc123/library/metadata/1/thumb/1", results[0].thumb);
+  EXPECT_FALSE(results[0].thumbArt);
+  EXPECT_EQ("section1", results[0].sectionUUID);
+  EXPECT_EQ("/library/metadata/1", results[0].key);
+  EXPECT_EQ(PLEX_DIR_TYPE_MOVIE, results[0].type);
+  EXPECT_FALSE(results[0].folder);
+}
+
+// counts the urls built
+class CCountingArt : public CGUIListItemArt
+{
+public:
+  CCountingArt() : m_built(0) {}
+  virtual std::string GetURL() const { m_built++; return "http://thumb"; }
+  mutable int m_built;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexSearchIndex, lazyThumb)
+{
+  boost::shared_ptr<CCountingArt> art(new CCountingArt);
+
+  CFileItemList list;
+  CFileItemPtr movie(new CFileItem("plexserver://abc123/library/metadata/1", false));
+  movie->SetLabel("Heat");
+  movie->SetPlexDirectoryType(PLEX_DIR_TYPE_MOVIE);
+  movie->SetArt("thumb", art);
+  list.Add(movie);
+
+  CPlexSearchIndex index;
+  index.AddItems("plexserver://abc123/library/sections/1/all", list);
+
+  // indexing doesn't build it
+  std::vector<CPlexSearchIndex::Result> results;
+  index.Query("heat", 10, results);
+  ASSERT_EQ(1, results.size());
+  EXPECT_EQ(art, results[0].thumbArt);
+  EXPECT_TRUE(results[0].thumb.empty());
+  EXPECT_EQ(0, art->m_built);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexSearchIndex, bounded)
+{
+  CPlexSearchIndex index(3);
+  std::vector<CPlexSearchIndex::Result> a, b, c;
+  a.push_back(makeResult("/library/metadata/1", "Alien"));
+  a.push_back(makeResult("/library/metadata/2", "Aliens"));
+  b.push_back(makeResult("/library/metadata/3", "Alien 3"));
+  c.push_back(makeResult("/library/metadata/4", "Alien Resurrection"));
+  c.push_back(makeResult("/library/metadata/5", "Alien Covenant"));
+
+  index.AddItems("a", a);
+  index.AddItems("b", b);
+  EXPECT_EQ(3, index.GetSize());
+
+  // a was added longest ago
+  index.AddItems("c", c);
+  EXPECT_EQ(3, index.GetSize());
+
+  std::vector<CPlexSearchIndex::Result> results;
+  index.Query("alien", 10, results);
+  std::vector<std::string> found = titles(results);
+  ASSERT_EQ(3, found.size());
+  EXPECT_EQ("Alien 3", found[0]);
+
+  // adding b again makes c the oldest, and a listing too large on its own is still kept
+  index.AddItems("b", b);
+  a.push_back(makeResult("/library/metadata/6", "Alien vs Predator"));
+  a.push_back(makeResult("/library/metadata/7", "Alien Romulus"));
+  index.AddItems("a", a);
+  EXPECT_EQ(4, index.GetSize());
+  index.Query("3", 10, results);
+  EXPECT_TRUE(results.empty());
+}
@@ -10,6 +10,7 @@
 #include "Breakpad.h"
 #include "filesystem/Directory.h"
 #include "PlexUtils.h"
+#include "utils/log.h"
 
 #include <string>
 
@@ -30,6 +31,9 @@
 /////////////////////////////////////////////////////////////////////////////////////////
 static inline bool BreakPad_MinidumpCallback(const google_breakpad::MinidumpDescriptor& desc, void *context, bool succeeded)
 {
+  // get the lines leading up to the crash into the log
+  CLog::Flush(false);
+
   // Store the version in the filename.
   char finalPath[PATH_MAX+1];
   strcpy(finalPath, desc.path());
@@ -72,6 +76,8 @@ bool BreakPad_MinidumpCallback(const wchar_t* dump_path,
                                MDRawAssertionInfo* assertion,
                                bool succeeded)
 {
+  CLog::Flush(false);
+
   if (dump_path && minidump_id)
   {
     // Rename the file, best effort
@@ -87,6 +93,8 @@ bool BreakPad_MinidumpCallback(const wchar_t* dump_path,
 #include <string>
 static inline bool BreakPad_MinidumpCallback(const char *dump_dir, const char *minidump_id, void *context, bool succeeded)
 {
+  CLog::Flush(false);
+
   // Store the version in the filename.
   std::string dp(dump_dir), mid(minidump_id);
   if (dp.empty() || mid.empty())
@@ -202,51 +202,105 @@ CStdString CPlexAttributeParserMediaUrl::GetImageURL(const CURL &url, const CStd
   return mediaUrl.Get();
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+static CCriticalSection g_imageArtSection;
+
+// the part of a directory url GetImageURL() uses, shared by all items from that server
+static boost::shared_ptr<const CURL> GetServerURL(const CURL &url)
+{
+  static std::map<std::string, boost::shared_ptr<const CURL> > serverUrls;
+
+  std::string key = url.GetProtocol() + "://" + url.GetUserName() + ":" + url.GetPassWord() + "@" +
+                    url.GetHostName() + ":" + boost::lexical_cast<std::string>(url.GetPort());
+
+  CSingleLock lock(g_imageArtSection);
+  std::map<std::string, boost::shared_ptr<const CURL> >::const_iterator it = serverUrls.find(key);
+  if (it != serverUrls.end())
+    return it->second;
+
+  CURL *serverUrl = new CURL(url);
+  serverUrl->SetFileName("");
+  serverUrl->SetOptions("");
+  boost::shared_ptr<const CURL> server(serverUrl);
+  serverUrls[key] = server;
+  return server;
+}
+
+CPlexImageArt::CPlexImageArt(const CURL &url, const CStdString &source, int height, int width, bool transcode)
+  : m_server(GetServerURL(url)), m_source(source), m_height(height), m_width(width), m_transcode(transcode)
+{
+}
+
+std::string CPlexImageArt::GetURL() const
+{
+  {
+    CSingleLock lock(g_imageArtSection);
+    if (!m_url.empty())
+      return m_url;
+  }
+
+  // built outside the lock as it looks up servers, worst case two threads build the same url
+  CStdString url = CPlexAttributeParserMediaUrl::GetImageURL(*m_server, m_source, m_height, m_width, m_transcode);
+
+  CSingleLock lock(g_imageArtSection);
+  m_url = url;
+  return m_url;
+}
+
 #define SMALL_SIZE 320
 #define MEDIUM_SIZE 720
 #define LARGE_SIZE 2048
 
+// the urls are only built for the sizes that end up being shown
+static CGUIListItemArtPtr ImageArt(const CURL &url, const CStdString &source, int size, bool transcode = true)
+{
+  return CGUIListItemArtPtr(new CPlexImageArt(url, source, size, size, transcode));
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void CPlexAttributeParserMediaUrl::Process(const CURL &url, const CStdString &key, const CStdString &value, CFileItem *item)
 {
   if (key == "thumb")
   {
-    item->SetArt("smallThumb", GetImageURL(url, value, SMALL_SIZE, SMALL_SIZE));
-    item->SetArt("thumb", GetImageURL(url, value, MEDIUM_SIZE, MEDIUM_SIZE));
-    item->SetArt("bigThumb", GetImageURL(url, value, LARGE_SIZE, LARGE_SIZE));
+    item->SetArt("smallThumb", ImageArt(url, value, SMALL_SIZE));
+    item->SetArt("thumb", ImageArt(url, value, MEDIUM_SIZE));
+    item->SetArt("bigThumb", ImageArt(url, value, LARGE_SIZE));
   }
   else if (key == "poster")
   {
-    item->SetArt("smallPoster", GetImageURL(url, value, SMALL_SIZE, SMALL_SIZE));
-    item->SetArt("poster", GetImageURL(url, value, MEDIUM_SIZE, MEDIUM_SIZE));
-    item->SetArt("bigPoster", GetImageURL(url, value, LARGE_SIZE, LARGE_SIZE));
+    item->SetArt("smallPoster", ImageArt(url, value, SMALL_SIZE));
+    item->SetArt("poster", ImageArt(url, value, MEDIUM_SIZE));
+    item->SetArt("bigPoster", ImageArt(url, value, LARGE_SIZE));
   }
   else if (key == "grandparentThumb")
   {
-    item->SetArt("smallGrandparentThumb", GetImageURL(url, value, SMALL_SIZE, SMALL_SIZE));
-    item->SetArt("grandparentThumb", GetImageURL(url, value, MEDIUM_SIZE, MEDIUM_SIZE));
-    item->SetArt(PLEX_ART_TVSHOW_THUMB, GetImageURL(url, value, MEDIUM_SIZE, MEDIUM_SIZE));
-    item->SetArt("bigGrandparentThumb", GetImageURL(url, value, LARGE_SIZE, LARGE_SIZE));
+    CGUIListItemArtPtr thumb = ImageArt(url, value, MEDIUM_SIZE);
+    item->SetArt("smallGrandparentThumb", ImageArt(url, value, SMALL_SIZE));
+    item->SetArt("grandparentThumb", thumb);
+    item->SetArt(PLEX_ART_TVSHOW_THUMB, thumb);
+    item->SetArt("bigGrandparentThumb", ImageArt(url, value, LARGE_SIZE));
   }
   else if (key == "banner")
-    item->SetArt("banner", GetImageURL(url, value, 200, 800));
+    item->SetArt("banner", CGUIListItemArtPtr(new CPlexImageArt(url, value, 200, 800)));
   else if (key == "art")
-    item->SetArt(PLEX_ART_FANART, GetImageURL(url, value, LARGE_SIZE, LARGE_SIZE, !g_guiSettings.GetBool("myplex.disablefanarttranscode")));
+    item->SetArt(PLEX_ART_FANART, ImageArt(url, value, LARGE_SIZE, !g_guiSettings.GetBool("myplex.disablefanarttranscode")));
   else if (key == "picture")
-    item->SetArt("picture", GetImageURL(url, value, LARGE_SIZE, LARGE_SIZE, !g_guiSettings.GetBool("myplex.disablepicturetranscode")));
+    item->SetArt("picture", ImageArt(url, value, LARGE_SIZE, !g_guiSettings.GetBool("myplex.disablepicturetranscode")));
   else
-    item->SetArt(key, GetImageURL(url, value, 320, 320));
+    item->SetArt(key, ImageArt(url, value, 320));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 void CPlexAttributeParserMediaFlag::Process(const CURL &url, const CStdString &key, const CStdString &value, CFileItem *item)
 {
-  static std::map<std::string, std::string> FlagsMap;
+  // thousands of items share the same few flags, so they share the art too
+  static std::map<std::string, CGUIListItemArtPtr> FlagsMap;
   static CCriticalSection FlagsMapSection;
   CSingleLock Lock(FlagsMapSection);
 
-  std::map<std::string, std::string>::const_iterator got = FlagsMap.find(key + "|" + value);
-  if ((got != FlagsMap.end()) && true)
+  std::string flagKey = url.GetHostName() + "|" + key + "|" + value;
+  std::map<std::string, CGUIListItemArtPtr>::const_iterator got = FlagsMap.find(flagKey);
+  if (got != FlagsMap.end())
   {
     item->SetArt("mediaTag::" + key, got->second);
     item->SetProperty("mediaTag-" + key, value);
@@ -283,11 +337,12 @@ void CPlexAttributeParserMediaFlag::Process(const CURL &url, const CStdString &k
       mediaTagUrl.SetOption("t", mediaTagVersion);
 
     //CLog::Log(LOGDEBUG, "CPlexAttributeParserMediaFlag::Process MEDIATAG: mediaTag::%s = %s | mediaTag-%s = %s", key.c_str(), mediaTagUrl.Get().c_str(), key.c_str(), value.c_str());
-    CPlexAttributeParserMediaUrl::Process(url, "mediaTag::" + key, mediaTagUrl.Get(), item);
+    CGUIListItemArtPtr art(new CPlexImageArt(url, mediaTagUrl.Get(), 320, 320));
+    item->SetArt("mediaTag::" + key, art);
 
     /* also store the raw value */
     item->SetProperty("mediaTag-" + key, value);
-    FlagsMap[key + "|" + value] = item->GetArt("mediaTag::" + key);
+    FlagsMap[flagKey] = art;
   }
 }
 
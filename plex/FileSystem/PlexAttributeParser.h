@@ -14,6 +14,7 @@
 
 #include "URL.h"
 #include "plex/PlexUtils.h"
+#include "guilib/GUIListItem.h"
 
 class CFileItem;
 
@@ -43,6 +44,24 @@ class CPlexAttributeParserKey : public CPlexAttributeParserBase
     virtual void Process(const CURL& url, const CStdString &key, const CStdString &value, CFileItem *item);
 };
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/// An image on a server, which only becomes a transcoder url when it's shown.
+/// Images of all items from the same server share the server's url.
+class CPlexImageArt : public CGUIListItemArt
+{
+  public:
+    CPlexImageArt(const CURL &url, const CStdString &source, int height, int width, bool transcode = true);
+    virtual std::string GetURL() const;
+
+  private:
+    boost::shared_ptr<const CURL> m_server;
+    CStdString m_source;
+    int m_height;
+    int m_width;
+    bool m_transcode;
+    mutable CStdString m_url;   // built by the first GetURL()
+};
+
 class CPlexAttributeParserMediaUrl : public CPlexAttributeParserBase
 {
   public:
@@ -47,6 +47,8 @@
 #include "XMLChoice.h"
 #include "AdvancedSettings.h"
 #include "PlexDirectoryCache.h"
+#include "PlexDirectoryFanout.h"
+#include "Client/PlexSearchIndex.h"
 #include "Client/PlexServerVersion.h"
 #include "StringUtils.h"
 
@@ -233,6 +235,10 @@ bool CPlexDirectory::GetDirectory(const CURL& url, CFileItemList& fileItems)
     // add evetually to the cache
     if (g_plexApplication.directoryCache)
       g_plexApplication.directoryCache->AddToCache(cacheURL, newHash, fileItems, m_cacheStrategy);
+
+    // and the titles of library listings to the local search index
+    if (g_plexApplication.searchIndex && m_url.GetFileName() != "search")
+      g_plexApplication.searchIndex->AddItems(cacheURL, fileItems);
   }
 
   float elapsed = timer.GetElapsedSeconds();
@@ -523,6 +529,7 @@ CFileItemPtr CPlexDirectory::NewPlexElement(XML_ELEMENT *element, const CFileIte
             newItem->m_bIsFolder ? "yes" : "no");
 #endif
 
+  newItem->CompactProperties();
   return newItem;
 }
 
@@ -579,6 +586,7 @@ void CPlexDirectory::ReadChildren(XML_ELEMENT* root, CFileItemList& container)
     item->SetProperty("index", container.GetProperty("offset").asInteger() + itemcount);
     
     item->m_bIsFolder = IsFolder(item, element);
+    item->CompactProperties();
 
     container.Add(item);
 
@@ -953,6 +961,44 @@ bool CPlexDirectory::GetOnlineChannelDirectory(CFileItemList &items)
   return success;
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// tags the playlists with the server they are on and passes on what's merged so far
+class CPlexPlaylistsFanoutCallback : public IPlexDirectoryFanoutCallback
+{
+public:
+  CPlexPlaylistsFanoutCallback(IPlexDirectoryFanoutCallback* progress) : m_progress(progress) {}
+
+  void OnFanoutItems(const CPlexServerPtr& server, CFileItemList& items)
+  {
+    for (int i = 0; i < items.Size(); i ++)
+    {
+      CFileItemPtr item = items.Get(i);
+      if (!item)
+        continue;
+
+      item->SetProperty("serverName", server->GetName());
+      item->SetProperty("serverOwner", server->GetOwner());
+      item->SetProperty("PlexContent", PlexUtils::GetPlexContent(*item));
+
+      // we expect music instead of audio in the skin
+      std::string type = item->GetProperty("playlistType").asString();
+      if (type == "audio")
+        type = "music";
+
+      item->SetProperty("type", type + "playlist");
+    }
+  }
+
+  void OnFanoutProgress(const CFileItemList& items, int done, int total)
+  {
+    if (m_progress)
+      m_progress->OnFanoutProgress(items, done, total);
+  }
+
+private:
+  IPlexDirectoryFanoutCallback* m_progress;
+};
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 bool CPlexDirectory::GetPlaylistsDirectory(CFileItemList &items, CStdString options)
 {
@@ -961,6 +1007,10 @@ bool CPlexDirectory::GetPlaylistsDirectory(CFileItemList &items, CStdString opti
   items.SetPath("plexserver://playlists/");
   items.AddSortMethod(SORT_METHOD_NONE, 553, LABEL_MASKS());
   
+  // all servers are asked at once, a slow one only holds up its own playlists
+  CPlexPlaylistsFanoutCallback callback(m_fanoutCallback);
+  CPlexDirectoryFanout fanout(&callback);
+
   CPlexServerVersion playlistVersion("0.9.9.12.0");
   PlexServerList list = g_plexApplication.serverManager->GetAllServers(CPlexServerManager::SERVER_OWNED, true);
   BOOST_FOREACH(CPlexServerPtr server, list)
@@ -972,37 +1022,14 @@ bool CPlexDirectory::GetPlaylistsDirectory(CFileItemList &items, CStdString opti
       plURL.SetOptions(options);
       plURL.SetOption("type", boost::lexical_cast<std::string>(PLEX_MEDIA_FILTER_TYPE_PLAYLISTITEM));
       plURL.SetOption("sort", "lastViewedAt");
-      
-      CFileItemList plList;
-      
-      if (GetDirectory(plURL, plList))
-      {
-        for (int i = 0; i < plList.Size(); i ++)
-        {
-          CFileItemPtr item = plList.Get(i);
-          if (!item)
-            continue;
-          
-          item->SetProperty("serverName", server->GetName());
-          item->SetProperty("serverOwner", server->GetOwner());
-          item->SetProperty("PlexContent", PlexUtils::GetPlexContent(*item));
-
-          // we expect music instead of audio in the skin
-          std::string type = item->GetProperty("playlistType").asString();
-          if (type == "audio")
-            type = "music";
-          
-          item->SetProperty("type", type + "playlist");
-          
-          items.Add(item);
-        }
-      }
-      else
-      {
-        CLog::Log(LOGWARNING, "CPlexDirectory::GetPlaylistsDirectory - failed to fetch playlists from %s", server->toString().c_str());
-      }
+
+      CPlexDirectory* dir = NewFanoutDirectory();
+      dir->SetCacheStrategy(m_cacheStrategy);
+      fanout.add(server, plURL, dir);
     }
   }
+
+  fanout.run(items);
   
   return true;
 }
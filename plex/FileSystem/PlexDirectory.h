@@ -28,6 +28,8 @@
 #include "FileSystem/PlexFile.h"
 #include "FileSystem/PlexDirectoryCache.h"
 
+class IPlexDirectoryFanoutCallback;
+
 namespace XFILE
 {
   class CPlexDirectory : public IDirectory
@@ -38,11 +40,16 @@ namespace XFILE
       , m_xmlData(new char[1024])
       , m_cacheStrategy(CPlexDirectoryCache::CACHE_STRATEGY_ITEM_COUNT)
       , m_showErrors(false)
+      , m_fanoutCallback(NULL)
     {
     }
 
     // make it easy to override network access in tests.
     virtual bool GetXMLData(CStdString& data);
+
+    // the directory that fetches from one of the servers of a fanout, tests return one that
+    // overrides GetXMLData as well.
+    virtual CPlexDirectory* NewFanoutDirectory() const { return new CPlexDirectory; }
     bool GetDirectory(const CURL& url, CFileItemList& items);
 
     /* plexserver://shared */
@@ -138,6 +145,9 @@ namespace XFILE
     inline void SetShowErrors(bool showErrors)  { m_showErrors = showErrors; }
     inline bool ShouldShowErrors()  { return m_showErrors; }
 
+    /* told about what the servers returned so far when the directory fans out to all of them */
+    inline void SetFanoutCallback(IPlexDirectoryFanoutCallback* callback) { m_fanoutCallback = callback; }
+
   private:
     CStdString m_body;
     CStdString m_data;
@@ -149,6 +159,7 @@ namespace XFILE
 
     CStdString m_verb;
     bool m_showErrors;
+    IPlexDirectoryFanoutCallback* m_fanoutCallback;
   };
 }
 
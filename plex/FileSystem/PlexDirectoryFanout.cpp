@@ -0,0 +1,340 @@
+#include "PlexDirectoryFanout.h"
+
+#include "JobManager.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/log.h"
+
+#include <algorithm>
+#include <climits>
+
+#define PLEX_LATENCY_BUCKETS 9
+#define PLEX_LATENCY_FIRST_BUCKET_MS 50
+
+using namespace XFILE;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CPlexLatencyHistogram::CPlexLatencyHistogram()
+  : m_buckets(PLEX_LATENCY_BUCKETS, 0), m_count(0), m_timeouts(0)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+unsigned int CPlexLatencyHistogram::getBucketLimit(size_t bucket)
+{
+  // the last one has everything that took longer
+  if (bucket >= PLEX_LATENCY_BUCKETS - 1)
+    return UINT_MAX;
+  return PLEX_LATENCY_FIRST_BUCKET_MS << bucket;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexLatencyHistogram::add(unsigned int ms)
+{
+  size_t bucket = 0;
+  while (ms > getBucketLimit(bucket))
+    bucket++;
+
+  m_buckets[bucket]++;
+  m_count++;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+unsigned int CPlexLatencyHistogram::getPercentile(unsigned int percent) const
+{
+  if (m_count == 0)
+    return 0;
+
+  unsigned int wanted = std::max(1u, (m_count * percent + 99) / 100);
+  unsigned int seen = 0;
+  for (size_t i = 0; i < m_buckets.size(); i++)
+  {
+    seen += m_buckets[i];
+    if (seen >= wanted)
+      return getBucketLimit(i);
+  }
+
+  return UINT_MAX;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+std::string CPlexLatencyHistogram::toString() const
+{
+  CStdString str;
+  str.Format("%u requests, p50 <= %ums, p90 <= %ums, %u timeouts", m_count, getPercentile(50),
+             getPercentile(90), m_timeouts);
+  return str;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+static CCriticalSection& latencyLock()
+{
+  static CCriticalSection lock;
+  return lock;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+static std::map<std::string, CPlexLatencyHistogram>& latencies()
+{
+  static std::map<std::string, CPlexLatencyHistogram> histograms;
+  return histograms;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CPlexLatencyHistogram CPlexDirectoryFanout::getLatency(const std::string& uuid)
+{
+  CSingleLock lk(latencyLock());
+  std::map<std::string, CPlexLatencyHistogram>::const_iterator it = latencies().find(uuid);
+  if (it == latencies().end())
+    return CPlexLatencyHistogram();
+  return it->second;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexDirectoryFanout::clearLatencies()
+{
+  CSingleLock lk(latencyLock());
+  latencies().clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexDirectoryFanout::addLatency(const std::string& uuid, unsigned int ms, bool timeout)
+{
+  CSingleLock lk(latencyLock());
+  CPlexLatencyHistogram& histogram = latencies()[uuid];
+  if (timeout)
+    histogram.addTimeout();
+  else
+    histogram.add(ms);
+
+  CLog::Log(LOGDEBUG, "CPlexDirectoryFanout::addLatency %s %s after %u ms, %s", uuid.c_str(),
+            timeout ? "timed out" : "answered", ms, histogram.toString().c_str());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CPlexDirectoryFanout::CPlexDirectoryFanout(IPlexDirectoryFanoutCallback* callback)
+  : m_callback(callback), m_startTime(0)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CPlexDirectoryFanout::~CPlexDirectoryFanout()
+{
+  CSingleLock lk(m_lock);
+
+  for (std::vector<Request>::iterator it = m_requests.begin(); it != m_requests.end(); ++it)
+  {
+    if (it->state == REQUEST_PENDING && it->jobID)
+      CJobManager::GetInstance().CancelJob(it->jobID);
+
+    // never handed to a job
+    delete it->dir;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexDirectoryFanout::add(const CPlexServerPtr& server, const CURL& url, CPlexDirectory* dir,
+                               unsigned int deadlineMs)
+{
+  CSingleLock lk(m_lock);
+
+  Request request;
+  request.server = server;
+  request.url = url;
+  request.dir = dir;
+  request.deadlineMs = deadlineMs;
+  request.jobID = 0;
+  request.started = false;
+  request.startTime = 0;
+  request.state = REQUEST_PENDING;
+  request.merged = 0;
+
+  m_requests.push_back(request);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexDirectoryFanout::run(CFileItemList& items)
+{
+  {
+    // held until every job has its id, so none of them can complete before that
+    CSingleLock lk(m_lock);
+
+    m_startTime = XbmcThreads::SystemClockMillis();
+    for (std::vector<Request>::iterator it = m_requests.begin(); it != m_requests.end(); ++it)
+    {
+      CPlexDirectory* dir = it->dir ? it->dir : new CPlexDirectory;
+      it->dir = NULL;
+      it->jobID = CJobManager::GetInstance().AddJob(new CPlexFanoutFetchJob(dir, it->url), this, CJob::PRIORITY_HIGH);
+    }
+  }
+
+  while (true)
+  {
+    bool pending = false;
+    unsigned int wait = UINT_MAX;
+
+    {
+      CSingleLock lk(m_lock);
+      unsigned int now = XbmcThreads::SystemClockMillis();
+
+      for (std::vector<Request>::iterator it = m_requests.begin(); it != m_requests.end(); ++it)
+      {
+        if (it->state != REQUEST_PENDING)
+          continue;
+
+        // still waiting for a worker, the deadline only starts once it has one
+        if (!it->started)
+        {
+          unsigned int queued = now - m_startTime;
+          if (queued >= PLEX_FANOUT_MAX_QUEUED_MS)
+          {
+            CLog::Log(LOGWARNING, "CPlexDirectoryFanout::run %s wasn't started within %u ms, going on without it",
+                      it->server ? it->server->toString().c_str() : "", queued);
+            CJobManager::GetInstance().CancelJob(it->jobID);
+            it->state = REQUEST_TIMEOUT;
+            continue;
+          }
+
+          pending = true;
+          wait = std::min(wait, PLEX_FANOUT_MAX_QUEUED_MS - queued);
+          continue;
+        }
+
+        unsigned int elapsed = now - it->startTime;
+        if (elapsed >= it->deadlineMs)
+        {
+          CLog::Log(LOGWARNING, "CPlexDirectoryFanout::run %s didn't answer within %u ms, going on without it",
+                    it->server ? it->server->toString().c_str() : "", it->deadlineMs);
+          CJobManager::GetInstance().CancelJob(it->jobID);
+          it->state = REQUEST_TIMEOUT;
+          if (it->server)
+            addLatency(it->server->GetUUID(), elapsed, true);
+          continue;
+        }
+
+        pending = true;
+        wait = std::min(wait, it->deadlineMs - elapsed);
+      }
+    }
+
+    mergeArrived(items);
+
+    if (!pending)
+      break;
+
+    m_arrived.WaitMSec(wait);
+  }
+
+  CSingleLock lk(m_lock);
+  for (std::vector<Request>::const_iterator it = m_requests.begin(); it != m_requests.end(); ++it)
+  {
+    if (it->state == REQUEST_MERGED)
+      return true;
+  }
+  return m_requests.empty();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexDirectoryFanout::mergeArrived(CFileItemList& items)
+{
+  std::vector<size_t> arrived;
+  int done = 0;
+
+  {
+    CSingleLock lk(m_lock);
+    for (size_t i = 0; i < m_requests.size(); i++)
+    {
+      if (m_requests[i].state == REQUEST_DONE)
+        arrived.push_back(i);
+      if (m_requests[i].state != REQUEST_PENDING)
+        done++;
+    }
+  }
+
+  if (arrived.empty())
+    return;
+
+  // nothing touches a request once it's done, so it's merged without holding the lock
+  for (std::vector<size_t>::const_iterator it = arrived.begin(); it != arrived.end(); ++it)
+  {
+    Request& request = m_requests[*it];
+
+    if (m_callback)
+      m_callback->OnFanoutItems(request.server, *request.items);
+
+    // after everything the servers before it returned
+    int position = 0;
+    for (size_t i = 0; i < *it; i++)
+      position += m_requests[i].merged;
+
+    for (int i = 0; i < request.items->Size(); i++)
+      items.Insert(position + i, request.items->Get(i));
+
+    request.merged = request.items->Size();
+    request.items.reset();
+
+    CSingleLock lk(m_lock);
+    request.state = REQUEST_MERGED;
+  }
+
+  if (m_callback)
+    m_callback->OnFanoutProgress(items, done, m_requests.size());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexDirectoryFanout::OnJobComplete(unsigned int jobID, bool success, CJob* job)
+{
+  CSingleLock lk(m_lock);
+
+  for (std::vector<Request>::iterator it = m_requests.begin(); it != m_requests.end(); ++it)
+  {
+    if (it->jobID != jobID)
+      continue;
+
+    // too late, the fanout went on without it
+    if (it->state != REQUEST_PENDING)
+      return;
+
+    unsigned int elapsed = XbmcThreads::SystemClockMillis() - (it->started ? it->startTime : m_startTime);
+    if (it->server)
+      addLatency(it->server->GetUUID(), elapsed, false);
+
+    CPlexFanoutFetchJob* fetchJob = static_cast<CPlexFanoutFetchJob*>(job);
+    if (success && fetchJob)
+    {
+      it->items = CFileItemListPtr(new CFileItemList);
+      it->items->Assign(fetchJob->m_items, false);
+      it->state = REQUEST_DONE;
+    }
+    else
+    {
+      CLog::Log(LOGWARNING, "CPlexDirectoryFanout::OnJobComplete failed to fetch %s", it->url.Get().c_str());
+      it->state = REQUEST_FAILED;
+    }
+
+    m_arrived.Set();
+    return;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexDirectoryFanout::OnJobProgress(unsigned int jobID, unsigned int progress, unsigned int total, const CJob* job)
+{
+  CSingleLock lk(m_lock);
+
+  for (std::vector<Request>::iterator it = m_requests.begin(); it != m_requests.end(); ++it)
+  {
+    if (it->jobID != jobID)
+      continue;
+
+    if (!it->started)
+    {
+      it->started = true;
+      it->startTime = XbmcThreads::SystemClockMillis();
+
+      // run() waits for the deadline from now on
+      m_arrived.Set();
+    }
+    return;
+  }
+}
@@ -0,0 +1,141 @@
+#ifndef PLEXDIRECTORYFANOUT_H
+#define PLEXDIRECTORYFANOUT_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/scoped_ptr.hpp>
+
+#include "FileItem.h"
+#include "Job.h"
+#include "URL.h"
+#include "Client/PlexServer.h"
+#include "FileSystem/PlexDirectory.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+
+// how long one server gets to answer before the fanout goes on without it, from when its job started
+#define PLEX_FANOUT_DEADLINE_MS 5000
+
+// how long a request may wait for a job worker at all, in case the job manager never gets to it
+#define PLEX_FANOUT_MAX_QUEUED_MS 30000
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// response times of one server, in buckets that double from 50ms, the last one has everything slower
+class CPlexLatencyHistogram
+{
+public:
+  CPlexLatencyHistogram();
+
+  void add(unsigned int ms);
+  void addTimeout() { m_timeouts++; }
+
+  unsigned int getCount() const { return m_count; }
+  unsigned int getTimeouts() const { return m_timeouts; }
+
+  // the upper bound of the bucket the percentile falls in
+  unsigned int getPercentile(unsigned int percent) const;
+
+  std::string toString() const;
+
+  static unsigned int getBucketLimit(size_t bucket);
+
+private:
+  std::vector<unsigned int> m_buckets;
+  unsigned int m_count;
+  unsigned int m_timeouts;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class IPlexDirectoryFanoutCallback
+{
+public:
+  virtual ~IPlexDirectoryFanoutCallback() {}
+
+  // the items one server returned, before they are merged with the others
+  virtual void OnFanoutItems(const CPlexServerPtr& server, CFileItemList& items) {}
+
+  // everything merged so far, each time the items of another server were merged
+  virtual void OnFanoutProgress(const CFileItemList& items, int done, int total) {}
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class CPlexFanoutFetchJob : public CJob
+{
+public:
+  CPlexFanoutFetchJob(XFILE::CPlexDirectory* dir, const CURL& url) : m_dir(dir), m_url(url) {}
+
+  // tells the fanout it started, so its deadline counts from here and not from when it was queued
+  virtual bool DoWork() { return !ShouldCancel(0, 0) && m_dir->GetDirectory(m_url, m_items); }
+  virtual void Cancel() { m_dir->CancelDirectory(); }
+  virtual const char* GetType() const { return "plexfanoutfetch"; }
+
+  boost::scoped_ptr<XFILE::CPlexDirectory> m_dir;
+  CURL m_url;
+  CFileItemList m_items;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Fetches the same kind of directory from several servers at once. Every server has its own
+// deadline, a server that doesn't make it is cancelled and left out instead of holding up the
+// others. The results are merged into the list as they come in, but always in the order the
+// servers were added, so the list doesn't reorder itself depending on who answered first.
+//
+// How long every server took is kept in a histogram per server for as long as we run.
+//
+class CPlexDirectoryFanout : public IJobCallback
+{
+public:
+  CPlexDirectoryFanout(IPlexDirectoryFanoutCallback* callback = NULL);
+  virtual ~CPlexDirectoryFanout();
+
+  // dir fetches url from server and is owned by the fanout, NULL uses a plain CPlexDirectory
+  void add(const CPlexServerPtr& server, const CURL& url, XFILE::CPlexDirectory* dir = NULL,
+           unsigned int deadlineMs = PLEX_FANOUT_DEADLINE_MS);
+
+  // blocks until every server answered or ran out of time, false if none of them answered
+  bool run(CFileItemList& items);
+
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob* job);
+  virtual void OnJobProgress(unsigned int jobID, unsigned int progress, unsigned int total, const CJob* job);
+
+  static CPlexLatencyHistogram getLatency(const std::string& uuid);
+  static void clearLatencies();
+
+private:
+  enum RequestState
+  {
+    REQUEST_PENDING,
+    REQUEST_DONE,     // arrived, not merged yet
+    REQUEST_MERGED,
+    REQUEST_FAILED,
+    REQUEST_TIMEOUT
+  };
+
+  struct Request
+  {
+    CPlexServerPtr server;
+    CURL url;
+    XFILE::CPlexDirectory* dir;
+    unsigned int deadlineMs;
+    unsigned int jobID;
+    bool started;             // the job got a worker
+    unsigned int startTime;   // when it did
+    RequestState state;
+    CFileItemListPtr items;
+    int merged;               // number of items it added to the list
+  };
+
+  void mergeArrived(CFileItemList& items);
+  static void addLatency(const std::string& uuid, unsigned int ms, bool timeout);
+
+  IPlexDirectoryFanoutCallback* m_callback;
+  std::vector<Request> m_requests;
+  unsigned int m_startTime;   // when the jobs were queued
+
+  CCriticalSection m_lock;
+  CEvent m_arrived;
+};
+
+#endif // PLEXDIRECTORYFANOUT_H
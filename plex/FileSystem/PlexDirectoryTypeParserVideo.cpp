@@ -185,7 +185,7 @@ CPlexDirectoryTypeParserVideo::Process(CFileItem &item, CFileItem &mediaContaine
   if (item.m_mediaItems.size() > 0)
   {
     CFileItemPtr firstMedia = item.m_mediaItems[0];
-    const boost::unordered_map<CStdString, CVariant> pMap = firstMedia->GetAllProperties();
+    const PropertyMap pMap = firstMedia->GetAllProperties();
     std::pair<CStdString, CVariant> p;
     BOOST_FOREACH(p, pMap)
     {
@@ -216,6 +216,41 @@ TEST(PlexAttributeParserMediaUrl, other)
   EXPECT_SIZE("foobar", "320", "320");
 }
 
+TEST(PlexAttributeParserMediaUrl, artMap)
+{
+  CFileItem item;
+  parser.Process(CURL("plexserver://abc123"), "thumb", "imageurl", &item);
+
+  // copies see the same urls before and after they're built
+  CFileItem copy(item);
+  std::string thumb = item.GetArt("thumb");
+  EXPECT_EQ(thumb, copy.GetArt("thumb"));
+
+  CGUIListItem::ArtMap art = copy.GetArt();
+  EXPECT_EQ(3, art.size());
+  EXPECT_EQ(thumb, art["thumb"]);
+  EXPECT_STREQ(CURL(art["bigThumb"]).GetOption("width"), "2048");
+
+  // setting a plain url replaces the lazy one
+  item.SetArt("smallThumb", "http://example.com/thumb.jpg");
+  EXPECT_EQ("http://example.com/thumb.jpg", item.GetArt("smallThumb"));
+  art = item.GetArt();
+  EXPECT_EQ(3, art.size());
+  EXPECT_EQ("http://example.com/thumb.jpg", art["smallThumb"]);
+}
+
+TEST(PlexAttributeParserMediaUrl, hasAnyArt)
+{
+  CFileItem item;
+  EXPECT_FALSE(item.HasAnyArt());
+
+  parser.Process(CURL("plexserver://abc123"), "thumb", "imageurl", &item);
+  EXPECT_TRUE(item.HasAnyArt());
+
+  item.ClearArt();
+  EXPECT_FALSE(item.HasAnyArt());
+}
+
 static CPlexAttributeParserMediaFlag mflag;
 
 TEST(PlexAttributeParserMediaFlag, basic)
@@ -246,6 +281,21 @@ TEST(PlexAttributeParserMediaFlag, testCache)
   mflag.Process(CURL("plexserver://abc123"), "aspectRatio", "16:9", &item2);
   EXPECT_TRUE(item2.HasProperty("mediaTag-aspectRatio"));
   EXPECT_TRUE(item2.HasArt("mediaTag::aspectRatio"));
+  EXPECT_EQ(item.GetArt("mediaTag::aspectRatio"), item2.GetArt("mediaTag::aspectRatio"));
+}
+
+TEST(PlexAttributeParserMediaFlag, cachePerServer)
+{
+  CFileItem item;
+  item.SetProperty("mediaTagPrefix", "abc123");
+  mflag.Process(CURL("plexserver://abc123"), "videoResolution", "1080", &item);
+
+  CFileItem item2;
+  item2.SetProperty("mediaTagPrefix", "abc123");
+  mflag.Process(CURL("plexserver://cba321"), "videoResolution", "1080", &item2);
+
+  EXPECT_STREQ(CURL(item.GetArt("mediaTag::videoResolution")).GetHostName(), "abc123");
+  EXPECT_STREQ(CURL(item2.GetArt("mediaTag::videoResolution")).GetHostName(), "cba321");
 }
 
 const char itemxml[] =
@@ -0,0 +1,158 @@
+#include "PlexTest.h"
+#include "PlexTestUtils.h"
+#include "PlexDirectoryFanout.h"
+#include "threads/Event.h"
+
+#include <climits>
+
+// one playlist titled after the directory, once the gate (if any) is open
+class CFakeFanoutDirectory : public XFILE::CPlexDirectory
+{
+public:
+  CFakeFanoutDirectory(const std::string& title, CEvent* gate = NULL) : m_title(title), m_gate(gate) {}
+
+  bool GetXMLData(CStdString& data)
+  {
+    if (m_gate)
+      m_gate->Wait();
+
+    data.Format("<MediaContainer size=\"1\"><Playlist key=\"/playlists/%s\" title=\"%s\" type=\"playlist\"/></MediaContainer>",
+                m_title.c_str(), m_title.c_str());
+    return true;
+  }
+
+  std::string m_title;
+  CEvent* m_gate;
+};
+
+// never opened in time, static since the job still holds it after the fanout gave up
+static CEvent g_slowGate(true);
+
+class PlexDirectoryFanoutTest : public ::testing::Test, public IPlexDirectoryFanoutCallback
+{
+public:
+  virtual void SetUp()
+  {
+    CPlexDirectoryFanout::clearLatencies();
+    m_openOnProgress = NULL;
+  }
+
+  virtual void OnFanoutItems(const CPlexServerPtr& server, CFileItemList& items)
+  {
+    for (int i = 0; i < items.Size(); i++)
+      items.Get(i)->SetProperty("serverName", server->GetName());
+  }
+
+  virtual void OnFanoutProgress(const CFileItemList& items, int done, int total)
+  {
+    std::vector<std::string> labels;
+    for (int i = 0; i < items.Size(); i++)
+      labels.push_back(items.Get(i)->GetLabel());
+    m_progress.push_back(labels);
+
+    if (m_openOnProgress)
+      m_openOnProgress->Set();
+  }
+
+  CPlexServerPtr server(const std::string& uuid)
+  {
+    CPlexServerPtr s = PlexTestUtils::serverWithConnection(uuid);
+    s->SetName(uuid + "-name");
+    return s;
+  }
+
+  CURL url(const std::string& uuid)
+  {
+    return CURL("plexserver://" + uuid + "/playlists/all");
+  }
+
+  std::vector<std::vector<std::string> > m_progress;
+  CEvent* m_openOnProgress;
+};
+
+TEST_F(PlexDirectoryFanoutTest, mergesAll)
+{
+  CPlexDirectoryFanout fanout(this);
+  fanout.add(server("a"), url("a"), new CFakeFanoutDirectory("A"));
+  fanout.add(server("b"), url("b"), new CFakeFanoutDirectory("B"));
+
+  CFileItemList items;
+  EXPECT_TRUE(fanout.run(items));
+
+  ASSERT_EQ(2, items.Size());
+  EXPECT_STREQ("A", items.Get(0)->GetLabel());
+  EXPECT_STREQ("B", items.Get(1)->GetLabel());
+  EXPECT_EQ("a-name", items.Get(0)->GetProperty("serverName").asString());
+  EXPECT_EQ("b-name", items.Get(1)->GetProperty("serverName").asString());
+}
+
+TEST_F(PlexDirectoryFanoutTest, stableOrderWhenFirstIsSlower)
+{
+  // the first server only answers once the second one was merged
+  CEvent firstGate(true);
+  m_openOnProgress = &firstGate;
+
+  CPlexDirectoryFanout fanout(this);
+  fanout.add(server("a"), url("a"), new CFakeFanoutDirectory("A", &firstGate));
+  fanout.add(server("b"), url("b"), new CFakeFanoutDirectory("B"));
+
+  CFileItemList items;
+  EXPECT_TRUE(fanout.run(items));
+
+  ASSERT_EQ(2, m_progress.size());
+  ASSERT_EQ(1, m_progress[0].size());
+  EXPECT_EQ("B", m_progress[0][0]);
+
+  ASSERT_EQ(2, items.Size());
+  EXPECT_STREQ("A", items.Get(0)->GetLabel());
+  EXPECT_STREQ("B", items.Get(1)->GetLabel());
+}
+
+TEST_F(PlexDirectoryFanoutTest, slowServerIsLeftOut)
+{
+  CPlexDirectoryFanout fanout(this);
+  fanout.add(server("slow"), url("slow"), new CFakeFanoutDirectory("S", &g_slowGate), 200);
+  fanout.add(server("fast"), url("fast"), new CFakeFanoutDirectory("F"));
+
+  CFileItemList items;
+  EXPECT_TRUE(fanout.run(items));
+  g_slowGate.Set();
+
+  ASSERT_EQ(1, items.Size());
+  EXPECT_STREQ("F", items.Get(0)->GetLabel());
+
+  EXPECT_EQ(1, CPlexDirectoryFanout::getLatency("slow").getTimeouts());
+  EXPECT_EQ(0, CPlexDirectoryFanout::getLatency("slow").getCount());
+  EXPECT_EQ(1, CPlexDirectoryFanout::getLatency("fast").getCount());
+}
+
+TEST_F(PlexDirectoryFanoutTest, nothingToFetch)
+{
+  CPlexDirectoryFanout fanout(this);
+  CFileItemList items;
+  EXPECT_TRUE(fanout.run(items));
+  EXPECT_EQ(0, items.Size());
+}
+
+TEST(PlexLatencyHistogram, percentiles)
+{
+  CPlexLatencyHistogram histogram;
+  EXPECT_EQ(0, histogram.getPercentile(50));
+
+  for (int i = 0; i < 8; i++)
+    histogram.add(40);
+  histogram.add(150);
+  histogram.add(3000);
+
+  EXPECT_EQ(10, histogram.getCount());
+  EXPECT_EQ(50, histogram.getPercentile(50));
+  EXPECT_EQ(200, histogram.getPercentile(90));
+  EXPECT_EQ(3200, histogram.getPercentile(100));
+}
+
+TEST(PlexLatencyHistogram, slowerThanLastBucket)
+{
+  CPlexLatencyHistogram histogram;
+  histogram.add(100000);
+  EXPECT_EQ(UINT_MAX, histogram.getPercentile(50));
+}
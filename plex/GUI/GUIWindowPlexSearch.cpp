@@ -47,6 +47,7 @@
 #include "PlexJobs.h"
 #include "settings/GUISettings.h"
 #include "Playlists/PlexPlayQueueManager.h"
+#include "Client/PlexSearchIndex.h"
 
 #define CTL_LABEL_EDIT       310
 #define CTL_BUTTON_BACKSPACE 8
@@ -54,6 +55,7 @@
 #define CTL_BUTTON_SPACE     32
 
 #define SEARCH_DELAY         750
+#define SEARCH_LOCAL_RESULTS 100
 
 using namespace XFILE;
 using namespace std;
@@ -90,26 +92,35 @@ CStdString CGUIWindowPlexSearch::GetString()
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
-void CGUIWindowPlexSearch::OnTimeout()
+PlexServerList CGUIWindowPlexSearch::GetSearchServers() const
 {
-  CGUIMessage msg(GUI_MSG_LABEL_RESET, GetID(), GetID());
-  CApplicationMessenger::Get().SendGUIMessage(msg, GetID(), false);
+  CPlexServerManager::CPlexServerOwnedModifier modifier = g_guiSettings.GetBool("myplex.searchsharedlibraries") ? CPlexServerManager::SERVER_ALL : CPlexServerManager::SERVER_OWNED;
+  PlexServerList list = g_plexApplication.serverManager->GetAllServers(modifier, true);
+
+  PlexServerList servers;
+  BOOST_FOREACH(CPlexServerPtr server, list)
+  {
+    if (server->GetActiveConnection() && !server->GetSynced())
+      servers.push_back(server);
+  }
+  return servers;
+}
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CGUIWindowPlexSearch::OnTimeout()
+{
+  // the results were reset when the string changed, and the local matches are showing
   CStdString str = GetString();
 
   if (str.empty())
     return;
 
-  CPlexServerManager::CPlexServerOwnedModifier modifier = g_guiSettings.GetBool("myplex.searchsharedlibraries") ? CPlexServerManager::SERVER_ALL : CPlexServerManager::SERVER_OWNED;
-  PlexServerList list = g_plexApplication.serverManager->GetAllServers(modifier, true);
+  PlexServerList list = GetSearchServers();
 
   CSingleLock lk(m_threadsSection);
   m_currentSearchString = str;
   BOOST_FOREACH(CPlexServerPtr server, list)
   {
-    if (!server->GetActiveConnection() || server->GetSynced())
-      continue;
-
     CURL u = server->BuildPlexURL("/search");
     u.SetOption("query", str);
     m_currentSearchId.push_back(CJobManager::GetInstance().AddJob(new CPlexDirectoryFetchJob(u), this, CJob::PRIORITY_LOW));
@@ -138,12 +149,67 @@ void CGUIWindowPlexSearch::UpdateSearch()
 
   if (!str.empty())
   {
+    ShowLocalResults(str);
     g_plexApplication.timer->SetTimeout(SEARCH_DELAY, this);
   }
   else
     Reset();
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CGUIWindowPlexSearch::ShowLocalResults(const CStdString& str)
+{
+  Reset();
+
+  if (!g_plexApplication.searchIndex)
+    return;
+
+  std::map<std::string, CPlexServerPtr> servers;
+  std::set<std::string> uuids;
+  BOOST_FOREACH(CPlexServerPtr server, GetSearchServers())
+  {
+    servers[server->GetUUID()] = server;
+    uuids.insert(server->GetUUID());
+  }
+
+  // titles already fetched from the libraries, the servers' results are merged in when they arrive
+  std::vector<CPlexSearchIndex::Result> matches;
+  g_plexApplication.searchIndex->Query(str, SEARCH_LOCAL_RESULTS, matches, &uuids);
+
+  std::map<int, CFileItemListPtr> mappedRes;
+  BOOST_FOREACH(const CPlexSearchIndex::Result& match, matches)
+  {
+    if (m_resultMap.find(match.type) == m_resultMap.end())
+      continue;
+
+    // a new item each time, the containers own them like the ones from the servers
+    CFileItemPtr item(new CFileItem(match.path, match.folder));
+    item->SetLabel(match.title);
+    item->SetPlexDirectoryType((EPlexDirectoryType)match.type);
+    if (match.thumbArt)
+      item->SetArt("thumb", match.thumbArt);
+    else if (!match.thumb.empty())
+      item->SetArt("thumb", match.thumb);
+    if (!match.sectionUUID.empty())
+    {
+      item->SetProperty("librarySectionUUID", match.sectionUUID);
+      item->SetProperty("unprocessed_key", match.key);
+    }
+
+    CPlexServerPtr server = servers[match.server];
+    item->SetProperty("serverName", server->GetName());
+    item->SetProperty("serverOwner", server->GetOwner());
+
+    CFileItemListPtr& list = mappedRes[match.type];
+    if (!list)
+      list = CFileItemListPtr(new CFileItemList);
+    list->Add(item);
+  }
+
+  CLog::Log(LOGDEBUG, "CGUIWindowPlexSearch::ShowLocalResults %d local matches for %s", (int)matches.size(), str.c_str());
+  BindResults(mappedRes);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 bool CGUIWindowPlexSearch::OnAction(const CAction &action)
 {
@@ -405,6 +471,15 @@ void CGUIWindowPlexSearch::ProcessResults(CFileItemList* results)
     }
   }
 
+  CLog::Log(LOGDEBUG, "CGUIWindowPlexSearch::ProcessResults adding %d items from %s", results->Size(), server->GetName().c_str());
+  BindResults(mappedRes);
+
+  delete results;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CGUIWindowPlexSearch::BindResults(const std::map<int, CFileItemListPtr>& mappedRes)
+{
   std::pair<int, CFileItemListPtr> pair;
   BOOST_FOREACH(pair, mappedRes)
   {
@@ -414,12 +489,24 @@ void CGUIWindowPlexSearch::ProcessResults(CFileItemList* results)
       CFileItemListPtr list = pair.second;
       std::vector<CGUIListItemPtr> cList = container->GetItems();
 
+      // items that are already showing, from the local index or another server, stay where they are
+      std::set<CStdString> shown;
+      BOOST_FOREACH(CGUIListItemPtr item, cList)
+        shown.insert(boost::static_pointer_cast<CFileItem>(item)->GetPath());
+
+      for (int i = list->Size() - 1; i >= 0; i--)
+      {
+        if (shown.find(list->Get(i)->GetPath()) != shown.end())
+          list->Remove(i);
+      }
+
+      if (list->Size() == 0)
+        continue;
+
       int i = 0;
       BOOST_FOREACH(CGUIListItemPtr item, cList)
         list->AddFront(boost::static_pointer_cast<CFileItem>(item), i++);
 
-      CLog::Log(LOGDEBUG, "CPlexWindowSearch::ProcessResults adding %d items to %d from %s", list->Size(), pair.first, server->GetName().c_str());
-
       CGUIMessage msg(GUI_MSG_LABEL_BIND, GetID(), container->GetID(), 0, 0, list.get());
       OnMessage(msg);
 
@@ -428,16 +515,23 @@ void CGUIWindowPlexSearch::ProcessResults(CFileItemList* results)
     }
     else
     {
-      CLog::Log(LOGDEBUG, "CGUIWindowPlexSearch::ProcessResults Could not find container %d", m_resultMap[pair.first]);
+      CLog::Log(LOGDEBUG, "CGUIWindowPlexSearch::BindResults Could not find container %d", m_resultMap[pair.first]);
     }
   }
-
-  delete results;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 void CGUIWindowPlexSearch::OnJobComplete(unsigned int jobID, bool success, CJob *job)
 {
+  CSingleLock lk(m_threadsSection);
+  std::vector<unsigned int>::iterator it = std::find(m_currentSearchId.begin(), m_currentSearchId.end(), jobID);
+
+  // results of a search that was replaced by a newer string aren't wanted
+  if (it == m_currentSearchId.end())
+    return;
+  m_currentSearchId.erase(it);
+  lk.Leave();
+
   CPlexDirectoryFetchJob *fjob = static_cast<CPlexDirectoryFetchJob*>(job);
   if (fjob && success)
   {
@@ -447,8 +541,4 @@ void CGUIWindowPlexSearch::OnJobComplete(unsigned int jobID, bool success, CJob
     CGUIMessage msg(GUI_MSG_SEARCH_UPDATE, GetID(), GetID(), 0, 0, list);
     CApplicationMessenger::Get().SendGUIMessage(msg, WINDOW_PLEX_SEARCH, false);
   }
-
-  CSingleLock lk(m_threadsSection);
-  if (!m_currentSearchId.empty())
-    m_currentSearchId.erase(std::remove(m_currentSearchId.begin(), m_currentSearchId.end(), jobID));
 }
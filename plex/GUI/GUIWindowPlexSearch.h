@@ -22,6 +22,7 @@
  */
 
 #include <map>
+#include <set>
 
 #include "FileItem.h"
 #include "guilib/GUIWindow.h"
@@ -30,6 +31,7 @@
 #include "PlexGlobalTimer.h"
 #include "threads/CriticalSection.h"
 #include "PlexNavigationHelper.h"
+#include "PlexTypes.h"
 
 class CGUIWindowPlexSearch : public CGUIWindow, public IJobCallback, public IPlexGlobalTimeout
 {
@@ -57,7 +59,10 @@ class CGUIWindowPlexSearch : public CGUIWindow, public IJobCallback, public IPle
     void OnTimeout();
     CStdString GetString();
     void HideAllLists();
+    PlexServerList GetSearchServers() const;
+    void ShowLocalResults(const CStdString& str);
     void ProcessResults(CFileItemList *results);
+    void BindResults(const std::map<int, CFileItemListPtr>& mappedRes);
     void Reset();
     CGUIEditControl *GetEditControl() const;
 
@@ -203,6 +203,35 @@ void CPlexSectionFanout::LoadArts(bool force)
   LoadSection(artsUrl, CONTENT_LIST_FANART);
 }
 
+//////////////////////////////////////////////////////////////////////////////
+void CPlexSectionFanout::OnJobProgress(unsigned int jobID, unsigned int progress, unsigned int total, const CJob* job)
+{
+  // a section that comes from several servers shows what the fast ones returned already
+  const CPlexSectionFetchJob* load = static_cast<const CPlexSectionFetchJob*>(job);
+  CFileItemListPtr partial = load->getPartialResult();
+  if (!partial || partial->Size() == 0)
+    return;
+
+  {
+    CSingleLock lk(m_critical);
+
+    int type = load->m_contentType;
+    if (m_fileLists.find(type) != m_fileLists.end() && m_fileLists[type] != NULL)
+      delete m_fileLists[type];
+
+    CFileItemList* newList = new CFileItemList;
+    newList->Assign(*partial, false);
+    m_fileLists[type] = newList;
+  }
+
+  CLog::Log(LOGDEBUG, "CPlexSectionFanout::OnJobProgress %d of %d servers returned %d items for %s",
+            progress, total, partial->Size(), m_url.Get().c_str());
+
+  CGUIMessage msg(GUI_MSG_PLEX_SECTION_LOADED, WINDOW_HOME, 300, m_sectionType);
+  msg.SetStringParam(m_url.Get());
+  g_windowManager.SendThreadMessage(msg, g_windowManager.GetActiveWindow());
+}
+
 //////////////////////////////////////////////////////////////////////////////
 void CPlexSectionFanout::OnJobComplete(unsigned int jobID, bool success, CJob* job)
 {
@@ -61,6 +61,7 @@ public:
   int LoadSection(const CURL& url, int contentType);
 
   void OnJobComplete(unsigned int jobID, bool success, CJob* job);
+  void OnJobProgress(unsigned int jobID, unsigned int progress, unsigned int total, const CJob* job);
 
   std::map<int, CFileItemList*> m_fileLists;
   CURL m_url;
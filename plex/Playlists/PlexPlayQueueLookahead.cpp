@@ -0,0 +1,244 @@
+#include "PlexPlayQueueLookahead.h"
+
+#include "File.h"
+#include "JobManager.h"
+#include "PlayListPlayer.h"
+#include "playlists/PlayList.h"
+#include "dialogs/GUIDialogKaiToast.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+
+using namespace PLAYLIST;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexLookaheadOpenJob::DoWork()
+{
+  XFILE::CFile file;
+  if (!file.Open(m_path, READ_NO_CACHE))
+    return false;
+
+  std::vector<char> buffer(PLEX_LOOKAHEAD_OPEN_SIZE);
+  unsigned int total = 0;
+  while (total < buffer.size())
+  {
+    int read = file.Read(&buffer[total], buffer.size() - total);
+    if (read <= 0)
+      break;
+    total += read;
+  }
+  file.Close();
+
+  CLog::Log(LOGDEBUG, "CPlexLookaheadOpenJob::DoWork read %u bytes of the next item", total);
+  return total > 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CPlexPlayQueueLookahead::CPlexPlayQueueLookahead(int items)
+  : m_items(items), m_hits(0), m_misses(0)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CPlexPlayQueueLookahead::~CPlexPlayQueueLookahead()
+{
+  clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexPlayQueueLookahead::canResolve(const CFileItem& item)
+{
+  // transcodes get a new url when they play
+  return item.IsPlexMediaServer() && !item.m_bIsFolder &&
+         !item.GetProperty("isResolved").asBoolean() &&
+         !item.GetProperty("plexDidTranscode").asBoolean();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+std::string CPlexPlayQueueLookahead::getKey(const CFileItem& item)
+{
+  CStdString key;
+  key.Format("%s|%s|%d|%s", item.GetPath().c_str(), item.GetProperty("playQueueItemID").asString().c_str(),
+             item.m_lStartOffset, item.GetProperty("selectedMediaItem").asString().c_str());
+  return key;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexPlayQueueLookahead::update()
+{
+  std::vector<CFileItemPtr> items;
+
+  int playlist = g_playlistPlayer.GetCurrentPlaylist();
+  int current = g_playlistPlayer.GetCurrentSong();
+  if (playlist != PLAYLIST_NONE && current >= 0)
+  {
+    const CPlayList& list = g_playlistPlayer.GetPlaylist(playlist);
+    for (int offset = 1; offset <= m_items; offset++)
+    {
+      // the first item asks for the media and the resume offset when it plays, that can't be
+      // decided ahead of time
+      int index = g_playlistPlayer.GetNextSong(offset);
+      if (index <= 0 || index >= list.size() || index == current)
+        break;
+      items.push_back(list[index]);
+    }
+  }
+
+  update(items);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexPlayQueueLookahead::update(const std::vector<CFileItemPtr>& items)
+{
+  CSingleLock lk(m_lock);
+
+  std::map<std::string, Entry> entries;
+  std::string nextKey;
+
+  for (size_t i = 0; i < items.size(); i++)
+  {
+    if (!items[i] || !canResolve(*items[i]))
+      continue;
+
+    std::string key = getKey(*items[i]);
+    if (i == 0)
+      nextKey = key;
+    if (entries.find(key) != entries.end())
+      continue;
+
+    std::map<std::string, Entry>::iterator it = m_entries.find(key);
+    if (it != m_entries.end())
+    {
+      entries[key] = it->second;
+      m_entries.erase(it);
+      continue;
+    }
+
+    Entry& entry = entries[key];
+    entry.opened = false;
+    entry.jobID = CJobManager::GetInstance().AddJob(createResolveJob(*items[i]), this, CJob::PRIORITY_LOW);
+    CLog::Log(LOGDEBUG, "CPlexPlayQueueLookahead::update resolving %s ahead", items[i]->GetLabel().c_str());
+  }
+
+  // what's left isn't going to play next anymore
+  for (std::map<std::string, Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+  {
+    if (it->second.jobID)
+      CJobManager::GetInstance().CancelJob(it->second.jobID);
+  }
+
+  m_entries.swap(entries);
+  m_nextKey = nextKey;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexPlayQueueLookahead::onProgress(double time, double totalTime)
+{
+  if (totalTime <= 0 || totalTime - time > PLEX_LOOKAHEAD_OPEN_SECONDS)
+    return;
+
+  CSingleLock lk(m_lock);
+
+  std::map<std::string, Entry>::iterator it = m_entries.find(m_nextKey);
+  if (it == m_entries.end() || !it->second.resolved || it->second.opened)
+    return;
+
+  it->second.opened = true;
+  CJob* job = createOpenJob(*it->second.resolved);
+  if (job)
+    CJobManager::GetInstance().AddJob(job, NULL, CJob::PRIORITY_LOW);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexPlayQueueLookahead::take(const CFileItem& item, CFileItem& resolvedItem)
+{
+  std::vector<std::pair<std::string, std::string> > notifications;
+
+  {
+    CSingleLock lk(m_lock);
+
+    std::map<std::string, Entry>::iterator it = m_entries.find(getKey(item));
+    if (it == m_entries.end())
+      return false;
+
+    // still deciding or the decision failed, it's made again the usual way
+    if (!it->second.resolved)
+    {
+      if (it->second.jobID)
+        CJobManager::GetInstance().CancelJob(it->second.jobID);
+      m_entries.erase(it);
+      m_misses++;
+      return false;
+    }
+
+    resolvedItem = *it->second.resolved;
+    notifications.swap(it->second.notifications);
+    m_entries.erase(it);
+    m_hits++;
+  }
+
+  CLog::Log(LOGDEBUG, "CPlexPlayQueueLookahead::take %s was resolved ahead", item.GetLabel().c_str());
+
+  for (size_t i = 0; i < notifications.size(); i++)
+    notify(notifications[i].first, notifications[i].second);
+
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexPlayQueueLookahead::clear()
+{
+  CSingleLock lk(m_lock);
+
+  for (std::map<std::string, Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+  {
+    if (it->second.jobID)
+      CJobManager::GetInstance().CancelJob(it->second.jobID);
+  }
+
+  m_entries.clear();
+  m_nextKey.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexPlayQueueLookahead::OnJobComplete(unsigned int jobID, bool success, CJob* job)
+{
+  CSingleLock lk(m_lock);
+
+  for (std::map<std::string, Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+  {
+    if (it->second.jobID != jobID)
+      continue;
+
+    it->second.jobID = 0;
+
+    CPlexLookaheadJob* lookaheadJob = static_cast<CPlexLookaheadJob*>(job);
+    if (success && lookaheadJob)
+    {
+      it->second.resolved = CFileItemPtr(new CFileItem(lookaheadJob->m_choosenMedia));
+      it->second.notifications = lookaheadJob->m_notifications;
+    }
+    return;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CPlexLookaheadJob* CPlexPlayQueueLookahead::createResolveJob(const CFileItem& item)
+{
+  return new CPlexLookaheadJob(item);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CJob* CPlexPlayQueueLookahead::createOpenJob(const CFileItem& resolvedItem)
+{
+  // opening a transcode would start the transcoder for an item that might never play
+  if (resolvedItem.GetProperty("plexDidTranscode").asBoolean() || resolvedItem.IsStack())
+    return NULL;
+
+  return new CPlexLookaheadOpenJob(resolvedItem.GetPath());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexPlayQueueLookahead::notify(const std::string& caption, const std::string& description)
+{
+  CGUIDialogKaiToast::QueueNotification(CGUIDialogKaiToast::Info, caption, description);
+}
@@ -0,0 +1,111 @@
+#ifndef PLEXPLAYQUEUELOOKAHEAD_H
+#define PLEXPLAYQUEUELOOKAHEAD_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "FileItem.h"
+#include "Job.h"
+#include "PlexMediaDecisionEngine.h"
+#include "threads/CriticalSection.h"
+
+// seconds before the end of the playing item the next one is opened
+#define PLEX_LOOKAHEAD_OPEN_SECONDS 15
+
+// how much of the next item is read when it's opened
+#define PLEX_LOOKAHEAD_OPEN_SIZE (256 * 1024)
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// media decision for an item that isn't playing yet, keeps the notifications for when it does
+class CPlexLookaheadJob : public CPlexMediaDecisionJob
+{
+public:
+  CPlexLookaheadJob(const CFileItem& item) : CPlexMediaDecisionJob(item) {}
+
+  std::vector<std::pair<std::string, std::string> > m_notifications;
+
+protected:
+  virtual void Notify(const std::string& caption, const std::string& description)
+  {
+    m_notifications.push_back(std::make_pair(caption, description));
+  }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// reads the start of a resolved item, so the server has it read and the connection is still
+// open when the player asks for it
+class CPlexLookaheadOpenJob : public CJob
+{
+public:
+  CPlexLookaheadOpenJob(const CStdString& path) : m_path(path) {}
+  virtual bool DoWork();
+  virtual const char* GetType() const { return "lookaheadopen"; }
+
+  CStdString m_path;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Resolves the items after the one that's playing in the background, so the media decision,
+// the indirect lookups and the transcode decision are done when the player gets to them instead
+// of between two items. The item right after the playing one is also opened shortly before the
+// playing one ends.
+//
+// CPlexMediaDecisionEngine::resolveItem takes the resolved item from here when it was resolved
+// for the same item, offset and media, anything else is resolved the way it was before.
+//
+class CPlexPlayQueueLookahead : public IJobCallback
+{
+public:
+  CPlexPlayQueueLookahead(int items);
+  virtual ~CPlexPlayQueueLookahead();
+
+  // resolves the items after the current one of the current playlist
+  void update();
+
+  // resolves these items, in the order they are going to play, and forgets everything else
+  void update(const std::vector<CFileItemPtr>& items);
+
+  // playback position of the current item, opens the next item when it's about to end
+  void onProgress(double time, double totalTime);
+
+  // the resolved item if it's done, the notifications of its decision are shown now
+  bool take(const CFileItem& item, CFileItem& resolvedItem);
+  void clear();
+
+  unsigned int getHits() const { return m_hits; }
+  unsigned int getMisses() const { return m_misses; }
+
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob* job);
+
+  static bool canResolve(const CFileItem& item);
+
+protected:
+  // allow override for tests.
+  virtual CPlexLookaheadJob* createResolveJob(const CFileItem& item);
+  virtual CJob* createOpenJob(const CFileItem& resolvedItem);
+  virtual void notify(const std::string& caption, const std::string& description);
+
+private:
+  struct Entry
+  {
+    CFileItemPtr resolved;    // NULL until the decision is done
+    unsigned int jobID;       // 0 once it's done
+    bool opened;
+    std::vector<std::pair<std::string, std::string> > notifications;
+  };
+
+  static std::string getKey(const CFileItem& item);
+
+  int m_items;
+  std::map<std::string, Entry> m_entries;
+  std::string m_nextKey;
+  unsigned int m_hits;
+  unsigned int m_misses;
+
+  CCriticalSection m_lock;
+};
+
+typedef boost::shared_ptr<CPlexPlayQueueLookahead> CPlexPlayQueueLookaheadPtr;
+
+#endif // PLEXPLAYQUEUELOOKAHEAD_H
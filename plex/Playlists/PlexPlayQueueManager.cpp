@@ -8,6 +8,7 @@
 #include "PlexApplication.h"
 #include "Client/PlexServerManager.h"
 #include "PlexPlayQueueLocal.h"
+#include "PlexPlayQueueLookahead.h"
 #include "settings/GUISettings.h"
 #include "guilib/GUIWindowManager.h"
 #include "music/tags/MusicInfoTag.h"
@@ -88,6 +89,8 @@ void CPlexPlayQueueManager::clear()
     CApplicationMessenger::Get().MediaStop();
 
   m_playQueues.clear();
+  if (g_plexApplication.playQueueLookahead)
+    g_plexApplication.playQueueLookahead->clear();
  
   CGUIMessage msg(GUI_MSG_PLEX_PLAYQUEUE_UPDATED, 0, 0);
   g_windowManager.SendThreadMessage(msg);
@@ -100,6 +103,8 @@ void CPlexPlayQueueManager::clear(ePlexMediaType type)
     CApplicationMessenger::Get().MediaStop();
   
   m_playQueues.erase(type);
+  if (g_plexApplication.playQueueLookahead)
+    g_plexApplication.playQueueLookahead->clear();
     
   // TODO : Save here by type
   CGUIMessage msg(GUI_MSG_PLEX_PLAYQUEUE_UPDATED, 0, 0);
@@ -163,6 +168,10 @@ void CPlexPlayQueueManager::playQueueUpdated(const ePlexMediaType& type, bool st
     g_windowManager.SendThreadMessage(msg);
 
     g_plexApplication.timelineManager->RefreshSubscribers();
+
+    // the items after the playing one might be different ones now
+    if (!startPlaying && g_plexApplication.playQueueLookahead)
+      g_plexApplication.playQueueLookahead->update();
   }
 
   if (startPlaying)
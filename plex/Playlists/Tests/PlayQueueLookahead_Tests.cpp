@@ -0,0 +1,183 @@
+#include "PlexTest.h"
+#include "PlexPlayQueueLookahead.h"
+#include "threads/Event.h"
+
+// decides without asking a server, resolved paths are the item path with a suffix
+class CFakeLookaheadJob : public CPlexLookaheadJob
+{
+public:
+  CFakeLookaheadJob(const CFileItem& item, CEvent* release)
+    : CPlexLookaheadJob(item), m_source(item), m_release(release) {}
+
+  virtual bool DoWork()
+  {
+    if (m_release)
+      m_release->Wait();
+
+    m_choosenMedia = m_source;
+    m_choosenMedia.SetPath(m_source.GetPath() + "/resolved");
+    if (m_source.HasProperty("transcode"))
+      Notify("Transcoding", m_source.GetLabel());
+    return !m_source.HasProperty("fail");
+  }
+
+private:
+  CFileItem m_source;
+  CEvent* m_release;
+};
+
+class CFakeLookahead : public CPlexPlayQueueLookahead
+{
+public:
+  CFakeLookahead(int items) : CPlexPlayQueueLookahead(items), m_release(NULL), m_resolves(0), m_opens(0) {}
+
+  CEvent* m_release;
+  int m_resolves;
+  int m_opens;
+  std::vector<std::string> m_notifications;
+
+protected:
+  virtual CPlexLookaheadJob* createResolveJob(const CFileItem& item)
+  {
+    m_resolves++;
+    return new CFakeLookaheadJob(item, m_release);
+  }
+
+  virtual CJob* createOpenJob(const CFileItem& resolvedItem)
+  {
+    m_opens++;
+    return NULL;
+  }
+
+  virtual void notify(const std::string& caption, const std::string& description)
+  {
+    m_notifications.push_back(description);
+  }
+};
+
+static CFileItemPtr makeItem(int id)
+{
+  CStdString path;
+  path.Format("plexserver://abc123/library/metadata/%d", id);
+
+  CFileItemPtr item(new CFileItem(path, false));
+  item->SetLabel(path);
+  item->SetProperty("playQueueItemID", id);
+  return item;
+}
+
+// the jobs run on the job manager, give them a moment
+static bool waitAndTake(CPlexPlayQueueLookahead& lookahead, const CFileItem& item, CFileItem& resolved)
+{
+  Sleep(500);
+  return lookahead.take(item, resolved);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlayQueueLookahead, resolvesAhead)
+{
+  CFakeLookahead lookahead(2);
+
+  std::vector<CFileItemPtr> items;
+  items.push_back(makeItem(2));
+  items.push_back(makeItem(3));
+  lookahead.update(items);
+  EXPECT_EQ(2, lookahead.m_resolves);
+
+  CFileItem resolved;
+  EXPECT_TRUE(waitAndTake(lookahead, *items[0], resolved));
+  EXPECT_EQ(items[0]->GetPath() + "/resolved", resolved.GetPath());
+  EXPECT_EQ(1, lookahead.getHits());
+
+  // taken once, the next play decides again
+  EXPECT_FALSE(lookahead.take(*items[0], resolved));
+
+  // moving on keeps what's resolved already
+  items.erase(items.begin());
+  items.push_back(makeItem(4));
+  lookahead.update(items);
+  EXPECT_EQ(3, lookahead.m_resolves);
+
+  EXPECT_TRUE(waitAndTake(lookahead, *items[0], resolved));
+  EXPECT_EQ(items[0]->GetPath() + "/resolved", resolved.GetPath());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlayQueueLookahead, onlyMatchingItems)
+{
+  CFakeLookahead lookahead(1);
+
+  std::vector<CFileItemPtr> items;
+  items.push_back(makeItem(2));
+  lookahead.update(items);
+
+  // another offset or media can't use what was decided
+  CFileItem other(*items[0]);
+  other.m_lStartOffset = 100;
+  CFileItem resolved;
+  EXPECT_FALSE(lookahead.take(other, resolved));
+
+  other = *items[0];
+  other.SetProperty("selectedMediaItem", 2);
+  EXPECT_FALSE(lookahead.take(other, resolved));
+
+  // items that aren't from a server or are resolved already are left alone
+  items.clear();
+  items.push_back(CFileItemPtr(new CFileItem("/home/user/music/track.flac", false)));
+  CFileItemPtr done = makeItem(5);
+  done->SetProperty("isResolved", true);
+  items.push_back(done);
+  lookahead.update(items);
+  EXPECT_EQ(1, lookahead.m_resolves);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlayQueueLookahead, failedAndPendingDecisions)
+{
+  CFakeLookahead lookahead(2);
+  CEvent release(true);
+  lookahead.m_release = &release;
+
+  std::vector<CFileItemPtr> items;
+  items.push_back(makeItem(2));
+  items.push_back(makeItem(3));
+  items[1]->SetProperty("fail", true);
+  lookahead.update(items);
+
+  // still deciding, the player decides itself
+  CFileItem resolved;
+  EXPECT_FALSE(lookahead.take(*items[0], resolved));
+  EXPECT_EQ(1, lookahead.getMisses());
+
+  release.Set();
+  EXPECT_FALSE(waitAndTake(lookahead, *items[1], resolved));
+  EXPECT_EQ(2, lookahead.getMisses());
+  EXPECT_EQ(0, lookahead.getHits());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlayQueueLookahead, opensNextAndShowsNotifications)
+{
+  CFakeLookahead lookahead(2);
+
+  std::vector<CFileItemPtr> items;
+  items.push_back(makeItem(2));
+  items.push_back(makeItem(3));
+  items[0]->SetProperty("transcode", true);
+  lookahead.update(items);
+  Sleep(500);
+
+  // only close to the end and only once
+  lookahead.onProgress(100, 1200);
+  EXPECT_EQ(0, lookahead.m_opens);
+  lookahead.onProgress(1190, 1200);
+  lookahead.onProgress(1191, 1200);
+  EXPECT_EQ(1, lookahead.m_opens);
+
+  // the decision was made while the item before played, it's shown when this one plays
+  EXPECT_TRUE(lookahead.m_notifications.empty());
+  CFileItem resolved;
+  EXPECT_TRUE(lookahead.take(*items[0], resolved));
+  ASSERT_EQ(1, lookahead.m_notifications.size());
+  EXPECT_EQ(items[0]->GetLabel(), lookahead.m_notifications[0]);
+}
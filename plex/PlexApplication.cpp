@@ -35,6 +35,7 @@
 #include "Client/PlexTranscoderClient.h"
 #include "music/tags/MusicInfoTag.h"
 #include "FileSystem/PlexDirectoryCache.h"
+#include "Client/PlexSearchIndex.h"
 #include "GUI/GUIPlexDefaultActionHandler.h"
 #include "Client/PlexPubsubManager.h"
 
@@ -43,6 +44,7 @@
 
 #include "Client/PlexExtraInfoLoader.h"
 #include "Playlists/PlexPlayQueueManager.h"
+#include "Playlists/PlexPlayQueueLookahead.h"
 #include "GUI/GUIWindowStartup.h"
 
 #ifdef ENABLE_AUTOUPDATE
@@ -72,7 +74,9 @@ void PlexApplication::Start()
   profiler = CPlexProfilerPtr(new CPlexProfiler);
   extraInfo = new CPlexExtraInfoLoader;
   playQueueManager = CPlexPlayQueueManagerPtr(new CPlexPlayQueueManager);
+  playQueueLookahead = CPlexPlayQueueLookaheadPtr(new CPlexPlayQueueLookahead(g_advancedSettings.m_playQueueLookahead));
   directoryCache = CPlexDirectoryCachePtr(new CPlexDirectoryCache);
+  searchIndex = CPlexSearchIndexPtr(new CPlexSearchIndex);
   defaultActionHandler = CGUIPlexDefaultActionHandlerPtr(new CGUIPlexDefaultActionHandler);
   pubsubManager = CPlexPubsubManagerPtr(new CPlexPubsubManager);
 
@@ -311,9 +315,11 @@ void PlexApplication::Shutdown()
   CPlexTranscoderClient::DeleteInstance();
 
   directoryCache.reset();
+  searchIndex.reset();
   defaultActionHandler.reset();
 
   themeMusicPlayer.reset();
+  playQueueLookahead.reset();
   playQueueManager.reset();
 
   OnTimeout();
@@ -352,6 +358,8 @@ void PlexApplication::Announce(ANNOUNCEMENT::AnnouncementFlag flag, const char*
     if (stricmp(message, "OnPlay") == 0)
     {
       m_triedToRestart = false;
+      if (playQueueLookahead)
+        playQueueLookahead->update();
     }
     else if (stricmp(message, "OnStop") == 0)
     {
@@ -71,6 +71,12 @@ typedef boost::shared_ptr<CPlexPlayQueueManager> CPlexPlayQueueManagerPtr;
 class CPlexDirectoryCache;
 typedef boost::shared_ptr<CPlexDirectoryCache> CPlexDirectoryCachePtr;
 
+class CPlexSearchIndex;
+typedef boost::shared_ptr<CPlexSearchIndex> CPlexSearchIndexPtr;
+
+class CPlexPlayQueueLookahead;
+typedef boost::shared_ptr<CPlexPlayQueueLookahead> CPlexPlayQueueLookaheadPtr;
+
 class CGUIPlexDefaultActionHandler;
 typedef boost::shared_ptr<CGUIPlexDefaultActionHandler> CGUIPlexDefaultActionHandlerPtr;
 
@@ -127,8 +133,10 @@ public:
   CPlexGlobalTimerPtr timer;
   CPlexExtraInfoLoader* extraInfo;
   CPlexPlayQueueManagerPtr playQueueManager;
+  CPlexPlayQueueLookaheadPtr playQueueLookahead;
   CPlexBusyIndicator busy;
   CPlexDirectoryCachePtr directoryCache;
+  CPlexSearchIndexPtr searchIndex;
   CGUIPlexDefaultActionHandlerPtr defaultActionHandler;
   CPlexPubsubManagerPtr pubsubManager;
 
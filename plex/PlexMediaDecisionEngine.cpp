@@ -29,9 +29,11 @@
 #include "video/VideoInfoTag.h"
 #include "GUISettings.h"
 #include "PlexPlayQueueManager.h"
+#include "PlexPlayQueueLookahead.h"
 #include "ApplicationMessenger.h"
 #include "Client/PlexServerVersion.h"
 #include "dialogs/GUIDialogKaiToast.h"
+#include "Utility/PlexTracer.h"
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 bool CPlexMediaDecisionEngine::checkItemPlayability(const CFileItem& item)
@@ -110,11 +112,22 @@ bool CPlexMediaDecisionEngine::resolveItem(const CFileItem& _item, CFileItem &re
         return false;
     }
 
-    g_plexApplication.busy.blockWaitingForJob(new CPlexMediaDecisionJob(item), this);
-    CLog::Log(LOGDEBUG, "CPlexMediaDecisionEngine::BlockAndResolve resolve done, success: %s", m_success ? "Yes" : "No");
+    CPlexTracer::GetInstance().BeginPlay(item.GetLabel());
+
+    // items after the first one of a play queue are usually decided while the one before plays
+    if (g_plexApplication.playQueueLookahead && g_plexApplication.playQueueLookahead->take(item, m_resolvedItem))
+    {
+      m_success = true;
+    }
+    else
+    {
+      g_plexApplication.busy.blockWaitingForJob(new CPlexMediaDecisionJob(item), this);
+      CLog::Log(LOGDEBUG, "CPlexMediaDecisionEngine::BlockAndResolve resolve done, success: %s", m_success ? "Yes" : "No");
+    }
   }
   else
   {
+    CPlexTracer::GetInstance().BeginPlay(item.GetLabel());
     m_success = true;
     m_resolvedItem = item;
     CLog::Log(LOGDEBUG, "CPlexMediaDecisionEngine::resolveItem item already resolved");
@@ -343,6 +356,12 @@ void CPlexMediaDecisionJob::AddHeaders()
   }
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexMediaDecisionJob::Notify(const std::string& caption, const std::string& description)
+{
+  CGUIDialogKaiToast::QueueNotification(CGUIDialogKaiToast::Info, caption, description);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 CStdString CPlexMediaDecisionJob::GetPartURL(CFileItemPtr mediaPart)
 {
@@ -363,6 +382,7 @@ CStdString CPlexMediaDecisionJob::GetPartURL(CFileItemPtr mediaPart)
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 CFileItemPtr CPlexMediaDecisionJob::GetUrl(const CStdString& url)
 {
+  PLEX_TRACE_SPAN("metadata");
   CFileItemList list;
   if (m_dir.GetDirectory(url, list))
   {
@@ -380,6 +400,8 @@ CFileItemPtr CPlexMediaDecisionJob::GetUrl(const CStdString& url)
  * should be passed to the player core */
 bool CPlexMediaDecisionJob::DoWork()
 {
+  PLEX_TRACE_SPAN("media decision");
+
   /* resolve items that are not synthesized */
   if (m_item.IsPlexMediaServerLibrary() && m_item.IsVideo() &&
       !m_item.GetProperty("isSynthesized").asBoolean())
@@ -455,7 +477,12 @@ bool CPlexMediaDecisionJob::DoWork()
         XFILE::CPlexDirectory dir;
         CFileItemList list;
         dir.SetTimeout(2000);
-        if (dir.GetDirectory(tURL, list))
+        bool gotDecision;
+        {
+          PLEX_TRACE_SPAN("server decision");
+          gotDecision = dir.GetDirectory(tURL, list);
+        }
+        if (gotDecision)
         {
           int64_t generalDecisionCode = list.GetProperty("generalDecisionCode").asInteger();
           if (generalDecisionCode >= 2000)
@@ -464,7 +491,7 @@ bool CPlexMediaDecisionJob::DoWork()
             std::string directPlayDecisionText = list.GetProperty("directPlayDecisionText").asString();
             std::string transcodeDecisionText = list.GetProperty("transcodeDecisionText").asString();
             CLog::Log(LOGINFO, "Streaming Brain decided no playback, Code : %d, General : %s, DirectPlay : %s, Transcode : %s", generalDecisionCode, generalDecisionText.c_str(), directPlayDecisionText.c_str(), transcodeDecisionText.c_str());
-            CGUIDialogKaiToast::QueueNotification(CGUIDialogKaiToast::Info, "No playback", generalDecisionText);
+            Notify("No playback", generalDecisionText);
             return false;
           }
           else if (generalDecisionCode == 1001 && !shouldTranscode)
@@ -472,7 +499,7 @@ bool CPlexMediaDecisionJob::DoWork()
             int64_t transcodeDecisionCode = list.GetProperty("transcodeDecisionCode").asInteger();
             std::string transcodeDecisionText = list.GetProperty("transcodeDecisionText").asString();
             CLog::Log(LOGINFO, "Streaming Brain decided to transcode, Code : %d, Transcode : %s", transcodeDecisionCode, transcodeDecisionText.c_str());
-            CGUIDialogKaiToast::QueueNotification(CGUIDialogKaiToast::Info, "Transcoding", transcodeDecisionText);
+            Notify("Transcoding", transcodeDecisionText);
             shouldTranscode = true;
           }
 
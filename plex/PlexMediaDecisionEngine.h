@@ -25,6 +25,10 @@ public:
   virtual bool DoWork();
   CFileItem m_choosenMedia;
 
+protected:
+  // shows what the server decided, allow override for decisions made ahead of playback
+  virtual void Notify(const std::string& caption, const std::string& description);
+
 private:
   // allow override for tests.
   virtual CFileItemPtr GetUrl(const CStdString &url);
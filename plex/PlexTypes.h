@@ -9,6 +9,7 @@
 #include <boost/algorithm/string.hpp>
 #include "Variant.h"
 #include "StdString.h"
+#include "Utility/PlexFlatMap.h"
 
 enum EPlexDirectoryType
 {
@@ -260,8 +261,8 @@ typedef std::pair<std::string, CPlexServerPtr> PlexServerPair;
 
 #define PLEX_DEFAULT_PAGE_SIZE 50
 
-/* Property map definition */
-typedef boost::unordered_map<CStdString, CVariant> PropertyMap;
+/* Property map definition, see CPlexFlatMap for why this isn't a hash map */
+typedef CPlexFlatMap<CStdString, CVariant> PropertyMap;
 
 #define PLEX_HOME_THEATER_CAPABILITY_STRING "navigation,playback,timeline,mirror,playqueues"
 #define PLEX_HOME_THEATER_USER_AGENT "Mozilla/5.0 (Macintosh; Intel Mac OS X 10_8_2) AppleWebKit/537.17 (KHTML, like Gecko) Chrome/24.0.1312.52 Safari/537.17"
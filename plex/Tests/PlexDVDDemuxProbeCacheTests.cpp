@@ -0,0 +1,132 @@
+#include "PlexTest.h"
+#include "cores/dvdplayer/DVDDemuxers/DVDDemuxProbeCache.h"
+
+#include <stdio.h>
+
+static std::string cacheFile()
+{
+  std::string path = std::string(P_tmpdir) + "/PlexDVDDemuxProbeCacheTest.xml";
+  remove(path.c_str());
+  return path;
+}
+
+static CDVDDemuxProbeCache::Entry makeEntry(const std::string& format, int videoCodec)
+{
+  CDVDDemuxProbeCache::Entry entry;
+  entry.format = format;
+
+  CDVDDemuxProbeCache::Stream video;
+  video.type = 0;
+  video.codecId = videoCodec;
+  video.width = 1920;
+  video.height = 1080;
+  video.pixFmt = 0;
+  video.extraData = std::string("\x01\x64\x00\x29\xff", 5);
+  entry.streams.push_back(video);
+
+  CDVDDemuxProbeCache::Stream audio;
+  audio.type = 1;
+  audio.codecId = 86019;
+  audio.sampleRate = 48000;
+  audio.channels = 6;
+  audio.channelLayout = 0x60f;
+  audio.sampleFmt = 8;
+  audio.frameSize = 1536;
+  entry.streams.push_back(audio);
+
+  return entry;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexDVDDemuxProbeCache, key)
+{
+  std::string key = CDVDDemuxProbeCache::GetKey("http://10.0.0.1:32400/library/parts/1234/file.mkv?X-Plex-Token=abc", 1000);
+  EXPECT_EQ(key, CDVDDemuxProbeCache::GetKey("http://10.0.0.1:32400/library/parts/1234/file.mkv?X-Plex-Token=def", 1000));
+  EXPECT_NE(key, CDVDDemuxProbeCache::GetKey("http://10.0.0.1:32400/library/parts/1234/file.mkv", 1001));
+  EXPECT_EQ(std::string::npos, key.find("abc"));
+
+  // a part replaced with a file of the same size
+  std::string part = CDVDDemuxProbeCache::GetKey("/media/movie.mkv", 1000, "1234@1391593013");
+  EXPECT_EQ(part, CDVDDemuxProbeCache::GetKey("/media/movie.mkv", 1000, "1234@1391593013"));
+  EXPECT_NE(part, CDVDDemuxProbeCache::GetKey("/media/movie.mkv", 1000, "1234@1391599999"));
+  EXPECT_NE(part, CDVDDemuxProbeCache::GetKey("/media/movie.mkv", 1000, "1235@1391593013"));
+
+  // streams without a known size can't be told apart
+  EXPECT_TRUE(CDVDDemuxProbeCache::GetKey("http://10.0.0.1/live.ts", 0).empty());
+  EXPECT_TRUE(CDVDDemuxProbeCache::GetKey("http://10.0.0.1/live.ts", -1).empty());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexDVDDemuxProbeCache, addGetRemove)
+{
+  CDVDDemuxProbeCache cache(cacheFile());
+  CDVDDemuxProbeCache::Entry entry;
+
+  EXPECT_FALSE(cache.Get("a|1", entry));
+  cache.Add("a|1", makeEntry("matroska,webm", 28));
+
+  ASSERT_TRUE(cache.Get("a|1", entry));
+  EXPECT_EQ("matroska,webm", entry.format);
+  ASSERT_EQ(2, entry.streams.size());
+  EXPECT_EQ(1920, entry.streams[0].width);
+  EXPECT_EQ(6, entry.streams[1].channels);
+
+  // empty keys are never cached
+  cache.Add("", makeEntry("avi", 13));
+  EXPECT_EQ(1, cache.GetSize());
+
+  cache.Remove("a|1");
+  EXPECT_FALSE(cache.Get("a|1", entry));
+  EXPECT_EQ(0, cache.GetSize());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexDVDDemuxProbeCache, dropsLeastRecentlyUsed)
+{
+  CDVDDemuxProbeCache cache(cacheFile(), 2);
+  CDVDDemuxProbeCache::Entry entry;
+
+  cache.Add("a|1", makeEntry("matroska,webm", 28));
+  cache.Add("b|1", makeEntry("mov,mp4,m4a,3gp,3g2,mj2", 28));
+  EXPECT_TRUE(cache.Get("a|1", entry));
+
+  cache.Add("c|1", makeEntry("avi", 13));
+  EXPECT_EQ(2, cache.GetSize());
+  EXPECT_TRUE(cache.Get("a|1", entry));
+  EXPECT_FALSE(cache.Get("b|1", entry));
+  EXPECT_TRUE(cache.Get("c|1", entry));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexDVDDemuxProbeCache, persists)
+{
+  std::string file = cacheFile();
+  {
+    CDVDDemuxProbeCache cache(file, 2);
+    cache.Add("a|1", makeEntry("matroska,webm", 28));
+    cache.Add("b|1", makeEntry("avi", 13));
+  }
+
+  CDVDDemuxProbeCache cache(file, 2);
+  CDVDDemuxProbeCache::Entry entry;
+  ASSERT_TRUE(cache.Get("b|1", entry));
+  EXPECT_EQ("avi", entry.format);
+  ASSERT_EQ(2, entry.streams.size());
+
+  CDVDDemuxProbeCache::Entry expected = makeEntry("avi", 13);
+  EXPECT_EQ(expected.streams[0].codecId, entry.streams[0].codecId);
+  EXPECT_EQ(expected.streams[0].height, entry.streams[0].height);
+  EXPECT_EQ(expected.streams[0].extraData, entry.streams[0].extraData);
+  EXPECT_EQ(expected.streams[1].sampleRate, entry.streams[1].sampleRate);
+  EXPECT_EQ(expected.streams[1].channelLayout, entry.streams[1].channelLayout);
+  EXPECT_EQ(expected.streams[1].sampleFmt, entry.streams[1].sampleFmt);
+  EXPECT_EQ(expected.streams[1].frameSize, entry.streams[1].frameSize);
+  EXPECT_TRUE(entry.streams[1].extraData.empty());
+
+  // the order of use survives too, "a" was used least recently
+  cache.Add("c|1", makeEntry("mpeg", 2));
+  EXPECT_FALSE(cache.Get("a|1", entry));
+  EXPECT_TRUE(cache.Get("b|1", entry));
+
+  remove(file.c_str());
+}
@@ -0,0 +1,175 @@
+#include "PlexTest.h"
+#include "dbwrappers/Database.h"
+#include "dbwrappers/dataset.h"
+#include "settings/AdvancedSettings.h"
+
+#include <stdio.h>
+
+// a database with one table of ids, each insert nests in a transaction of its own like the
+// SetDetailsFor* calls of the scanners do
+class CTestBatchDatabase : public CDatabase
+{
+public:
+  bool Open()
+  {
+    DatabaseSettings settings;
+    settings.type = "sqlite3";
+    settings.host = P_tmpdir;
+    // connects, creating the tables if needed, without going through the database manager
+    return Update(settings);
+  }
+
+  void Insert(int id, bool fail = false)
+  {
+    BeginTransaction();
+    m_pDS->exec(PrepareSQL("INSERT INTO item (id) VALUES (%i)", id));
+    if (fail)
+      return; // as if it threw before committing
+    CommitTransaction();
+  }
+
+  int Count()
+  {
+    m_pDS->query("SELECT COUNT(*) FROM item");
+    int count = m_pDS->fv(0).get_asInt();
+    m_pDS->close();
+    return count;
+  }
+
+protected:
+  virtual bool CreateTables()
+  {
+    if (!CDatabase::CreateTables())
+      return false;
+    m_pDS->exec("CREATE TABLE item (id integer primary key)");
+    return true;
+  }
+
+  virtual int GetMinVersion() const { return 1; }
+  virtual const char *GetBaseDBName() const { return "PlexDatabaseBatchTest"; }
+};
+
+class CTestDatabaseBatch : public CDatabaseBatch
+{
+public:
+  CTestDatabaseBatch(CDatabase &db) : CDatabaseBatch(db, 3, 1000), m_time(0) {}
+  virtual unsigned int GetTime() const { return m_time; }
+  unsigned int m_time;
+};
+
+class PlexDatabaseBatchTest : public ::testing::Test
+{
+public:
+  void SetUp()
+  {
+    remove(path().c_str());
+    ASSERT_TRUE(m_db.Open());
+  }
+
+  void TearDown()
+  {
+    m_db.Close();
+    remove(path().c_str());
+  }
+
+  std::string path() const
+  {
+    return std::string(P_tmpdir) + "/PlexDatabaseBatchTest1.db";
+  }
+
+  // what another connection sees, ie. what's committed
+  int committed()
+  {
+    CTestBatchDatabase other;
+    if (!other.Open())
+      return -1;
+    int count = other.Count();
+    other.Close();
+    return count;
+  }
+
+  CTestBatchDatabase m_db;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F(PlexDatabaseBatchTest, commitsEveryFewWrites)
+{
+  CTestDatabaseBatch batch(m_db);
+  batch.Start();
+
+  for (int i = 1; i <= 7; i++)
+  {
+    batch.Open();
+    m_db.Insert(i);
+    batch.AddWrites();
+    batch.Commit(false);
+  }
+
+  EXPECT_EQ(2, batch.GetCommits());
+  EXPECT_EQ(6, committed());
+  EXPECT_TRUE(batch.IsOpen());
+
+  batch.End();
+  EXPECT_EQ(3, batch.GetCommits());
+  EXPECT_EQ(7, committed());
+  EXPECT_FALSE(m_db.InTransaction());
+  EXPECT_EQ(0, m_db.GetTransactionDepth());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F(PlexDatabaseBatchTest, commitsWhenOpenTooLong)
+{
+  CTestDatabaseBatch batch(m_db);
+  batch.Start();
+
+  batch.Open();
+  m_db.Insert(1);
+  batch.AddWrites();
+  batch.Commit(false);
+  EXPECT_TRUE(batch.IsOpen());
+
+  batch.m_time += 1000;
+  batch.Commit(false);
+  EXPECT_FALSE(batch.IsOpen());
+  EXPECT_EQ(1, committed());
+
+  batch.End();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F(PlexDatabaseBatchTest, nothingBatchedUnlessStarted)
+{
+  CTestDatabaseBatch batch(m_db);
+  batch.Open();
+  EXPECT_FALSE(batch.IsOpen());
+
+  m_db.Insert(1);
+  EXPECT_EQ(1, committed());
+  EXPECT_EQ(0, m_db.GetTransactionDepth());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F(PlexDatabaseBatchTest, unfinishedWriteIsRolledBack)
+{
+  CTestDatabaseBatch batch(m_db);
+  batch.Start();
+
+  batch.Open();
+  m_db.Insert(1);
+  m_db.Insert(2, true);
+  EXPECT_EQ(2, m_db.GetTransactionDepth());
+
+  // the write that failed goes, the rest of the batch is kept
+  batch.End();
+  EXPECT_EQ(0, m_db.GetTransactionDepth());
+  EXPECT_FALSE(m_db.InTransaction());
+  EXPECT_EQ(1, committed());
+
+  // and the next batch starts at the top again
+  batch.Start();
+  batch.Open();
+  m_db.Insert(3);
+  EXPECT_EQ(1, m_db.GetTransactionDepth());
+  batch.End();
+  EXPECT_EQ(2, committed());
+}
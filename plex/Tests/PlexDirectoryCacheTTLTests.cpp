@@ -0,0 +1,225 @@
+#include "PlexTest.h"
+#include "filesystem/DirectoryCache.h"
+#include "settings/AdvancedSettings.h"
+#include "FileItem.h"
+
+using namespace XFILE;
+
+// a clock the test moves and refreshes that are only counted
+class CTestDirectoryCache : public CDirectoryCache
+{
+public:
+  CTestDirectoryCache() : m_time(1000) {}
+
+  virtual void RefreshDirectory(const CStdString& strPath) { m_refreshed.push_back(strPath); }
+  virtual unsigned int GetTime() const { return m_time; }
+
+  unsigned int m_time;
+  std::vector<CStdString> m_refreshed;
+};
+
+static void fillItems(CFileItemList& items, const std::string& dir, int count)
+{
+  for (int i = 0; i < count; i++)
+  {
+    CStdString path;
+    path.Format("%s/file%d.mkv", dir.c_str(), i);
+    CFileItemPtr item(new CFileItem(path, false));
+    item->SetLabel(path);
+    items.Add(item);
+  }
+}
+
+class PlexDirectoryCacheTTLTest : public ::testing::Test
+{
+public:
+  virtual void SetUp()
+  {
+    m_size = g_advancedSettings.m_directoryCacheSize;
+    m_ttl = g_advancedSettings.m_directoryCacheTTL;
+    m_ttls = g_advancedSettings.m_directoryCacheTTLs;
+
+    g_advancedSettings.m_directoryCacheSize = 1024;
+    g_advancedSettings.m_directoryCacheTTL = 300;
+    g_advancedSettings.m_directoryCacheTTLs.clear();
+    g_advancedSettings.m_directoryCacheTTLs["smb"] = 60;
+  }
+
+  virtual void TearDown()
+  {
+    g_advancedSettings.m_directoryCacheSize = m_size;
+    g_advancedSettings.m_directoryCacheTTL = m_ttl;
+    g_advancedSettings.m_directoryCacheTTLs = m_ttls;
+  }
+
+  int m_size;
+  int m_ttl;
+  std::map<std::string, int> m_ttls;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F(PlexDirectoryCacheTTLTest, ttlByProtocol)
+{
+  EXPECT_EQ(60000, CDirectoryCache::GetTTL("smb://server/share/"));
+  EXPECT_EQ(60000, CDirectoryCache::GetTTL("SMB://server/share/"));
+  EXPECT_EQ(300000, CDirectoryCache::GetTTL("http://server/dir/"));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F(PlexDirectoryCacheTTLTest, freshHit)
+{
+  CTestDirectoryCache cache;
+  CFileItemList items;
+  fillItems(items, "http://server/dir", 3);
+  cache.SetDirectory("http://server/dir", items, DIR_CACHE_ALWAYS);
+
+  cache.m_time += 1000;
+  CFileItemList cached;
+  EXPECT_TRUE(cache.GetDirectory("http://server/dir", cached));
+  EXPECT_EQ(3, cached.Size());
+  EXPECT_EQ(1, cache.GetHits());
+  EXPECT_EQ(0, cache.GetStaleHits());
+  EXPECT_TRUE(cache.m_refreshed.empty());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F(PlexDirectoryCacheTTLTest, staleHitRefreshes)
+{
+  CTestDirectoryCache cache;
+  CFileItemList items;
+  fillItems(items, "smb://server/share", 3);
+  cache.SetDirectory("smb://server/share", items, DIR_CACHE_ALWAYS);
+
+  cache.m_time += 61000;
+  CFileItemList cached;
+  EXPECT_TRUE(cache.GetDirectory("smb://server/share", cached));
+  EXPECT_EQ(3, cached.Size());
+  EXPECT_EQ(0, cache.GetHits());
+  EXPECT_EQ(1, cache.GetStaleHits());
+  ASSERT_EQ(1, cache.m_refreshed.size());
+  EXPECT_STREQ("smb://server/share", cache.m_refreshed[0]);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F(PlexDirectoryCacheTTLTest, tooStaleIsMiss)
+{
+  CTestDirectoryCache cache;
+  CFileItemList items;
+  fillItems(items, "smb://server/share", 3);
+  cache.SetDirectory("smb://server/share", items, DIR_CACHE_ALWAYS);
+
+  cache.m_time += 600000;
+  CFileItemList cached;
+  EXPECT_FALSE(cache.GetDirectory("smb://server/share", cached));
+  EXPECT_EQ(1, cache.GetMisses());
+  EXPECT_TRUE(cache.m_refreshed.empty());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F(PlexDirectoryCacheTTLTest, boundedBySize)
+{
+  CTestDirectoryCache cache;
+
+  CFileItemList items;
+  fillItems(items, "http://server/a", 10);
+  unsigned int size = CDirectoryCache::EstimateSize(items);
+  ASSERT_GT(size, 0);
+
+  // room for two of them
+  g_advancedSettings.m_directoryCacheSize = (size * 2 + size / 2) / 1024 + 1;
+
+  cache.SetDirectory("http://server/a", items, DIR_CACHE_ALWAYS);
+  cache.SetDirectory("http://server/b", items, DIR_CACHE_ALWAYS);
+  EXPECT_EQ(size * 2, cache.GetSize());
+
+  // a was used last, b goes
+  CFileItemList cached;
+  EXPECT_TRUE(cache.GetDirectory("http://server/a", cached));
+  cache.SetDirectory("http://server/c", items, DIR_CACHE_ALWAYS);
+  EXPECT_EQ(size * 2, cache.GetSize());
+
+  CFileItemList a, b, c;
+  EXPECT_TRUE(cache.GetDirectory("http://server/a", a));
+  EXPECT_FALSE(cache.GetDirectory("http://server/b", b));
+  EXPECT_TRUE(cache.GetDirectory("http://server/c", c));
+
+  cache.ClearDirectory("http://server/a");
+  cache.ClearDirectory("http://server/c");
+  EXPECT_EQ(0, cache.GetSize());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F(PlexDirectoryCacheTTLTest, tooLargeIsKeptAlone)
+{
+  CTestDirectoryCache cache;
+  g_advancedSettings.m_directoryCacheSize = 1;
+
+  CFileItemList small, items;
+  fillItems(small, "http://server/small", 1);
+  fillItems(items, "http://server/big", 100);
+  cache.SetDirectory("http://server/small", small, DIR_CACHE_ALWAYS);
+  cache.SetDirectory("http://server/big", items, DIR_CACHE_ALWAYS);
+
+  // whoever fetched it reads it back, everything else made room for it
+  CFileItemList cached;
+  EXPECT_TRUE(cache.GetDirectory("http://server/big", cached));
+  EXPECT_EQ(100, cached.Size());
+  EXPECT_FALSE(cache.GetDirectory("http://server/small", cached));
+  EXPECT_EQ(CDirectoryCache::EstimateSize(items), cache.GetSize());
+
+  // and it's the first to go for the next one
+  cache.SetDirectory("http://server/small", small, DIR_CACHE_ALWAYS);
+  EXPECT_FALSE(cache.GetDirectory("http://server/big", cached));
+  EXPECT_TRUE(cache.GetDirectory("http://server/small", cached));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F(PlexDirectoryCacheTTLTest, onceBrowsedWithinProtocolTTL)
+{
+  CTestDirectoryCache cache;
+  CFileItemList items;
+  fillItems(items, "smb://server/share", 3);
+  cache.SetDirectory("smb://server/share", items, DIR_CACHE_ONCE, DIR_FLAG_READ_CACHE_TTL);
+
+  // only for those asking for it
+  CFileItemList cached;
+  EXPECT_FALSE(cache.GetDirectory("smb://server/share", cached));
+  EXPECT_TRUE(cache.GetDirectory("smb://server/share", cached, false, true));
+  EXPECT_EQ(3, cached.Size());
+
+  cache.m_time += 61000;
+  EXPECT_TRUE(cache.GetDirectory("smb://server/share", cached, false, true));
+  EXPECT_EQ(1, cache.m_refreshed.size());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F(PlexDirectoryCacheTTLTest, onceNotBrowsedWithoutProtocolTTL)
+{
+  CTestDirectoryCache cache;
+  CFileItemList items;
+  fillItems(items, "/media/disk", 3);
+  cache.SetDirectory("/media/disk", items, DIR_CACHE_ONCE, DIR_FLAG_READ_CACHE_TTL);
+
+  CFileItemList cached;
+  EXPECT_FALSE(cache.GetDirectory("/media/disk", cached, false, true));
+
+  // still there for those reading the cache on purpose
+  EXPECT_TRUE(cache.GetDirectory("/media/disk", cached, true));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F(PlexDirectoryCacheTTLTest, noTTLNeverExpires)
+{
+  g_advancedSettings.m_directoryCacheTTL = 0;
+
+  CTestDirectoryCache cache;
+  CFileItemList items;
+  fillItems(items, "http://server/dir", 3);
+  cache.SetDirectory("http://server/dir", items, DIR_CACHE_ALWAYS);
+
+  cache.m_time += 24 * 3600 * 1000;
+  CFileItemList cached;
+  EXPECT_TRUE(cache.GetDirectory("http://server/dir", cached));
+  EXPECT_EQ(1, cache.GetHits());
+  EXPECT_TRUE(cache.m_refreshed.empty());
+}
@@ -0,0 +1,128 @@
+#include "PlexTest.h"
+#include "guilib/GUIFontGlyphAtlas.h"
+
+#include <stdlib.h>
+#include <vector>
+
+struct AtlasRect
+{
+  unsigned int x, y, w, h;
+};
+
+static bool overlaps(const AtlasRect& a, const AtlasRect& b)
+{
+  return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexGUIFontGlyphAtlas, noPagesNoRoom)
+{
+  CGUIFontGlyphAtlas atlas;
+  atlas.Reset(256, 64, 2);
+
+  unsigned int x, y, page;
+  EXPECT_FALSE(atlas.Allocate(10, 10, x, y, page));
+  EXPECT_EQ(CGUIFontGlyphAtlas::NO_PAGE, atlas.GetLeastRecentlyUsedPage());
+
+  EXPECT_TRUE(atlas.AddPage());
+  EXPECT_TRUE(atlas.AddPage());
+  EXPECT_FALSE(atlas.AddPage());
+  EXPECT_EQ(2, atlas.GetPageCount());
+
+  // never larger than a page
+  EXPECT_FALSE(atlas.Allocate(257, 10, x, y, page));
+  EXPECT_FALSE(atlas.Allocate(10, 65, x, y, page));
+}
+
+// fill the atlas with random glyph sizes, returning the density a fixed line height would have given
+static float fillAtlas(CGUIFontGlyphAtlas& atlas, unsigned int minW, unsigned int maxW, unsigned int minH, unsigned int maxH,
+                       std::vector<AtlasRect>& rects)
+{
+  atlas.Reset(1024, 128, 16);
+  atlas.AddPage();
+
+  srand(42);
+  double area = 0;
+  unsigned int lineX = 0, lines = 1;
+  int failures = 0;
+  while (failures < 100)
+  {
+    AtlasRect r;
+    r.w = minW + rand() % (maxW - minW + 1);
+    r.h = minH + rand() % (maxH - minH + 1);
+    unsigned int page;
+    if (!atlas.Allocate(r.w, r.h, r.x, r.y, page))
+    {
+      // once full, keep trying for a bit so smaller glyphs can fill the gaps
+      if (!atlas.AddPage())
+        failures++;
+      continue;
+    }
+    EXPECT_EQ(page, r.y / 128);
+    EXPECT_LE(r.x + r.w, 1024);
+    EXPECT_LE(r.y + r.h, (page + 1) * 128);
+    rects.push_back(r);
+
+    area += r.w * r.h;
+    if (lineX + r.w > 1024)
+    {
+      lines++;
+      lineX = 0;
+    }
+    lineX += r.w;
+  }
+  return (float)(area / (lines * 1024.0 * (maxH + 1)));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexGUIFontGlyphAtlas, packingDensity)
+{
+  // glyph sizes of a 28px CJK heavy font, which vary a lot less than latin ones
+  std::vector<AtlasRect> rects;
+  CGUIFontGlyphAtlas atlas;
+  float lineDensity = fillAtlas(atlas, 20, 29, 22, 31, rects);
+  EXPECT_EQ(16, atlas.GetPageCount());
+  EXPECT_GT(atlas.GetOccupancy(), 0.8f);
+  EXPECT_GE(atlas.GetOccupancy(), lineDensity);
+
+  for (size_t i = 0; i < rects.size(); i++)
+  {
+    for (size_t j = i + 1; j < rects.size(); j++)
+      ASSERT_FALSE(overlaps(rects[i], rects[j]));
+  }
+
+  // latin glyphs range from '.' to 'Q', which is where a skyline beats fixed lines by far
+  rects.clear();
+  lineDensity = fillAtlas(atlas, 4, 27, 4, 31, rects);
+  EXPECT_GT(atlas.GetOccupancy(), 0.85f);
+  EXPECT_GT(atlas.GetOccupancy(), lineDensity * 1.5f);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexGUIFontGlyphAtlas, evictLeastRecentlyUsed)
+{
+  CGUIFontGlyphAtlas atlas;
+  atlas.Reset(64, 16, 3);
+  atlas.AddPage();
+  atlas.AddPage();
+  atlas.AddPage();
+
+  // fill all pages, one glyph per page
+  unsigned int x, y, page;
+  for (unsigned int i = 0; i < 3; i++)
+    EXPECT_TRUE(atlas.Allocate(64, 16, x, y, page));
+  EXPECT_FALSE(atlas.Allocate(8, 8, x, y, page));
+
+  // page 1 is the oldest once 0 and 2 are used again
+  atlas.Touch(0);
+  atlas.Touch(2);
+  EXPECT_EQ(1, atlas.GetLeastRecentlyUsedPage());
+
+  atlas.ClearPage(1);
+  EXPECT_TRUE(atlas.Allocate(8, 8, x, y, page));
+  EXPECT_EQ(1, page);
+  EXPECT_EQ(16, y);
+
+  // a cleared page counts as just used
+  EXPECT_EQ(0, atlas.GetLeastRecentlyUsedPage());
+}
@@ -7,6 +7,10 @@
 #include "PlexApplication.h"
 #include "Playlists/PlexPlayQueueManager.h"
 #include "Playlists/PlexPlayQueueServer.h"
+#include "filesystem/Directory.h"
+#include "utils/XBMCTinyXML.h"
+#include "utils/Stopwatch.h"
+#include "test/TestUtils.h"
 
 class FakeVideoPlayer : public CDVDPlayer
 {
@@ -233,3 +237,140 @@ TEST_F(PlexGUIInfoManagerPlayQueueTest, caseSensitive)
       CPlexPlayQueueManagerPtr(new PlexPlayQueueManagerFake(PLEX_MEDIA_TYPE_VIDEO, PLEX_DIR_TYPE_CLIP));
   EXPECT_TRUE(g_infoManager.EvaluateBool("System.PlexPlayQueue(clip)"));
 }
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+static void collectSkinConditions(const TiXmlElement* element, std::vector<CStdString>& conditions)
+{
+  for (; element; element = element->NextSiblingElement())
+  {
+    const char* condition = element->Attribute("condition");
+    if (condition)
+      conditions.push_back(condition);
+
+    CStdString tag = element->ValueStr();
+    if ((tag == "visible" || tag == "enable" || tag == "selected" || tag == "usealttexture") &&
+        element->FirstChild())
+      conditions.push_back(element->FirstChild()->ValueStr());
+
+    collectSkinConditions(element->FirstChildElement(), conditions);
+  }
+}
+
+TEST_F(PlexGUIInfoManagerTest, registerSkinConditionsBenchmark)
+{
+  CFileItemList files;
+  ASSERT_TRUE(XFILE::CDirectory::GetDirectory(XBMC_REF_FILE_PATH("addons/skin.plex/720p/"), files, ".xml"));
+
+  std::vector<std::pair<int, std::vector<CStdString> > > windows;
+  size_t total = 0;
+  for (int i = 0; i < files.Size(); i++)
+  {
+    CXBMCTinyXML doc;
+    if (!doc.LoadFile(files.Get(i)->GetPath()))
+      continue;
+
+    // each window registers its conditions in its own context, like CGUIWindow::Load does
+    windows.push_back(std::make_pair(i + 1, std::vector<CStdString>()));
+    collectSkinConditions(doc.RootElement(), windows.back().second);
+    total += windows.back().second.size();
+  }
+  EXPECT_GT(total, 0);
+
+  std::vector<INFO::InfoPtr> registered;
+  registered.reserve(total);
+
+  CStopWatch timer;
+  timer.StartZero();
+  for (size_t w = 0; w < windows.size(); w++)
+  {
+    for (size_t c = 0; c < windows[w].second.size(); c++)
+      registered.push_back(g_infoManager.Register(windows[w].second[c], windows[w].first));
+  }
+  float firstLoad = timer.GetElapsedMilliseconds();
+
+  // a skin reload registers everything again and should only hit the index
+  timer.StartZero();
+  size_t index = 0;
+  for (size_t w = 0; w < windows.size(); w++)
+  {
+    for (size_t c = 0; c < windows[w].second.size(); c++, index++)
+      EXPECT_EQ(registered[index], g_infoManager.Register(windows[w].second[c], windows[w].first));
+  }
+  float reload = timer.GetElapsedMilliseconds();
+
+  std::cout << "Registered " << total << " conditions from " << windows.size() << " windows: "
+            << firstLoad << " ms, reload " << reload << " ms" << std::endl;
+
+  // once released, Clear() must drop them from the index as well
+  registered.clear();
+  g_infoManager.Clear();
+  INFO::InfoPtr info = g_infoManager.Register("Player.HasVideo", 1);
+  EXPECT_TRUE(info);
+  EXPECT_EQ(info, g_infoManager.Register("player.hasvideo", 1));
+  EXPECT_NE(info, g_infoManager.Register("Player.HasVideo", 2));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+static int countDirty(const std::vector<INFO::InfoPtr>& bools)
+{
+  int dirty = 0;
+  for (size_t i = 0; i < bools.size(); i++)
+  {
+    if (bools[i]->IsDirty())
+      dirty++;
+    bools[i]->Get();
+  }
+  return dirty;
+}
+
+TEST_F(PlexGUIInfoManagerTest, incrementalEvaluationBenchmark)
+{
+  const char* conditions[] = { "System.Platform.Linux", "true", "Player.HasVideo", "Player.Paused",
+                               "Window.IsActive(home)", "Window.IsVisible(10000)",
+                               "[Player.HasVideo + !Window.IsActive(home)]", "Container.Scrolling" };
+
+  std::vector<INFO::InfoPtr> bools;
+  for (size_t i = 0; i < sizeof(conditions) / sizeof(conditions[0]); i++)
+    bools.push_back(g_infoManager.Register(conditions[i], 0));
+
+  EXPECT_EQ((unsigned int)INFO::DEPENDS_NONE, bools[0]->GetDependencies());
+  EXPECT_EQ((unsigned int)INFO::DEPENDS_PLAYER, bools[2]->GetDependencies());
+  EXPECT_EQ((unsigned int)INFO::DEPENDS_WINDOW, bools[4]->GetDependencies());
+  EXPECT_EQ((unsigned int)(INFO::DEPENDS_PLAYER | INFO::DEPENDS_WINDOW), bools[6]->GetDependencies());
+  EXPECT_EQ((unsigned int)INFO::DEPENDS_ALWAYS, bools[7]->GetDependencies());
+
+  // everything is evaluated on the first use
+  EXPECT_EQ((int)bools.size(), countDirty(bools));
+
+  // flush anything notified by earlier tests
+  g_infoManager.ResetCache(true);
+  countDirty(bools);
+
+  // an idle frame only re-evaluates what can't be tracked
+  g_infoManager.ResetCache(true);
+  EXPECT_EQ(1, countDirty(bools));
+
+  g_infoManager.NotifyChanged(INFO::DEPENDS_PLAYER);
+  g_infoManager.ResetCache(true);
+  EXPECT_TRUE(bools[2]->IsDirty());
+  EXPECT_TRUE(bools[6]->IsDirty());
+  EXPECT_FALSE(bools[4]->IsDirty());
+  EXPECT_EQ(4, countDirty(bools));
+
+  // a full reset still marks everything
+  g_infoManager.ResetCache();
+  EXPECT_EQ((int)bools.size(), countDirty(bools));
+
+  const int frames = 1000;
+  int incremental = 0, full = 0;
+  for (int i = 0; i < frames; i++)
+  {
+    g_infoManager.ResetCache(true);
+    incremental += countDirty(bools);
+    g_infoManager.ResetCache();
+    full += countDirty(bools);
+  }
+  std::cout << "Evaluations per idle frame: " << (float)incremental / frames << " incremental, "
+            << (float)full / frames << " full reset, " << bools.size() << " registered" << std::endl;
+  EXPECT_LT(incremental, full);
+}
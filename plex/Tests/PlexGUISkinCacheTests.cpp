@@ -0,0 +1,102 @@
+#include "PlexTest.h"
+#include "guilib/GUISkinCache.h"
+#include "utils/XBMCTinyXML.h"
+
+static const char* testWindow =
+  "<window id=\"1\">"
+  "<defaultcontrol always=\"true\">50</defaultcontrol>"
+  "<!-- dropped -->"
+  "<controls>"
+  "<control type=\"label\" id=\"2\"><label>$INFO[ListItem.Title]</label><visible>Player.HasVideo</visible></control>"
+  "<control type=\"group\"><control type=\"image\"><texture><![CDATA[a<b]]></texture></control></control>"
+  "</controls>"
+  "</window>";
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexGUISkinCache, serializeRoundTrip)
+{
+  CXBMCTinyXML doc;
+  doc.Parse(testWindow);
+  ASSERT_TRUE(doc.RootElement());
+
+  std::string data;
+  CGUISkinCache::Serialize(doc.RootElement(), data);
+
+  size_t pos = 0;
+  TiXmlNode* node = CGUISkinCache::Deserialize(data.c_str(), data.size(), pos);
+  ASSERT_TRUE(node);
+  EXPECT_EQ(data.size(), pos);
+
+  TiXmlElement* root = node->ToElement();
+  ASSERT_TRUE(root);
+  EXPECT_STREQ("window", root->Value());
+  EXPECT_STREQ("1", root->Attribute("id"));
+
+  const TiXmlElement* def = root->FirstChildElement("defaultcontrol");
+  ASSERT_TRUE(def);
+  EXPECT_STREQ("true", def->Attribute("always"));
+  EXPECT_STREQ("50", def->GetText());
+
+  const TiXmlElement* label = root->FirstChildElement("controls")->FirstChildElement("control");
+  ASSERT_TRUE(label);
+  EXPECT_STREQ("$INFO[ListItem.Title]", label->FirstChildElement("label")->GetText());
+  EXPECT_STREQ("Player.HasVideo", label->FirstChildElement("visible")->GetText());
+
+  const TiXmlElement* texture = label->NextSiblingElement("control")->FirstChildElement("control")->FirstChildElement("texture");
+  ASSERT_TRUE(texture);
+  EXPECT_TRUE(texture->FirstChild()->ToText()->CDATA());
+  EXPECT_STREQ("a<b", texture->GetText());
+
+  // serializing the copy gives the same data, ie comments are dropped on the first pass
+  std::string copy;
+  CGUISkinCache::Serialize(root, copy);
+  EXPECT_EQ(data, copy);
+  delete node;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexGUISkinCache, deserializeTruncated)
+{
+  CXBMCTinyXML doc;
+  doc.Parse(testWindow);
+
+  std::string data;
+  CGUISkinCache::Serialize(doc.RootElement(), data);
+
+  for (size_t size = 0; size < data.size(); size += 7)
+  {
+    size_t pos = 0;
+    EXPECT_TRUE(CGUISkinCache::Deserialize(data.c_str(), size, pos) == NULL);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexGUISkinCache, deserializeTooDeep)
+{
+  // a corrupt file must not recurse without bound
+  std::string xml;
+  for (int i = 0; i < 300; i++)
+    xml += "<control>";
+  for (int i = 0; i < 300; i++)
+    xml += "</control>";
+
+  CXBMCTinyXML doc;
+  doc.Parse(xml.c_str());
+  ASSERT_TRUE(doc.RootElement());
+
+  std::string data;
+  CGUISkinCache::Serialize(doc.RootElement(), data);
+  size_t pos = 0;
+  EXPECT_TRUE(CGUISkinCache::Deserialize(data.c_str(), data.size(), pos) == NULL);
+
+  // while windows nested as deep as real ones load
+  TiXmlElement* inner = doc.RootElement();
+  for (int i = 0; i < 250; i++)
+    inner = inner->FirstChildElement();
+  data.clear();
+  CGUISkinCache::Serialize(inner, data);
+  pos = 0;
+  TiXmlNode* node = CGUISkinCache::Deserialize(data.c_str(), data.size(), pos);
+  EXPECT_TRUE(node != NULL);
+  delete node;
+}
@@ -0,0 +1,88 @@
+#include "PlexTest.h"
+#include "guilib/GUITextLayoutCache.h"
+
+static CGUITextLayoutCache::Key makeKey(const CStdStringW& text, float maxWidth = 0)
+{
+  CGUITextLayoutCache::Key key;
+  key.text = text;
+  key.font = (const CGUIFont*)0x1000;
+  key.maxWidth = maxWidth;
+  key.maxHeight = 0;
+  key.textColor = 0;
+  key.wrap = maxWidth > 0;
+  key.forceLTRReadingOrder = false;
+  return key;
+}
+
+static CGUITextLayoutCache::Layout makeLayout(float width)
+{
+  CGUITextLayoutCache::Layout layout;
+  vecText text(3, 'a');
+  layout.lines.push_back(CGUIString(text.begin(), text.end(), true));
+  layout.colors.push_back(0xffffffff);
+  layout.width = width;
+  layout.height = 20;
+  return layout;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexGUITextLayoutCache, hitAndMiss)
+{
+  CGUITextLayoutCache cache;
+  CGUITextLayoutCache::Layout layout;
+
+  EXPECT_FALSE(cache.Get(makeKey(L"Season 1"), layout));
+  cache.Add(makeKey(L"Season 1"), makeLayout(60));
+
+  ASSERT_TRUE(cache.Get(makeKey(L"Season 1"), layout));
+  EXPECT_EQ(60, layout.width);
+  EXPECT_EQ(1, layout.lines.size());
+  EXPECT_EQ(3, layout.lines[0].m_text.size());
+
+  // the layout parameters are part of the key
+  EXPECT_FALSE(cache.Get(makeKey(L"Season 1", 100), layout));
+  CGUITextLayoutCache::Key other = makeKey(L"Season 1");
+  other.font = (const CGUIFont*)0x2000;
+  EXPECT_FALSE(cache.Get(other, layout));
+
+  EXPECT_EQ(1, cache.GetHits());
+  EXPECT_EQ(3, cache.GetMisses());
+
+  cache.Clear();
+  EXPECT_EQ(0, cache.GetSize());
+  EXPECT_FALSE(cache.Get(makeKey(L"Season 1"), layout));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexGUITextLayoutCache, dropsLeastRecentlyUsed)
+{
+  CGUITextLayoutCache cache(2);
+  CGUITextLayoutCache::Layout layout;
+
+  cache.Add(makeKey(L"1080p"), makeLayout(1));
+  cache.Add(makeKey(L"720p"), makeLayout(2));
+  EXPECT_TRUE(cache.Get(makeKey(L"1080p"), layout));
+
+  cache.Add(makeKey(L"SD"), makeLayout(3));
+  EXPECT_EQ(2, cache.GetSize());
+  EXPECT_TRUE(cache.Get(makeKey(L"1080p"), layout));
+  EXPECT_FALSE(cache.Get(makeKey(L"720p"), layout));
+  EXPECT_TRUE(cache.Get(makeKey(L"SD"), layout));
+
+  // replacing an entry doesn't grow the cache
+  cache.Add(makeKey(L"SD"), makeLayout(4));
+  EXPECT_EQ(2, cache.GetSize());
+  EXPECT_TRUE(cache.Get(makeKey(L"SD"), layout));
+  EXPECT_EQ(4, layout.width);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexGUITextLayoutCache, skipsLongText)
+{
+  CGUITextLayoutCache cache(16, 8);
+  CGUITextLayoutCache::Layout layout;
+
+  cache.Add(makeKey(L"A long plot summary"), makeLayout(1));
+  EXPECT_EQ(0, cache.GetSize());
+  EXPECT_FALSE(cache.Get(makeKey(L"A long plot summary"), layout));
+}
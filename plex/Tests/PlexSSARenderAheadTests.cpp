@@ -0,0 +1,135 @@
+#include "PlexTest.h"
+#include "cores/VideoRenderers/OverlayRendererSSA.h"
+#include "cores/VideoRenderers/OverlayRendererUtil.h"
+#include "cores/dvdplayer/DVDClock.h"
+#include "utils/TimeUtils.h"
+
+#include <stdio.h>
+
+using namespace OVERLAY;
+
+#define FRAME_INTERVAL DVD_MSEC_TO_TIME(40)
+
+// stands in for libass rendering a heavily styled script: every frame takes a while to rasterize
+// and the picture only changes every fourth frame, like karaoke syllables do
+class CFakeSSARenderAhead : public CSSARenderAhead
+{
+public:
+  CFakeSSARenderAhead(int frames, unsigned int renderMs) : CSSARenderAhead(frames), m_renderMs(renderMs), m_renders(0), m_lastContent(-1) {}
+  ~CFakeSSARenderAhead() { Flush(); }
+
+  int m_renders;
+
+protected:
+  virtual SQuadsPtr Render(CDVDSubtitlesLibass* libass, const SSSAParams& params, double pts, const SQuadsPtr& last)
+  {
+    ::Sleep(m_renderMs);
+    m_renders++;
+
+    int content = DVD_TIME_TO_MSEC(pts) / 160;
+    bool changed = content != m_lastContent;
+    m_lastContent = content;
+    if (last && !changed)
+      return last;
+
+    SQuadsPtr quads(new SQuads());
+    quads->count = content;
+    return quads;
+  }
+
+private:
+  unsigned int m_renderMs;
+  int m_lastContent;
+};
+
+static SSSAParams makeParams()
+{
+  SSSAParams params;
+  params.frameWidth = 1920;
+  params.frameHeight = 1080;
+  params.videoWidth = 1920;
+  params.videoHeight = 800;
+  return params;
+}
+
+// average and worst time the render thread waited for each frame of a run
+static void measure(int frames, double& average, double& worst, unsigned int& hits)
+{
+  CFakeSSARenderAhead ahead(frames, 8);
+  SSSAParams params = makeParams();
+  average = worst = 0;
+
+  const int count = 40;
+  for (int i = 0; i < count; i++)
+  {
+    int64_t start = CurrentHostCounter();
+    ahead.Get(NULL, params, i * FRAME_INTERVAL);
+    double ms = (CurrentHostCounter() - start) * 1000.0 / CurrentHostFrequency();
+
+    average += ms / count;
+    if (ms > worst)
+      worst = ms;
+
+    // the rest of the frame
+    Sleep(20);
+  }
+  hits = ahead.GetHits();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexSSARenderAhead, unchangedFramesShareQuads)
+{
+  CFakeSSARenderAhead ahead(0, 0);
+  SSSAParams params = makeParams();
+
+  SQuadsPtr first = ahead.Get(NULL, params, 0);
+  EXPECT_EQ(first, ahead.Get(NULL, params, FRAME_INTERVAL));
+  EXPECT_EQ(first, ahead.Get(NULL, params, 3 * FRAME_INTERVAL));
+
+  SQuadsPtr next = ahead.Get(NULL, params, 4 * FRAME_INTERVAL);
+  EXPECT_NE(first, next);
+  EXPECT_EQ(1, next->count);
+
+  // another target size can't reuse what was rendered for the old one
+  params.frameWidth = 1280;
+  EXPECT_NE(next, ahead.Get(NULL, params, 5 * FRAME_INTERVAL));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexSSARenderAhead, rendersAhead)
+{
+  CFakeSSARenderAhead ahead(4, 0);
+  SSSAParams params = makeParams();
+
+  // two frames give the frame rate, then the worker renders the next four
+  ahead.Get(NULL, params, 0);
+  ahead.Get(NULL, params, FRAME_INTERVAL);
+  Sleep(200);
+  EXPECT_EQ(6, ahead.m_renders);
+
+  for (int i = 2; i < 6; i++)
+    ahead.Get(NULL, params, i * FRAME_INTERVAL);
+  EXPECT_EQ(4, ahead.GetHits());
+  EXPECT_EQ(2, ahead.GetMisses());
+
+  // a seek renders where it was asked to
+  SQuadsPtr quads = ahead.Get(NULL, params, 100 * FRAME_INTERVAL);
+  EXPECT_EQ(25, quads->count);
+  EXPECT_EQ(3, ahead.GetMisses());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexSSARenderAhead, latency)
+{
+  double syncAverage, syncWorst, aheadAverage, aheadWorst;
+  unsigned int syncHits, aheadHits;
+  measure(0, syncAverage, syncWorst, syncHits);
+  measure(4, aheadAverage, aheadWorst, aheadHits);
+
+  printf("per-frame rasterization latency when shown: average %.2fms, worst %.2fms\n", syncAverage, syncWorst);
+  printf("per-frame rasterization latency rendered ahead: average %.2fms, worst %.2fms, %u of 40 frames ready\n", aheadAverage, aheadWorst, aheadHits);
+
+  EXPECT_EQ(0, syncHits);
+  EXPECT_GT(aheadHits, 30);
+  EXPECT_LT(aheadAverage, syncAverage);
+}
@@ -0,0 +1,171 @@
+#include "PlexTest.h"
+#include "dbwrappers/sqlitedataset.h"
+#include "dbwrappers/Database.h"
+#include "utils/SortUtils.h"
+
+#include <memory>
+#include <stdio.h>
+
+using namespace dbiplus;
+
+class PlexSqliteCursorTest : public ::testing::Test
+{
+public:
+  void SetUp()
+  {
+    remove(path().c_str());
+    m_db.setHostName(P_tmpdir);
+    m_db.setDatabase("PlexSqliteCursorTest.db");
+    ASSERT_EQ(DB_CONNECTION_OK, m_db.connect(true));
+
+    std::auto_ptr<Dataset> ds(m_db.CreateDataset());
+    ds->exec("CREATE TABLE texture (id integer primary key, url text, width integer, size double)");
+    ds->exec("INSERT INTO texture VALUES (1, 'http://plex/thumb/1', 320, 1.5)");
+    ds->exec("INSERT INTO texture VALUES (2, 'it''s quoted', 640, NULL)");
+  }
+
+  void TearDown()
+  {
+    m_db.disconnect();
+    remove(path().c_str());
+  }
+
+  std::string path() const
+  {
+    return std::string(P_tmpdir) + "/PlexSqliteCursorTest.db";
+  }
+
+  SqliteDatabase m_db;
+};
+
+static void checkLookup(Cursor* cursor)
+{
+  cursor->bind(1, std::string("it's quoted"));
+  ASSERT_TRUE(cursor->step());
+  EXPECT_EQ(2, cursor->getInt(0));
+  EXPECT_EQ(640, cursor->getInt64(1));
+  EXPECT_TRUE(cursor->isNull(2));
+  EXPECT_STREQ("", cursor->getText(2));
+  EXPECT_FALSE(cursor->step());
+
+  cursor->reset();
+  cursor->bind(1, std::string("http://plex/thumb/1"));
+  ASSERT_TRUE(cursor->step());
+  EXPECT_EQ(1, cursor->getInt(0));
+  EXPECT_EQ(1.5, cursor->getDouble(2));
+  EXPECT_FALSE(cursor->isNull(2));
+
+  // unknown values give no rows
+  cursor->reset();
+  cursor->bind(1, std::string("missing"));
+  EXPECT_FALSE(cursor->step());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F(PlexSqliteCursorTest, bindAndRead)
+{
+  std::auto_ptr<Cursor> cursor(m_db.CreateCursor("SELECT id, width, size FROM texture WHERE url=?"));
+  EXPECT_EQ(3, cursor->columnCount());
+  checkLookup(cursor.get());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F(PlexSqliteCursorTest, writes)
+{
+  {
+    std::auto_ptr<Cursor> cursor(m_db.CreateCursor("UPDATE texture SET width=width+? WHERE id=?"));
+    cursor->bind(1, 10);
+    cursor->bind(2, 1);
+    cursor->exec();
+
+    // the same statement can run again once reset
+    cursor->reset();
+    cursor->bind(1, 5);
+    cursor->bind(2, 1);
+    cursor->exec();
+  }
+
+  std::auto_ptr<Cursor> cursor(m_db.CreateCursor("SELECT width FROM texture WHERE id=?"));
+  cursor->bind(1, 1);
+  ASSERT_TRUE(cursor->step());
+  EXPECT_EQ(335, cursor->getInt(0));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F(PlexSqliteCursorTest, reusesStatements)
+{
+  const std::string sql = "SELECT id FROM texture WHERE id=?";
+  for (int i = 0; i < 3; i++)
+  {
+    std::auto_ptr<Cursor> cursor(m_db.CreateCursor(sql));
+    // bindings never leak from an earlier cursor on the same statement
+    EXPECT_FALSE(cursor->step());
+  }
+
+  // two cursors on the same query at once each get their own statement
+  std::auto_ptr<Cursor> first(m_db.CreateCursor(sql));
+  std::auto_ptr<Cursor> second(m_db.CreateCursor(sql));
+  first->bind(1, 1);
+  second->bind(1, 2);
+  ASSERT_TRUE(first->step());
+  ASSERT_TRUE(second->step());
+  EXPECT_EQ(1, first->getInt(0));
+  EXPECT_EQ(2, second->getInt(0));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F(PlexSqliteCursorTest, badQueryThrows)
+{
+  EXPECT_ANY_THROW(m_db.CreateCursor("SELECT nothing FROM nowhere"));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F(PlexSqliteCursorTest, getRecord)
+{
+  std::auto_ptr<Cursor> cursor(m_db.CreateCursor("SELECT id, url, size FROM texture ORDER BY id DESC"));
+  sql_record record;
+
+  ASSERT_TRUE(cursor->step());
+  cursor->getRecord(record);
+  ASSERT_EQ(3, record.size());
+  EXPECT_EQ(2, record[0].get_asInt());
+  EXPECT_EQ("it's quoted", record[1].get_asString());
+  EXPECT_TRUE(record[2].get_isNull());
+
+  // the record is reused, the NULL of the previous row doesn't stick
+  ASSERT_TRUE(cursor->step());
+  cursor->getRecord(record);
+  EXPECT_EQ(1, record[0].get_asInt());
+  EXPECT_FALSE(record[2].get_isNull());
+  EXPECT_EQ(1.5, record[2].get_asDouble());
+  EXPECT_FALSE(cursor->step());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F(PlexSqliteCursorTest, streamsUnsortedRows)
+{
+  std::auto_ptr<Dataset> ds(m_db.CreateDataset());
+  CDatabaseRows rows(&m_db, ds);
+  ASSERT_TRUE(rows.Open("SELECT id, url FROM texture ORDER BY id", SortDescription(), MediaTypeNone));
+  EXPECT_TRUE(rows.IsStreaming());
+
+  const sql_record *record = rows.Next();
+  ASSERT_TRUE(record != NULL);
+  EXPECT_EQ(1, record->at(0).get_asInt());
+  record = rows.Next();
+  ASSERT_TRUE(record != NULL);
+  EXPECT_EQ(2, record->at(0).get_asInt());
+  EXPECT_TRUE(rows.Next() == NULL);
+  EXPECT_EQ(2, rows.GetRows());
+
+  // nothing was read into the dataset
+  EXPECT_EQ(0, ds->num_rows());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F(PlexSqliteCursorTest, datasetFallback)
+{
+  // the generic cursor used by backends without prepared statements
+  std::auto_ptr<Cursor> cursor(m_db.Database::CreateCursor("SELECT id, width, size FROM texture WHERE url=?"));
+  checkLookup(cursor.get());
+}
@@ -27,6 +27,11 @@ public:
     return true;
   }
 
+  XFILE::CPlexDirectory* NewFanoutDirectory() const
+  {
+    return new PlexDirectoryFakeDataTest(m_fakedata);
+  }
+
   std::string m_fakedata;
 };
 
@@ -0,0 +1,144 @@
+#include "PlexTest.h"
+#include "guilib/XBTFReader.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+struct BundleFrame
+{
+  std::string data;
+  uint64_t offset; // overrides the real offset if set
+};
+
+struct BundleFile
+{
+  std::string path;
+  std::vector<BundleFrame> frames;
+};
+
+static void writeU32(FILE* file, uint32_t value)
+{
+  fwrite(&value, 4, 1, file);
+}
+
+static void writeU64(FILE* file, uint64_t value)
+{
+  fwrite(&value, 8, 1, file);
+}
+
+// write a bundle the way TexturePacker does, frame data following the header
+static std::string writeBundle(const std::vector<BundleFile>& files)
+{
+  std::string path = std::string(P_tmpdir) + "/PlexXBTFReaderTest.xbt";
+  FILE* file = fopen(path.c_str(), "wb");
+
+  uint64_t offset = 4 + 1 + 4;
+  for (size_t i = 0; i < files.size(); i++)
+    offset += 256 + 4 + 4 + files[i].frames.size() * 40;
+
+  fwrite(XBTF_MAGIC, 4, 1, file);
+  fwrite(XBTF_VERSION, 1, 1, file);
+  writeU32(file, files.size());
+  for (size_t i = 0; i < files.size(); i++)
+  {
+    char name[256];
+    memset(name, 0, sizeof(name));
+    strncpy(name, files[i].path.c_str(), sizeof(name) - 1);
+    fwrite(name, 256, 1, file);
+    writeU32(file, 0);
+    writeU32(file, files[i].frames.size());
+    for (size_t j = 0; j < files[i].frames.size(); j++)
+    {
+      const BundleFrame& frame = files[i].frames[j];
+      writeU32(file, 1);
+      writeU32(file, 1);
+      writeU32(file, XB_FMT_A8);
+      writeU64(file, frame.data.size());
+      writeU64(file, frame.data.size());
+      writeU32(file, 0);
+      writeU64(file, frame.offset ? frame.offset : offset);
+      offset += frame.data.size();
+    }
+  }
+
+  for (size_t i = 0; i < files.size(); i++)
+  {
+    for (size_t j = 0; j < files[i].frames.size(); j++)
+      fwrite(files[i].frames[j].data.c_str(), files[i].frames[j].data.size(), 1, file);
+  }
+
+  fclose(file);
+  return path;
+}
+
+static BundleFile bundleFile(const std::string& path, const std::string& data, uint64_t offset = 0)
+{
+  BundleFile file;
+  file.path = path;
+  BundleFrame frame;
+  frame.data = data;
+  frame.offset = offset;
+  file.frames.push_back(frame);
+  return file;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexXBTFReader, findAndLoad)
+{
+  std::vector<BundleFile> files;
+  files.push_back(bundleFile("button.png", "focus"));
+  files.push_back(bundleFile("flags/1080.png", "hd"));
+  files[1].frames.push_back(files[1].frames[0]);
+  files[1].frames[1].data = "anim";
+  std::string path = writeBundle(files);
+
+  CXBTFReader reader;
+  ASSERT_TRUE(reader.Open(path));
+  EXPECT_EQ(2, reader.GetFiles().size());
+  EXPECT_TRUE(reader.Exists("button.png"));
+  EXPECT_FALSE(reader.Exists("flags/720.png"));
+
+  CXBTFFile* file = reader.Find("flags/1080.png");
+  ASSERT_TRUE(file != NULL);
+  ASSERT_EQ(2, file->GetFrames().size());
+
+  unsigned char buffer[16];
+  ASSERT_TRUE(reader.Load(file->GetFrames()[1], buffer));
+  EXPECT_EQ(0, memcmp(buffer, "anim", 4));
+
+  const unsigned char* data = reader.GetFrameData(file->GetFrames()[0]);
+  ASSERT_TRUE(data != NULL);
+  EXPECT_EQ(0, memcmp(data, "hd", 2));
+
+  file = reader.Find("button.png");
+  ASSERT_TRUE(file != NULL);
+  data = reader.GetFrameData(file->GetFrames()[0]);
+  ASSERT_TRUE(data != NULL);
+  EXPECT_EQ(0, memcmp(data, "focus", 5));
+
+  reader.Close();
+  EXPECT_FALSE(reader.IsOpen());
+  EXPECT_TRUE(reader.Find("button.png") == NULL);
+  remove(path.c_str());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexXBTFReader, frameOutsideTheFile)
+{
+  std::vector<BundleFile> files;
+  files.push_back(bundleFile("broken.png", "data", 1 << 20));
+  std::string path = writeBundle(files);
+
+  CXBTFReader reader;
+  ASSERT_TRUE(reader.Open(path));
+  CXBTFFile* file = reader.Find("broken.png");
+  ASSERT_TRUE(file != NULL);
+
+  unsigned char buffer[16];
+  EXPECT_TRUE(reader.GetFrameData(file->GetFrames()[0]) == NULL);
+  EXPECT_FALSE(reader.Load(file->GetFrames()[0], buffer));
+
+  reader.Close();
+  remove(path.c_str());
+}
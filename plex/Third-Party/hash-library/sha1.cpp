@@ -321,3 +321,64 @@ std::string SHA1::operator()(const std::string& text)
   add(text.c_str(), text.size());
   return getHash();
 }
+
+
+/// everything hashed so far as hex characters, so hashing can be continued later on
+std::string SHA1::getState() const
+{
+  static const char dec2hex[16+1] = "0123456789abcdef";
+
+  // hash values, number of processed bytes, then the bytes still in the buffer
+  std::string state;
+  for (int i = 0; i < HashValues; i++)
+    for (int shift = 28; shift >= 0; shift -= 4)
+      state += dec2hex[(m_hash[i] >> shift) & 15];
+  for (int shift = 60; shift >= 0; shift -= 4)
+    state += dec2hex[(m_numBytes >> shift) & 15];
+  for (size_t i = 0; i < m_bufferSize; i++)
+  {
+    state += dec2hex[m_buffer[i] >> 4];
+    state += dec2hex[m_buffer[i] & 15];
+  }
+
+  return state;
+}
+
+
+/// continue hashing from what getState() returned, false if it isn't a valid state
+bool SHA1::setState(const std::string& state)
+{
+  const size_t fixedSize = HashValues*8 + 16;
+  if (state.size() < fixedSize || state.size() >= fixedSize + 2*BlockSize || state.size() % 2 != 0)
+    return false;
+
+  uint8_t nibbles[HashValues*8 + 16 + 2*BlockSize];
+  for (size_t i = 0; i < state.size(); i++)
+  {
+    char c = state[i];
+    if (c >= '0' && c <= '9')
+      nibbles[i] = c - '0';
+    else if (c >= 'a' && c <= 'f')
+      nibbles[i] = c - 'a' + 10;
+    else
+      return false;
+  }
+
+  const uint8_t* current = nibbles;
+  for (int i = 0; i < HashValues; i++)
+  {
+    m_hash[i] = 0;
+    for (int j = 0; j < 8; j++)
+      m_hash[i] = (m_hash[i] << 4) | *current++;
+  }
+
+  m_numBytes = 0;
+  for (int j = 0; j < 16; j++)
+    m_numBytes = (m_numBytes << 4) | *current++;
+
+  m_bufferSize = (state.size() - fixedSize) / 2;
+  for (size_t i = 0; i < m_bufferSize; i++, current += 2)
+    m_buffer[i] = (current[0] << 4) | current[1];
+
+  return true;
+}
@@ -54,6 +54,11 @@ public:
   /// restart
   void reset();
 
+  /// everything hashed so far as hex characters, so hashing can be continued later on
+  std::string getState() const;
+  /// continue hashing from what getState() returned, false if it isn't a valid state
+  bool setState(const std::string& state);
+
 private:
   /// process 64 bytes
   void processBlock(const void* data);
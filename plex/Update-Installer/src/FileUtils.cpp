@@ -11,6 +11,7 @@
 #include <string.h>
 #include <fstream>
 #include <iostream>
+#include <vector>
 
 #include "minizip/zip.h"
 #include "minizip/unzip.h"
@@ -273,52 +274,87 @@ const std::string FileUtils::sha1FromFile(const char* filePath) throw(IOExceptio
     throw IOException("Unable to find file: " + std::string(filePath));
   }
 
-  std::string fileData = readFile(filePath);
+  // hash the file a chunk at a time instead of reading all of it into memory
+  std::ifstream inputFile(filePath, std::ios::in | std::ios::binary);
+  if (!inputFile.good())
+  {
+    throw IOException("Unable to read file: " + std::string(filePath));
+  }
+
+  const int chunkSize = 65536;
+  std::vector<char> buffer(chunkSize);
   SHA1 hash;
-  hash.update((uint8_t*)fileData.c_str(), fileData.length());
+  while (inputFile.read(&buffer[0], chunkSize) || inputFile.gcount() > 0)
+  {
+    hash.update((uint8_t*)&buffer[0], static_cast<size_t>(inputFile.gcount()));
+  }
+
+  if (inputFile.bad())
+  {
+    throw IOException("Error reading file: " + std::string(filePath));
+  }
+  return hash.end().hex();
+}
+
+const std::string FileUtils::sha1FromData(const std::string& data)
+{
+  SHA1 hash;
+  hash.update((const uint8_t*)data.data(), data.size());
   return hash.end().hex();
 }
 
 void FileUtils::extractFromZip(const char* zipFilePath, const char* src,
-                               const char* dest) throw(IOException)
+                               const char* dest, std::string* sha1) throw(IOException)
 {
   unzFile zipFile = unzOpen(zipFilePath);
+  if (!zipFile)
+  {
+    throw IOException("Unable to open zip archive " + std::string(zipFilePath));
+  }
+
   int result = unzLocateFile(zipFile, src, 0);
-  if (result == UNZ_OK)
+  if (result != UNZ_OK || unzOpenCurrentFile(zipFile) != UNZ_OK)
   {
-    // found a match which is now the current file
-    unzOpenCurrentFile(zipFile);
-    const int chunkSize = 4096;
-    char buffer[chunkSize];
+    unzClose(zipFile);
+    throw IOException("Unable to find file " + std::string(src) + " in zip archive " +
+                      std::string(zipFilePath));
+  }
 
-    std::ofstream outputFile(dest, std::ofstream::binary);
-    if (!outputFile.good())
-    {
-      throw IOException("Unable to write to file " + std::string(dest));
-    }
-    while (true)
+  // found a match which is now the current file
+  const int chunkSize = 65536;
+  std::vector<char> buffer(chunkSize);
+  SHA1 hash;
+
+  std::ofstream outputFile(dest, std::ofstream::binary);
+  while (outputFile.good())
+  {
+    int count = unzReadCurrentFile(zipFile, &buffer[0], chunkSize);
+    if (count <= 0)
     {
-      int count = unzReadCurrentFile(zipFile, buffer, chunkSize);
-      if (count <= 0)
-      {
-        if (count < 0)
-        {
-          throw IOException("Error extracting file from archive " + std::string(src));
-        }
-        break;
-      }
-      outputFile.write(buffer, count);
+      result = count;
+      break;
     }
-    outputFile.close();
+    outputFile.write(&buffer[0], count);
+    if (sha1)
+      hash.update((uint8_t*)&buffer[0], static_cast<size_t>(count));
+  }
+  outputFile.close();
 
-    unzCloseCurrentFile(zipFile);
+  bool writeFailed = outputFile.fail();
+  unzCloseCurrentFile(zipFile);
+  unzClose(zipFile);
+
+  if (writeFailed)
+  {
+    throw IOException("Unable to write to file " + std::string(dest));
   }
-  else
+  if (result < 0)
   {
-    throw IOException("Unable to find file " + std::string(src) + " in zip archive " +
-                      std::string(zipFilePath));
+    throw IOException("Error extracting file from archive " + std::string(src));
   }
-  unzClose(zipFile);
+
+  if (sha1)
+    *sha1 = hash.end().hex();
 }
 
 void FileUtils::mkpath(const char* dir) throw(IOException)
@@ -804,46 +840,61 @@ static int bz2_read(const struct bspatch_stream* stream, void* buffer, int lengt
   return 0;
 }
 
-bool FileUtils::patchFile(const char* oldFile, const char* newFile, const char* patchFile)
+// a bzip2 stream decompressed as it is read out of a zip archive entry
+struct ZipBz2Stream
 {
-  if (!fileExists(oldFile) || !fileExists(patchFile))
-  {
-    LOG(Error, "Missing patch or old file!");
-    return false;
-  }
+  unzFile zipFile;
+  bz_stream bz2;
+  char input[65536];
+  bool inputEnded;
+};
 
-  FILE* patchFd = fopen(patchFile, "rb");
-  if (!patchFd)
-  {
-    LOG(Error, "Failed to open patch file!");
-    return false;
-  }
+static int zip_bz2_read(const struct bspatch_stream* stream, void* buffer, int length)
+{
+  ZipBz2Stream* zip = (ZipBz2Stream*)stream->opaque;
+  zip->bz2.next_out = (char*)buffer;
+  zip->bz2.avail_out = (unsigned int)length;
 
-  // BSDIFF header that we need to check
-  uint8_t header[24];
-  if (fread(header, 1, 24, patchFd) != 24)
+  while (zip->bz2.avail_out > 0)
   {
-    LOG(Error, "Failed to read patch header...");
+    if (zip->bz2.avail_in == 0 && !zip->inputEnded)
+    {
+      int count = unzReadCurrentFile(zip->zipFile, zip->input, sizeof(zip->input));
+      if (count < 0)
+        return -1;
 
-    fclose(patchFd);
-    return false;
+      zip->inputEnded = (count == 0);
+      zip->bz2.next_in = zip->input;
+      zip->bz2.avail_in = (unsigned int)count;
+    }
+
+    int result = BZ2_bzDecompress(&zip->bz2);
+    if (result == BZ_STREAM_END && zip->bz2.avail_out > 0)
+      return -1;
+    if (result != BZ_OK && result != BZ_STREAM_END)
+      return -1;
+    if (zip->inputEnded && zip->bz2.avail_in == 0 && zip->bz2.avail_out > 0 && result == BZ_OK)
+      return -1;
   }
 
+  return 0;
+}
+
+// checks the bsdiff header, then patches oldData with the rest of the patch read from stream
+static bool applyPatch(const std::string& oldData, const char* newFile, const uint8_t* header,
+                       struct bspatch_stream* stream, std::string* sha1)
+{
   // check header magic
   if (memcmp(header, "ENDSLEY/BSDIFF43", 16) != 0)
   {
     LOG(Error, "Patch did not contain correct header!");
-
-    fclose(patchFd);
     return false;
   }
 
-  int64_t newSize = bspatch_offtin(header + 16);
+  int64_t newSize = bspatch_offtin((uint8_t*)header + 16);
   if (newSize == 0)
   {
     LOG(Error, "Failed to get newsize from patch file");
-
-    fclose(patchFd);
     return false;
   }
 
@@ -851,6 +902,52 @@ bool FileUtils::patchFile(const char* oldFile, const char* newFile, const char*
   if (newData == NULL)
   {
     LOG(Error, "Failed to allocate " + intToStr(newSize) + " bytes of memory");
+    return false;
+  }
+
+  if (bspatch((const uint8_t*)oldData.c_str(), (int64_t)oldData.size(), newData, newSize, stream) != 0)
+  {
+    LOG(Error, "Failed to patch file");
+
+    free(newData);
+    return false;
+  }
+
+  // the new data is still in memory, hash it there instead of reading the file back
+  if (sha1)
+  {
+    SHA1 hash;
+    hash.update(newData, (size_t)newSize);
+    *sha1 = hash.end().hex();
+  }
+
+  FileUtils::writeFile(newFile, (const char*)newData, (int)newSize);
+
+  free(newData);
+
+  return true;
+}
+
+bool FileUtils::patchFile(const char* oldFile, const char* newFile, const char* patchFile)
+{
+  if (!fileExists(oldFile) || !fileExists(patchFile))
+  {
+    LOG(Error, "Missing patch or old file!");
+    return false;
+  }
+
+  FILE* patchFd = fopen(patchFile, "rb");
+  if (!patchFd)
+  {
+    LOG(Error, "Failed to open patch file!");
+    return false;
+  }
+
+  // BSDIFF header that we need to check
+  uint8_t header[24];
+  if (fread(header, 1, 24, patchFd) != 24)
+  {
+    LOG(Error, "Failed to read patch header...");
 
     fclose(patchFd);
     return false;
@@ -862,33 +959,74 @@ bool FileUtils::patchFile(const char* oldFile, const char* newFile, const char*
   {
     LOG(Error, "Failed to open BZ file after header.");
 
-    free(newData);
     fclose(patchFd);
     return false;
   }
 
-  std::string oldData = readFile(oldFile);
-
   struct bspatch_stream stream;
   stream.read = bz2_read;
   stream.opaque = (void*)bfp;
 
-  if (bspatch((uint8_t*)oldData.c_str(), (int64_t)oldData.size(), newData, newSize, &stream) != 0)
+  bool patched = applyPatch(readFile(oldFile), newFile, header, &stream, NULL);
+
+  BZ2_bzReadClose(&bz2error, bfp);
+  fclose(patchFd);
+
+  return patched;
+}
+
+bool FileUtils::patchFromZip(const std::string& oldData, const char* newFile, const char* zipFilePath,
+                             const char* patchPath, std::string* sha1)
+{
+  unzFile zipFile = unzOpen(zipFilePath);
+  if (!zipFile)
+  {
+    LOG(Error, "Failed to open zip archive " + std::string(zipFilePath));
+    return false;
+  }
+
+  if (unzLocateFile(zipFile, patchPath, 0) != UNZ_OK || unzOpenCurrentFile(zipFile) != UNZ_OK)
   {
-    LOG(Error, "Failed to patch file");
+    LOG(Error, "Unable to find patch " + std::string(patchPath) + " in zip archive " + zipFilePath);
 
-    fclose(patchFd);
-    free(newData);
-    BZ2_bzReadClose(&bz2error, bfp);
+    unzClose(zipFile);
     return false;
   }
 
-  fclose(patchFd);
-  BZ2_bzReadClose(&bz2error, bfp);
+  // BSDIFF header that we need to check
+  uint8_t header[24];
+  if (unzReadCurrentFile(zipFile, header, 24) != 24)
+  {
+    LOG(Error, "Failed to read patch header...");
 
-  writeFile(newFile, (const char*)newData, (int)newSize);
+    unzCloseCurrentFile(zipFile);
+    unzClose(zipFile);
+    return false;
+  }
 
-  free(newData);
+  ZipBz2Stream* zip = new ZipBz2Stream;
+  memset(&zip->bz2, 0, sizeof(zip->bz2));
+  zip->zipFile = zipFile;
+  zip->inputEnded = false;
 
-  return true;
+  bool patched = false;
+  if (BZ2_bzDecompressInit(&zip->bz2, 0, 0) != BZ_OK)
+  {
+    LOG(Error, "Failed to open BZ stream after header.");
+  }
+  else
+  {
+    struct bspatch_stream stream;
+    stream.read = zip_bz2_read;
+    stream.opaque = (void*)zip;
+
+    patched = applyPatch(oldData, newFile, header, &stream, sha1);
+    BZ2_bzDecompressEnd(&zip->bz2);
+  }
+
+  delete zip;
+  unzCloseCurrentFile(zipFile);
+  unzClose(zipFile);
+
+  return patched;
 }
@@ -115,10 +115,11 @@ public:
                        int length) throw(IOException);
 
   /** Extract the file @p src from the zip archive @p zipFile and
-    * write it to @p dest.
+    * write it to @p dest.  If @p sha1 is not null, it is set to the
+    * SHA-1 of the extracted data, which is hashed while it is written.
     */
   static void extractFromZip(const char* zipFile, const char* src,
-                             const char* dest) throw(IOException);
+                             const char* dest, std::string* sha1 = 0) throw(IOException);
 
   /** Returns a copy of the path 'str' with Windows-style '\'
    * dir separators converted to Unix-style '/' separators
@@ -149,9 +150,18 @@ public:
   /** Returns the current working directory of the application. */
   static std::string getcwd() throw(IOException);
   static const std::string sha1FromFile(const char* filePath) throw(IOException);
+  static const std::string sha1FromData(const std::string& data);
   static void copyTree(const std::string& source, const std::string& destination,
                        std::string root = "") throw(IOException);
   static std::string getSymlinkTarget(const char* path) throw(IOException);
   static bool patchFile(const char *oldFile, const char *newFile, const char *patchFile);
+
+  /** Apply the bsdiff patch @p patchPath to @p oldData and write the result
+    * to @p newFile.  The patch is decompressed straight out of the zip archive
+    * @p zipFile, without extracting it first.  If @p sha1 is not null, it is
+    * set to the SHA-1 of the new file.
+    */
+  static bool patchFromZip(const std::string& oldData, const char* newFile, const char* zipFile,
+                           const char* patchPath, std::string* sha1 = 0);
   static bool isDirectory(const char* path) throw(IOException);
 };
@@ -8,6 +8,9 @@
 #include "bspatch.h"
 #include "DirIterator.h"
 
+// patches are applied in memory, so every worker may hold an old and a new file at once
+#define MAX_INSTALL_THREADS 8
+
 UpdateInstaller::UpdateInstaller()
   : m_mode(Setup),
     m_waitPid(0),
@@ -15,7 +18,10 @@ UpdateInstaller::UpdateInstaller()
     m_observer(0),
     m_forceElevated(false),
     m_autoClose(false),
-    m_installed(0)
+    m_installed(0),
+    m_nextTask(0),
+    m_taskFailed(false),
+    m_taskIOError(0)
 {
   m_tempDir = FileUtils::tempPath();
   LOG(Info, "Using tmpdir: " + m_tempDir);
@@ -200,10 +206,7 @@ void UpdateInstaller::run() throw()
 
       DID_CANCEL();
 
-      LOG(Info, "Patching files");
-      patchFiles();
-
-      LOG(Info, "Installing new and updated files");
+      LOG(Info, "Patching files and installing new and updated files");
       installFiles();
 
       LOG(Info, "Uninstalling removed files");
@@ -276,7 +279,7 @@ void UpdateInstaller::run() throw()
   }
 }
 
-void UpdateInstaller::installFile(const UpdateScriptFile& file)
+void UpdateInstaller::prepareFile(const UpdateScriptFile& file)
 {
   std::string destPath = m_installDir + '/' + file.path;
   std::string target = file.linkTarget;
@@ -290,46 +293,15 @@ void UpdateInstaller::installFile(const UpdateScriptFile& file)
 
   if (target.empty())
   {
-    // locate the package containing the file
-    if (!file.package.empty())
-    {
-      std::string packageFile = m_packageDir + '/' + file.package + ".zip";
-      if (!FileUtils::fileExists(packageFile.c_str()))
-      {
-        throw "Package file does not exist: " + packageFile;
-      }
-
-      std::string filePath = file.path;
-      if (!file.pathPrefix.empty())
-        filePath = file.pathPrefix + '/' + file.path;
-      
-      if (FileUtils::fileExists(destPath.c_str()) && FileUtils::fileIsLink(destPath.c_str()))
-      {
-        LOG(Info, "New file is not link, removing: " + destPath);
-        if (FileUtils::isDirectory(destPath.c_str()))
-          FileUtils::rmdirRecursive(destPath.c_str());
-        else
-          FileUtils::removeFile(destPath.c_str());
-      }
-
-      // extract the file from the package and copy it to
-      // the destination
-      FileUtils::extractFromZip(packageFile.c_str(), filePath.c_str(), destPath.c_str());
-    }
-    else
+    if (!file.package.empty() && FileUtils::fileExists(destPath.c_str()) &&
+        FileUtils::fileIsLink(destPath.c_str()))
     {
-      // if no package is specified, look for an uncompressed file in the
-      // root of the package directory
-      std::string sourceFile = m_packageDir + '/' + FileUtils::fileName(file.path.c_str());
-      if (!FileUtils::fileExists(sourceFile.c_str()))
-      {
-        throw "Source file does not exist: " + sourceFile;
-      }
-      FileUtils::copyFile(sourceFile.c_str(), destPath.c_str());
+      LOG(Info, "New file is not link, removing: " + destPath);
+      if (FileUtils::isDirectory(destPath.c_str()))
+        FileUtils::rmdirRecursive(destPath.c_str());
+      else
+        FileUtils::removeFile(destPath.c_str());
     }
-
-    // set the permissions on the newly extracted file
-    FileUtils::chmod(destPath.c_str(), file.permissions);
   }
   else
   {
@@ -362,6 +334,49 @@ void UpdateInstaller::installFile(const UpdateScriptFile& file)
   }
 }
 
+void UpdateInstaller::installFile(const UpdateScriptFile& file)
+{
+  std::string destPath = m_installDir + '/' + file.path;
+
+  // locate the package containing the file
+  if (!file.package.empty())
+  {
+    std::string packageFile = m_packageDir + '/' + file.package + ".zip";
+    if (!FileUtils::fileExists(packageFile.c_str()))
+    {
+      throw "Package file does not exist: " + packageFile;
+    }
+
+    std::string filePath = file.path;
+    if (!file.pathPrefix.empty())
+      filePath = file.pathPrefix + '/' + file.path;
+
+    // extract the file from the package and copy it to
+    // the destination
+    std::string hash;
+    FileUtils::extractFromZip(packageFile.c_str(), filePath.c_str(), destPath.c_str(), &hash);
+
+    {
+      tthread::lock_guard<tthread::mutex> lock(m_taskMutex);
+      m_fileHashes[file.path] = hash;
+    }
+  }
+  else
+  {
+    // if no package is specified, look for an uncompressed file in the
+    // root of the package directory
+    std::string sourceFile = m_packageDir + '/' + FileUtils::fileName(file.path.c_str());
+    if (!FileUtils::fileExists(sourceFile.c_str()))
+    {
+      throw "Source file does not exist: " + sourceFile;
+    }
+    FileUtils::copyFile(sourceFile.c_str(), destPath.c_str());
+  }
+
+  // set the permissions on the newly extracted file
+  FileUtils::chmod(destPath.c_str(), file.permissions);
+}
+
 void UpdateInstaller::updateProgress()
 {
   if (m_observer)
@@ -382,8 +397,9 @@ void UpdateInstaller::patchFile(const UpdateScriptPatch& patch)
     throw "Can't find file to patch: " + oldFile;
   }
 
-  const std::string oldFileHash = FileUtils::sha1FromFile(oldFile.c_str());
-  if (oldFileHash != patch.sourceHash)
+  // the old file is read once, both to check it and to patch it
+  const std::string oldData = FileUtils::readFile(oldFile.c_str());
+  if (FileUtils::sha1FromData(oldData) != patch.sourceHash)
   {
     throw "File sha1 mismatch, can't patch: " + oldFile;
   }
@@ -396,75 +412,179 @@ void UpdateInstaller::patchFile(const UpdateScriptPatch& patch)
       throw "Package file not found: " + packageFile;
     }
 
-    std::string patchPath = patch.patchPath;
-    std::string patchDir = m_tempDir + "/__patches/" + patchPath;
-    if (!FileUtils::fileExists(FileUtils::dirname(patchDir.c_str()).c_str()))
-    {
-      FileUtils::mkpath(FileUtils::dirname(patchDir.c_str()).c_str());
-    }
-
-    FileUtils::extractFromZip(packageFile.c_str(), patchPath.c_str(), patchDir.c_str());
-
     std::string newFilePath = oldFile + ".new";
 
-    if (!FileUtils::patchFile(oldFile.c_str(), newFilePath.c_str(), patchDir.c_str()))
+    // the patch is decompressed straight out of the package
+    std::string newFileHash;
+    if (!FileUtils::patchFromZip(oldData, newFilePath.c_str(), packageFile.c_str(),
+                                 patch.patchPath.c_str(), &newFileHash))
     {
-      throw "bspatch() failed!";
+      throw "bspatch() failed on " + patch.path;
     }
 
-    std::string newFileHash = FileUtils::sha1FromFile(newFilePath.c_str());
     if (newFileHash != patch.targetHash)
     {
-      throw "After patching the hash was all wrong!";
+      throw "After patching the hash was all wrong: " + patch.path;
     }
 
     FileUtils::removeFile(oldFile.c_str());
     FileUtils::moveFile(newFilePath.c_str(), oldFile.c_str());
     FileUtils::chmod(oldFile.c_str(), patch.targetPerm);
+
+    tthread::lock_guard<tthread::mutex> lock(m_taskMutex);
+    m_fileHashes[patch.path] = newFileHash;
   }
 }
 
-void UpdateInstaller::copyBundle()
+void UpdateInstaller::verifyFile(const UpdateScriptFile& file)
 {
-  if (m_observer)
+  // files written by the update were hashed while they were written
+  std::string hash;
+  std::map<std::string, std::string>::const_iterator written = m_fileHashes.find(file.path);
+  if (written != m_fileHashes.end())
+    hash = written->second;
+  else
+    hash = FileUtils::sha1FromFile((m_installDir + '/' + file.path).c_str());
+
+  if (hash != file.hash)
   {
-    m_observer->updateMessage("Creating Backup...");
+    LOG(Error, "File " + file.path + " had the wrong hash! Expected: " + file.hash +
+               ", got: " + hash);
+    throw "Wrong hash on file: " + file.path;
   }
+}
 
-  m_installDir = m_tempDir + '/' + FileUtils::fileName(m_targetDir.c_str());
+void UpdateInstaller::runWorker(void* installer)
+{
+  static_cast<UpdateInstaller*>(installer)->runTasks();
+}
 
-  if (FileUtils::fileExists(m_installDir.c_str()))
+void UpdateInstaller::runTasks()
+{
+  while (true)
   {
-    LOG(Warn, "Backup directory " + m_installDir + " - removing it.");
-    FileUtils::rmdirRecursive(m_installDir.c_str());
-  }
+    const InstallTask* task;
+    {
+      tthread::lock_guard<tthread::mutex> lock(m_taskMutex);
+      if (m_taskFailed || m_nextTask >= m_tasks.size())
+        return;
 
-  FileUtils::copyTree(m_targetDir, m_installDir);
+      if (m_observer && m_observer->didCancel())
+      {
+        m_taskFailed = true;
+        m_taskError = "Update canceled";
+        return;
+      }
+
+      task = &m_tasks[m_nextTask++];
+    }
+
+    std::string error;
+    FileUtils::IOException* ioError = 0;
+    try
+    {
+      if (task->type == InstallTask::Patch)
+        patchFile(*task->patch);
+      else if (task->type == InstallTask::Install)
+        installFile(*task->file);
+      else
+        verifyFile(*task->file);
+    }
+    catch (const FileUtils::IOException& exception)
+    {
+      error = exception.what();
+      ioError = new FileUtils::IOException(exception);
+    }
+    catch (const std::string& genericError)
+    {
+      error = genericError;
+    }
+
+    tthread::lock_guard<tthread::mutex> lock(m_taskMutex);
+    if (!error.empty() || ioError)
+    {
+      // the first error is the one reported, the other workers stop after their current task
+      if (!m_taskFailed)
+      {
+        m_taskFailed = true;
+        m_taskError = error;
+        m_taskIOError = ioError;
+      }
+      else
+      {
+        delete ioError;
+      }
+      return;
+    }
+
+    if (task->type != InstallTask::Verify)
+    {
+      ++m_installed;
+      updateProgress();
+    }
+  }
 }
 
-void UpdateInstaller::patchFiles()
+void UpdateInstaller::runParallel(const std::vector<InstallTask>& tasks)
 {
-  std::vector<UpdateScriptPatch>::const_iterator iter = m_script->patches().begin();
-  if (m_observer)
+  m_tasks = tasks;
+  m_nextTask = 0;
+  m_taskFailed = false;
+  m_taskError.clear();
+  m_taskIOError = 0;
+
+  unsigned int threadCount = tthread::thread::hardware_concurrency();
+  if (threadCount > MAX_INSTALL_THREADS)
+    threadCount = MAX_INSTALL_THREADS;
+  if (threadCount > m_tasks.size())
+    threadCount = static_cast<unsigned int>(m_tasks.size());
+  if (threadCount == 0)
+    threadCount = 1;
+
+  LOG(Info, "Running " + intToStr(m_tasks.size()) + " tasks on " + intToStr(threadCount) + " threads");
+
+  // this thread is one of the workers
+  std::vector<tthread::thread*> threads;
+  for (unsigned int i = 1; i < threadCount; i++)
+    threads.push_back(new tthread::thread(runWorker, this));
+
+  runTasks();
+
+  for (std::vector<tthread::thread*>::iterator it = threads.begin(); it != threads.end(); ++it)
   {
-    m_observer->updateMessage("Patching Files...");
+    (*it)->join();
+    delete *it;
   }
+  m_tasks.clear();
 
-  std::string patchDir = m_tempDir + "/__patches/";
-  if (!FileUtils::fileExists(patchDir.c_str()))
+  if (m_taskIOError)
   {
-    FileUtils::mkpath(patchDir.c_str());
+    FileUtils::IOException error(*m_taskIOError);
+    delete m_taskIOError;
+    m_taskIOError = 0;
+    throw error;
   }
 
-  for (; iter != m_script->patches().end(); iter++)
+  if (m_taskFailed)
+    throw m_taskError;
+}
+
+void UpdateInstaller::copyBundle()
+{
+  if (m_observer)
   {
-    patchFile(*iter);
-    ++m_installed;
-    updateProgress();
-    DID_CANCEL();
+    m_observer->updateMessage("Creating Backup...");
   }
 
-  FileUtils::rmdirRecursive(patchDir.c_str());
+  m_installDir = m_tempDir + '/' + FileUtils::fileName(m_targetDir.c_str());
+
+  if (FileUtils::fileExists(m_installDir.c_str()))
+  {
+    LOG(Warn, "Backup directory " + m_installDir + " - removing it.");
+    FileUtils::rmdirRecursive(m_installDir.c_str());
+  }
+
+  FileUtils::copyTree(m_targetDir, m_installDir);
 }
 
 void UpdateInstaller::installFiles()
@@ -473,15 +593,40 @@ void UpdateInstaller::installFiles()
   {
     m_observer->updateMessage("Installing Files...");
   }
+
+  // directories and links are set up in script order first, after that
+  // every patch and every file can be written independently of the others
+  std::vector<InstallTask> tasks;
   std::vector<UpdateScriptFile>::const_iterator iter = m_script->filesToInstall().begin();
   for (; iter != m_script->filesToInstall().end(); iter++)
   {
-    installFile(*iter);
-    ++m_installed;
-    updateProgress();
+    prepareFile(*iter);
+    if (!iter->linkTarget.empty())
+    {
+      ++m_installed;
+      updateProgress();
+    }
+  }
+
+  DID_CANCEL();
+
+  std::vector<UpdateScriptPatch>::const_iterator patch = m_script->patches().begin();
+  for (; patch != m_script->patches().end(); patch++)
+  {
+    InstallTask task = { InstallTask::Patch, &*patch, 0 };
+    tasks.push_back(task);
+  }
 
-    DID_CANCEL();
+  for (iter = m_script->filesToInstall().begin(); iter != m_script->filesToInstall().end(); iter++)
+  {
+    if (iter->linkTarget.empty())
+    {
+      InstallTask task = { InstallTask::Install, 0, &*iter };
+      tasks.push_back(task);
+    }
   }
+
+  runParallel(tasks);
 }
 
 void UpdateInstaller::findFiles(const std::string& path, std::vector<std::string>& list)
@@ -509,26 +654,29 @@ void UpdateInstaller::verifyAgainstManifest()
 {
   std::vector<std::string> files;
   findFiles(m_installDir, files);
-  std::map<std::string, UpdateScriptFile> fileMap = m_script->filesManifest();
+  const std::map<std::string, UpdateScriptFile>& fileMap = m_script->filesManifest();
 
   if (m_observer)
   {
     m_observer->updateMessage("Verifying Installation...");
   }
 
+  // links are checked here, the hashes on the workers
+  std::vector<InstallTask> tasks;
   for (std::vector<std::string>::const_iterator it = files.begin(); it != files.end(); ++it)
   {
     std::string filePath = *it;
     filePath = filePath.substr(m_installDir.size() + 1);
 
-    if (fileMap.find(filePath) == fileMap.end())
+    std::map<std::string, UpdateScriptFile>::const_iterator manifestFile = fileMap.find(filePath);
+    if (manifestFile == fileMap.end())
     {
       FileUtils::removeFile((m_installDir + '/' + filePath).c_str());
     }
     else
     {
-      UpdateScriptFile scriptFile = fileMap[filePath];
-      
+      const UpdateScriptFile& scriptFile = manifestFile->second;
+
       // verify links
       if (!scriptFile.linkTarget.empty())
       {
@@ -546,17 +694,13 @@ void UpdateInstaller::verifyAgainstManifest()
       }
       else if (!scriptFile.hash.empty())
       {
-        std::string hash = FileUtils::sha1FromFile((m_installDir + '/' + filePath).c_str());
-        if (hash != scriptFile.hash)
-        {
-          LOG(Error, "File " + filePath + " had the wrong hash! Expected: " + scriptFile.hash +
-                     ", got: " + hash);
-          throw "Wrong hash on file: " + filePath;
-        }
+        InstallTask task = { InstallTask::Verify, 0, &scriptFile };
+        tasks.push_back(task);
       }
-      
     }
   }
+
+  runParallel(tasks);
 }
 
 void UpdateInstaller::uninstallFiles()
@@ -4,9 +4,12 @@
 #include "FileUtils.h"
 #include "UpdateScript.h"
 
+#include "tinythread.h"
+
 #include <list>
 #include <string>
 #include <map>
+#include <vector>
 
 class UpdateObserver;
 
@@ -41,13 +44,34 @@ public:
   void restartMainApp();
 
 private:
+  /** A patch, file or hash check that doesn't depend on any other,
+    * so it can run on any of the worker threads.
+    */
+  struct InstallTask
+  {
+    enum Type
+    {
+      Patch,
+      Install,
+      Verify
+    };
+
+    Type type;
+    const UpdateScriptPatch* patch;
+    const UpdateScriptFile* file;
+  };
+
   bool checkAccess();
 
   void installFiles();
-  void patchFiles();
   void uninstallFiles();
+  void prepareFile(const UpdateScriptFile& file);
   void installFile(const UpdateScriptFile& file);
   void patchFile(const UpdateScriptPatch& file);
+  void verifyFile(const UpdateScriptFile& file);
+  void runParallel(const std::vector<InstallTask>& tasks);
+  void runTasks();
+  static void runWorker(void* installer);
   void reportError(const std::string& error);
   void postInstallUpdate();
   void updateProgress();
@@ -70,4 +94,15 @@ private:
   bool m_autoClose;
 
   int m_installed;
+
+  // the tasks runParallel() hands out to the workers and the first error one of them hit
+  std::vector<InstallTask> m_tasks;
+  size_t m_nextTask;
+  bool m_taskFailed;
+  std::string m_taskError;
+  FileUtils::IOException* m_taskIOError;
+  tthread::mutex m_taskMutex;
+
+  // SHA-1 of the files patched or extracted, taken while they were written
+  std::map<std::string, std::string> m_fileHashes;
 };
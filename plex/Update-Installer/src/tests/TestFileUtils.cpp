@@ -3,6 +3,45 @@
 #include "FileUtils.h"
 #include "TestUtils.h"
 
+#include "bzlib.h"
+
+#include <stdint.h>
+#include <vector>
+
+// little endian with the sign in the top bit, like bsdiff writes offsets
+static void appendOffset(std::string& data, int64_t value)
+{
+  uint64_t magnitude = value < 0 ? -value : value;
+  for (int i = 0; i < 8; i++)
+  {
+    uint8_t byte = (uint8_t)(magnitude >> (8 * i));
+    if (i == 7 && value < 0)
+      byte |= 0x80;
+    data += (char)byte;
+  }
+}
+
+// a bsdiff patch that adds the difference to the whole of oldData, then appends the rest of newData
+static std::string createPatch(const std::string& oldData, const std::string& newData)
+{
+  std::string body;
+  appendOffset(body, (int64_t)oldData.size());
+  appendOffset(body, (int64_t)(newData.size() - oldData.size()));
+  appendOffset(body, 0);
+  for (size_t i = 0; i < oldData.size(); i++)
+    body += (char)(newData[i] - oldData[i]);
+  body += newData.substr(oldData.size());
+
+  std::vector<char> compressed(body.size() * 2 + 600);
+  unsigned int compressedSize = (unsigned int)compressed.size();
+  BZ2_bzBuffToBuffCompress(&compressed[0], &compressedSize, &body[0], (unsigned int)body.size(), 9, 0, 0);
+
+  std::string patch = "ENDSLEY/BSDIFF43";
+  appendOffset(patch, (int64_t)newData.size());
+  patch.append(&compressed[0], compressedSize);
+  return patch;
+}
+
 void TestFileUtils::testDirName()
 {
 #ifdef PLATFORM_WINDOWS
@@ -39,6 +78,57 @@ void TestFileUtils::testStandardDirs()
   TEST_COMPARE(FileUtils::fileExists(tmpDir.data()), true);
 }
 
+void TestFileUtils::testExtractFromZip()
+{
+  const char* zipFile = "test-extract.zip";
+  const char* destFile = "test-extracted-file";
+  FileUtils::removeFile(zipFile);
+
+  std::string content(200000, 'x');
+  for (size_t i = 0; i < content.size(); i++)
+    content[i] = (char)(i * 7 % 251);
+  FileUtils::addToZip(zipFile, "dir/file", content.data(), (int)content.size());
+
+  std::string hash;
+  FileUtils::extractFromZip(zipFile, "dir/file", destFile, &hash);
+  TEST_COMPARE(FileUtils::readFile(destFile) == content, true);
+  TEST_COMPARE(hash, FileUtils::sha1FromFile(destFile));
+  TEST_COMPARE(hash, FileUtils::sha1FromData(content));
+
+  FileUtils::removeFile(zipFile);
+  FileUtils::removeFile(destFile);
+}
+
+void TestFileUtils::testPatchFromZip()
+{
+  const char* zipFile = "test-patch.zip";
+  const char* newFile = "test-patched-file";
+  FileUtils::removeFile(zipFile);
+
+  std::string oldData(300000, 'o');
+  std::string newData(oldData.size() + 1000, 'n');
+  for (size_t i = 0; i < newData.size(); i++)
+  {
+    if (i < oldData.size())
+      oldData[i] = (char)(i % 13);
+    newData[i] = (char)(i % 17);
+  }
+
+  std::string patch = createPatch(oldData, newData);
+  FileUtils::addToZip(zipFile, "patches/file.bsdiff", patch.data(), (int)patch.size());
+
+  std::string hash;
+  TEST_COMPARE(FileUtils::patchFromZip(oldData, newFile, zipFile, "patches/file.bsdiff", &hash), true);
+  TEST_COMPARE(FileUtils::readFile(newFile) == newData, true);
+  TEST_COMPARE(hash, FileUtils::sha1FromData(newData));
+
+  // a patch missing from the package fails
+  TEST_COMPARE(FileUtils::patchFromZip(oldData, newFile, zipFile, "patches/missing.bsdiff"), false);
+
+  FileUtils::removeFile(zipFile);
+  FileUtils::removeFile(newFile);
+}
+
 int main(int, char**)
 {
   TestList<TestFileUtils> tests;
@@ -46,5 +136,7 @@ int main(int, char**)
   tests.addTest(&TestFileUtils::testIsRelative);
   tests.addTest(&TestFileUtils::testSymlinkFileExists);
   tests.addTest(&TestFileUtils::testStandardDirs);
+  tests.addTest(&TestFileUtils::testExtractFromZip);
+  tests.addTest(&TestFileUtils::testPatchFromZip);
   return TestUtils::runTest(tests);
 }
@@ -7,4 +7,6 @@ public:
   void testIsRelative();
   void testSymlinkFileExists();
   void testStandardDirs();
+  void testExtractFromZip();
+  void testPatchFromZip();
 };
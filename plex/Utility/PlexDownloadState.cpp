@@ -0,0 +1,223 @@
+#include "PlexDownloadState.h"
+
+#include "File.h"
+#include "utils/XBMCTinyXML.h"
+#include "utils/log.h"
+
+#include <algorithm>
+#include <boost/lexical_cast.hpp>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CPlexDownloadState::CPlexDownloadState(const std::string& destination, unsigned int chunkSize)
+  : m_destination(destination), m_chunkSize(chunkSize)
+{
+  Reset("", 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexDownloadState::Reset(const std::string& url, int64_t size)
+{
+  m_url = url;
+  m_size = size;
+  m_chunks.clear();
+  m_complete = false;
+  m_hash.clear();
+
+  m_fileHash.reset();
+  m_chunkHash.reset();
+  m_chunkBytes = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexDownloadState::Load()
+{
+  CXBMCTinyXML doc;
+  if (!doc.LoadFile(GetStatePath(m_destination)) || !FromXML(doc.RootElement()))
+  {
+    Reset("", 0);
+    return false;
+  }
+
+  if (!VerifyFile())
+  {
+    CLog::Log(LOGDEBUG, "CPlexDownloadState::Load %s doesn't match its state anymore", m_destination.c_str());
+    Reset("", 0);
+    return false;
+  }
+
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexDownloadState::Save() const
+{
+  CXBMCTinyXML doc;
+  doc.LinkEndChild(new TiXmlDeclaration("1.0", "utf-8", ""));
+
+  TiXmlElement element("download");
+  ToXML(element);
+  doc.InsertEndChild(element);
+
+  return doc.SaveFile(GetStatePath(m_destination));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexDownloadState::Remove()
+{
+  XFILE::CFile::Delete(GetStatePath(m_destination));
+  Reset("", 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexDownloadState::AddData(const void* data, size_t length)
+{
+  const uint8_t* current = (const uint8_t*)data;
+  bool completed = false;
+
+  while (length > 0)
+  {
+    size_t count = std::min(length, (size_t)(m_chunkSize - m_chunkBytes));
+    m_fileHash.add(current, count);
+    m_chunkHash.add(current, count);
+
+    m_chunkBytes += count;
+    current += count;
+    length -= count;
+
+    if (m_chunkBytes == m_chunkSize)
+    {
+      CompleteChunk();
+      completed = true;
+    }
+  }
+
+  return completed;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexDownloadState::CompleteChunk()
+{
+  Chunk chunk;
+  chunk.hash = m_chunkHash.getHash();
+  chunk.fileState = m_fileHash.getState();
+  m_chunks.push_back(chunk);
+
+  m_chunkHash.reset();
+  m_chunkBytes = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+std::string CPlexDownloadState::Finish()
+{
+  if (m_chunkBytes > 0)
+    CompleteChunk();
+
+  m_complete = true;
+  m_hash = m_fileHash.getHash();
+  return m_hash;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+int64_t CPlexDownloadState::GetOffset() const
+{
+  if (m_complete)
+    return m_size;
+  return (int64_t)m_chunks.size() * m_chunkSize;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexDownloadState::VerifyFile()
+{
+  XFILE::CFile file;
+  if (!file.Open(m_destination))
+    return false;
+
+  int64_t length = file.GetLength();
+  if (m_complete)
+    return length == m_size;
+
+  // the state is saved after a chunk was flushed, but the last one might still not have made it
+  // to disk if the system went down, so that one is read back, the ones before aren't
+  std::vector<uint8_t> buffer(m_chunkSize);
+  while (!m_chunks.empty())
+  {
+    int64_t offset = (int64_t)(m_chunks.size() - 1) * m_chunkSize;
+    if (offset + m_chunkSize <= length && file.Seek(offset, SEEK_SET) == offset &&
+        file.Read(&buffer[0], m_chunkSize) == m_chunkSize &&
+        SHA1()(&buffer[0], m_chunkSize) == m_chunks.back().hash)
+      break;
+
+    m_chunks.pop_back();
+  }
+
+  if (m_chunks.empty())
+    m_fileHash.reset();
+  else
+    m_fileHash.setState(m_chunks.back().fileState);
+
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexDownloadState::ToXML(TiXmlElement& element) const
+{
+  element.SetAttribute("url", m_url);
+  element.SetAttribute("size", boost::lexical_cast<std::string>(m_size));
+  element.SetAttribute("chunkSize", (int)m_chunkSize);
+  element.SetAttribute("complete", m_complete ? 1 : 0);
+  if (m_complete)
+    element.SetAttribute("hash", m_hash);
+
+  for (std::vector<Chunk>::const_iterator it = m_chunks.begin(); it != m_chunks.end(); ++it)
+  {
+    TiXmlElement chunk("chunk");
+    chunk.SetAttribute("hash", it->hash);
+    chunk.SetAttribute("fileState", it->fileState);
+    element.InsertEndChild(chunk);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexDownloadState::FromXML(const TiXmlElement* element)
+{
+  Reset("", 0);
+
+  if (!element || element->ValueStr() != "download")
+    return false;
+
+  std::string size;
+  int chunkSize, complete;
+  if (element->QueryStringAttribute("url", &m_url) != TIXML_SUCCESS ||
+      element->QueryStringAttribute("size", &size) != TIXML_SUCCESS ||
+      element->QueryIntAttribute("chunkSize", &chunkSize) != TIXML_SUCCESS ||
+      element->QueryIntAttribute("complete", &complete) != TIXML_SUCCESS)
+    return false;
+
+  // chunks of another size can't be continued
+  if (chunkSize != (int)m_chunkSize)
+    return false;
+
+  try { m_size = boost::lexical_cast<int64_t>(size); }
+  catch (boost::bad_lexical_cast) { return false; }
+
+  m_complete = complete != 0;
+  if (m_complete && element->QueryStringAttribute("hash", &m_hash) != TIXML_SUCCESS)
+    return false;
+
+  for (const TiXmlElement* chunkElement = element->FirstChildElement("chunk"); chunkElement; chunkElement = chunkElement->NextSiblingElement("chunk"))
+  {
+    Chunk chunk;
+    SHA1 fileHash;
+    if (chunkElement->QueryStringAttribute("hash", &chunk.hash) != TIXML_SUCCESS ||
+        chunkElement->QueryStringAttribute("fileState", &chunk.fileState) != TIXML_SUCCESS ||
+        !fileHash.setState(chunk.fileState))
+      return false;
+
+    m_chunks.push_back(chunk);
+  }
+
+  if (!m_chunks.empty())
+    m_fileHash.setState(m_chunks.back().fileState);
+
+  return true;
+}
@@ -0,0 +1,77 @@
+#ifndef PLEXDOWNLOADSTATE_H
+#define PLEXDOWNLOADSTATE_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "Third-Party/hash-library/sha1.h"
+
+class TiXmlElement;
+
+#define PLEX_DOWNLOAD_CHUNK_SIZE (1024 * 1024)
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// How far a download got, saved next to the file it's written to so an interrupted download can
+// continue from where it stopped instead of starting over.
+//
+// The file is downloaded in fixed size chunks and the SHA-1 of the whole file is computed while
+// the data arrives. For every chunk that was written the state keeps the chunk's own SHA-1 and
+// where the hash of the whole file was at after it, so resuming only reads back the last chunk to
+// check it made it to disk and never hashes the rest of the file again.
+//
+class CPlexDownloadState
+{
+public:
+  CPlexDownloadState(const std::string& destination, unsigned int chunkSize = PLEX_DOWNLOAD_CHUNK_SIZE);
+
+  // starts over, nothing of url has been downloaded yet
+  void Reset(const std::string& url, int64_t size);
+
+  // loads what was saved for the destination, dropping chunks that aren't in the file anymore
+  bool Load();
+  bool Save() const;
+  void Remove();
+
+  bool Matches(const std::string& url, int64_t size) const { return m_url == url && m_size == size; }
+
+  // returns true when the data completed a chunk, which should be flushed before calling Save()
+  bool AddData(const void* data, size_t length);
+
+  // the SHA-1 of everything added since the download started
+  std::string Finish();
+
+  int64_t GetOffset() const;
+  bool IsComplete() const { return m_complete; }
+  std::string GetHash() const { return m_hash; }
+
+  void ToXML(TiXmlElement& element) const;
+  bool FromXML(const TiXmlElement* element);
+
+  static std::string GetStatePath(const std::string& destination) { return destination + ".state"; }
+
+private:
+  struct Chunk
+  {
+    std::string hash;       // of the chunk
+    std::string fileState;  // of the file hash after the chunk
+  };
+
+  bool VerifyFile();
+  void CompleteChunk();
+
+  std::string m_destination;
+  unsigned int m_chunkSize;
+
+  std::string m_url;
+  int64_t m_size;
+  std::vector<Chunk> m_chunks;
+  bool m_complete;
+  std::string m_hash;
+
+  SHA1 m_fileHash;
+  SHA1 m_chunkHash;
+  unsigned int m_chunkBytes;
+};
+
+#endif // PLEXDOWNLOADSTATE_H
@@ -0,0 +1,111 @@
+//
+//  PlexFlatMap.h
+//  Plex Home Theater
+//
+
+#ifndef __Plex_Home_Theater__PlexFlatMap__
+#define __Plex_Home_Theater__PlexFlatMap__
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <memory>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// A map kept as one sorted array of pairs.
+//
+// Every item in a Plex section carries a few dozen properties, and a node based map pays a heap
+// block, a couple of pointers and a hash for each of them. Keeping the pairs next to each other
+// costs nothing but the pairs themselves, and with so few entries a binary search is as quick as
+// hashing the key. Inserting and erasing moves the tail of the array, so this is only meant for
+// small maps that are mostly read.
+//
+template <typename Key, typename T, typename Compare = std::less<Key>,
+          typename Alloc = std::allocator<std::pair<Key, T> > >
+class CPlexFlatMap
+{
+public:
+  typedef Key key_type;
+  typedef T mapped_type;
+  typedef std::pair<Key, T> value_type;
+  typedef typename std::vector<value_type, Alloc>::iterator iterator;
+  typedef typename std::vector<value_type, Alloc>::const_iterator const_iterator;
+  typedef typename std::vector<value_type, Alloc>::size_type size_type;
+
+  iterator begin() { return m_values.begin(); }
+  iterator end() { return m_values.end(); }
+  const_iterator begin() const { return m_values.begin(); }
+  const_iterator end() const { return m_values.end(); }
+
+  size_type size() const { return m_values.size(); }
+  bool empty() const { return m_values.empty(); }
+  void clear() { m_values.clear(); }
+
+  iterator find(const Key& key)
+  {
+    iterator it = lower_bound(key);
+    if (it != m_values.end() && !m_compare(key, it->first))
+      return it;
+    return m_values.end();
+  }
+
+  const_iterator find(const Key& key) const
+  {
+    const_iterator it = std::lower_bound(m_values.begin(), m_values.end(), key, KeyCompare(m_compare));
+    if (it != m_values.end() && !m_compare(key, it->first))
+      return it;
+    return m_values.end();
+  }
+
+  size_type count(const Key& key) const { return find(key) != end() ? 1 : 0; }
+
+  std::pair<iterator, bool> insert(const value_type& value)
+  {
+    iterator it = lower_bound(value.first);
+    if (it != m_values.end() && !m_compare(value.first, it->first))
+      return std::make_pair(it, false);
+    return std::make_pair(m_values.insert(it, value), true);
+  }
+
+  T& operator[](const Key& key)
+  {
+    return insert(value_type(key, T())).first->second;
+  }
+
+  void erase(iterator it) { m_values.erase(it); }
+
+  size_type erase(const Key& key)
+  {
+    iterator it = find(key);
+    if (it == m_values.end())
+      return 0;
+    m_values.erase(it);
+    return 1;
+  }
+
+  // drop the room the array kept for growing, once the map is filled in
+  void compact()
+  {
+    if (m_values.capacity() > m_values.size())
+      std::vector<value_type, Alloc>(m_values).swap(m_values);
+  }
+
+private:
+  struct KeyCompare
+  {
+    KeyCompare(const Compare& compare) : m_compare(compare) {}
+    bool operator()(const value_type& value, const Key& key) const { return m_compare(value.first, key); }
+    Compare m_compare;
+  };
+
+  iterator lower_bound(const Key& key)
+  {
+    return std::lower_bound(m_values.begin(), m_values.end(), key, KeyCompare(m_compare));
+  }
+
+  std::vector<value_type, Alloc> m_values;
+  Compare m_compare;
+};
+
+#endif /* defined(__Plex_Home_Theater__PlexFlatMap__) */
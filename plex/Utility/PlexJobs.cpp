@@ -20,8 +20,11 @@
 #include "PlexUtils.h"
 #include "xbmc/Util.h"
 #include "ApplicationMessenger.h"
+#include "PlexDownloadState.h"
 
 #define TEXTURE_CACHE_BUFFER_SIZE 131072
+#define DOWNLOAD_BUFFER_SIZE 65536
+#define DOWNLOAD_MAX_ATTEMPTS 5
 
 ////////////////////////////////////////////////////////////////////////////////
 bool CPlexHTTPFetchJob::DoWork()
@@ -50,6 +53,26 @@ CFileItemListPtr CPlexDirectoryFetchJob::getResult()
   return list;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+CFileItemListPtr CPlexSectionFetchJob::getPartialResult() const
+{
+  CSingleLock lk(m_partialLock);
+  CFileItemListPtr list = CFileItemListPtr(new CFileItemList());
+  list->Assign(m_partialItems, false);
+  return list;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CPlexSectionFetchJob::OnFanoutProgress(const CFileItemList& items, int done, int total)
+{
+  {
+    CSingleLock lk(m_partialLock);
+    m_partialItems.Assign(items, false);
+  }
+
+  ShouldCancel(done, total);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 bool CPlexMediaServerClientJob::DoWork()
 {
@@ -99,58 +122,124 @@ using namespace XFILE;
 bool
 CPlexDownloadFileJob::DoWork()
 {
-  CFile file;
-  CURL theUrl(m_url);
   m_http.SetRequestHeader("X-Plex-Client", PLEX_TARGET_NAME);
 
-  if (!file.OpenForWrite(m_destination, true))
+  // a dropped connection continues where it stopped, so does the next job for the same file
+  CPlexDownloadState state(m_destination);
+  for (int attempt = 1; attempt <= DOWNLOAD_MAX_ATTEMPTS; attempt++)
   {
-    CLog::Log(LOGWARNING, "[DownloadJob] Couldn't open file %s for writing", m_destination.c_str());
-    return false;
+    DownloadResult result = Download(state);
+    if (result == DOWNLOAD_DONE)
+      return true;
+    if (result == DOWNLOAD_FAILED)
+      break;
+
+    CLog::Log(LOGINFO, "[DownloadJob] Download of %s was interrupted at %lld, retrying", m_url.c_str(), state.GetOffset());
+    Sleep(attempt * 2000);
   }
 
-  if (m_http.Open(theUrl))
-  {
-    CLog::Log(LOGINFO, "[DownloadJob] Downloading %s to %s", m_url.c_str(), m_destination.c_str());
+  CLog::Log(LOGWARNING, "[DownloadJob] Failed to download file.");
+  return false;
+}
 
-    bool done = false;
-    bool failed = false;
-    int64_t read;
-    int64_t leftToDownload = m_http.GetLength();
-    int64_t total = leftToDownload;
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CPlexDownloadFileJob::DownloadResult CPlexDownloadFileJob::Download(CPlexDownloadState& state)
+{
+  CURL theUrl(m_url);
+  if (!m_http.Open(theUrl))
+    return DOWNLOAD_RETRY;
 
-    while (!done)
+  int64_t total = m_http.GetLength();
+  int64_t offset = 0;
+
+  if (total > 0 && state.Load() && state.Matches(m_url, total))
+  {
+    if (state.IsComplete())
     {
-      char buffer[4096];
-      read = m_http.Read(buffer, 4096);
-      if (read > 0)
-      {
-        leftToDownload -= read;
-        file.Write(buffer, read);
-        done = ShouldCancel(total-leftToDownload, total);
-        if(done) failed = true;
-      }
-      else if (read == 0)
-      {
-        done = true;
-        failed = total == 0;
-        continue;
-      }
+      CLog::Log(LOGINFO, "[DownloadJob] %s is already downloaded", m_destination.c_str());
+      m_http.Close();
+      m_hash = state.GetHash();
+      return DOWNLOAD_DONE;
+    }
 
-      if (total == 0)
-        done = true;
+    offset = state.GetOffset();
+    if (offset > 0 && m_http.Seek(offset, SEEK_SET) != offset)
+    {
+      CLog::Log(LOGINFO, "[DownloadJob] %s can't be resumed, starting over", m_url.c_str());
+      m_http.Close();
+      if (!m_http.Open(theUrl))
+        return DOWNLOAD_RETRY;
+      offset = 0;
     }
+  }
 
-    CLog::Log(LOGINFO, "[DownloadJob] Done with the download.");
+  if (offset == 0)
+  {
+    state.Remove();
+    state.Reset(m_url, total);
+  }
 
+  CFile file;
+  if (!file.OpenForWrite(m_destination, offset == 0) || file.Seek(offset, SEEK_SET) != offset || file.Truncate(offset) != 0)
+  {
+    CLog::Log(LOGWARNING, "[DownloadJob] Couldn't open file %s for writing", m_destination.c_str());
     m_http.Close();
-    file.Close();
+    return DOWNLOAD_FAILED;
+  }
 
-    return !failed;
+  CLog::Log(LOGINFO, "[DownloadJob] Downloading %s to %s from %lld", m_url.c_str(), m_destination.c_str(), offset);
+
+  std::vector<char> buffer(DOWNLOAD_BUFFER_SIZE);
+  int64_t downloaded = offset;
+  DownloadResult result = DOWNLOAD_DONE;
+
+  while (true)
+  {
+    int64_t read = m_http.Read(&buffer[0], buffer.size());
+    if (read <= 0)
+    {
+      // without a length there is no telling whether everything arrived
+      if (total == 0)
+        result = DOWNLOAD_FAILED;
+      // the connection went away before everything was there
+      else if (read < 0 || downloaded < total)
+        result = DOWNLOAD_RETRY;
+      break;
+    }
+
+    if (file.Write(&buffer[0], read) != read)
+    {
+      CLog::Log(LOGWARNING, "[DownloadJob] Couldn't write to %s", m_destination.c_str());
+      result = DOWNLOAD_FAILED;
+      break;
+    }
+    downloaded += read;
+
+    // the state can only say a chunk is there once it's on disk
+    if (state.AddData(&buffer[0], read))
+    {
+      file.Flush();
+      state.Save();
+    }
+
+    if (ShouldCancel(downloaded, total))
+    {
+      result = DOWNLOAD_FAILED;
+      break;
+    }
   }
 
-  CLog::Log(LOGWARNING, "[DownloadJob] Failed to download file.");
-  return false;
+  m_http.Close();
+  file.Close();
+
+  if (result == DOWNLOAD_DONE)
+  {
+    m_hash = state.Finish();
+    state.Save();
+    CLog::Log(LOGINFO, "[DownloadJob] Done with the download.");
+  }
+
+  return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -16,11 +16,13 @@
 #include "guilib/GUIMessage.h"
 #include "Client/PlexMediaServerClient.h"
 #include "FileSystem/PlexDirectory.h"
+#include "FileSystem/PlexDirectoryFanout.h"
 #include "threads/CriticalSection.h"
 #include "TextureCacheJob.h"
 #include "filesystem/File.h"
 
 class CPlexPlayQueue;
+class CPlexDownloadState;
 typedef boost::shared_ptr<CPlexPlayQueue> CPlexPlayQueuePtr;
 
 ////////////////////////////////////////////////////////////////////////////////////////
@@ -41,6 +43,7 @@ class CPlexHTTPFetchJob : public CJob
     bool DoWork();
     void Cancel() { m_http.Cancel(); }
     virtual bool operator==(const CJob* job) const;
+    virtual std::string GetIdentity() const { return m_url.Get(); }
   
     XFILE::CCurlFile m_http;
     CStdString m_data;
@@ -61,6 +64,8 @@ public:
       return true;
     return false;
   }
+
+  virtual std::string GetIdentity() const { return m_url.Get(); }
   
   virtual const char* GetType() const { return "plexdirectoryfetch"; }
   
@@ -109,11 +114,20 @@ public:
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////
-class CPlexSectionFetchJob : public CPlexDirectoryFetchJob
+class CPlexSectionFetchJob : public CPlexDirectoryFetchJob, public IPlexDirectoryFanoutCallback
 {
 public:
-  CPlexSectionFetchJob(const CURL& url, int contentType) : CPlexDirectoryFetchJob(url,CPlexDirectoryCache::CACHE_STRATEGY_ALWAYS), m_contentType(contentType) { }
+  CPlexSectionFetchJob(const CURL& url, int contentType) : CPlexDirectoryFetchJob(url,CPlexDirectoryCache::CACHE_STRATEGY_ALWAYS), m_contentType(contentType) { m_dir.SetFanoutCallback(this); }
   int m_contentType;
+
+  // when the section comes from several servers, what they returned so far. OnJobProgress is
+  // called every time it grows.
+  CFileItemListPtr getPartialResult() const;
+  virtual void OnFanoutProgress(const CFileItemList& items, int done, int total);
+
+private:
+  CFileItemList m_partialItems;
+  mutable CCriticalSection m_partialLock;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////
@@ -148,6 +162,8 @@ public:
       return true;
     return false;
   }
+
+  virtual std::string GetIdentity() const { return m_url.Get(); }
 };
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -194,7 +210,20 @@ class CPlexDownloadFileJob : public CJob
     CStdString m_destination;
     XFILE::CCurlFile m_http;
 
+    // SHA-1 of the downloaded file, computed while it was downloaded
+    std::string m_hash;
+
     bool m_failed;
+
+  private:
+    enum DownloadResult
+    {
+      DOWNLOAD_DONE,
+      DOWNLOAD_FAILED,
+      DOWNLOAD_RETRY
+    };
+
+    DownloadResult Download(CPlexDownloadState& state);
 };
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
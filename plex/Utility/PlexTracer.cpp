@@ -0,0 +1,234 @@
+//
+//  PlexTracer.cpp
+//  Plex Home Theater
+//
+
+#include "PlexTracer.h"
+#include "filesystem/File.h"
+#include "threads/SingleLock.h"
+#include "threads/Thread.h"
+#include "utils/log.h"
+#include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
+
+#include <inttypes.h>
+#include <string.h>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+static std::string EscapeJSON(const std::string& str)
+{
+  std::string escaped;
+  for (size_t i = 0; i < str.size(); i++)
+  {
+    unsigned char c = str[i];
+    if (c == '"' || c == '\\')
+    {
+      escaped += '\\';
+      escaped += c;
+    }
+    else if (c < 0x20)
+      escaped += StringUtils::Format("\\u%04x", c);
+    else
+      escaped += c;
+  }
+  return escaped;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CPlexTracer::CPlexTracer(unsigned int maxEvents)
+{
+  m_maxEvents = maxEvents > 0 ? maxEvents : 1;
+  m_nextEvent = 0;
+  m_play = 0;
+  m_lastPlay = 0;
+  m_playStart = 0;
+  m_frequency = CurrentHostFrequency();
+  m_epoch = CurrentHostCounter();
+  m_events.reserve(m_maxEvents);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CPlexTracer& CPlexTracer::GetInstance()
+{
+  static CPlexTracer tracer;
+  return tracer;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+int64_t CPlexTracer::Now() const
+{
+  int64_t ticks = CurrentHostCounter() - m_epoch;
+  return (ticks / m_frequency) * 1000000 + ((ticks % m_frequency) * 1000000) / m_frequency;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+unsigned int CPlexTracer::GetThreadIndex()
+{
+  ThreadIdentifier thread = CThread::GetCurrentThreadId();
+  std::map<ThreadIdentifier, unsigned int>::iterator it = m_threads.find(thread);
+  if (it != m_threads.end())
+    return it->second;
+
+  unsigned int index = m_threads.size() + 1;
+  m_threads[thread] = index;
+  return index;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexTracer::AddEvent(const char* name, int64_t start, int64_t duration)
+{
+  Event event;
+  event.name = name;
+  event.start = start;
+  event.duration = duration;
+  event.thread = GetThreadIndex();
+  event.play = m_play;
+
+  if (m_events.size() < m_maxEvents)
+  {
+    m_events.push_back(event);
+    return;
+  }
+
+  m_events[m_nextEvent] = event;
+  m_nextEvent = (m_nextEvent + 1) % m_maxEvents;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexTracer::AddSpan(const char* name, int64_t start, int64_t end)
+{
+  CSingleLock lk(m_lock);
+  AddEvent(name, start, end - start);
+
+  if (!m_play || start < m_playStart)
+    return;
+
+  for (size_t i = 0; i < m_playStages.size(); i++)
+  {
+    // the same name can be a different literal in each translation unit
+    if (strcmp(m_playStages[i].first, name) == 0)
+    {
+      m_playStages[i].second += end - start;
+      return;
+    }
+  }
+  m_playStages.push_back(std::make_pair(name, end - start));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexTracer::AddMark(const char* name)
+{
+  CSingleLock lk(m_lock);
+  AddEvent(name, Now(), -1);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexTracer::BeginPlay(const std::string& title)
+{
+  CSingleLock lk(m_lock);
+  if (m_play)
+    CLog::Log(LOGDEBUG, "CPlexTracer::BeginPlay play %u never got to its first frame", m_play);
+
+  m_play = ++m_lastPlay;
+  m_playStart = Now();
+  m_playStages.clear();
+
+  // only titles of plays still in the buffer are needed
+  if (m_playTitles.size() >= 16)
+    m_playTitles.erase(m_playTitles.begin());
+  m_playTitles[m_play] = title;
+
+  AddEvent("play", m_playStart, -1);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+std::string CPlexTracer::EndPlay()
+{
+  CSingleLock lk(m_lock);
+  if (!m_play)
+    return "";
+
+  int64_t now = Now();
+  AddEvent("first frame", now, -1);
+
+  std::string summary = StringUtils::Format("%.3fs to first frame of %s", (now - m_playStart) / 1000000.0, m_playTitles[m_play].c_str());
+  for (size_t i = 0; i < m_playStages.size(); i++)
+    summary += StringUtils::Format("%s %s %.3fs", i ? "," : ":", m_playStages[i].first, m_playStages[i].second / 1000000.0);
+
+  CLog::Log(LOGINFO, "CPlexTracer::EndPlay %s", summary.c_str());
+
+  m_play = 0;
+  m_playStages.clear();
+  m_lastSummary = summary;
+  return summary;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+std::string CPlexTracer::GetLastSummary() const
+{
+  CSingleLock lk(m_lock);
+  return m_lastSummary;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexTracer::GetEvents(std::vector<Event>& events) const
+{
+  CSingleLock lk(m_lock);
+  events.assign(m_events.begin() + m_nextEvent, m_events.end());
+  events.insert(events.end(), m_events.begin(), m_events.begin() + m_nextEvent);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+std::string CPlexTracer::GetChromeTrace() const
+{
+  std::vector<Event> events;
+  GetEvents(events);
+
+  std::map<unsigned int, std::string> titles;
+  {
+    CSingleLock lk(m_lock);
+    titles = m_playTitles;
+  }
+
+  std::string json = "{\"traceEvents\":[";
+  for (size_t i = 0; i < events.size(); i++)
+  {
+    const Event& event = events[i];
+    if (i)
+      json += ",";
+
+    json += StringUtils::Format("\n{\"name\":\"%s\",\"cat\":\"playback\",\"pid\":1,\"tid\":%u,\"ts\":%" PRId64,
+                                EscapeJSON(event.name).c_str(), event.thread, event.start);
+    if (event.duration >= 0)
+      json += StringUtils::Format(",\"ph\":\"X\",\"dur\":%" PRId64, event.duration);
+    else
+      json += ",\"ph\":\"i\",\"s\":\"g\"";
+
+    if (event.play)
+    {
+      std::map<unsigned int, std::string>::const_iterator title = titles.find(event.play);
+      json += StringUtils::Format(",\"args\":{\"play\":%u,\"title\":\"%s\"}", event.play,
+                                  title != titles.end() ? EscapeJSON(title->second).c_str() : "");
+    }
+    json += "}";
+  }
+  json += "\n]}\n";
+
+  return json;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexTracer::SaveChromeTrace(const std::string& path) const
+{
+  std::string json = GetChromeTrace();
+
+  XFILE::CFile file;
+  if (!file.OpenForWrite(path, true) || file.Write(json.c_str(), json.size()) != (int)json.size())
+  {
+    CLog::Log(LOGERROR, "CPlexTracer::SaveChromeTrace failed to write %s", path.c_str());
+    return false;
+  }
+
+  CLog::Log(LOGINFO, "CPlexTracer::SaveChromeTrace saved playback trace to %s", path.c_str());
+  return true;
+}
@@ -0,0 +1,96 @@
+//
+//  PlexTracer.h
+//  Plex Home Theater
+//
+
+#ifndef __Plex_Home_Theater__PlexTracer__
+#define __Plex_Home_Theater__PlexTracer__
+
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "threads/CriticalSection.h"
+#include "threads/platform/ThreadImpl.h"
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Records named spans of the playback startup path (media decision, transcoder url, input,
+// demuxer and codec opening, ...) into a fixed size ring buffer, together with the thread they
+// ran on. The buffer can be saved as Chrome trace-event JSON (chrome://tracing) on demand with
+// the SavePlaybackTrace builtin.
+//
+// Between BeginPlay and EndPlay the spans are also summed up by name, and EndPlay logs the
+// time to first frame along with how much of it each stage took, so slow starts show whether
+// they were waiting on the server, the network, probing or the decoders.
+//
+class CPlexTracer
+{
+public:
+  struct Event
+  {
+    const char* name;       // span names are literals, so only the pointer is kept
+    int64_t start;          // microseconds since the tracer was created
+    int64_t duration;       // microseconds, -1 for marks
+    unsigned int thread;    // small number identifying the thread
+    unsigned int play;      // the play being started, 0 if none
+  };
+
+  CPlexTracer(unsigned int maxEvents = 2048);
+
+  static CPlexTracer& GetInstance();
+
+  int64_t Now() const;
+
+  void AddSpan(const char* name, int64_t start, int64_t end);
+  void AddMark(const char* name);
+
+  // starts timing a new play, replacing any play that never got to its first frame
+  void BeginPlay(const std::string& title);
+
+  // ends the current play and logs its breakdown, returns the breakdown or "" if no play was started
+  std::string EndPlay();
+
+  std::string GetLastSummary() const;
+  void GetEvents(std::vector<Event>& events) const;
+
+  std::string GetChromeTrace() const;
+  bool SaveChromeTrace(const std::string& path) const;
+
+private:
+  unsigned int GetThreadIndex();
+  void AddEvent(const char* name, int64_t start, int64_t duration);
+
+  std::vector<Event> m_events;
+  unsigned int m_maxEvents;
+  unsigned int m_nextEvent;         // slot the next event goes into once the buffer is full
+
+  std::map<ThreadIdentifier, unsigned int> m_threads;
+  std::map<unsigned int, std::string> m_playTitles;
+
+  unsigned int m_play;
+  unsigned int m_lastPlay;
+  int64_t m_playStart;
+  std::vector<std::pair<const char*, int64_t> > m_playStages;
+  std::string m_lastSummary;
+
+  int64_t m_epoch;
+  int64_t m_frequency;
+  mutable CCriticalSection m_lock;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class CPlexTraceSpan
+{
+public:
+  CPlexTraceSpan(const char* name) : m_name(name), m_start(CPlexTracer::GetInstance().Now()) {}
+  ~CPlexTraceSpan() { CPlexTracer::GetInstance().AddSpan(m_name, m_start, CPlexTracer::GetInstance().Now()); }
+
+private:
+  const char* m_name;
+  int64_t m_start;
+};
+
+#define PLEX_TRACE_SPAN(name) CPlexTraceSpan plexTraceSpan(name)
+
+#endif /* defined(__Plex_Home_Theater__PlexTracer__) */
@@ -0,0 +1,85 @@
+#include "PlexTest.h"
+#include "PlexDownloadState.h"
+#include "utils/XBMCTinyXML.h"
+
+#define TEST_CHUNK_SIZE 1000
+
+static std::string makeData(size_t size)
+{
+  std::string data;
+  for (size_t i = 0; i < size; i++)
+    data += (char)(i * 7 + i / 13);
+  return data;
+}
+
+TEST(PlexDownloadState, sha1StateRoundTrip)
+{
+  std::string data = makeData(300);
+
+  // cut at every length, including in the middle of a 64 byte block
+  for (size_t i = 0; i <= data.size(); i += 17)
+  {
+    SHA1 first;
+    first.add(data.c_str(), i);
+
+    SHA1 second;
+    EXPECT_TRUE(second.setState(first.getState()));
+    second.add(data.c_str() + i, data.size() - i);
+
+    EXPECT_EQ(SHA1()(data.c_str(), data.size()), second.getHash());
+  }
+
+  SHA1 hash;
+  EXPECT_FALSE(hash.setState("not a state"));
+}
+
+TEST(PlexDownloadState, chunks)
+{
+  std::string data = makeData(2500);
+  CPlexDownloadState state("special://temp/test.bin", TEST_CHUNK_SIZE);
+  state.Reset("http://example.com/test.bin", data.size());
+
+  EXPECT_FALSE(state.AddData(data.c_str(), 999));
+  EXPECT_EQ(0, state.GetOffset());
+
+  // completes the first chunk and starts the second
+  EXPECT_TRUE(state.AddData(data.c_str() + 999, 2));
+  EXPECT_EQ(TEST_CHUNK_SIZE, state.GetOffset());
+
+  // two chunks at once
+  EXPECT_TRUE(state.AddData(data.c_str() + 1001, 1499));
+  EXPECT_EQ(2 * TEST_CHUNK_SIZE, state.GetOffset());
+  EXPECT_FALSE(state.IsComplete());
+
+  EXPECT_EQ(SHA1()(data.c_str(), data.size()), state.Finish());
+  EXPECT_TRUE(state.IsComplete());
+  EXPECT_EQ((int64_t)data.size(), state.GetOffset());
+}
+
+TEST(PlexDownloadState, resume)
+{
+  std::string data = makeData(4321);
+  std::string url = "http://example.com/test.bin";
+
+  CPlexDownloadState state("special://temp/test.bin", TEST_CHUNK_SIZE);
+  state.Reset(url, data.size());
+  state.AddData(data.c_str(), 2600);
+
+  TiXmlElement element("download");
+  state.ToXML(element);
+
+  // the half chunk that was added last has to be downloaded again
+  CPlexDownloadState resumed("special://temp/test.bin", TEST_CHUNK_SIZE);
+  EXPECT_TRUE(resumed.FromXML(&element));
+  EXPECT_TRUE(resumed.Matches(url, data.size()));
+  EXPECT_FALSE(resumed.Matches(url, data.size() + 1));
+  EXPECT_EQ(2 * TEST_CHUNK_SIZE, resumed.GetOffset());
+
+  resumed.AddData(data.c_str() + resumed.GetOffset(), data.size() - resumed.GetOffset());
+  EXPECT_EQ(SHA1()(data.c_str(), data.size()), resumed.Finish());
+
+  // chunks of another size can't be continued
+  CPlexDownloadState other("special://temp/test.bin", 2 * TEST_CHUNK_SIZE);
+  EXPECT_FALSE(other.FromXML(&element));
+  EXPECT_EQ(0, other.GetOffset());
+}
@@ -0,0 +1,178 @@
+#include "PlexTest.h"
+#include "PlexTestUtils.h"
+#include "PlexFlatMap.h"
+#include "FileItem.h"
+
+#include <boost/unordered_map.hpp>
+
+typedef CPlexFlatMap<std::string, int> IntMap;
+
+TEST(PlexFlatMap, insertAndFind)
+{
+  IntMap map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_TRUE(map.find("year") == map.end());
+
+  EXPECT_TRUE(map.insert(std::make_pair(std::string("year"), 2003)).second);
+  EXPECT_TRUE(map.insert(std::make_pair(std::string("duration"), 7200)).second);
+  EXPECT_TRUE(map.insert(std::make_pair(std::string("viewcount"), 2)).second);
+
+  // inserting an existing key keeps the old value
+  std::pair<IntMap::iterator, bool> res = map.insert(std::make_pair(std::string("year"), 1999));
+  EXPECT_FALSE(res.second);
+  EXPECT_EQ(2003, res.first->second);
+
+  EXPECT_EQ(3, map.size());
+  EXPECT_EQ(7200, map.find("duration")->second);
+  EXPECT_EQ(1, map.count("viewcount"));
+  EXPECT_EQ(0, map.count("index"));
+
+  map["index"] = 4;
+  map["year"] = 2004;
+  EXPECT_EQ(4, map.size());
+  EXPECT_EQ(2004, map.find("year")->second);
+
+  // iteration is sorted by key
+  std::string last;
+  for (IntMap::const_iterator it = map.begin(); it != map.end(); ++it)
+  {
+    EXPECT_LT(last, it->first);
+    last = it->first;
+  }
+}
+
+TEST(PlexFlatMap, erase)
+{
+  IntMap map;
+  map["a"] = 1;
+  map["b"] = 2;
+  map["c"] = 3;
+
+  EXPECT_EQ(1, map.erase("b"));
+  EXPECT_EQ(0, map.erase("b"));
+  map.erase(map.find("a"));
+
+  EXPECT_EQ(1, map.size());
+  EXPECT_EQ(3, map.find("c")->second);
+
+  map.compact();
+  EXPECT_EQ(3, map.find("c")->second);
+
+  map.clear();
+  EXPECT_TRUE(map.empty());
+}
+
+TEST(PlexFlatMap, itemProperties)
+{
+  CFileItem item;
+  item.SetProperty("ratingKey", "1234");
+  item.SetProperty("viewCount", 3);
+  item.SetProperty("title", "The Matrix");
+  item.CompactProperties();
+
+  EXPECT_EQ(3, item.GetAllProperties().size());
+  EXPECT_EQ(3, item.GetProperty("viewcount").asInteger());
+  EXPECT_STREQ("1234", item.GetProperty("ratingKey").asString().c_str());
+  EXPECT_TRUE(item.GetProperty("summary").isNull());
+
+  item.ClearProperty("title");
+  EXPECT_FALSE(item.HasProperty("title"));
+
+  CFileItem copy(item);
+  EXPECT_EQ(2, copy.GetAllProperties().size());
+  EXPECT_STREQ("1234", copy.GetProperty("ratingkey").asString().c_str());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// counts the memory the maps hold for their pairs and bookkeeping, not what the keys and values
+// point to, which is the same for both
+static size_t g_mapBytes = 0;
+static size_t g_mapBlocks = 0;
+
+template <typename T>
+class CCountingAllocator : public std::allocator<T>
+{
+public:
+  template <typename U> struct rebind { typedef CCountingAllocator<U> other; };
+
+  CCountingAllocator() {}
+  CCountingAllocator(const CCountingAllocator&) : std::allocator<T>() {}
+  template <typename U> CCountingAllocator(const CCountingAllocator<U>&) : std::allocator<T>() {}
+
+  T* allocate(size_t n, const void* = 0)
+  {
+    g_mapBytes += n * sizeof(T);
+    g_mapBlocks++;
+    return std::allocator<T>::allocate(n);
+  }
+
+  void deallocate(T* p, size_t n)
+  {
+    g_mapBytes -= n * sizeof(T);
+    g_mapBlocks--;
+    std::allocator<T>::deallocate(p, n);
+  }
+};
+
+typedef boost::unordered_map<CStdString, CVariant, boost::hash<CStdString>, std::equal_to<CStdString>,
+                             CCountingAllocator<std::pair<const CStdString, CVariant> > > HashPropertyMap;
+typedef CPlexFlatMap<CStdString, CVariant, std::less<CStdString>,
+                     CCountingAllocator<std::pair<CStdString, CVariant> > > FlatPropertyMap;
+
+// about what malloc adds to each block, on 64 bit glibc
+#define MALLOC_BLOCK_OVERHEAD 16
+
+TEST(PlexFlatMap, memoryPerItem)
+{
+  // a section listing of 1000 movies, with the properties the parser sets on each of them
+  std::string movie(testItem_movie);
+  std::string video = movie.substr(movie.find("<Video"), movie.find("</Video>") + 8 - movie.find("<Video"));
+  std::string xml = movie.substr(0, movie.find("<Video"));
+  for (int i = 0; i < 1000; i++)
+    xml += video;
+  xml += "</MediaContainer>";
+
+  CFileItemList list;
+  ASSERT_TRUE(PlexTestUtils::listFromXML(xml, list));
+  ASSERT_EQ(1000, list.Size());
+
+  size_t properties = 0;
+  size_t before = 0, beforeBlocks = 0;
+  size_t after = 0, afterBlocks = 0;
+  for (int i = 0; i < list.Size(); i++)
+  {
+    const PropertyMap& props = list.Get(i)->GetAllProperties();
+    properties += props.size();
+
+    // before: the hash map PropertyMap used to be
+    {
+      HashPropertyMap map;
+      for (PropertyMap::const_iterator it = props.begin(); it != props.end(); ++it)
+        map.insert(*it);
+      before += g_mapBytes;
+      beforeBlocks += g_mapBlocks;
+    }
+
+    // after: filled in the same way, then compacted like the parser does
+    {
+      FlatPropertyMap map;
+      for (PropertyMap::const_iterator it = props.begin(); it != props.end(); ++it)
+        map.insert(*it);
+      map.compact();
+      after += g_mapBytes;
+      afterBlocks += g_mapBlocks;
+    }
+  }
+  EXPECT_EQ(0, g_mapBytes);
+
+  size_t items = list.Size();
+  size_t beforePerItem = (before + beforeBlocks * MALLOC_BLOCK_OVERHEAD) / items;
+  size_t afterPerItem = (after + afterBlocks * MALLOC_BLOCK_OVERHEAD) / items;
+  printf("%u properties per item, map storage per item: hash map %u bytes in %u blocks, flat map %u bytes in %u blocks\n",
+         (unsigned int)(properties / items),
+         (unsigned int)beforePerItem, (unsigned int)(beforeBlocks / items),
+         (unsigned int)afterPerItem, (unsigned int)(afterBlocks / items));
+
+  EXPECT_LT(afterPerItem, beforePerItem);
+  EXPECT_EQ(items, afterBlocks);
+}
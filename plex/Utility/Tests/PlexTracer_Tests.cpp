@@ -0,0 +1,87 @@
+#include "PlexTest.h"
+#include "PlexTracer.h"
+
+TEST(PlexTracer, ringBuffer)
+{
+  CPlexTracer tracer(4);
+  static const char* names[] = { "a", "b", "c", "d", "e", "f" };
+  for (int i = 0; i < 6; i++)
+    tracer.AddSpan(names[i], i * 10, i * 10 + 5);
+
+  std::vector<CPlexTracer::Event> events;
+  tracer.GetEvents(events);
+  ASSERT_EQ(4, events.size());
+
+  // the oldest were dropped, the rest come oldest first
+  for (int i = 0; i < 4; i++)
+  {
+    EXPECT_STREQ(names[i + 2], events[i].name);
+    EXPECT_EQ((i + 2) * 10, events[i].start);
+    EXPECT_EQ(5, events[i].duration);
+    EXPECT_EQ(0, events[i].play);
+  }
+}
+
+TEST(PlexTracer, playSummary)
+{
+  CPlexTracer tracer;
+  EXPECT_TRUE(tracer.EndPlay().empty());
+
+  tracer.BeginPlay("Big Buck Bunny");
+  int64_t start = tracer.Now();
+  tracer.AddSpan("media decision", start, start + 400000);
+  tracer.AddSpan("open input", start + 400000, start + 500000);
+  tracer.AddSpan("open input", start + 500000, start + 700000);
+
+  // spans that started before the play aren't part of it
+  tracer.AddSpan("open codecs", start - 1000000, start + 100);
+
+  std::string summary = tracer.EndPlay();
+  EXPECT_NE(std::string::npos, summary.find("first frame of Big Buck Bunny"));
+  EXPECT_NE(std::string::npos, summary.find("media decision 0.400s"));
+  EXPECT_NE(std::string::npos, summary.find("open input 0.300s"));
+  EXPECT_EQ(std::string::npos, summary.find("open codecs"));
+  EXPECT_EQ(summary, tracer.GetLastSummary());
+
+  // the play is over
+  EXPECT_TRUE(tracer.EndPlay().empty());
+
+  std::vector<CPlexTracer::Event> events;
+  tracer.GetEvents(events);
+  ASSERT_EQ(6, events.size());
+  EXPECT_STREQ("play", events[0].name);
+  EXPECT_EQ(-1, events[0].duration);
+  EXPECT_EQ(1, events[1].play);
+  EXPECT_STREQ("first frame", events[5].name);
+}
+
+TEST(PlexTracer, stagesByName)
+{
+  CPlexTracer tracer;
+  tracer.BeginPlay("Sintel");
+  int64_t start = tracer.Now();
+
+  // the same literal in two translation units can have two addresses
+  static const char first[] = "open input";
+  static const char second[] = "open input";
+  tracer.AddSpan(first, start, start + 100000);
+  tracer.AddSpan(second, start + 100000, start + 300000);
+
+  std::string summary = tracer.EndPlay();
+  EXPECT_NE(std::string::npos, summary.find("open input 0.300s"));
+  EXPECT_EQ(summary.find("open input"), summary.rfind("open input"));
+}
+
+TEST(PlexTracer, chromeTrace)
+{
+  CPlexTracer tracer;
+  tracer.AddSpan("open demuxer", 100, 350);
+  tracer.BeginPlay("\"Quoted\" title");
+  tracer.AddMark("click");
+
+  std::string json = tracer.GetChromeTrace();
+  EXPECT_EQ(0, json.find("{\"traceEvents\":["));
+  EXPECT_NE(std::string::npos, json.find("\"name\":\"open demuxer\",\"cat\":\"playback\",\"pid\":1,\"tid\":1,\"ts\":100,\"ph\":\"X\",\"dur\":250}"));
+  EXPECT_NE(std::string::npos, json.find("\"ph\":\"i\""));
+  EXPECT_NE(std::string::npos, json.find("\"title\":\"\\\"Quoted\\\" title\""));
+}
@@ -271,6 +271,7 @@
 #include "plex/Remote/PlexRemoteSubscriberManager.h"
 #include "plex/CrashReporter/Breakpad.h"
 #include "plex/PlexThemeMusicPlayer.h"
+#include "plex/Playlists/PlexPlayQueueLookahead.h"
 #include "plex/Client/PlexTranscoderClient.h"
 #include "plex/GUI/GUIDialogPlexError.h"
 /* END PLEX */
@@ -2357,8 +2358,8 @@ void CApplication::Render()
 
   // reset our info cache - we do this at the end of Render so that it is
   // fresh for the next process(), or after a windowclose animation (where process()
-  // isn't called)
-  g_infoManager.ResetCache();
+  // isn't called). Only bools whose inputs changed since the last frame are reset.
+  g_infoManager.ResetCache(true);
 
 
   unsigned int now = XbmcThreads::SystemClockMillis();
@@ -4287,6 +4288,7 @@ bool CApplication::PlayFile(const CFileItem& item_, bool bRestart)
 
   CSingleLock lock(m_playStateMutex);
   m_bPlaybackStarting = false;
+  g_infoManager.NotifyChanged(INFO::DEPENDS_PLAYER);
 
   if (bResult)
   {
@@ -4334,6 +4336,8 @@ bool CApplication::PlayFile(const CFileItem& item_, bool bRestart)
 
 void CApplication::OnPlayBackEnded()
 {
+  g_infoManager.NotifyChanged(INFO::DEPENDS_PLAYER);
+
   CSingleLock lock(m_playStateMutex);
   CLog::Log(LOGDEBUG,"%s : play state was %d, starting %d", __FUNCTION__, m_ePlayState, m_bPlaybackStarting);
   m_ePlayState = PLAY_STATE_ENDED;
@@ -4365,6 +4369,8 @@ void CApplication::OnPlayBackEnded()
 
 void CApplication::OnPlayBackStarted()
 {
+  g_infoManager.NotifyChanged(INFO::DEPENDS_PLAYER);
+
   CSingleLock lock(m_playStateMutex);
   CLog::Log(LOGDEBUG,"%s : play state was %d, starting %d", __FUNCTION__, m_ePlayState, m_bPlaybackStarting);
   m_ePlayState = PLAY_STATE_PLAYING;
@@ -4408,6 +4414,8 @@ void CApplication::OnQueueNextItem()
 
 void CApplication::OnPlayBackStopped()
 {
+  g_infoManager.NotifyChanged(INFO::DEPENDS_PLAYER);
+
   CSingleLock lock(m_playStateMutex);
   CLog::Log(LOGDEBUG, "%s : play state was %d, starting %d", __FUNCTION__, m_ePlayState, m_bPlaybackStarting);
   m_ePlayState = PLAY_STATE_STOPPED;
@@ -4437,6 +4445,8 @@ void CApplication::OnPlayBackStopped()
 
 void CApplication::OnPlayBackPaused()
 {
+  g_infoManager.NotifyChanged(INFO::DEPENDS_PLAYER);
+
 #ifdef HAS_PYTHON
   g_pythonParser.OnPlayBackPaused();
 #endif
@@ -4449,6 +4459,8 @@ void CApplication::OnPlayBackPaused()
 
 void CApplication::OnPlayBackResumed()
 {
+  g_infoManager.NotifyChanged(INFO::DEPENDS_PLAYER);
+
 #ifdef HAS_PYTHON
   g_pythonParser.OnPlayBackResumed();
 #endif
@@ -4461,6 +4473,8 @@ void CApplication::OnPlayBackResumed()
 
 void CApplication::OnPlayBackSpeedChanged(int iSpeed)
 {
+  g_infoManager.NotifyChanged(INFO::DEPENDS_PLAYER);
+
 #ifdef HAS_PYTHON
   g_pythonParser.OnPlayBackSpeedChanged(iSpeed);
 #endif
@@ -5369,6 +5383,12 @@ void CApplication::ProcessSlow()
   // Store our file state for use on close()
   UpdateFileState();
 
+  /* PLEX */
+  // open the next play queue item shortly before this one ends
+  if (m_pPlayer->IsPlaying() && g_plexApplication.playQueueLookahead)
+    g_plexApplication.playQueueLookahead->onProgress(GetTime(), GetTotalTime());
+  /* END PLEX */
+
   if (m_pPlayer->IsPlayingAudio())
   {
     CLastfmScrobbler::GetInstance()->UpdateStatus();
@@ -123,6 +123,8 @@ CGUIInfoManager::CGUIInfoManager(void) :
   m_seekOffset = 0;
   m_nextWindowID = WINDOW_INVALID;
   m_prevWindowID = WINDOW_INVALID;
+  m_changedDependencies = 0;
+  m_lastResetTime = 0;
   m_stringParameters.push_back("__ZZZZ__");   // to offset the string parameters by 1 to assure that all entries are non-zero
   m_currentFile = CFileItemPtr(new CFileItem);
   m_currentSlide = new CFileItem;
@@ -163,6 +165,7 @@ bool CGUIInfoManager::OnMessage(CGUIMessage &message)
       if (m_currentFile->IsSamePath(item.get()))
       {
         m_currentFile->UpdateInfo(*item);
+        NotifyChanged(DEPENDS_ITEM);
         return true;
       }
     }
@@ -2277,14 +2280,6 @@ bool CGUIInfoManager::GetInt(int &value, int info, int contextWindow, const CGUI
   return false;
 }
 
-// functor for comparison InfoPtr's
-struct InfoBoolFinder
-{
-  InfoBoolFinder(const std::string &expression, int context) : m_bool(expression, context) {};
-  bool operator() (const InfoPtr &right) const { return m_bool == *right; };
-  InfoBool m_bool;
-};
-
 INFO::InfoPtr CGUIInfoManager::Register(const CStdString &expression, int context)
 {
   CStdString condition(CGUIInfoLabel::ReplaceLocalize(expression));
@@ -2294,18 +2289,31 @@ INFO::InfoPtr CGUIInfoManager::Register(const CStdString &expression, int contex
   if (condition.IsEmpty())
     return INFO::InfoPtr();
 
+  // InfoBool compares lower cased expressions, so index them the same way
+  CStdString normalized(condition);
+  normalized.ToLower();
+  InfoBoolKey key(normalized, context);
+
   CSingleLock lock(m_critInfo);
   // do we have the boolean expression already registered?
-  vector<InfoPtr>::const_iterator i = find_if(m_bools.begin(), m_bools.end(), InfoBoolFinder(condition, context));
-  if (i != m_bools.end())
-    return *i;
+  InfoBoolIndex::const_iterator i = m_boolIndex.find(key);
+  if (i != m_boolIndex.end())
+  {
+    InfoPtr info = i->second.lock();
+    if (info)
+      return info;
+  }
 
+  // note that InfoExpression registers its sub-expressions while being constructed
+  InfoPtr info;
   if (condition.find_first_of("|+[]!") != condition.npos)
-    m_bools.push_back(boost::make_shared<InfoExpression>(condition, context));
+    info = boost::make_shared<InfoExpression>(condition, context);
   else
-    m_bools.push_back(boost::make_shared<InfoSingle>(condition, context));
+    info = boost::make_shared<InfoSingle>(condition, context);
 
-  return m_bools.back();
+  m_bools.push_back(info);
+  m_boolIndex[key] = info;
+  return info;
 }
 
 bool CGUIInfoManager::EvaluateBool(const CStdString &expression, int contextWindow /* = 0 */, const CGUIListItemPtr &item /* = NULL */)
@@ -4497,6 +4505,7 @@ void CGUIInfoManager::ResetCurrentItem()
   m_currentFile->Reset();
   m_currentMovieThumb = "";
   m_currentMovieDuration = "";
+  NotifyChanged(DEPENDS_ITEM);
 
   /* PLEX */
   if (art.empty() == false)
@@ -4522,6 +4531,7 @@ void CGUIInfoManager::SetCurrentItem(CFileItem &item)
       *m_currentFile->GetEPGInfoTag() = tag;
   }
 
+  NotifyChanged(DEPENDS_ITEM);
   SetChanged();
   NotifyObservers(ObservableMessageCurrentItem);
 }
@@ -4540,6 +4550,7 @@ void CGUIInfoManager::SetCurrentAlbumThumb(const CStdString thumbFileName)
 void CGUIInfoManager::SetCurrentSong(CFileItem &item)
 {
   CLog::Log(LOGDEBUG,"CGUIInfoManager::SetCurrentSong(%s)",item.GetPath().c_str());
+  NotifyChanged(DEPENDS_ITEM);
   /* PLEX */
   if (m_currentFile->HasArt("thumb") && m_currentFile->GetArt("thumb") == "special://temp/airtunes_album_thumb.jpg" && !item.HasArt("thumb"))
     item.SetArt("thumb", m_currentFile->GetArt("thumb"));
@@ -4591,6 +4602,7 @@ void CGUIInfoManager::SetCurrentSong(CFileItem &item)
 void CGUIInfoManager::SetCurrentMovie(CFileItem &item)
 {
   CLog::Log(LOGDEBUG,"CGUIInfoManager::SetCurrentMovie(%s)",item.GetPath().c_str());
+  NotifyChanged(DEPENDS_ITEM);
   *m_currentFile = item;
 
   /* also call GetMovieInfo() when a VideoInfoTag is already present or additional info won't be present in the tag */
@@ -4782,12 +4794,23 @@ void CGUIInfoManager::Clear()
     will remove those bools that are no longer dependencies of other bools
     in the vector.
    */
-  vector<InfoPtr>::iterator i = remove_if(m_bools.begin(), m_bools.end(), std::mem_fun_ref(&InfoPtr::unique));
-  while (i != m_bools.end())
+  size_t count;
+  do
   {
-    m_bools.erase(i, m_bools.end());
-    i = remove_if(m_bools.begin(), m_bools.end(), std::mem_fun_ref(&InfoPtr::unique));
-  }
+    count = m_bools.size();
+    vector<InfoPtr> used;
+    used.reserve(count);
+    for (vector<InfoPtr>::const_iterator i = m_bools.begin(); i != m_bools.end(); ++i)
+    {
+      if (i->unique())
+        m_boolIndex.erase(InfoBoolKey((*i)->GetExpression(), (*i)->GetContext()));
+      else
+        used.push_back(*i);
+    }
+    // the unused bools (and thus their references to dependencies) are released along with 'used'
+    m_bools.swap(used);
+  } while (m_bools.size() != count);
+
   // log which ones are used - they should all be gone by now
   for (vector<InfoPtr>::const_iterator i = m_bools.begin(); i != m_bools.end(); ++i)
     CLog::Log(LOGDEBUG, "Infobool '%s' still used by %u instances", (*i)->GetExpression().c_str(), (unsigned int) i->use_count());
@@ -5835,14 +5858,108 @@ bool CGUIInfoManager::GetItemBool(const CGUIListItem *item, int condition) const
 }
 #endif
 
-void CGUIInfoManager::ResetCache()
+void CGUIInfoManager::ResetCache(bool changedOnly /* = false */)
 {
   // reset any animation triggers as well
   m_containerMoves.clear();
+
+  unsigned int changed = DEPENDS_ALWAYS;
+  if (changedOnly)
+  {
+    CSingleLock lock(m_critChanged);
+    changed |= m_changedDependencies;
+    m_changedDependencies = 0;
+
+    time_t now = time(NULL);
+    if (now != m_lastResetTime)
+    {
+      changed |= DEPENDS_TIME;
+      m_lastResetTime = now;
+    }
+  }
+
   // mark our infobools as dirty
   CSingleLock lock(m_critInfo);
   for (vector<InfoPtr>::iterator i = m_bools.begin(); i != m_bools.end(); ++i)
-    (*i)->SetDirty();
+  {
+    if (!changedOnly || ((*i)->GetDependencies() & changed))
+      (*i)->SetDirty();
+  }
+}
+
+void CGUIInfoManager::NotifyChanged(unsigned int dependencies)
+{
+  CSingleLock lock(m_critChanged);
+  m_changedDependencies |= dependencies;
+}
+
+unsigned int CGUIInfoManager::GetInfoDependencies(int condition) const
+{
+  condition = abs(condition);
+  if (condition >= MULTI_INFO_START && condition <= MULTI_INFO_END)
+  {
+    const GUIInfo &info = m_multiInfo[condition - MULTI_INFO_START];
+    switch (info.m_info)
+    {
+      case SKIN_BOOL:
+      case SKIN_STRING:
+      case SKIN_HAS_THEME:
+      case SYSTEM_GET_BOOL:
+        return DEPENDS_SETTING;
+      case WINDOW_NEXT:
+      case WINDOW_PREVIOUS:
+      case WINDOW_IS_VISIBLE:
+      case WINDOW_IS_TOPMOST:
+      case WINDOW_IS_ACTIVE:
+        return DEPENDS_WINDOW;
+      case SYSTEM_DATE:
+      case SYSTEM_TIME:
+        return DEPENDS_TIME;
+      default:
+        return DEPENDS_ALWAYS;
+    }
+  }
+
+  switch (condition)
+  {
+    case SYSTEM_ALWAYS_TRUE:
+    case SYSTEM_ALWAYS_FALSE:
+    case SYSTEM_ETHERNET_LINK_ACTIVE:
+    case SYSTEM_PLATFORM_LINUX:
+    case SYSTEM_PLATFORM_WINDOWS:
+    case SYSTEM_PLATFORM_DARWIN:
+    case SYSTEM_PLATFORM_DARWIN_OSX:
+    case SYSTEM_PLATFORM_DARWIN_IOS:
+    case SYSTEM_PLATFORM_DARWIN_ATV2:
+    case SYSTEM_PLATFORM_ANDROID:
+      return DEPENDS_NONE;
+    case PLAYER_HAS_MEDIA:
+    case PLAYER_HAS_AUDIO:
+    case PLAYER_HAS_VIDEO:
+    case PLAYER_PLAYING:
+    case PLAYER_PAUSED:
+    case PLAYER_REWINDING:
+    case PLAYER_REWINDING_2x:
+    case PLAYER_REWINDING_4x:
+    case PLAYER_REWINDING_8x:
+    case PLAYER_REWINDING_16x:
+    case PLAYER_REWINDING_32x:
+    case PLAYER_FORWARDING:
+    case PLAYER_FORWARDING_2x:
+    case PLAYER_FORWARDING_4x:
+    case PLAYER_FORWARDING_8x:
+    case PLAYER_FORWARDING_16x:
+    case PLAYER_FORWARDING_32x:
+    case PLAYER_SHOWINFO:
+    case PLAYER_SHOWCODEC:
+      return DEPENDS_PLAYER;
+    case VIDEOPLAYER_HAS_INFO:
+      return DEPENDS_ITEM;
+    case WINDOW_IS_MEDIA:
+      return DEPENDS_WINDOW;
+    default:
+      return DEPENDS_ALWAYS;
+  }
 }
 
 // Called from tuxbox service thread to update current status
@@ -5973,6 +6090,7 @@ void CGUIInfoManager::SetCurrentVideoTag(const CVideoInfoTag &tag)
 {
   *m_currentFile->GetVideoInfoTag() = tag;
   m_currentFile->m_lStartOffset = 0;
+  NotifyChanged(DEPENDS_ITEM);
 }
 
 void CGUIInfoManager::SetCurrentSongTag(const MUSIC_INFO::CMusicInfoTag &tag)
@@ -5980,6 +6098,7 @@ void CGUIInfoManager::SetCurrentSongTag(const MUSIC_INFO::CMusicInfoTag &tag)
   //CLog::Log(LOGDEBUG, "Asked to SetCurrentTag");
   *m_currentFile->GetMusicInfoTag() = tag;
   m_currentFile->m_lStartOffset = 0;
+  NotifyChanged(DEPENDS_ITEM);
 }
 
 const CFileItem& CGUIInfoManager::GetCurrentSlide() const
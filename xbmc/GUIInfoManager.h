@@ -38,6 +38,8 @@
 
 #include <list>
 #include <map>
+#include <boost/unordered_map.hpp>
+#include <boost/weak_ptr.hpp>
 
 /* PLEX */
 #include "ThumbLoader.h"
@@ -825,10 +827,10 @@ public:
   bool GetDisplayAfterSeek();
   void SetDisplayAfterSeek(unsigned int timeOut = 2500, int seekOffset = 0);
   void SetShowTime(bool showtime) { m_playerShowTime = showtime; };
-  void SetShowCodec(bool showcodec) { m_playerShowCodec = showcodec; };
-  void SetShowInfo(bool showinfo) { m_playerShowInfo = showinfo; };
-  void ToggleShowCodec() { m_playerShowCodec = !m_playerShowCodec; };
-  bool ToggleShowInfo() { m_playerShowInfo = !m_playerShowInfo; return m_playerShowInfo; };
+  void SetShowCodec(bool showcodec) { m_playerShowCodec = showcodec; NotifyChanged(INFO::DEPENDS_PLAYER); };
+  void SetShowInfo(bool showinfo) { m_playerShowInfo = showinfo; NotifyChanged(INFO::DEPENDS_PLAYER); };
+  void ToggleShowCodec() { m_playerShowCodec = !m_playerShowCodec; NotifyChanged(INFO::DEPENDS_PLAYER); };
+  bool ToggleShowInfo() { m_playerShowInfo = !m_playerShowInfo; NotifyChanged(INFO::DEPENDS_PLAYER); return m_playerShowInfo; };
 
   std::string GetSystemHeatInfo(int info);
   CTemperature GetGPUTemperature();
@@ -837,10 +839,26 @@ public:
   void UpdateAVInfo();
   inline float GetFPS() const { return m_fps; };
 
-  void SetNextWindow(int windowID) { m_nextWindowID = windowID; };
-  void SetPreviousWindow(int windowID) { m_prevWindowID = windowID; };
+  void SetNextWindow(int windowID) { m_nextWindowID = windowID; NotifyChanged(INFO::DEPENDS_WINDOW); };
+  void SetPreviousWindow(int windowID) { m_prevWindowID = windowID; NotifyChanged(INFO::DEPENDS_WINDOW); };
+
+  /*! \brief Mark registered bools dirty so that they are re-evaluated on their next use
+   \param changedOnly only mark the bools depending on state that changed since the last call, see NotifyChanged()
+   */
+  void ResetCache(bool changedOnly = false);
+
+  /*! \brief Notify that state info bools may depend on has changed
+   Safe to call from any thread. Bools depending on the state are marked dirty in the next ResetCache(true).
+   \param dependencies INFO::InfoDependency flags of the state that changed
+   */
+  void NotifyChanged(unsigned int dependencies);
+
+  /*! \brief Get the state a condition depends on
+   \param condition the condition as returned from TranslateSingleString
+   \return INFO::InfoDependency flags, INFO::DEPENDS_ALWAYS if the condition has to be evaluated every frame
+   */
+  unsigned int GetInfoDependencies(int condition) const;
 
-  void ResetCache();
   bool GetItemInt(int &value, const CGUIListItem *item, int info) const;
   CStdString GetItemLabel(const CFileItem *item, int info, CStdString *fallback = NULL);
   CStdString GetItemImage(const CFileItem *item, int info, CStdString *fallback = NULL);
@@ -978,6 +996,13 @@ protected:
   int m_prevWindowID;
 
   std::vector<INFO::InfoPtr> m_bools;
+
+  /*! \brief Index of m_bools keyed on the lower cased expression and context.
+   Holds weak references so that Clear() can still detect bools that are no longer used.
+   */
+  typedef std::pair<std::string, int> InfoBoolKey;
+  typedef boost::unordered_map<InfoBoolKey, boost::weak_ptr<INFO::InfoBool> > InfoBoolIndex;
+  InfoBoolIndex m_boolIndex;
   std::vector<INFO::CSkinVariableString> m_skinVariableStrings;
 
   int m_libraryHasMusic;
@@ -991,6 +1016,10 @@ protected:
 
   CCriticalSection m_critInfo;
 
+  unsigned int m_changedDependencies;   ///< INFO::InfoDependency flags changed since the last ResetCache(true)
+  time_t m_lastResetTime;               ///< wall clock second of the last ResetCache(true)
+  CCriticalSection m_critChanged;
+
   /* PLEX */
   int TranslateVideoPlayerString(const CStdString& info) const;
   bool GetItemBool(const CGUIListItem *item, int condition, int secondCondition=0) const;
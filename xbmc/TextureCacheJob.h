@@ -70,6 +70,7 @@ public:
 
   virtual const char* GetType() const { return "cacheimage"; };
   virtual bool operator==(const CJob *job) const;
+  virtual std::string GetIdentity() const { return m_cachePath; };
   virtual bool DoWork();
 
   /*! \brief retrieve a hash for the given image
@@ -140,6 +141,7 @@ public:
 
   virtual const char* GetType() const { return "ddscompress"; };
   virtual bool operator==(const CJob *job) const;
+  virtual std::string GetIdentity() const { return m_original; };
   virtual bool DoWork();
 
   CStdString m_original;
@@ -142,8 +142,22 @@ bool CTextureDatabase::UpdateOldVersion(int version)
 
 bool CTextureDatabase::IncrementUseCount(const CTextureDetails &details)
 {
-  CStdString sql = PrepareSQL("UPDATE sizes SET usecount=usecount+1, lastusetime=CURRENT_TIMESTAMP WHERE idtexture=%u AND width=%u AND height=%u", details.id, details.width, details.height);
-  return ExecuteQuery(sql);
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+
+    std::auto_ptr<dbiplus::Cursor> cursor(m_pDB->CreateCursor("UPDATE sizes SET usecount=usecount+1, lastusetime=CURRENT_TIMESTAMP WHERE idtexture=? AND width=? AND height=?"));
+    cursor->bind(1, details.id);
+    cursor->bind(2, (int)details.width);
+    cursor->bind(3, (int)details.height);
+    cursor->exec();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed on texture %i", __FUNCTION__, details.id);
+  }
+  return false;
 }
 
 bool CTextureDatabase::GetCachedTexture(const CStdString &url, CTextureDetails &details)
@@ -151,24 +165,22 @@ bool CTextureDatabase::GetCachedTexture(const CStdString &url, CTextureDetails &
   try
   {
     if (NULL == m_pDB.get()) return false;
-    if (NULL == m_pDS.get()) return false;
 
-    CStdString sql = PrepareSQL("SELECT id, cachedurl, lasthashcheck, imagehash, width, height FROM texture JOIN sizes ON (texture.id=sizes.idtexture AND sizes.size=1) WHERE url='%s'", url.c_str());
-    m_pDS->query(sql.c_str());
-    if (!m_pDS->eof())
+    // looked up for every image shown, so use a cached statement rather than a dataset
+    std::auto_ptr<dbiplus::Cursor> cursor(m_pDB->CreateCursor("SELECT id, cachedurl, lasthashcheck, imagehash, width, height FROM texture JOIN sizes ON (texture.id=sizes.idtexture AND sizes.size=1) WHERE url=?"));
+    cursor->bind(1, url);
+    if (cursor->step())
     { // have some information
-      details.id = m_pDS->fv(0).get_asInt();
-      details.file  = m_pDS->fv(1).get_asString();
+      details.id = cursor->getInt(0);
+      details.file  = cursor->getString(1);
       CDateTime lastCheck;
-      lastCheck.SetFromDBDateTime(m_pDS->fv(2).get_asString());
+      lastCheck.SetFromDBDateTime(cursor->getString(2));
       if (lastCheck.IsValid() && lastCheck + CDateTimeSpan(1,0,0,0) < CDateTime::GetCurrentDateTime())
-        details.hash = m_pDS->fv(3).get_asString();
-      details.width = m_pDS->fv(4).get_asInt();
-      details.height = m_pDS->fv(5).get_asInt();
-      m_pDS->close();
+        details.hash = cursor->getString(3);
+      details.width = cursor->getInt(4);
+      details.height = cursor->getInt(5);
       return true;
     }
-    m_pDS->close();
   }
   catch (...)
   {
@@ -251,21 +263,17 @@ CStdString CTextureDatabase::GetTextureForPath(const CStdString &url, const CStd
   try
   {
     if (NULL == m_pDB.get()) return "";
-    if (NULL == m_pDS.get()) return "";
 
     if (url.empty())
       return "";
 
-    CStdString sql = PrepareSQL("select texture from path where url='%s' and type='%s'", url.c_str(), type.c_str());
-    m_pDS->query(sql.c_str());
-
-    if (!m_pDS->eof())
+    std::auto_ptr<dbiplus::Cursor> cursor(m_pDB->CreateCursor("select texture from path where url=? and type=?"));
+    cursor->bind(1, url);
+    cursor->bind(2, type);
+    if (cursor->step())
     { // have some information
-      CStdString texture = m_pDS->fv(0).get_asString();
-      m_pDS->close();
-      return texture;
+      return cursor->getString(0);
     }
-    m_pDS->close();
   }
   catch (...)
   {
@@ -284,18 +292,23 @@ void CTextureDatabase::SetTextureForPath(const CStdString &url, const CStdString
     if (url.empty())
       return;
 
-    CStdString sql = PrepareSQL("select id from path where url='%s' and type='%s'", url.c_str(), type.c_str());
-    m_pDS->query(sql.c_str());
-    if (!m_pDS->eof())
+    int pathID = -1;
+    {
+      std::auto_ptr<dbiplus::Cursor> cursor(m_pDB->CreateCursor("select id from path where url=? and type=?"));
+      cursor->bind(1, url);
+      cursor->bind(2, type);
+      if (cursor->step())
+        pathID = cursor->getInt(0);
+    }
+
+    CStdString sql;
+    if (pathID >= 0)
     { // update
-      int pathID = m_pDS->fv(0).get_asInt();
-      m_pDS->close();
       sql = PrepareSQL("update path set texture='%s' where id=%u", texture.c_str(), pathID);
       m_pDS->exec(sql.c_str());
     }
     else
     { // add the texture
-      m_pDS->close();
       sql = PrepareSQL("insert into path (id, url, type, texture) values(NULL, '%s', '%s', '%s')", url.c_str(), type.c_str(), texture.c_str());
       m_pDS->exec(sql.c_str());
     }
@@ -194,6 +194,8 @@ void CSkinInfo::LoadIncludes()
   CLog::Log(LOGINFO, "Loading skin includes from %s", includesPath.c_str());
   m_includes.ClearIncludes();
   m_includes.LoadIncludes(includesPath);
+
+  m_precompiled.SetCachePath(URIUtils::AddFileToFolder("special://temp/skincache/", ID()));
 }
 
 void CSkinInfo::ResolveIncludes(TiXmlElement *node, std::map<INFO::InfoPtr, bool>* xmlIncludeConditions /* = NULL */)
@@ -204,6 +206,24 @@ void CSkinInfo::ResolveIncludes(TiXmlElement *node, std::map<INFO::InfoPtr, bool
   m_includes.ResolveIncludes(node, xmlIncludeConditions);
 }
 
+TiXmlElement *CSkinInfo::LoadPrecompiledWindow(const CStdString &xmlFile, const RESOLUTION_INFO &res, std::map<INFO::InfoPtr, bool> &xmlIncludeConditions)
+{
+  std::vector<CStdString> includeFiles;
+  TiXmlElement *root = m_precompiled.Load(xmlFile, res, m_Version, xmlIncludeConditions, includeFiles);
+  if (root)
+  {
+    // skin variables defined in include files are looked up when the controls are created
+    for (std::vector<CStdString>::const_iterator it = includeFiles.begin(); it != includeFiles.end(); ++it)
+      m_includes.LoadIncludes(*it);
+  }
+  return root;
+}
+
+void CSkinInfo::StorePrecompiledWindow(const CStdString &xmlFile, const RESOLUTION_INFO &res, const TiXmlElement *node, const std::map<INFO::InfoPtr, bool> &xmlIncludeConditions)
+{
+  m_precompiled.Store(xmlFile, res, m_Version, node, xmlIncludeConditions, m_includes.GetFiles());
+}
+
 int CSkinInfo::GetStartWindow() const
 {
 #ifndef __PLEX__
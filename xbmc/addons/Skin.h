@@ -23,6 +23,7 @@
 #include "Addon.h"
 #include "guilib/GraphicContext.h" // needed for the RESOLUTION members
 #include "guilib/GUIIncludes.h"    // needed for the GUIInclude member
+#include "guilib/GUISkinCache.h"   // needed for the precompiled window member
 #define CREDIT_LINE_LENGTH 50
 
 class TiXmlNode;
@@ -93,6 +94,19 @@ public:
 
   void ResolveIncludes(TiXmlElement *node, std::map<INFO::InfoPtr, bool>* xmlIncludeConditions = NULL);
 
+  /*! \brief Load a window with its includes already resolved from the precompiled cache
+   \param xmlFile path of the window XML file
+   \param res resolution the window is loaded in
+   \param xmlIncludeConditions [out] include conditions the resolved window depends on
+   \return the resolved root element, owned by the caller, or NULL if the window needs to be parsed
+   */
+  TiXmlElement *LoadPrecompiledWindow(const CStdString &xmlFile, const RESOLUTION_INFO &res, std::map<INFO::InfoPtr, bool> &xmlIncludeConditions);
+
+  /*! \brief Store a window after ResolveIncludes() so that following loads can skip parsing it
+   \sa LoadPrecompiledWindow
+   */
+  void StorePrecompiledWindow(const CStdString &xmlFile, const RESOLUTION_INFO &res, const TiXmlElement *node, const std::map<INFO::InfoPtr, bool> &xmlIncludeConditions);
+
   float GetEffectsSlowdown() const { return m_effectsSlowDown; };
 
   const std::vector<CStartupWindow> &GetStartupWindows() const { return m_startupWindows; };
@@ -134,6 +148,7 @@ protected:
 
   float m_effectsSlowDown;
   CGUIIncludes m_includes;
+  CGUISkinCache m_precompiled;
   CStdString m_currentAspect;
 
   std::vector<CStartupWindow> m_startupWindows;
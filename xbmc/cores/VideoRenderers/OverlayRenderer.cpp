@@ -93,12 +93,14 @@ long COverlayMainThread::Release()
 
 CRenderer::CRenderer()
 {
+  m_ssa = NULL;
 }
 
 CRenderer::~CRenderer()
 {
   for(int i = 0; i < NUM_BUFFERS; i++)
     Release(m_buffers[i]);
+  delete m_ssa;
 }
 
 void CRenderer::AddOverlay(CDVDOverlay* o, double pts, int index)
@@ -158,6 +160,10 @@ void CRenderer::Flush()
     Release(m_buffers[i]);
 
   Release(m_cleanup);
+
+  if(m_ssa)
+    m_ssa->Flush();
+  m_ssaQuads.reset();
 }
 
 void CRenderer::Release(int idx)
@@ -358,20 +364,32 @@ COverlay* CRenderer::Convert(CDVDOverlaySSA* o, double pts)
   }
   else
     position = 0.0;
-  int changes = 0;
-  ASS_Image* images = o->m_libass->RenderImage(targetWidth, targetHeight, videoWidth, videoHeight, pts, useMargin, position, &changes);
+
+  // the quads are usually rendered ahead already, and unchanged frames share them
+  if(!m_ssa)
+    m_ssa = new CSSARenderAhead(g_advancedSettings.m_videoAssRenderAhead);
+
+  SSSAParams params;
+  params.frameWidth  = targetWidth;
+  params.frameHeight = targetHeight;
+  params.videoWidth  = videoWidth;
+  params.videoHeight = videoHeight;
+  params.useMargin   = useMargin;
+  params.position    = position;
+  SQuadsPtr quads = m_ssa->Get(o->m_libass, params, pts);
 
   if(o->m_overlay)
   {
-    if(changes == 0)
+    if(quads == m_ssaQuads)
       return o->m_overlay->Acquire();
   }
+  m_ssaQuads = quads;
 
   COverlay *overlay = NULL;
 #if defined(HAS_GL) || defined(HAS_GLES)
-  overlay = new COverlayGlyphGL(images, targetWidth, targetHeight);
+  overlay = new COverlayGlyphGL(*quads, targetWidth, targetHeight);
 #elif defined(HAS_DX)
-  overlay = new COverlayQuadsDX(images, targetWidth, targetHeight);
+  overlay = new COverlayQuadsDX(*quads, targetWidth, targetHeight);
 #endif
   // scale to video dimensions
   if (overlay)
@@ -24,6 +24,7 @@
 
 #include "threads/CriticalSection.h"
 #include "BaseRenderer.h"
+#include "OverlayRendererSSA.h"
 
 #include <vector>
 
@@ -132,5 +133,8 @@ namespace OVERLAY {
     SElementV        m_buffers[NUM_BUFFERS];
 
     COverlayV        m_cleanup;
+
+    CSSARenderAhead* m_ssa;
+    SQuadsPtr        m_ssaQuads; /* what the last ssa overlay was made from */
   };
 }
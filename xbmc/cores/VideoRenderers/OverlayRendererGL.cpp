@@ -290,7 +290,7 @@ COverlayTextureGL::COverlayTextureGL(CDVDOverlaySpu* o)
   m_pma    = !!USE_PREMULTIPLIED_ALPHA;
 }
 
-COverlayGlyphGL::COverlayGlyphGL(ASS_Image* images, int width, int height)
+COverlayGlyphGL::COverlayGlyphGL(const SQuads& quads, int width, int height)
 {
   m_vertex = NULL;
   m_width  = 1.0;
@@ -301,8 +301,7 @@ COverlayGlyphGL::COverlayGlyphGL(ASS_Image* images, int width, int height)
   m_y      = 0.0f;
   m_texture = 0;
 
-  SQuads quads;
-  if(!convert_quad(images, quads))
+  if(quads.count == 0)
     return;
 
   glGenTextures(1, &m_texture);
@@ -328,7 +327,7 @@ COverlayGlyphGL::COverlayGlyphGL(ASS_Image* images, int width, int height)
   m_vertex = (VERTEX*)calloc(m_count * 4, sizeof(VERTEX));
 
   VERTEX* vt = m_vertex;
-  SQuad*  vs = quads.quad;
+  const SQuad* vs = quads.quad;
 
   for(int i=0; i < quads.count; i++)
   {
@@ -54,7 +54,7 @@ namespace OVERLAY {
      : public COverlayMainThread
   {
   public:
-   COverlayGlyphGL(ASS_Image* images, int width, int height);
+   COverlayGlyphGL(const SQuads& quads, int width, int height);
 
    virtual ~COverlayGlyphGL();
 
@@ -0,0 +1,236 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "OverlayRendererSSA.h"
+#include "OverlayRendererUtil.h"
+#include "cores/dvdplayer/DVDClock.h"
+#include "cores/dvdplayer/DVDSubtitles/DVDSubtitlesLibass.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+
+using namespace OVERLAY;
+
+/* frames further apart than this are a seek or a pause, not the frame rate */
+#define SSA_MAX_INTERVAL DVD_MSEC_TO_TIME(200)
+
+SSSAParams::SSSAParams()
+{
+  frameWidth  = 0;
+  frameHeight = 0;
+  videoWidth  = 0;
+  videoHeight = 0;
+  useMargin   = 0;
+  position    = 0.0;
+}
+
+bool SSSAParams::operator==(const SSSAParams& right) const
+{
+  return frameWidth  == right.frameWidth
+      && frameHeight == right.frameHeight
+      && videoWidth  == right.videoWidth
+      && videoHeight == right.videoHeight
+      && useMargin   == right.useMargin
+      && position    == right.position;
+}
+
+CSSARenderAhead::CSSARenderAhead(int frames) : CThread("SSARenderAhead")
+{
+  m_ahead      = frames > 0 ? frames : 0;
+  m_libass     = NULL;
+  m_version    = 0;
+  m_generation = 0;
+  m_pts        = DVD_NOPTS_VALUE;
+  m_interval   = 0.0;
+  m_hits       = 0;
+  m_misses     = 0;
+}
+
+CSSARenderAhead::~CSSARenderAhead()
+{
+  m_bStop = true;
+  m_wake.Set();
+  StopThread();
+  Flush();
+}
+
+void CSSARenderAhead::Flush()
+{
+  CSingleLock lock(m_section);
+  if (m_hits || m_misses)
+    CLog::Log(LOGDEBUG, "CSSARenderAhead::Flush - %u of %u subtitle frames were rendered ahead", m_hits, m_hits + m_misses);
+
+  Reset(NULL, SSSAParams(), 0);
+  m_hits   = 0;
+  m_misses = 0;
+}
+
+unsigned int CSSARenderAhead::GetHits() const
+{
+  CSingleLock lock(m_section);
+  return m_hits;
+}
+
+unsigned int CSSARenderAhead::GetMisses() const
+{
+  CSingleLock lock(m_section);
+  return m_misses;
+}
+
+void CSSARenderAhead::Reset(CDVDSubtitlesLibass* libass, const SSSAParams& params, int version)
+{
+  if (libass)
+    libass->Acquire();
+  if (m_libass)
+    m_libass->Release();
+
+  m_libass   = libass;
+  m_params   = params;
+  m_version  = version;
+  m_pts      = DVD_NOPTS_VALUE;
+  m_interval = 0.0;
+  m_frames.clear();
+  m_generation++;
+
+  /* libass compares against what the renderer drew last, which may have been
+   * for another track or target size */
+  CSingleLock lock(m_render);
+  m_last.reset();
+}
+
+SQuadsPtr CSSARenderAhead::Get(CDVDSubtitlesLibass* libass, const SSSAParams& params, double pts)
+{
+  CSingleLock lock(m_section);
+
+  int version = libass ? libass->GetVersion() : 0;
+  if (libass != m_libass || params != m_params)
+    Reset(libass, params, version);
+  else if (version != m_version)
+  {
+    /* new events usually arrive well ahead, but may start in a frame rendered already */
+    m_version = version;
+    m_frames.clear();
+    m_generation++;
+  }
+
+  if (m_pts != DVD_NOPTS_VALUE && pts > m_pts && pts - m_pts <= SSA_MAX_INTERVAL)
+    m_interval = pts - m_pts;
+  m_pts = pts;
+
+  /* what's before the current frame won't be asked for again */
+  SFrames::iterator it = FindFrame(pts);
+  m_frames.erase(m_frames.begin(), it == m_frames.end() ? m_frames.lower_bound(DVD_TIME_TO_MSEC(pts)) : it);
+
+  if (m_ahead > 0 && !IsRunning())
+    Create();
+
+  if (it != m_frames.end())
+  {
+    m_hits++;
+    m_wake.Set();
+    return it->second;
+  }
+
+  m_misses++;
+  unsigned int generation = m_generation;
+  lock.Leave();
+
+  SQuadsPtr quads = RenderFrame(libass, params, pts);
+
+  lock.Enter();
+  if (generation == m_generation)
+    m_frames[DVD_TIME_TO_MSEC(pts)] = quads;
+  m_wake.Set();
+  return quads;
+}
+
+CSSARenderAhead::SFrames::iterator CSSARenderAhead::FindFrame(double pts)
+{
+  /* libass works in milliseconds, predicted pts may round the other way */
+  int ms = DVD_TIME_TO_MSEC(pts);
+  SFrames::iterator it = m_frames.lower_bound(ms - 1);
+  if (it != m_frames.end() && it->first <= ms + 1)
+    return it;
+  return m_frames.end();
+}
+
+bool CSSARenderAhead::NextFrame(double& pts)
+{
+  if (m_pts == DVD_NOPTS_VALUE || m_interval <= 0.0)
+    return false;
+
+  for (int i = 1; i <= m_ahead; i++)
+  {
+    pts = m_pts + i * m_interval;
+    if (FindFrame(pts) == m_frames.end())
+      return true;
+  }
+  return false;
+}
+
+SQuadsPtr CSSARenderAhead::RenderFrame(CDVDSubtitlesLibass* libass, const SSSAParams& params, double pts)
+{
+  CSingleLock lock(m_render);
+  m_last = Render(libass, params, pts, m_last);
+  return m_last;
+}
+
+SQuadsPtr CSSARenderAhead::Render(CDVDSubtitlesLibass* libass, const SSSAParams& params, double pts, const SQuadsPtr& last)
+{
+  int changes = 2;
+  ASS_Image* images = libass->RenderImage(params.frameWidth, params.frameHeight, params.videoWidth, params.videoHeight, pts, params.useMargin, params.position, &changes);
+  if (last && changes == 0)
+    return last;
+
+  /* an empty frame still gets quads, so unchanged frames can be told apart from unrendered ones */
+  SQuadsPtr quads(new SQuads());
+  if (!convert_quad(images, *quads))
+    quads.reset(new SQuads());
+  return quads;
+}
+
+void CSSARenderAhead::Process()
+{
+  while (!m_bStop)
+  {
+    m_wake.Wait();
+
+    while (!m_bStop)
+    {
+      CSingleLock lock(m_section);
+
+      double pts;
+      if (!NextFrame(pts))
+        break;
+
+      CDVDSubtitlesLibass* libass = m_libass ? m_libass->Acquire() : NULL;
+      SSSAParams params = m_params;
+      unsigned int generation = m_generation;
+      lock.Leave();
+
+      SQuadsPtr quads = RenderFrame(libass, params, pts);
+      if (libass)
+        libass->Release();
+
+      lock.Enter();
+      if (generation == m_generation)
+        m_frames[DVD_TIME_TO_MSEC(pts)] = quads;
+    }
+  }
+}
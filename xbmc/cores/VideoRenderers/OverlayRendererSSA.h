@@ -0,0 +1,106 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <map>
+#include <boost/shared_ptr.hpp>
+
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/Thread.h"
+
+class CDVDSubtitlesLibass;
+
+namespace OVERLAY {
+
+  struct SQuads;
+  typedef boost::shared_ptr<SQuads> SQuadsPtr;
+
+  /* where libass renders to, see CRenderer::Convert(CDVDOverlaySSA*, double) */
+  struct SSSAParams
+  {
+    SSSAParams();
+    bool operator==(const SSSAParams& right) const;
+    bool operator!=(const SSSAParams& right) const { return !(*this == right); }
+
+    int    frameWidth;
+    int    frameHeight;
+    int    videoWidth;
+    int    videoHeight;
+    int    useMargin;
+    double position;
+  };
+
+  /* Renders ass/ssa subtitles into quads a number of video frames ahead of
+   * the one being shown, so the render thread only has to upload them.
+   *
+   * The next frames are predicted from the pts and frame interval of the
+   * frames asked for so far. A frame that wasn't rendered ahead in time is
+   * rendered when it's asked for, like it used to be. Frames libass reports
+   * as unchanged share the quads of the frame before them, so callers can
+   * tell unchanged frames apart by comparing the pointers.
+   *
+   * All rendering of a libass instance has to go through here, since the
+   * libass change detection is relative to whatever was rendered last. */
+  class CSSARenderAhead : private CThread
+  {
+  public:
+             CSSARenderAhead(int frames);
+    virtual ~CSSARenderAhead();
+
+    SQuadsPtr Get(CDVDSubtitlesLibass* libass, const SSSAParams& params, double pts);
+    void      Flush();
+
+    unsigned int GetHits() const;
+    unsigned int GetMisses() const;
+
+  protected:
+    /* renders and converts a frame, returning last when libass says nothing changed */
+    virtual SQuadsPtr Render(CDVDSubtitlesLibass* libass, const SSSAParams& params, double pts, const SQuadsPtr& last);
+    virtual void      Process();
+
+  private:
+    typedef std::map<int, SQuadsPtr> SFrames;
+
+    SQuadsPtr         RenderFrame(CDVDSubtitlesLibass* libass, const SSSAParams& params, double pts);
+    SFrames::iterator FindFrame(double pts);
+    bool              NextFrame(double& pts);
+    void              Reset(CDVDSubtitlesLibass* libass, const SSSAParams& params, int version);
+
+    int                  m_ahead;
+    CDVDSubtitlesLibass* m_libass;
+    SSSAParams           m_params;
+    int                  m_version;
+    unsigned int         m_generation; /* bumped whenever the cached frames become invalid */
+    double               m_pts;
+    double               m_interval;
+    SFrames              m_frames;
+    unsigned int         m_hits;
+    unsigned int         m_misses;
+    CEvent               m_wake;
+    mutable CCriticalSection m_section;
+
+    /* serializes the libass calls, m_last is what they rendered last */
+    CCriticalSection     m_render;
+    SQuadsPtr            m_last;
+  };
+
+}
@@ -38,6 +38,7 @@
 #include "URL.h"
 #include "utils/log.h"
 #include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
 
 #ifdef HAVE_LIBBLURAY
 #include "DVDInputStreams/DVDInputStreamBluray.h"
@@ -59,6 +60,7 @@ extern "C" {
 /* PLEX */
 #include "guilib/LocalizeStrings.h"
 #include "FileSystem/PlexFile.h"
+#include "Utility/PlexTracer.h"
 #include <boost/foreach.hpp>
 
 typedef std::pair<std::string, std::string> stringPair;
@@ -466,8 +468,42 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput, bool streaminfo, bool filein
     if(m_pInput->IsStreamType(DVDSTREAM_TYPE_DVD))
       av_opt_set_int(m_pFormatContext, "analyzeduration", 500000, 0);
 
+    // files that were analysed before only need a short look to confirm their streams
+    std::string probeKey = GetProbeCacheKey(strFile);
+    CDVDDemuxProbeCache::Entry probe;
+    bool probeHit = !probeKey.empty() && CDVDDemuxProbeCache::GetInstance().Get(probeKey, probe) && MatchesProbeCache(probe);
+    int64_t analyzeDuration = 0;
+    std::vector<int> probeApplied;
+    if (probeHit)
+    {
+      CLog::Log(LOGDEBUG, "%s - using cached stream info for %s", __FUNCTION__, strFile.c_str());
+      ApplyProbeCache(probe, probeApplied);
+      av_opt_get_int(m_pFormatContext, "analyzeduration", 0, &analyzeDuration);
+      av_opt_set_int(m_pFormatContext, "analyzeduration", 500000, 0);
+    }
+
     CLog::Log(LOGDEBUG, "%s - avformat_find_stream_info starting", __FUNCTION__);
-    int iErr = avformat_find_stream_info(m_pFormatContext, NULL);
+    int iErr;
+    /* PLEX */
+    // the span only covers the probing, not storing its result below
+    {
+      PLEX_TRACE_SPAN("find stream info");
+      iErr = avformat_find_stream_info(m_pFormatContext, NULL);
+      if (probeHit && (iErr < 0 || !MatchesProbeCache(probe)))
+      {
+        CLog::Log(LOGDEBUG, "%s - cached stream info doesn't match %s, analysing again", __FUNCTION__, strFile.c_str());
+        CDVDDemuxProbeCache::GetInstance().Remove(probeKey);
+        // analyse from what the container headers told, not from the cached values
+        UndoProbeCache(probeApplied);
+        av_opt_set_int(m_pFormatContext, "analyzeduration", analyzeDuration, 0);
+        iErr = avformat_find_stream_info(m_pFormatContext, NULL);
+        probeHit = false;
+      }
+    }
+    /* END PLEX */
+    if (iErr >= 0 && !probeHit && !probeKey.empty())
+      AddToProbeCache(probeKey);
+
     if (iErr < 0)
     {
       CLog::Log(LOGWARNING,"could not find codec parameters for %s", strFile.c_str());
@@ -1095,6 +1131,210 @@ double CDVDDemuxFFmpeg::SelectAspect(AVStream* st, bool& forced)
   return 0.0;
 }
 
+std::string CDVDDemuxFFmpeg::GetProbeCacheKey(const std::string &strFile)
+{
+  // discs switch titles, and transcoder output differs between sessions
+  if (m_pInput->IsStreamType(DVDSTREAM_TYPE_DVD) || m_pInput->IsStreamType(DVDSTREAM_TYPE_BLURAY))
+    return "";
+  if (strFile.find("/transcode/") != std::string::npos)
+    return "";
+
+  // a file replaced on the server can keep its url and size, but not its part or the item's updatedAt
+  std::string version;
+  const CFileItem &item = m_pInput->GetFileItem();
+  if (item.m_selectedMediaPart)
+    version = item.m_selectedMediaPart->GetProperty("id").asString();
+  if (item.HasProperty("updatedAt"))
+  {
+    version += "@" + item.GetProperty("updatedAt").asString();
+  }
+  else if (!URIUtils::IsInternetStream(CURL(strFile)))
+  {
+    struct __stat64 st;
+    if (XFILE::CFile::Stat(strFile, &st) == 0)
+      version += StringUtils::Format("@%" PRId64, (int64_t)st.st_mtime);
+  }
+
+  return CDVDDemuxProbeCache::GetKey(strFile, m_pInput->GetLength(), version);
+}
+
+bool CDVDDemuxFFmpeg::MatchesProbeCache(const CDVDDemuxProbeCache::Entry &entry)
+{
+  if (entry.format != m_pFormatContext->iformat->name || entry.streams.size() != m_pFormatContext->nb_streams)
+    return false;
+
+  for (unsigned int i = 0; i < m_pFormatContext->nb_streams; i++)
+  {
+    const AVCodecContext *codec = m_pFormatContext->streams[i]->codec;
+    const CDVDDemuxProbeCache::Stream &stream = entry.streams[i];
+    if (codec->codec_type != stream.type)
+      return false;
+    if (codec->codec_id != AV_CODEC_ID_NONE && codec->codec_id != stream.codecId)
+      return false;
+  }
+  return true;
+}
+
+// the fields ApplyProbeCache() filled in, per stream
+enum
+{
+  PROBE_CODEC_ID       = 0x001,
+  PROBE_CODEC_TAG      = 0x002,
+  PROBE_SIZE           = 0x004,
+  PROBE_PIX_FMT        = 0x008,
+  PROBE_SAMPLE_RATE    = 0x010,
+  PROBE_CHANNELS       = 0x020,
+  PROBE_CHANNEL_LAYOUT = 0x040,
+  PROBE_SAMPLE_FMT     = 0x080,
+  PROBE_FRAME_SIZE     = 0x100,
+  PROBE_EXTRADATA      = 0x200
+};
+
+void CDVDDemuxFFmpeg::ApplyProbeCache(const CDVDDemuxProbeCache::Entry &entry, std::vector<int> &applied)
+{
+  applied.assign(m_pFormatContext->nb_streams, 0);
+
+  // only fill in what the container headers didn't tell already
+  for (unsigned int i = 0; i < m_pFormatContext->nb_streams; i++)
+  {
+    AVCodecContext *codec = m_pFormatContext->streams[i]->codec;
+    const CDVDDemuxProbeCache::Stream &stream = entry.streams[i];
+    int &flags = applied[i];
+
+    if (codec->codec_id == AV_CODEC_ID_NONE)
+    {
+      codec->codec_id = (AVCodecID)stream.codecId;
+      flags |= PROBE_CODEC_ID;
+    }
+    if (!codec->codec_tag)
+    {
+      codec->codec_tag = stream.codecTag;
+      flags |= PROBE_CODEC_TAG;
+    }
+
+    if (codec->codec_type == AVMEDIA_TYPE_VIDEO)
+    {
+      if (!codec->width || !codec->height)
+      {
+        codec->width = stream.width;
+        codec->height = stream.height;
+        flags |= PROBE_SIZE;
+      }
+      if (codec->pix_fmt == AV_PIX_FMT_NONE)
+      {
+        codec->pix_fmt = (AVPixelFormat)stream.pixFmt;
+        flags |= PROBE_PIX_FMT;
+      }
+    }
+    else if (codec->codec_type == AVMEDIA_TYPE_AUDIO)
+    {
+      if (!codec->sample_rate)
+      {
+        codec->sample_rate = stream.sampleRate;
+        flags |= PROBE_SAMPLE_RATE;
+      }
+      if (!codec->channels)
+      {
+        codec->channels = stream.channels;
+        flags |= PROBE_CHANNELS;
+      }
+      if (!codec->channel_layout)
+      {
+        codec->channel_layout = stream.channelLayout;
+        flags |= PROBE_CHANNEL_LAYOUT;
+      }
+      if (codec->sample_fmt == AV_SAMPLE_FMT_NONE)
+      {
+        codec->sample_fmt = (AVSampleFormat)stream.sampleFmt;
+        flags |= PROBE_SAMPLE_FMT;
+      }
+      if (!codec->frame_size)
+      {
+        codec->frame_size = stream.frameSize;
+        flags |= PROBE_FRAME_SIZE;
+      }
+    }
+
+    if (!codec->extradata && !stream.extraData.empty())
+    {
+      codec->extradata = (uint8_t*)av_mallocz(stream.extraData.size() + FF_INPUT_BUFFER_PADDING_SIZE);
+      if (codec->extradata)
+      {
+        memcpy(codec->extradata, stream.extraData.c_str(), stream.extraData.size());
+        codec->extradata_size = stream.extraData.size();
+        flags |= PROBE_EXTRADATA;
+      }
+    }
+  }
+}
+
+void CDVDDemuxFFmpeg::UndoProbeCache(const std::vector<int> &applied)
+{
+  // back to what the container headers told, so the streams are analysed as if never cached
+  for (unsigned int i = 0; i < applied.size() && i < m_pFormatContext->nb_streams; i++)
+  {
+    AVCodecContext *codec = m_pFormatContext->streams[i]->codec;
+    int flags = applied[i];
+
+    if (flags & PROBE_CODEC_ID)
+      codec->codec_id = AV_CODEC_ID_NONE;
+    if (flags & PROBE_CODEC_TAG)
+      codec->codec_tag = 0;
+    if (flags & PROBE_SIZE)
+    {
+      codec->width = 0;
+      codec->height = 0;
+    }
+    if (flags & PROBE_PIX_FMT)
+      codec->pix_fmt = AV_PIX_FMT_NONE;
+    if (flags & PROBE_SAMPLE_RATE)
+      codec->sample_rate = 0;
+    if (flags & PROBE_CHANNELS)
+      codec->channels = 0;
+    if (flags & PROBE_CHANNEL_LAYOUT)
+      codec->channel_layout = 0;
+    if (flags & PROBE_SAMPLE_FMT)
+      codec->sample_fmt = AV_SAMPLE_FMT_NONE;
+    if (flags & PROBE_FRAME_SIZE)
+      codec->frame_size = 0;
+    if (flags & PROBE_EXTRADATA)
+    {
+      av_freep(&codec->extradata);
+      codec->extradata_size = 0;
+    }
+  }
+}
+
+void CDVDDemuxFFmpeg::AddToProbeCache(const std::string &key)
+{
+  if (!m_pFormatContext->nb_streams)
+    return;
+
+  CDVDDemuxProbeCache::Entry entry;
+  entry.format = m_pFormatContext->iformat->name;
+  for (unsigned int i = 0; i < m_pFormatContext->nb_streams; i++)
+  {
+    const AVCodecContext *codec = m_pFormatContext->streams[i]->codec;
+    CDVDDemuxProbeCache::Stream stream;
+    stream.type = codec->codec_type;
+    stream.codecId = codec->codec_id;
+    stream.codecTag = codec->codec_tag;
+    stream.width = codec->width;
+    stream.height = codec->height;
+    stream.pixFmt = codec->pix_fmt;
+    stream.sampleRate = codec->sample_rate;
+    stream.channels = codec->channels;
+    stream.channelLayout = codec->channel_layout;
+    stream.sampleFmt = codec->sample_fmt;
+    stream.frameSize = codec->frame_size;
+    if (codec->extradata && codec->extradata_size > 0)
+      stream.extraData.assign((const char*)codec->extradata, codec->extradata_size);
+    entry.streams.push_back(stream);
+  }
+
+  CDVDDemuxProbeCache::GetInstance().Add(key, entry);
+}
+
 void CDVDDemuxFFmpeg::CreateStreams(unsigned int program)
 {
   DisposeStreams();
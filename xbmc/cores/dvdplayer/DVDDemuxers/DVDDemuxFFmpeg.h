@@ -21,6 +21,7 @@
  */
 
 #include "DVDDemux.h"
+#include "DVDDemuxProbeCache.h"
 #include "threads/CriticalSection.h"
 #include "threads/SystemClock.h"
 #include <map>
@@ -146,6 +147,12 @@ protected:
   void GetL16Parameters(int &channels, int &samplerate);
   double SelectAspect(AVStream* st, bool& forced);
 
+  std::string GetProbeCacheKey(const std::string &strFile);
+  bool MatchesProbeCache(const CDVDDemuxProbeCache::Entry &entry);
+  void ApplyProbeCache(const CDVDDemuxProbeCache::Entry &entry, std::vector<int> &applied);
+  void UndoProbeCache(const std::vector<int> &applied);
+  void AddToProbeCache(const std::string &key);
+
   CCriticalSection m_critSection;
   std::map<int, CDemuxStream*> m_streams;
   std::vector<std::map<int, CDemuxStream*>::iterator> m_stream_index;
@@ -0,0 +1,239 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DVDDemuxProbeCache.h"
+#include "filesystem/File.h"
+#include "threads/SingleLock.h"
+#include "URL.h"
+#include "utils/Base64.h"
+#include "utils/log.h"
+#include "utils/StringUtils.h"
+#include "utils/XBMCTinyXML.h"
+
+#include <algorithm>
+#include <inttypes.h>
+#include <stdlib.h>
+
+using namespace std;
+
+CDVDDemuxProbeCache::Stream::Stream()
+{
+  type = -1;
+  codecId = 0;
+  codecTag = 0;
+  width = 0;
+  height = 0;
+  pixFmt = -1;
+  sampleRate = 0;
+  channels = 0;
+  channelLayout = 0;
+  sampleFmt = -1;
+  frameSize = 0;
+}
+
+CDVDDemuxProbeCache::CDVDDemuxProbeCache(const string &file, unsigned int maxEntries)
+{
+  m_file = file;
+  m_maxEntries = maxEntries;
+  m_clock = 0;
+  m_loaded = false;
+}
+
+CDVDDemuxProbeCache &CDVDDemuxProbeCache::GetInstance()
+{
+  static CDVDDemuxProbeCache cache("special://temp/probecache.xml");
+  return cache;
+}
+
+string CDVDDemuxProbeCache::GetKey(const string &path, int64_t size, const string &version)
+{
+  if (size <= 0)
+    return "";
+
+  CURL url(path);
+  url.SetOptions("");
+  url.SetProtocolOptions("");
+  url.SetUserName("");
+  url.SetPassword("");
+  return StringUtils::Format("%s|%" PRId64 "|%s", url.Get().c_str(), size, version.c_str());
+}
+
+bool CDVDDemuxProbeCache::Get(const string &key, Entry &entry)
+{
+  CSingleLock lock(m_critSection);
+  Load();
+
+  EntryMap::iterator it = m_entries.find(key);
+  if (it == m_entries.end())
+    return false;
+
+  it->second.lastUsed = ++m_clock;
+  entry = it->second.entry;
+  return true;
+}
+
+void CDVDDemuxProbeCache::Add(const string &key, const Entry &entry)
+{
+  if (key.empty() || !m_maxEntries)
+    return;
+
+  CSingleLock lock(m_critSection);
+  Load();
+
+  if (m_entries.find(key) == m_entries.end())
+  {
+    while (m_entries.size() >= m_maxEntries)
+    {
+      EntryMap::iterator oldest = m_entries.begin();
+      for (EntryMap::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+      {
+        if (it->second.lastUsed < oldest->second.lastUsed)
+          oldest = it;
+      }
+      m_entries.erase(oldest);
+    }
+  }
+
+  CachedEntry &cached = m_entries[key];
+  cached.entry = entry;
+  cached.lastUsed = ++m_clock;
+  Save();
+}
+
+void CDVDDemuxProbeCache::Remove(const string &key)
+{
+  CSingleLock lock(m_critSection);
+  Load();
+
+  if (m_entries.erase(key))
+    Save();
+}
+
+unsigned int CDVDDemuxProbeCache::GetSize()
+{
+  CSingleLock lock(m_critSection);
+  Load();
+  return m_entries.size();
+}
+
+void CDVDDemuxProbeCache::Load()
+{
+  if (m_loaded)
+    return;
+  m_loaded = true;
+
+  if (!XFILE::CFile::Exists(m_file))
+    return;
+
+  CXBMCTinyXML doc;
+  if (!doc.LoadFile(m_file))
+  {
+    CLog::Log(LOGERROR, "%s - Unable to load: %s, Line %d\n%s", __FUNCTION__, m_file.c_str(), doc.ErrorRow(), doc.ErrorDesc());
+    return;
+  }
+
+  const TiXmlElement *root = doc.RootElement();
+  if (!root || root->ValueStr() != "probecache")
+    return;
+
+  // files are stored least recently used first
+  for (const TiXmlElement *file = root->FirstChildElement("file"); file; file = file->NextSiblingElement("file"))
+  {
+    const char *key = file->Attribute("key");
+    const char *format = file->Attribute("format");
+    if (!key || !format)
+      continue;
+
+    CachedEntry cached;
+    cached.entry.format = format;
+    for (const TiXmlElement *element = file->FirstChildElement("stream"); element; element = element->NextSiblingElement("stream"))
+    {
+      Stream stream;
+      int codecTag = 0;
+      element->QueryIntAttribute("type", &stream.type);
+      element->QueryIntAttribute("codec", &stream.codecId);
+      element->QueryIntAttribute("tag", &codecTag);
+      element->QueryIntAttribute("width", &stream.width);
+      element->QueryIntAttribute("height", &stream.height);
+      element->QueryIntAttribute("pixfmt", &stream.pixFmt);
+      element->QueryIntAttribute("samplerate", &stream.sampleRate);
+      element->QueryIntAttribute("channels", &stream.channels);
+      element->QueryIntAttribute("samplefmt", &stream.sampleFmt);
+      element->QueryIntAttribute("framesize", &stream.frameSize);
+      stream.codecTag = (unsigned int)codecTag;
+      if (element->Attribute("layout"))
+        stream.channelLayout = strtoull(element->Attribute("layout"), NULL, 10);
+      if (element->FirstChild())
+        stream.extraData = Base64::Decode(element->FirstChild()->ValueStr());
+      cached.entry.streams.push_back(stream);
+    }
+
+    cached.lastUsed = ++m_clock;
+    m_entries[key] = cached;
+  }
+}
+
+void CDVDDemuxProbeCache::Save() const
+{
+  vector<pair<unsigned int, const EntryMap::value_type*> > order;
+  for (EntryMap::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+    order.push_back(make_pair(it->second.lastUsed, &*it));
+  sort(order.begin(), order.end());
+
+  CXBMCTinyXML doc;
+  TiXmlElement rootElement("probecache");
+  TiXmlNode *root = doc.InsertEndChild(rootElement);
+  if (!root)
+    return;
+
+  for (size_t i = 0; i < order.size(); i++)
+  {
+    const Entry &entry = order[i].second->second.entry;
+    TiXmlElement fileElement("file");
+    fileElement.SetAttribute("key", order[i].second->first);
+    fileElement.SetAttribute("format", entry.format);
+
+    for (vector<Stream>::const_iterator stream = entry.streams.begin(); stream != entry.streams.end(); ++stream)
+    {
+      TiXmlElement streamElement("stream");
+      streamElement.SetAttribute("type", stream->type);
+      streamElement.SetAttribute("codec", stream->codecId);
+      streamElement.SetAttribute("tag", (int)stream->codecTag);
+      streamElement.SetAttribute("width", stream->width);
+      streamElement.SetAttribute("height", stream->height);
+      streamElement.SetAttribute("pixfmt", stream->pixFmt);
+      streamElement.SetAttribute("samplerate", stream->sampleRate);
+      streamElement.SetAttribute("channels", stream->channels);
+      streamElement.SetAttribute("layout", StringUtils::Format("%" PRIu64, stream->channelLayout));
+      streamElement.SetAttribute("samplefmt", stream->sampleFmt);
+      streamElement.SetAttribute("framesize", stream->frameSize);
+      if (!stream->extraData.empty())
+      {
+        TiXmlText extraData(Base64::Encode(stream->extraData));
+        streamElement.InsertEndChild(extraData);
+      }
+      fileElement.InsertEndChild(streamElement);
+    }
+    root->InsertEndChild(fileElement);
+  }
+
+  if (!doc.SaveFile(m_file))
+    CLog::Log(LOGERROR, "%s - Unable to save: %s", __FUNCTION__, m_file.c_str());
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "threads/CriticalSection.h"
+
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/*!
+ \brief Persistent cache of the stream layout found by probing a file.
+
+ avformat_find_stream_info reads and decodes up to several seconds of a file to find the
+ codec parameters of each stream, which for remote files means many ranged reads before
+ playback can start. The parameters of a file don't change between plays, so once a file
+ was analysed they are kept here, keyed by its location and size, and the demuxer fills
+ them in up front the next time the file is opened.
+
+ The cache holds plain values so it doesn't depend on the FFmpeg headers. The least
+ recently used files are dropped once it is full, and it is written to disk whenever
+ it changes.
+ */
+class CDVDDemuxProbeCache
+{
+public:
+  struct Stream
+  {
+    Stream();
+
+    int type;          // AVMediaType
+    int codecId;       // AVCodecID
+    unsigned int codecTag;
+    int width;
+    int height;
+    int pixFmt;        // AVPixelFormat
+    int sampleRate;
+    int channels;
+    uint64_t channelLayout;
+    int sampleFmt;     // AVSampleFormat
+    int frameSize;
+    std::string extraData;
+  };
+
+  struct Entry
+  {
+    std::string format;
+    std::vector<Stream> streams;
+  };
+
+  CDVDDemuxProbeCache(const std::string &file, unsigned int maxEntries = 64);
+
+  static CDVDDemuxProbeCache &GetInstance();
+
+  /*! \brief Get the key a file is cached under
+   \param path the path or url of the file, options such as access tokens are ignored
+   \param size size of the file in bytes, so a replaced file doesn't match
+   \param version eg. the part id and modification time, a replaced file of the same size doesn't match either
+   \return the key, or an empty string if the file can't be cached
+   */
+  static std::string GetKey(const std::string &path, int64_t size, const std::string &version = "");
+
+  /*! \brief Look up the streams of a file
+   \param key the key from GetKey
+   \param entry [out] the format and streams found when the file was analysed
+   \return true if the file was cached
+   */
+  bool Get(const std::string &key, Entry &entry);
+
+  /*! \brief Remember the streams of a file that was analysed */
+  void Add(const std::string &key, const Entry &entry);
+
+  /*! \brief Forget a file, eg. because the cached streams didn't match it anymore */
+  void Remove(const std::string &key);
+
+  unsigned int GetSize();
+
+private:
+  struct CachedEntry
+  {
+    Entry entry;
+    unsigned int lastUsed;
+  };
+  typedef std::map<std::string, CachedEntry> EntryMap;
+
+  void Load();
+  void Save() const;
+
+  EntryMap m_entries;
+  std::string m_file;
+  unsigned int m_maxEntries;
+  unsigned int m_clock;
+  bool m_loaded;
+  CCriticalSection m_critSection;
+};
@@ -179,6 +179,9 @@ public:
   virtual BitstreamStats GetBitstreamStats() const { return m_stats; }
 
   void SetFileItem(const CFileItem& item);
+  /* PLEX */
+  const CFileItem& GetFileItem() const { return m_item; }
+  /* END PLEX */
 
 protected:
   DVDStreamType m_streamType;
@@ -93,6 +93,7 @@
 #include "Client/PlexTranscoderClient.h"
 #include "PlexApplication.h"
 #include "FileSystem/PlexFile.h"
+#include "Utility/PlexTracer.h"
 
 static StreamType ConvertPlexStreamType(int plexStreamType);
 static void UpdatePlexSelectionStream(SelectionStream &s, const CFileItemPtr &part);
@@ -646,6 +647,10 @@ void CDVDPlayer::OnStartup()
 
 bool CDVDPlayer::OpenInputStream()
 {
+  /* PLEX */
+  PLEX_TRACE_SPAN("open input");
+  /* END PLEX */
+
   if(m_pInputStream)
     SAFE_DELETE(m_pInputStream);
 
@@ -791,6 +796,10 @@ bool CDVDPlayer::OpenInputStream()
 
 bool CDVDPlayer::OpenDemuxStream()
 {
+  /* PLEX */
+  PLEX_TRACE_SPAN("open demuxer");
+  /* END PLEX */
+
   if(m_pDemuxer)
     SAFE_DELETE(m_pDemuxer);
 
@@ -832,6 +841,10 @@ bool CDVDPlayer::OpenDemuxStream()
 
 void CDVDPlayer::OpenDefaultStreams(bool reset)
 {
+  /* PLEX */
+  PLEX_TRACE_SPAN("open codecs");
+  /* END PLEX */
+
   // if input stream dictate, we will open later
   if(m_dvd.iSelectedAudioStream >= 0
   || m_dvd.iSelectedSPUStream   >= 0)
@@ -2547,6 +2560,10 @@ void CDVDPlayer::HandleMessages()
         m_clock.SetSpeed(speed);
         m_dvdPlayerAudio->SetSpeed(speed);
         m_dvdPlayerVideo->SetSpeed(speed);
+        /* PLEX */
+        // the application already notified when it asked for the speed, it only applies now
+        g_infoManager.NotifyChanged(INFO::DEPENDS_PLAYER);
+        /* END PLEX */
 
         // We can't pause demuxer until our buffers are full. Doing so will result in continued
         // calls to Read() which may then block indefinitely (CDVDInputStreamRTMP for example).
@@ -2648,6 +2665,11 @@ void CDVDPlayer::HandleMessages()
           m_CurrentVideo.started = true;
         CLog::Log(LOGDEBUG, "CDVDPlayer::HandleMessages - player started %d", player);
 
+        /* PLEX */
+        if (player == DVDPLAYER_VIDEO || (player == DVDPLAYER_AUDIO && !m_HasVideo))
+          CPlexTracer::GetInstance().EndPlay();
+        /* END PLEX */
+
         if (m_omxplayer_mode)
         {
           if ((player == DVDPLAYER_AUDIO || player == DVDPLAYER_VIDEO) &&
@@ -2740,6 +2762,10 @@ void CDVDPlayer::SetCaching(ECacheState state)
     m_pInputStream->ResetScanTimeout(0);
   }
   m_caching = state;
+  /* PLEX */
+  // IsPaused() includes caching
+  g_infoManager.NotifyChanged(INFO::DEPENDS_PLAYER);
+  /* END PLEX */
 
   m_clock.SetSpeedAdjust(0);
   if (m_omxplayer_mode)
@@ -45,6 +45,7 @@ CDVDSubtitlesLibass::CDVDSubtitlesLibass()
   m_library = NULL;
   m_renderer = NULL;
   m_references = 1;
+  m_version = 0;
 
   if(!m_dll.Load())
   {
@@ -118,6 +119,7 @@ bool CDVDSubtitlesLibass::DecodeHeader(char* data, int size)
   }
 
   m_dll.ass_process_codec_private(m_track, data, size);
+  m_version++;
   return true;
 }
 
@@ -131,6 +133,7 @@ bool CDVDSubtitlesLibass::DecodeDemuxPkt(char* data, int size, double start, dou
   }
 
   m_dll.ass_process_chunk(m_track, data, size, DVD_TIME_TO_MSEC(start), DVD_TIME_TO_MSEC(duration));
+  m_version++;
   return true;
 }
 
@@ -149,6 +152,7 @@ bool CDVDSubtitlesLibass::CreateTrack(char* buf, size_t size)
   if(m_track == NULL)
     return false;
 
+  m_version++;
   return true;
 }
 
@@ -191,3 +195,8 @@ int CDVDSubtitlesLibass::GetNrOfEvents()
   return m_track->n_events;
 }
 
+int CDVDSubtitlesLibass::GetVersion()
+{
+  CSingleLock lock(m_section);
+  return m_version;
+}
@@ -37,6 +37,9 @@ public:
 
   int GetNrOfEvents();
 
+  /* changes whenever events are added to the track */
+  int GetVersion();
+
   bool DecodeHeader(char* data, int size);
   bool DecodeDemuxPkt(char* data, int size, double start, double duration);
   bool CreateTrack(char* buf, size_t size);
@@ -47,6 +50,7 @@ private:
   ASS_Library* m_library;
   ASS_Track* m_track;
   ASS_Renderer* m_renderer;
+  int m_version;
   CCriticalSection m_section;
 };
 
@@ -36,11 +36,11 @@ CAudioDecoder::CAudioDecoder()
   m_status = STATUS_NO_FILE;
   m_canPlay = false;
 
-  // output buffer (for transferring data from the Pcm Buffer to the rest of the audio chain)
-  memset(&m_outputBuffer, 0, OUTPUT_SAMPLES * sizeof(float));
-  memset(&m_pcmInputBuffer, 0, INPUT_SIZE * sizeof(BYTE));
-  memset(&m_inputBuffer, 0, INPUT_SAMPLES * sizeof(float));
-
+  /* PLEX */
+  m_packetSamples = 0;
+  m_bytesPerSecond = 0;
+  m_queueBytes = 0;
+  /* END PLEX */
 }
 
 CAudioDecoder::~CAudioDecoder()
@@ -62,7 +62,7 @@ void CAudioDecoder::Destroy()
   m_canPlay = false;
 }
 
-bool CAudioDecoder::Create(const CFileItem &file, int64_t seekOffset)
+bool CAudioDecoder::Create(const CFileItem &file, int64_t seekOffset, unsigned int queueMs)
 {
   Destroy();
 
@@ -122,8 +122,30 @@ bool CAudioDecoder::Create(const CFileItem &file, int64_t seekOffset)
     return false;
   }
 
-  /* allocate the pcmBuffer for 2 seconds of audio */
-  m_pcmBuffer.Create(2 * blockSize * m_codec->m_SampleRate);
+  /* PLEX */
+  unsigned int channels = m_codec->GetChannelInfo().Count();
+  unsigned int bytesPerSample = m_codec->m_BitsPerSample >> 3;
+
+  /* read whole frames, and more of them at a time for high rate / many channel streams */
+  m_packetSamples = std::max<unsigned int>(PACKET_SIZE, m_codec->m_SampleRate * channels / 1000 * DECODER_PACKET_MS);
+  m_packetSamples -= m_packetSamples % channels;
+  m_pcmInputBuffer.assign(m_packetSamples * bytesPerSample, 0);
+  m_outputBuffer.assign(m_packetSamples * bytesPerSample, 0);
+
+  /* buffer by duration instead of bytes, but always room for two seconds and a few packets */
+  m_bytesPerSecond = blockSize * m_codec->m_SampleRate;
+  uint64_t bufferSize = (uint64_t)m_bytesPerSecond * DECODER_BUFFER_MS / 1000;
+  bufferSize = std::min<uint64_t>(bufferSize, DECODER_MAX_BUFFER);
+  bufferSize = std::max<uint64_t>(bufferSize, 2 * m_bytesPerSecond + 4 * m_pcmInputBuffer.size());
+  m_pcmBuffer.Create((unsigned int)bufferSize);
+
+  /* the buffer has to be able to get to the queue threshold */
+  m_queueBytes = (unsigned int)std::min<uint64_t>((uint64_t)m_bytesPerSecond * queueMs / 1000,
+                                                  bufferSize - m_pcmInputBuffer.size());
+
+  CLog::Log(LOGDEBUG, "CAudioDecoder::Create %u samples per read, %u bytes buffered, queued after %u bytes",
+            m_packetSamples, (unsigned int)bufferSize, m_queueBytes);
+  /* END PLEX */
 
   if (seekOffset)
     m_codec->Seek(seekOffset);
@@ -174,13 +196,29 @@ unsigned int CAudioDecoder::GetDataSize()
   // check for end of file and end of buffer
   if (m_status == STATUS_ENDING && m_pcmBuffer.getMaxReadSize() < PACKET_SIZE)
     m_status = STATUS_ENDED;
-  return std::min(m_pcmBuffer.getMaxReadSize() / (m_codec->m_BitsPerSample >> 3), (unsigned int)OUTPUT_SAMPLES);
+  return std::min(m_pcmBuffer.getMaxReadSize() / (m_codec->m_BitsPerSample >> 3), m_packetSamples);
+}
+
+/* PLEX */
+int CAudioDecoder::GetBufferLevel()
+{
+  if (m_pcmBuffer.getSize() == 0)
+    return 0;
+  return (int)((uint64_t)m_pcmBuffer.getMaxReadSize() * 100 / m_pcmBuffer.getSize());
+}
+
+unsigned int CAudioDecoder::GetBufferedTime()
+{
+  if (m_bytesPerSecond == 0)
+    return 0;
+  return (unsigned int)((uint64_t)m_pcmBuffer.getMaxReadSize() * 1000 / m_bytesPerSecond);
 }
+/* END PLEX */
 
 void *CAudioDecoder::GetData(unsigned int samples)
 {
   unsigned int size  = samples * (m_codec->m_BitsPerSample >> 3);
-  if (size > sizeof(m_outputBuffer))
+  if (size > m_outputBuffer.size())
   {
     CLog::Log(LOGERROR, "CAudioDecoder::GetData - More data was requested then we have space to buffer!");
     return NULL;
@@ -192,12 +230,12 @@ void *CAudioDecoder::GetData(unsigned int samples)
     size = m_pcmBuffer.getMaxReadSize();
   }
 
-  if (m_pcmBuffer.ReadData((char *)m_outputBuffer, size))
+  if (m_pcmBuffer.ReadData((char *)&m_outputBuffer[0], size))
   {
     if (m_status == STATUS_ENDING && m_pcmBuffer.getMaxReadSize() == 0)
       m_status = STATUS_ENDED;
     
-    return m_outputBuffer;
+    return &m_outputBuffer[0];
   }
   
   CLog::Log(LOGERROR, "CAudioDecoder::GetData() ReadBinary failed with %i samples", samples);
@@ -217,21 +255,21 @@ int CAudioDecoder::ReadSamples(int numsamples)
   CSingleLock lock(m_critSection);
 
   // Read in more data
-  int maxsize = std::min<int>(INPUT_SAMPLES, m_pcmBuffer.getMaxWriteSize() / (m_codec->m_BitsPerSample >> 3));
+  int maxsize = std::min<int>(m_packetSamples, m_pcmBuffer.getMaxWriteSize() / (m_codec->m_BitsPerSample >> 3));
   numsamples = std::min<int>(numsamples, maxsize);
   numsamples -= (numsamples % m_codec->GetChannelInfo().Count());  // make sure it's divisible by our number of channels
   if ( numsamples )
   {
     int readSize = 0;
-    int result = m_codec->ReadPCM(m_pcmInputBuffer, numsamples * (m_codec->m_BitsPerSample >> 3), &readSize);
+    int result = m_codec->ReadPCM(&m_pcmInputBuffer[0], numsamples * (m_codec->m_BitsPerSample >> 3), &readSize);
 
     if (result != READ_ERROR && readSize)
     {
       // move it into our buffer
-      m_pcmBuffer.WriteData((char *)m_pcmInputBuffer, readSize);
+      m_pcmBuffer.WriteData((char *)&m_pcmInputBuffer[0], readSize);
 
       // update status
-      if (m_status == STATUS_QUEUING && m_pcmBuffer.getMaxReadSize() > m_pcmBuffer.getSize() * 0.9)
+      if (m_status == STATUS_QUEUING && m_pcmBuffer.getMaxReadSize() >= m_queueBytes)
       {
         CLog::Log(LOGINFO, "AudioDecoder: File is queued");
         m_status = STATUS_QUEUED;
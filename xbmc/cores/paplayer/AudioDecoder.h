@@ -20,6 +20,8 @@
  *
  */
 
+#include <vector>
+
 #include "ICodec.h"
 #include "threads/CriticalSection.h"
 #include "utils/RingBuffer.h"
@@ -31,11 +33,13 @@ class CFileItem;
                             // using a multiple of 1, 2, 3, 4, 5, 6 to guarantee track alignment
                             // note that 7 or higher channels won't work too well.
 
-#define INPUT_SIZE PACKET_SIZE * 3      // input data size we read from the codecs at a time
-                                        // * 3 to allow 24 bit audio
-
-#define OUTPUT_SAMPLES PACKET_SIZE      // max number of output samples
-#define INPUT_SAMPLES  PACKET_SIZE      // number of input samples (distributed over channels)
+/* PLEX */
+#define DECODER_PACKET_MS     40                // decode at least this much per read, PACKET_SIZE at the least
+#define DECODER_BUFFER_MS     10000             // how much pcm is buffered per stream
+#define DECODER_MAX_BUFFER    (8 * 1024 * 1024) // the most bytes buffered per stream, for high rate / many channel streams
+#define DECODER_START_MS      1000              // decoded before a stream that plays right away is queued
+#define DECODER_PREDECODE_MS  8000              // decoded before an upcoming stream is queued
+/* END PLEX */
 
 #define STATUS_NO_FILE  0
 #define STATUS_QUEUING  1
@@ -55,10 +59,19 @@ public:
   CAudioDecoder();
   ~CAudioDecoder();
 
-  bool Create(const CFileItem &file, int64_t seekOffset);
+  /* PLEX */
+  // queueMs is how much is decoded before the stream is queued, the buffers are sized from the
+  // stream's sample rate and channels
+  bool Create(const CFileItem &file, int64_t seekOffset, unsigned int queueMs = DECODER_START_MS);
+  /* END PLEX */
   void Destroy();
 
   int ReadSamples(int numsamples);
+  /* PLEX */
+  unsigned int GetPacketSize() const { return m_packetSamples; } // samples to pass to ReadSamples
+  int GetBufferLevel();            // how full the pcm buffer is, in percent
+  unsigned int GetBufferedTime();  // how much is decoded and not taken yet, in ms
+  /* END PLEX */
 
   bool CanSeek() { if (m_codec) return m_codec->CanSeek(); else return false; };
   int64_t Seek(int64_t time);
@@ -80,12 +93,17 @@ private:
   // pcm buffer
   CRingBuffer m_pcmBuffer;
 
+  /* PLEX */
   // output buffer (for transferring data from the Pcm Buffer to the rest of the audio chain)
-  float m_outputBuffer[OUTPUT_SAMPLES];
+  std::vector<BYTE> m_outputBuffer;
 
   // input buffer (for transferring data from the Codecs to our Pcm Ringbuffer
-  BYTE m_pcmInputBuffer[INPUT_SIZE];
-  float m_inputBuffer[INPUT_SAMPLES];
+  std::vector<BYTE> m_pcmInputBuffer;
+
+  unsigned int m_packetSamples;  // samples read from the codec at a time, a multiple of the channels
+  unsigned int m_bytesPerSecond; // of decoded pcm
+  unsigned int m_queueBytes;     // decoded before the stream is queued
+  /* END PLEX */
 
   // status
   bool    m_eof;
@@ -33,7 +33,10 @@
 #include "cores/AudioEngine/Interfaces/AEStream.h"
 #include "cores/DataCacheCore.h"
 
-#define TIME_TO_CACHE_NEXT_FILE 5000 /* 5 seconds before end of song, start caching the next song */
+/* PLEX */
+#define TIME_TO_CACHE_NEXT_FILE 15000 /* 15 seconds before end of song, start caching the next song, enough to open it and decode DECODER_PREDECODE_MS of it */
+#define UNDERRUN_CACHE_TIME     0.05  /* seconds left in the stream when the decoder running dry counts as an underrun */
+/* END PLEX */
 #define FAST_XFADE_TIME           80 /* 80 milliseconds */
 #define MAX_SKIP_XFADE_TIME     2000 /* max 2 seconds crossfade on track skip */
 
@@ -371,7 +374,12 @@ bool PAPlayer::QueueNextFileEx(const CFileItem &file, bool fadeIn/* = true */, b
   }
 
   StreamInfo *si = new StreamInfo();
-  if (!si->m_decoder.Create(file, (file.m_lStartOffset * 1000) / 75))
+  /* PLEX */
+  /* a stream queued by the job is the upcoming one, it's decoded further ahead so a slow source
+     doesn't leave a gap when it starts, anything else is waited on to play right away */
+  unsigned int queueMs = job ? DECODER_PREDECODE_MS : DECODER_START_MS;
+  if (!si->m_decoder.Create(file, (file.m_lStartOffset * 1000) / 75, queueMs))
+  /* END PLEX */
   {
     CLog::Log(LOGWARNING, "PAPlayer::QueueNextFileEx - Failed to create the decoder");
 
@@ -383,14 +391,14 @@ bool PAPlayer::QueueNextFileEx(const CFileItem &file, bool fadeIn/* = true */, b
     return false;
   }
 
-  /* decode until there is data-available */
+  /* decode until there is data-available, that is until the decoder queued the stream */
   si->m_decoder.Start();
   while(si->m_decoder.GetDataSize() == 0)
   {
     int status = si->m_decoder.GetStatus();
     if (status == STATUS_ENDED   ||
         status == STATUS_NO_FILE ||
-        si->m_decoder.ReadSamples(PACKET_SIZE) == RET_ERROR)
+        si->m_decoder.ReadSamples(si->m_decoder.GetPacketSize()) == RET_ERROR)
     {
       CLog::Log(LOGINFO, "PAPlayer::QueueNextFileEx - Error reading samples");
 
@@ -427,6 +435,10 @@ bool PAPlayer::QueueNextFileEx(const CFileItem &file, bool fadeIn/* = true */, b
   /* END PLEX */
   si->m_fadeOutTriggered   = false;
   si->m_isSlaved           = false;
+  /* PLEX */
+  si->m_underruns          = 0;
+  si->m_underrun           = false;
+  /* END PLEX */
 
   int64_t streamTotalTime = si->m_decoder.TotalTime();
   if (si->m_endOffset)
@@ -435,10 +447,7 @@ bool PAPlayer::QueueNextFileEx(const CFileItem &file, bool fadeIn/* = true */, b
   si->m_prepareNextAtFrame = 0;
   // cd drives don't really like it to be crossfaded or prepared
   if(!file.IsCDDA())
-  {
-    if (streamTotalTime >= TIME_TO_CACHE_NEXT_FILE + m_defaultCrossfadeMS)
-      si->m_prepareNextAtFrame = (int)((streamTotalTime - TIME_TO_CACHE_NEXT_FILE - m_defaultCrossfadeMS) * si->m_sampleRate / 1000.0f);
-  }
+    si->m_prepareNextAtFrame = GetPrepareNextAtFrame(si, streamTotalTime);
 
   if (m_currentStream && (AE_IS_RAW(m_currentStream->m_dataFormat) || AE_IS_RAW(si->m_dataFormat)))
   {
@@ -494,6 +503,16 @@ void PAPlayer::UpdateStreamInfoPlayNextAtFrame(StreamInfo *si, unsigned int cros
   }
 }
 
+/* PLEX */
+int PAPlayer::GetPrepareNextAtFrame(StreamInfo *si, int64_t streamTotalTime)
+{
+  // streams too short to prepare the next one in time do it as soon as they play
+  if (streamTotalTime < TIME_TO_CACHE_NEXT_FILE + m_defaultCrossfadeMS)
+    return 1;
+  return (int)((streamTotalTime - TIME_TO_CACHE_NEXT_FILE - m_defaultCrossfadeMS) * si->m_sampleRate / 1000.0f);
+}
+/* END PLEX */
+
 inline bool PAPlayer::PrepareStream(StreamInfo *si)
 {
   /* if we have a stream we are already prepared */
@@ -532,7 +551,7 @@ inline bool PAPlayer::PrepareStream(StreamInfo *si)
     int status = si->m_decoder.GetStatus();
     if (status == STATUS_ENDED   ||
         status == STATUS_NO_FILE ||
-        si->m_decoder.ReadSamples(PACKET_SIZE) == RET_ERROR)
+        si->m_decoder.ReadSamples(si->m_decoder.GetPacketSize()) == RET_ERROR)
     {
       CLog::Log(LOGINFO, "PAPlayer::PrepareStream - Stream Finished");
       break;
@@ -803,7 +822,7 @@ inline bool PAPlayer::ProcessStream(StreamInfo *si, double &freeBufferTime)
   int status = si->m_decoder.GetStatus();
   if (status == STATUS_ENDED   ||
       status == STATUS_NO_FILE ||
-      si->m_decoder.ReadSamples(PACKET_SIZE) == RET_ERROR ||
+      si->m_decoder.ReadSamples(si->m_decoder.GetPacketSize()) == RET_ERROR ||
       ((si->m_endOffset) && (si->m_framesSent / si->m_sampleRate >= (si->m_endOffset - si->m_startOffset) / 1000)))
   {
     if (si == m_currentStream && m_continueStream)
@@ -821,9 +840,7 @@ inline bool PAPlayer::ProcessStream(StreamInfo *si, double &freeBufferTime)
         streamTotalTime = si->m_endOffset - si->m_startOffset;
 
       // calculate time when to prepare next stream
-      si->m_prepareNextAtFrame = 0;
-      if (streamTotalTime >= TIME_TO_CACHE_NEXT_FILE + m_defaultCrossfadeMS)
-        si->m_prepareNextAtFrame = (int)((streamTotalTime - TIME_TO_CACHE_NEXT_FILE - m_defaultCrossfadeMS) * si->m_sampleRate / 1000.0f);
+      si->m_prepareNextAtFrame = GetPrepareNextAtFrame(si, streamTotalTime);
 
       si->m_prepareTriggered = false;
       si->m_playNextAtFrame = 0;
@@ -839,7 +856,7 @@ inline bool PAPlayer::ProcessStream(StreamInfo *si, double &freeBufferTime)
     }
     else
     {
-      CLog::Log(LOGINFO, "PAPlayer::ProcessStream - Stream Finished");
+      CLog::Log(LOGINFO, "PAPlayer::ProcessStream - Stream Finished, %u underruns", si->m_underruns);
       return false;
     }
   }
@@ -866,6 +883,29 @@ bool PAPlayer::QueueData(StreamInfo *si)
 {
   unsigned int space   = si->m_stream->GetSpace();
   unsigned int samples = std::min(si->m_decoder.GetDataSize(), space / si->m_bytesPerSample);
+
+  /* PLEX */
+  /* count every time the decoder couldn't keep up and the playing stream is about to run out */
+  if (si->m_started && space && !samples && si->m_decoder.GetStatus() < STATUS_ENDING)
+  {
+    if (!si->m_underrun && si->m_stream->GetCacheTime() < UNDERRUN_CACHE_TIME)
+    {
+      si->m_underrun = true;
+      si->m_underruns++;
+      CLog::Log(LOGWARNING, "PAPlayer::QueueData - Underrun %u, the decoder has no data", si->m_underruns);
+    }
+  }
+  else if (samples)
+    si->m_underrun = false;
+
+  if (si == m_currentStream)
+  {
+    m_playerGUIData.m_underruns    = si->m_underruns;
+    m_playerGUIData.m_bufferLevel  = si->m_decoder.GetBufferLevel();
+    m_playerGUIData.m_bufferedTime = si->m_decoder.GetBufferedTime();
+  }
+  /* END PLEX */
+
   if (!samples)
     return true;
 
@@ -1040,6 +1080,14 @@ int PAPlayer::GetCacheLevel() const
   return m_playerGUIData.m_cacheLevel;
 }
 
+/* PLEX */
+void PAPlayer::GetAudioInfo(CStdString& strAudioInfo)
+{
+  strAudioInfo.Format("P(dec:%i%% %ums, underruns:%u)", m_playerGUIData.m_bufferLevel,
+                      m_playerGUIData.m_bufferedTime, m_playerGUIData.m_underruns);
+}
+/* END PLEX */
+
 void PAPlayer::GetAudioStreamInfo(int index, SPlayerAudioStreamInfo &info)
 {
   info.bitrate = m_playerGUIData.m_audioBitrate;
@@ -1136,6 +1184,11 @@ void PAPlayer::UpdateGUIData(StreamInfo *si)
   strncpy(m_playerGUIData.m_codec,codec ? codec->m_CodecName.c_str() : "",20);
   m_playerGUIData.m_cacheLevel   = codec ? codec->GetCacheLevel() : 0;
   m_playerGUIData.m_bitsPerSample = (codec && codec->m_BitsPerCodedSample) ? codec->m_BitsPerCodedSample : si->m_bytesPerSample << 3;
+  /* PLEX */
+  m_playerGUIData.m_underruns     = si->m_underruns;
+  m_playerGUIData.m_bufferLevel   = si->m_decoder.GetBufferLevel();
+  m_playerGUIData.m_bufferedTime  = si->m_decoder.GetBufferedTime();
+  /* END PLEX */
 
   int64_t total = si->m_decoder.TotalTime();
   if (si->m_endOffset)
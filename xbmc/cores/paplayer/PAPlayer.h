@@ -58,7 +58,9 @@ public:
   virtual float GetPercentage();
   virtual void SetVolume(float volume);
   virtual void SetDynamicRangeCompression(long drc);
-  virtual void GetAudioInfo( CStdString& strAudioInfo) {}
+  /* PLEX */
+  virtual void GetAudioInfo( CStdString& strAudioInfo);
+  /* END PLEX */
   virtual void GetVideoInfo( CStdString& strVideoInfo) {}
   virtual void GetGeneralInfo( CStdString& strVideoInfo) {}
   virtual void ToFFRW(int iSpeed = 0);
@@ -91,6 +93,11 @@ public:
     int          m_audioBitrate;
     int          m_cacheLevel;
     bool         m_canSeek;
+    /* PLEX */
+    unsigned int m_underruns;     /* times the current stream ran out of decoded data */
+    int          m_bufferLevel;   /* how full the decoder buffer of the current stream is, in percent */
+    unsigned int m_bufferedTime;  /* how much the decoder of the current stream has buffered, in ms */
+    /* END PLEX */
   } m_playerGUIData;
 
 protected:
@@ -126,6 +133,10 @@ private:
 
     bool              m_isSlaved;            /* true if the stream has been slaved to another */
     bool              m_waitOnDrain;         /* wait for stream being drained in AE */
+    /* PLEX */
+    unsigned int      m_underruns;           /* times the decoder ran dry while the stream played */
+    bool              m_underrun;            /* if the decoder is dry right now */
+    /* END PLEX */
   } StreamInfo;
 
   typedef std::list<StreamInfo*> StreamList;
@@ -174,6 +185,8 @@ private:
   float m_userRequestedVolume;
   float GetMaxVolume();
 
+  int GetPrepareNextAtFrame(StreamInfo *si, int64_t streamTotalTime);
+
   /* END PLEX */
 
 };
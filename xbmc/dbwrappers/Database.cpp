@@ -28,9 +28,13 @@
 #include "utils/log.h"
 #include "utils/SortUtils.h"
 #include "utils/URIUtils.h"
+/* PLEX */
+#include "utils/Variant.h"
+/* END PLEX */
 #include "sqlitedataset.h"
 #include "DatabaseManager.h"
 #include "DbUrl.h"
+#include "threads/SystemClock.h"
 
 #ifdef HAS_MYSQL
 #include "mysqldataset.h"
@@ -103,6 +107,7 @@ void CDatabase::Filter::AppendGroup(const std::string &strGroup)
 CDatabase::CDatabase(void)
 {
   m_openCount = 0;
+  m_transactionDepth = 0;
   m_sqlite = true;
   m_bMultiWrite = false;
 }
@@ -575,6 +580,7 @@ void CDatabase::Close()
   }
 
   m_openCount = 0;
+  m_transactionDepth = 0;
 
   if (NULL == m_pDB.get() ) return ;
   if (NULL != m_pDS.get()) m_pDS->close();
@@ -630,7 +636,16 @@ void CDatabase::BeginTransaction()
   try
   {
     if (NULL != m_pDB.get())
-      m_pDB->start_transaction();
+    {
+      if (m_transactionDepth > 0 && m_pDB->in_transaction())
+        m_pDS->exec(PrepareSQL("SAVEPOINT nested%u", m_transactionDepth));
+      else
+      {
+        m_pDB->start_transaction();
+        m_transactionDepth = 0;
+      }
+      m_transactionDepth++;
+    }
   }
   catch (...)
   {
@@ -643,7 +658,18 @@ bool CDatabase::CommitTransaction()
   try
   {
     if (NULL != m_pDB.get())
-      m_pDB->commit_transaction();
+    {
+      if (m_transactionDepth > 1)
+      {
+        m_transactionDepth--;
+        m_pDS->exec(PrepareSQL("RELEASE SAVEPOINT nested%u", m_transactionDepth));
+      }
+      else
+      {
+        m_transactionDepth = 0;
+        m_pDB->commit_transaction();
+      }
+    }
   }
   catch (...)
   {
@@ -658,7 +684,19 @@ void CDatabase::RollbackTransaction()
   try
   {
     if (NULL != m_pDB.get())
-      m_pDB->rollback_transaction();
+    {
+      if (m_transactionDepth > 1)
+      {
+        m_transactionDepth--;
+        m_pDS->exec(PrepareSQL("ROLLBACK TO SAVEPOINT nested%u", m_transactionDepth));
+        m_pDS->exec(PrepareSQL("RELEASE SAVEPOINT nested%u", m_transactionDepth));
+      }
+      else
+      {
+        m_transactionDepth = 0;
+        m_pDB->rollback_transaction();
+      }
+    }
   }
   catch (...)
   {
@@ -668,10 +706,139 @@ void CDatabase::RollbackTransaction()
 
 bool CDatabase::InTransaction()
 {
-  if (NULL != m_pDB.get()) return false;
+  if (NULL == m_pDB.get()) return false;
   return m_pDB->in_transaction();
 }
 
+void CDatabase::RollbackTransactionsTo(unsigned int depth)
+{
+  if (NULL == m_pDB.get())
+    return;
+
+  if (m_transactionDepth > depth)
+    CLog::Log(LOGWARNING, "database:rolling back %u unfinished transactions", m_transactionDepth - depth);
+
+  while (m_transactionDepth > depth)
+    RollbackTransaction();
+}
+
+CDatabaseBatch::CDatabaseBatch(CDatabase &db, unsigned int maxWrites, unsigned int maxTime)
+  : m_db(db), m_maxWrites(maxWrites), m_maxTime(maxTime)
+{
+  m_active = false;
+  m_open = false;
+  m_depth = 0;
+  m_writes = 0;
+  m_start = 0;
+  m_commits = 0;
+}
+
+void CDatabaseBatch::Start()
+{
+  m_active = true;
+}
+
+void CDatabaseBatch::Open()
+{
+  if (!m_active || m_open)
+    return;
+
+  m_db.BeginTransaction();
+  m_open = true;
+  m_depth = m_db.GetTransactionDepth();
+  m_writes = 0;
+  m_start = GetTime();
+}
+
+void CDatabaseBatch::Commit(bool force)
+{
+  if (!m_open)
+    return;
+  if (!force && m_writes < m_maxWrites && GetTime() - m_start < m_maxTime)
+    return;
+
+  m_open = false;
+
+  // someone else ended it already
+  if (m_db.GetTransactionDepth() < m_depth)
+    return;
+
+  m_db.RollbackTransactionsTo(m_depth);
+  m_db.CommitTransaction();
+  m_commits++;
+}
+
+void CDatabaseBatch::End()
+{
+  Commit(true);
+  m_active = false;
+}
+
+unsigned int CDatabaseBatch::GetTime() const
+{
+  return XbmcThreads::SystemClockMillis();
+}
+
+/* PLEX */
+CDatabaseRows::CDatabaseRows(dbiplus::Database *db, std::auto_ptr<dbiplus::Dataset> &ds)
+  : m_db(db), m_ds(ds)
+{
+  m_next = 0;
+  m_rows = 0;
+}
+
+CDatabaseRows::~CDatabaseRows()
+{
+  if (!m_cursor.get())
+    m_ds->close();
+}
+
+bool CDatabaseRows::Open(const std::string &sql, const SortDescription &sorting, MediaType mediaType)
+{
+  unsigned int time = XbmcThreads::SystemClockMillis();
+  m_cursor.reset();
+  m_results.clear();
+  m_next = 0;
+  m_rows = 0;
+
+  if (sorting.sortBy == SortByNone)
+  {
+    // SortFromDataset() would keep the rows in the order of the query, no need to hold them all
+    m_cursor.reset(m_db->CreateCursor(sql));
+    CLog::Log(LOGDEBUG, "%s took %d ms to prepare query: %s", __FUNCTION__, XbmcThreads::SystemClockMillis() - time, sql.c_str());
+    return true;
+  }
+
+  if (!m_ds->query(sql.c_str()))
+    return false;
+
+  if (!SortUtils::SortFromDataset(sorting, mediaType, m_ds, m_results))
+    return false;
+
+  m_rows = m_results.size();
+  CLog::Log(LOGDEBUG, "%s took %d ms for %u items query: %s", __FUNCTION__, XbmcThreads::SystemClockMillis() - time, m_rows, sql.c_str());
+  return true;
+}
+
+const dbiplus::sql_record *CDatabaseRows::Next()
+{
+  if (m_cursor.get())
+  {
+    if (!m_cursor->step())
+      return NULL;
+    m_cursor->getRecord(m_row);
+    m_rows++;
+    return &m_row;
+  }
+
+  if (m_next >= m_results.size())
+    return NULL;
+
+  unsigned int targetRow = (unsigned int)m_results[m_next++].at(FieldRow).asInteger();
+  return m_ds->get_result_set().records.at(targetRow);
+}
+/* END PLEX */
+
 bool CDatabase::CreateTables()
 {
 
@@ -21,10 +21,17 @@
  */
 
 #include "utils/StdString.h"
+/* PLEX */
+#include "utils/DatabaseUtils.h"
+#include "qry_dat.h"
+/* END PLEX */
 
 namespace dbiplus {
   class Database;
   class Dataset;
+  /* PLEX */
+  class Cursor;
+  /* END PLEX */
 }
 
 #include <memory>
@@ -66,11 +73,26 @@ public:
 
   bool Open(const DatabaseSettings &db);
 
+  /*! \brief Start a transaction.
+   Transactions nest: starting one while another is active sets a savepoint, which the matching
+   CommitTransaction() releases and RollbackTransaction() rolls back to. Only the outermost
+   CommitTransaction() writes to disk, so a caller can batch many writes that use transactions
+   themselves into one.
+   */
   void BeginTransaction();
   virtual bool CommitTransaction();
   void RollbackTransaction();
   bool InTransaction();
 
+  /*! \brief Number of BeginTransaction() calls not yet committed or rolled back */
+  unsigned int GetTransactionDepth() const { return m_transactionDepth; }
+
+  /*! \brief Roll back the transactions begun after the one at depth
+   A write that throws before it commits or rolls back its own transaction leaves it open, so
+   whoever started the transaction it nests in can drop what's left of the write this way.
+   */
+  void RollbackTransactionsTo(unsigned int depth);
+
   static CStdString FormatSQL(CStdString strStmt, ...);
   CStdString PrepareSQL(CStdString strStmt, ...) const;
 
@@ -173,4 +195,96 @@ private:
 
   bool m_bMultiWrite; /*!< True if there are any queries in the queue, false otherwise */
   unsigned int m_openCount;
+  unsigned int m_transactionDepth; /*!< Number of active BeginTransaction() calls, all but the first are savepoints */
+};
+
+/*! \brief Groups the writes of a long running job, eg. a library scan, into few transactions
+ The writes nest in the batch's transaction, and it's committed once it holds enough writes or
+ has been open long enough. Other connections can't write while it's open, so the job commits it
+ before doing anything slow.
+ */
+class CDatabaseBatch
+{
+public:
+  CDatabaseBatch(CDatabase &db, unsigned int maxWrites, unsigned int maxTime);
+  virtual ~CDatabaseBatch() {}
+
+  /*! \brief Batch the writes from now on, until End().  Commits are counted over all batches. */
+  void Start();
+
+  /*! \brief Start a transaction for the writes that follow, unless one is open or we're not batching */
+  void Open();
+
+  /*! \brief Count writes done in the open transaction */
+  void AddWrites(unsigned int writes = 1) { m_writes += writes; }
+
+  /*! \brief Commit the transaction if it holds enough writes or has been open long enough
+   Transactions of writes that threw and were left open are rolled back first, so they don't keep
+   the batch's transaction from being committed.
+   \param force commit regardless, eg. before waiting on the network
+   */
+  void Commit(bool force);
+
+  /*! \brief Commit the transaction and stop batching writes */
+  void End();
+
+  bool IsOpen() const { return m_open; }
+  unsigned int GetCommits() const { return m_commits; }
+
+protected:
+  // allow override for tests.
+  virtual unsigned int GetTime() const;
+
+private:
+  CDatabase &m_db;
+  unsigned int m_maxWrites;
+  unsigned int m_maxTime;   /* in ms */
+  bool m_active;
+  bool m_open;
+  unsigned int m_depth;     /* transaction depth of the batch's own transaction */
+  unsigned int m_writes;
+  unsigned int m_start;
+  unsigned int m_commits;
+};
+
+/* PLEX */
+/*! \brief Reads the rows of a listing query one at a time
+ Unsorted listings are stepped through a cursor, so only the current row is held in memory. Sorted
+ listings need all of their rows to sort them, so they're read into the dataset and sorted first.
+ */
+class CDatabaseRows
+{
+public:
+  CDatabaseRows(dbiplus::Database *db, std::auto_ptr<dbiplus::Dataset> &ds);
+  ~CDatabaseRows();
+
+  /*! \brief Run the query
+   \param sql the query, its rows are returned in this order when sorting by SortByNone
+   \param sorting how to sort the rows, limits are ignored when sorting by SortByNone
+   \param mediaType type of the rows, to get the fields to sort by
+   \return false if the query failed
+   */
+  bool Open(const std::string &sql, const SortDescription &sorting, MediaType mediaType);
+
+  /*! \brief The next row, NULL once there are no more. Only valid until the next call. */
+  const dbiplus::sql_record *Next();
+
+  /*! \brief Number of rows, when streaming only those returned by Next() so far */
+  unsigned int GetRows() const { return m_rows; }
+
+  /*! \brief Whether the rows are stepped through a cursor, ie. GetRows() isn't known up front */
+  bool IsStreaming() const { return m_cursor.get() != NULL; }
+
+private:
+  CDatabaseRows(const CDatabaseRows &);
+  CDatabaseRows &operator=(const CDatabaseRows &);
+
+  dbiplus::Database *m_db;
+  std::auto_ptr<dbiplus::Dataset> &m_ds;
+  std::auto_ptr<dbiplus::Cursor> m_cursor;
+  dbiplus::sql_record m_row;
+  DatabaseResults m_results;
+  unsigned int m_next;
+  unsigned int m_rows;
 };
+/* END PLEX */
@@ -29,6 +29,7 @@
 #include "dataset.h"
 #include "utils/log.h"
 #include <cstring>
+#include <cctype>
 
 #ifndef __GNUC__
 #pragma warning (disable:4800)
@@ -506,6 +507,123 @@ for (unsigned int i=0; i < fields_object->size(); i++)
 
 
 
+//************* DatasetCursor implementation ***************
+
+/* Cursor for databases without native statements: the parameters are
+   escaped into the sql, which is then run through a Dataset. */
+class DatasetCursor : public Cursor {
+public:
+  DatasetCursor(Database *newDb, const string &newSql) : db(newDb), sql(newSql), ds(newDb->CreateDataset()), started(false) {}
+  virtual ~DatasetCursor() { delete ds; }
+
+  virtual void bind(int n, int value) { param(n) = value; }
+  virtual void bind(int n, int64_t value) { param(n) = value; }
+  virtual void bind(int n, double value) { param(n) = value; }
+  virtual void bind(int n, const string &value) { param(n) = value; }
+  virtual void bindNull(int n) { param(n).set_isNull(); }
+
+  virtual bool step() {
+    if (started) {
+      if (ds->eof()) return false;
+      ds->next();
+      return !ds->eof();
+    }
+    started = true;
+    string query = expand();
+    if (isSelect(query)) {
+      ds->query(query.c_str());
+      return !ds->eof();
+    }
+    ds->exec(query);
+    return false;
+  }
+
+  virtual void reset() {
+    ds->close();
+    params.clear();
+    started = false;
+  }
+
+  virtual int columnCount() { return ds->fieldCount(); }
+  virtual bool isNull(int col) { return ds->fv(col).get_isNull(); }
+  virtual int getInt(int col) { return ds->fv(col).get_asInt(); }
+  virtual int64_t getInt64(int col) { return ds->fv(col).get_asInt64(); }
+  virtual double getDouble(int col) { return ds->fv(col).get_asDouble(); }
+  virtual const char *getText(int col) {
+    text = ds->fv(col).get_asString();
+    return text.c_str();
+  }
+
+private:
+  field_value &param(int n) {
+    while ((int)params.size() < n) {
+      params.push_back(field_value());
+      params.back().set_isNull(); // unbound parameters are NULL
+    }
+    params[n - 1] = field_value();
+    return params[n - 1];
+  }
+
+  static bool isSelect(const string &query) {
+    size_t pos = query.find_first_not_of(" \t\r\n(");
+    if (pos == string::npos)
+      return false;
+    string verb = query.substr(pos, 6);
+    for (size_t i = 0; i < verb.size(); i++)
+      verb[i] = toupper(verb[i]);
+    return verb == "SELECT";
+  }
+
+  /* replaces the '?' placeholders outside of string literals with the parameters */
+  string expand() {
+    string result;
+    unsigned int n = 0;
+    bool quoted = false;
+    for (size_t i = 0; i < sql.size(); i++) {
+      if (sql[i] == '\'')
+        quoted = !quoted;
+      if (sql[i] != '?' || quoted) {
+        result += sql[i];
+        continue;
+      }
+      if (n >= params.size() || params[n].get_isNull())
+        result += "NULL";
+      else if (params[n].get_fType() == ft_String)
+        result += db->prepare("'%s'", params[n].get_asString().c_str());
+      else
+        result += params[n].get_asString();
+      n++;
+    }
+    return result;
+  }
+
+  Database *db;
+  string sql;
+  Dataset *ds;
+  bool started;
+  sql_record params;
+  string text;
+};
+
+Cursor *Database::CreateCursor(const string &sql) {
+  return new DatasetCursor(this, sql);
+}
+
+//************* Cursor implementation ***************
+
+void Cursor::getRecord(sql_record &record) {
+  int cols = columnCount();
+  record.resize(cols);
+  for (int i = 0; i < cols; i++)
+  {
+    // assigned anew, a value that was NULL in the previous row isn't anymore
+    bool null = isNull(i);
+    record[i] = field_value(null ? "" : getText(i));
+    if (null)
+      record[i].set_isNull();
+  }
+}
+
 //************* DbErrors implementation ***************
 
 DbErrors::DbErrors() {
@@ -42,6 +42,7 @@
 
 namespace dbiplus {
 class Dataset;		// forward declaration of class Dataset
+class Cursor;		// forward declaration of class Cursor
 
 
 #define S_NO_CONNECTION "No active connection";
@@ -79,6 +80,9 @@ public:
 /* destructor */
   virtual ~Database();
   virtual Dataset *CreateDataset() const = 0;
+/* creates a cursor over a statement with '?' parameters, see class Cursor.
+   The default runs the statement through a Dataset, with the parameters escaped into the sql. */
+  virtual Cursor *CreateCursor(const std::string &sql);
 /* sets a new host name */
   virtual void setHostName(const char *newHost) { host = newHost; }
 /* gets a host name */
@@ -425,6 +429,51 @@ public:
 
 
 
+/******************* Class Cursor definition **********************
+
+  forward only walk over the rows of a single statement, with
+  parameters bound to the '?' placeholders of the statement and
+  typed access to the columns of the current row.
+
+  Unlike Dataset, rows are fetched one at a time as step() is called,
+  so large results are never held in memory as a whole.
+
+******************************************************************/
+class Cursor {
+public:
+  virtual ~Cursor() {}
+
+/* bind a value to parameter n (starting with 1) */
+  virtual void bind(int n, int value) = 0;
+  virtual void bind(int n, int64_t value) = 0;
+  virtual void bind(int n, double value) = 0;
+  virtual void bind(int n, const std::string &value) = 0;
+  virtual void bindNull(int n) = 0;
+
+/* runs the statement on the first call, then moves to the next row.
+   Returns false once there are no more rows. */
+  virtual bool step() = 0;
+/* runs a statement that doesn't return rows */
+  void exec() { while (step()) ; }
+/* rewinds the statement and clears the bound parameters, so it can run again */
+  virtual void reset() = 0;
+
+/* values of the current row, columns starting with 0 */
+  virtual int columnCount() = 0;
+  virtual bool isNull(int col) = 0;
+  virtual int getInt(int col) = 0;
+  virtual int64_t getInt64(int col) = 0;
+  virtual double getDouble(int col) = 0;
+/* text of a column, only valid until the next call to step() */
+  virtual const char *getText(int col) = 0;
+  std::string getString(int col) { return getText(col); }
+/* the current row as a record, for code that reads the rows of a Dataset.
+   Only this one row is held, record is reused from row to row. */
+  void getRecord(sql_record &record);
+};
+
+
+
 /******************** Class DbErrors definition *********************
 
 			   error handling
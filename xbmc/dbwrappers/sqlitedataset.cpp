@@ -79,6 +79,58 @@ int callback(void* res_ptr,int ncol, char** reslt,char** cols)
   return 0;  
 }
 
+//************* SqliteCursor implementation ***************
+
+class SqliteCursor : public Cursor {
+public:
+  SqliteCursor(SqliteDatabase *newDb, const string &newSql) : db(newDb), sql(newSql), done(false) {
+    stmt = db->acquire_statement(sql);
+  }
+  virtual ~SqliteCursor() { db->release_statement(sql, stmt); }
+
+  virtual void bind(int n, int value) { check(sqlite3_bind_int(stmt, n, value)); }
+  virtual void bind(int n, int64_t value) { check(sqlite3_bind_int64(stmt, n, value)); }
+  virtual void bind(int n, double value) { check(sqlite3_bind_double(stmt, n, value)); }
+  virtual void bind(int n, const string &value) { check(sqlite3_bind_text(stmt, n, value.c_str(), value.size(), SQLITE_TRANSIENT)); }
+  virtual void bindNull(int n) { check(sqlite3_bind_null(stmt, n)); }
+
+  virtual bool step() {
+    if (done) return false;
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) return true;
+    done = true;
+    if (rc != SQLITE_DONE) check(sqlite3_reset(stmt));
+    return false;
+  }
+
+  virtual void reset() {
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    done = false;
+  }
+
+  virtual int columnCount() { return sqlite3_column_count(stmt); }
+  virtual bool isNull(int col) { return sqlite3_column_type(stmt, col) == SQLITE_NULL; }
+  virtual int getInt(int col) { return sqlite3_column_int(stmt, col); }
+  virtual int64_t getInt64(int col) { return sqlite3_column_int64(stmt, col); }
+  virtual double getDouble(int col) { return sqlite3_column_double(stmt, col); }
+  virtual const char *getText(int col) {
+    const char *text = (const char *)sqlite3_column_text(stmt, col);
+    return text ? text : "";
+  }
+
+private:
+  void check(int rc) {
+    if (db->setErr(rc, sql.c_str()) != SQLITE_OK)
+      throw DbErrors(db->getErrorMsg());
+  }
+
+  SqliteDatabase *db;
+  string sql;
+  sqlite3_stmt *stmt;
+  bool done;
+};
+
 static int busy_callback(void*, int busyCount)
 {
 	Sleep(100);
@@ -99,6 +151,7 @@ SqliteDatabase::SqliteDatabase() {
   db = "sqlite.db";
   login = "root";
   passwd = "";
+  max_statements = 32;
 }
 
 SqliteDatabase::~SqliteDatabase() {
@@ -110,6 +163,54 @@ Dataset* SqliteDatabase::CreateDataset() const {
 	return new SqliteDataset((SqliteDatabase*)this); 
 }
 
+Cursor* SqliteDatabase::CreateCursor(const string &sql) {
+  return new SqliteCursor(this, sql);
+}
+
+sqlite3_stmt *SqliteDatabase::acquire_statement(const string &sql) {
+  if (!active) throw DbErrors("No Database Connection");
+
+  map<string, StatementList::iterator>::iterator i = statement_index.find(sql);
+  if (i != statement_index.end()) {
+    // hand it out, so a second cursor on the same sql gets its own statement
+    sqlite3_stmt *stmt = i->second->second;
+    statements.erase(i->second);
+    statement_index.erase(i);
+    return stmt;
+  }
+
+  sqlite3_stmt *stmt = NULL;
+  if (setErr(sqlite3_prepare_v2(conn, sql.c_str(), -1, &stmt, NULL), sql.c_str()) != SQLITE_OK)
+    throw DbErrors(getErrorMsg());
+  return stmt;
+}
+
+void SqliteDatabase::release_statement(const string &sql, sqlite3_stmt *stmt) {
+  // reset, so the statement doesn't keep the database locked while cached
+  sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+
+  if (!active || statement_index.find(sql) != statement_index.end()) {
+    sqlite3_finalize(stmt);
+    return;
+  }
+
+  statements.push_front(make_pair(sql, stmt));
+  statement_index[sql] = statements.begin();
+  while (statements.size() > max_statements) {
+    statement_index.erase(statements.back().first);
+    sqlite3_finalize(statements.back().second);
+    statements.pop_back();
+  }
+}
+
+void SqliteDatabase::clear_statements() {
+  for (StatementList::iterator i = statements.begin(); i != statements.end(); ++i)
+    sqlite3_finalize(i->second);
+  statements.clear();
+  statement_index.clear();
+}
+
 void SqliteDatabase::setHostName(const char *newHost) {
   host = newHost;
 
@@ -260,6 +361,7 @@ bool SqliteDatabase::exists(void)
 
 void SqliteDatabase::disconnect(void) {
   if (active == false) return;
+  clear_statements();
   sqlite3_close(conn);
   active = false;
 }
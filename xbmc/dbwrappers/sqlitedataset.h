@@ -30,6 +30,8 @@
 #define _SQLITEDATASET_H
 
 #include <stdio.h>
+#include <list>
+#include <map>
 #include "dataset.h"
 #include <sqlite3.h>
 
@@ -46,6 +48,12 @@ protected:
   bool _in_transaction;
   int last_err;
 
+/* prepared statements not used by a cursor right now, most recently used first */
+  typedef std::list<std::pair<std::string, sqlite3_stmt*> > StatementList;
+  StatementList statements;
+  std::map<std::string, StatementList::iterator> statement_index;
+  unsigned int max_statements;
+
 public:
 /* default constructor */
   SqliteDatabase();
@@ -53,6 +61,16 @@ public:
   ~SqliteDatabase();
 
   Dataset *CreateDataset() const; 
+/* creates a cursor stepping through a prepared statement.
+   Cursors have to be destroyed before the database is disconnected. */
+  virtual Cursor *CreateCursor(const std::string &sql);
+
+/* takes the statement for the sql out of the cache, preparing it if it isn't cached */
+  sqlite3_stmt *acquire_statement(const std::string &sql);
+/* resets a statement and puts it back into the cache, dropping the least recently used ones */
+  void release_statement(const std::string &sql, sqlite3_stmt *stmt);
+/* finalizes all cached statements */
+  void clear_statements();
 
 /* func. returns connection handle with SQLite-server */
   sqlite3 *getHandle() {  return conn; }
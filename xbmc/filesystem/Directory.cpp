@@ -133,7 +133,12 @@ bool CDirectory::GetDirectory(const CStdString& strPath, CFileItemList &items, c
       return false;
 
     // check our cache for this path
+#ifndef __PLEX__
     if (g_directoryCache.GetDirectory(strPath, items, (hints.flags & DIR_FLAG_READ_CACHE) == DIR_FLAG_READ_CACHE))
+#else
+    if (g_directoryCache.GetDirectory(strPath, items, (hints.flags & DIR_FLAG_READ_CACHE) == DIR_FLAG_READ_CACHE,
+                                      (hints.flags & DIR_FLAG_READ_CACHE_TTL) == DIR_FLAG_READ_CACHE_TTL))
+#endif
       items.SetPath(strPath);
     else
     {
@@ -198,7 +203,7 @@ bool CDirectory::GetDirectory(const CStdString& strPath, CFileItemList &items, c
 
       // cache the directory, if necessary
       if (!(hints.flags & DIR_FLAG_BYPASS_CACHE))
-        g_directoryCache.SetDirectory(strPath, items, pDirectory->GetCacheType(strPath));
+        g_directoryCache.SetDirectory(strPath, items, pDirectory->GetCacheType(strPath) /* PLEX */, hints.flags /* END PLEX */);
     }
 
     // now filter for allowed files
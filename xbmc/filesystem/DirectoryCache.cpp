@@ -28,18 +28,81 @@
 
 /* PLEX */
 #include "URL.h"
+#include "DirectoryFactory.h"
+#include "GUIUserMessages.h"
+#include "guilib/GUIWindowManager.h"
+#include "music/tags/MusicInfoTag.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/SystemClock.h"
+#include "utils/JobManager.h"
+#include "video/VideoInfoTag.h"
 #include <boost/foreach.hpp>
+#include <boost/shared_ptr.hpp>
+
+// listings older than this many ttls aren't shown anymore while they are listed again
+#define DIRECTORY_CACHE_MAX_STALE 10
+
+// what an item carries besides its strings and tags, properties and art mostly
+#define DIRECTORY_CACHE_ITEM_OVERHEAD 512
+
+// the hits and misses are logged every this many lookups
+#define DIRECTORY_CACHE_STATS_INTERVAL 100
 /* END PLEX */
 
 using namespace std;
 using namespace XFILE;
 
+/* PLEX */
+class CDirectoryRefreshJob : public CJob
+{
+public:
+  CDirectoryRefreshJob(const CStdString& path, DIR_CACHE_TYPE cacheType, int flags)
+    : m_path(path), m_cacheType(cacheType), m_flags(flags) {}
+
+  virtual const char* GetType() const { return "directoryrefresh"; }
+
+  virtual bool DoWork()
+  {
+    CStdString realPath = URIUtils::SubstitutePath(m_path);
+    boost::shared_ptr<IDirectory> directory(CDirectoryFactory::Create(realPath));
+    if (!directory.get())
+      return false;
+
+    // listed as before, so it only differs if the directory did, but nobody's there to answer prompts
+    directory->SetFlags(m_flags & ~DIR_FLAG_ALLOW_PROMPT);
+    m_items.SetPath(m_path);
+    return directory->GetDirectory(realPath, m_items);
+  }
+
+  CStdString m_path;
+  DIR_CACHE_TYPE m_cacheType;
+  int m_flags;
+  CFileItemList m_items;
+};
+
+static unsigned int EstimateItemSize(const CFileItem& item)
+{
+  unsigned int size = sizeof(CFileItem) + DIRECTORY_CACHE_ITEM_OVERHEAD;
+  size += item.GetPath().size() + item.GetLabel().size() + item.GetLabel2().size();
+  if (item.HasVideoInfoTag())
+    size += sizeof(CVideoInfoTag);
+  if (item.HasMusicInfoTag())
+    size += sizeof(MUSIC_INFO::CMusicInfoTag);
+  return size;
+}
+/* END PLEX */
+
 CDirectoryCache::CDir::CDir(DIR_CACHE_TYPE cacheType)
 {
   m_cacheType = cacheType;
   m_lastAccess = 0;
   m_Items = new CFileItemList;
   m_Items->SetFastLookup(true);
+  /* PLEX */
+  m_size = 0;
+  m_listedAt = 0;
+  m_flags = DIR_FLAG_DEFAULTS;
+  /* END PLEX */
 }
 
 CDirectoryCache::CDir::~CDir()
@@ -59,13 +122,19 @@ CDirectoryCache::CDirectoryCache(void)
   m_cacheHits = 0;
   m_cacheMisses = 0;
 #endif
+  /* PLEX */
+  m_size = 0;
+  m_hits = 0;
+  m_staleHits = 0;
+  m_misses = 0;
+  /* END PLEX */
 }
 
 CDirectoryCache::~CDirectoryCache(void)
 {
 }
 
-bool CDirectoryCache::GetDirectory(const CStdString& strPath, CFileItemList &items, bool retrieveAll)
+bool CDirectoryCache::GetDirectory(const CStdString& strPath, CFileItemList &items, bool retrieveAll, bool withinTTL)
 {
   CSingleLock lock (m_cs);
 
@@ -76,22 +145,54 @@ bool CDirectoryCache::GetDirectory(const CStdString& strPath, CFileItemList &ite
   if (i != m_cache.end())
   {
     CDir* dir = i->second;
+    /* PLEX */
+    unsigned int ttl = GetTTL(storedPath);
+
+    // listings that are only cached for one fetch are browsed again for as long as their protocol
+    // says, as that's what it takes to list them again (shares, plugins)
+    bool browse = withinTTL && dir->m_cacheType == XFILE::DIR_CACHE_ONCE && ttl > 0 && HasProtocolTTL(storedPath);
+    /* END PLEX */
     if (dir->m_cacheType == XFILE::DIR_CACHE_ALWAYS ||
-       (dir->m_cacheType == XFILE::DIR_CACHE_ONCE && retrieveAll))
+       (dir->m_cacheType == XFILE::DIR_CACHE_ONCE && retrieveAll) /* PLEX */ || browse /* END PLEX */)
     {
+      /* PLEX */
+      unsigned int age = GetTime() - dir->m_listedAt;
+      if (ttl > 0 && age >= ttl * DIRECTORY_CACHE_MAX_STALE)
+      {
+        m_misses++;
+        LogStats();
+        return false;
+      }
+      /* END PLEX */
+
       items.Copy(*dir->m_Items);
       dir->SetLastAccess(m_accessCounter);
 #ifdef _DEBUG
       CLog::Log(LOGDEBUG, "CDirectoryCache::GetDirectory cache hit for %s", strPath.c_str());
       m_cacheHits+=items.Size();
 #endif
+
+      /* PLEX */
+      if (ttl > 0 && age >= ttl)
+      {
+        m_staleHits++;
+        RefreshDirectory(strPath);
+      }
+      else
+        m_hits++;
+      LogStats();
+      /* END PLEX */
       return true;
     }
   }
+  /* PLEX */
+  m_misses++;
+  LogStats();
+  /* END PLEX */
   return false;
 }
 
-void CDirectoryCache::SetDirectory(const CStdString& strPath, const CFileItemList &items, DIR_CACHE_TYPE cacheType)
+void CDirectoryCache::SetDirectory(const CStdString& strPath, const CFileItemList &items, DIR_CACHE_TYPE cacheType, int flags)
 {
   if (cacheType == DIR_CACHE_NEVER)
     return; // nothing to do
@@ -114,11 +215,24 @@ void CDirectoryCache::SetDirectory(const CStdString& strPath, const CFileItemLis
 
   ClearDirectory(storedPath);
 
+#ifndef __PLEX__
   CheckIfFull();
+#else
+  // the newest listing is always kept, even if everything else has to go for it. Windows read
+  // back what was just fetched for them, large sections most of all.
+  unsigned int size = EstimateSize(items);
+  CheckIfFull(size);
+#endif
 
   CDir* dir = new CDir(cacheType);
   dir->m_Items->Copy(items);
   dir->SetLastAccess(m_accessCounter);
+#ifdef __PLEX__
+  dir->m_size = size;
+  dir->m_listedAt = GetTime();
+  dir->m_flags = flags;
+  m_size += size;
+#endif
   m_cache.insert(pair<CStdString, CDir*>(storedPath, dir));
 }
 
@@ -174,6 +288,10 @@ void CDirectoryCache::AddFile(const CStdString& strFile)
     CFileItemPtr item(new CFileItem(strFile, false));
     dir->m_Items->Add(item);
     dir->SetLastAccess(m_accessCounter);
+    /* PLEX */
+    dir->m_size += EstimateItemSize(*item);
+    m_size += EstimateItemSize(*item);
+    /* END PLEX */
   }
 }
 
@@ -248,6 +366,113 @@ void CDirectoryCache::ClearDirWithFile(const CStdString& strPath)
     ClearDirectory(dirPath);
 }
 
+void CDirectoryCache::RefreshDirectory(const CStdString& strPath)
+{
+  CSingleLock lock(m_cs);
+
+  CStdString storedPath = URIUtils::SubstitutePath(strPath);
+  URIUtils::RemoveSlashAtEnd(storedPath);
+
+  ciCache i = m_cache.find(storedPath);
+  if (i == m_cache.end() || m_refreshing.find(storedPath) != m_refreshing.end())
+    return;
+
+  m_refreshing.insert(storedPath);
+  CJobManager::GetInstance().AddJob(new CDirectoryRefreshJob(strPath, i->second->m_cacheType, i->second->m_flags), this, CJob::PRIORITY_LOW);
+}
+
+void CDirectoryCache::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  CDirectoryRefreshJob* refresh = (CDirectoryRefreshJob*)job;
+  bool changed;
+
+  {
+    CSingleLock lock(m_cs);
+
+    CStdString storedPath = URIUtils::SubstitutePath(refresh->m_path);
+    URIUtils::RemoveSlashAtEnd(storedPath);
+    m_refreshing.erase(storedPath);
+
+    if (!success)
+    {
+      // don't keep showing it, the next visit lists it the usual way
+      CLog::Log(LOGDEBUG, "CDirectoryCache::OnJobComplete failed to refresh %s", refresh->m_path.c_str());
+      ClearDirectory(storedPath);
+      return;
+    }
+
+    ciCache i = m_cache.find(storedPath);
+    changed = i == m_cache.end() || HasChanged(*i->second->m_Items, refresh->m_items);
+    SetDirectory(refresh->m_path, refresh->m_items, refresh->m_cacheType, refresh->m_flags);
+  }
+
+  if (changed)
+  {
+    CLog::Log(LOGDEBUG, "CDirectoryCache::OnJobComplete %s changed since it was cached", refresh->m_path.c_str());
+    CGUIMessage msg(GUI_MSG_NOTIFY_ALL, 0, 0, GUI_MSG_UPDATE_PATH);
+    msg.SetStringParam(refresh->m_path);
+    g_windowManager.SendThreadMessage(msg);
+  }
+}
+
+bool CDirectoryCache::HasChanged(const CFileItemList& before, const CFileItemList& after)
+{
+  if (before.Size() != after.Size())
+    return true;
+
+  for (int i = 0; i < before.Size(); i++)
+  {
+    const CFileItemPtr a = before.Get(i);
+    const CFileItemPtr b = after.Get(i);
+    if (a->GetPath() != b->GetPath() ||
+        a->GetLabel() != b->GetLabel() ||
+        a->GetLabel2() != b->GetLabel2() ||
+        a->m_bIsFolder != b->m_bIsFolder ||
+        a->m_dwSize != b->m_dwSize ||
+        a->m_dateTime != b->m_dateTime ||
+        a->GetOverlayImage() != b->GetOverlayImage())
+      return true;
+  }
+
+  return false;
+}
+
+unsigned int CDirectoryCache::EstimateSize(const CFileItemList& items)
+{
+  unsigned int size = sizeof(CFileItemList);
+  for (int i = 0; i < items.Size(); i++)
+    size += EstimateItemSize(*items.Get(i));
+  return size;
+}
+
+unsigned int CDirectoryCache::GetTTL(const CStdString& strPath)
+{
+  CStdString protocol = CURL(strPath).GetProtocol();
+  protocol.ToLower();
+
+  std::map<std::string, int>::const_iterator it = g_advancedSettings.m_directoryCacheTTLs.find(protocol);
+  if (it != g_advancedSettings.m_directoryCacheTTLs.end())
+    return it->second * 1000;
+  return g_advancedSettings.m_directoryCacheTTL * 1000;
+}
+
+bool CDirectoryCache::HasProtocolTTL(const CStdString& strPath)
+{
+  CStdString protocol = CURL(strPath).GetProtocol();
+  protocol.ToLower();
+  return g_advancedSettings.m_directoryCacheTTLs.find(protocol) != g_advancedSettings.m_directoryCacheTTLs.end();
+}
+
+unsigned int CDirectoryCache::GetSize() const
+{
+  return m_size;
+}
+
+unsigned int CDirectoryCache::GetTime() const
+{
+  return XbmcThreads::SystemClockMillis();
+}
+
 #endif
 
 void CDirectoryCache::Clear()
@@ -284,6 +509,36 @@ void CDirectoryCache::ClearCache(set<CStdString>& dirs)
   }
 }
 
+/* PLEX */
+void CDirectoryCache::LogStats() const
+{
+  unsigned int lookups = m_hits + m_staleHits + m_misses;
+  if (lookups % DIRECTORY_CACHE_STATS_INTERVAL != 0)
+    return;
+
+  CLog::Log(LOGDEBUG, "CDirectoryCache::LogStats %u lookups: %u hits, %u stale hits, %u misses, %u listings in %u kB",
+            lookups, m_hits, m_staleHits, m_misses, (unsigned int)m_cache.size(), m_size / 1024);
+}
+
+void CDirectoryCache::CheckIfFull(unsigned int newSize)
+{
+  CSingleLock lock (m_cs);
+  unsigned int maxSize = g_advancedSettings.m_directoryCacheSize * 1024;
+
+  // remove the least recently accessed folders until the new one fits
+  while (!m_cache.empty() && m_size + newSize > maxSize)
+  {
+    iCache lastAccessed = m_cache.begin();
+    for (iCache i = m_cache.begin(); i != m_cache.end(); i++)
+    {
+      if (i->second->GetLastAccess() < lastAccessed->second->GetLastAccess())
+        lastAccessed = i;
+    }
+    Delete(lastAccessed);
+  }
+}
+/* END PLEX */
+
 void CDirectoryCache::CheckIfFull()
 {
   CSingleLock lock (m_cs);
@@ -309,6 +564,9 @@ void CDirectoryCache::CheckIfFull()
 void CDirectoryCache::Delete(iCache it)
 {
   CDir* dir = it->second;
+  /* PLEX */
+  m_size -= dir->m_size;
+  /* END PLEX */
   delete dir;
   m_cache.erase(it);
 }
@@ -22,6 +22,9 @@
 #include "IDirectory.h"
 #include "Directory.h"
 #include "threads/CriticalSection.h"
+/* PLEX */
+#include "utils/Job.h"
+/* END PLEX */
 
 #include <map>
 #include <set>
@@ -30,7 +33,12 @@ class CFileItem;
 
 namespace XFILE
 {
-  class CDirectoryCache
+  /* PLEX */
+  // Listings are kept up to a number of bytes rather than a number of directories, the least
+  // recently used go first. A listing older than the ttl of its protocol is still returned right
+  // away, but it's listed again in a job and windows showing it refresh when it changed.
+  class CDirectoryCache : public IJobCallback
+  /* END PLEX */
   {
     class CDir
     {
@@ -43,14 +51,22 @@ namespace XFILE
 
       CFileItemList* m_Items;
       DIR_CACHE_TYPE m_cacheType;
+      /* PLEX */
+      unsigned int m_size;      // estimated bytes of m_Items
+      unsigned int m_listedAt;  // when m_Items was listed, in ms
+      int m_flags;              // DIR_FLAGs it was listed with
+      /* END PLEX */
     private:
       unsigned int m_lastAccess;
     };
   public:
     CDirectoryCache(void);
     virtual ~CDirectoryCache(void);
-    bool GetDirectory(const CStdString& strPath, CFileItemList &items, bool retrieveAll = false);
-    void SetDirectory(const CStdString& strPath, const CFileItemList &items, DIR_CACHE_TYPE cacheType);
+    /* PLEX */
+    // withinTTL also returns DIR_CACHE_ONCE listings of protocols with a ttl of their own, see DIR_FLAG_READ_CACHE_TTL
+    bool GetDirectory(const CStdString& strPath, CFileItemList &items, bool retrieveAll = false, bool withinTTL = false);
+    void SetDirectory(const CStdString& strPath, const CFileItemList &items, DIR_CACHE_TYPE cacheType, int flags = DIR_FLAG_DEFAULTS);
+    /* END PLEX */
     void ClearDirectory(const CStdString& strPath);
     void ClearFile(const CStdString& strFile);
     void ClearSubPaths(const CStdString& strPath);
@@ -62,6 +78,19 @@ namespace XFILE
 #endif
     /* PLEX */
     void ClearDirWithFile(const CStdString &strPath);
+
+    // lists the directory again in the background, windows showing it are told when it changed
+    virtual void RefreshDirectory(const CStdString& strPath);
+    virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
+
+    unsigned int GetSize() const;
+    unsigned int GetHits() const { return m_hits; }
+    unsigned int GetStaleHits() const { return m_staleHits; }
+    unsigned int GetMisses() const { return m_misses; }
+
+    static unsigned int EstimateSize(const CFileItemList& items);
+    static unsigned int GetTTL(const CStdString& strPath); // in ms, 0 if listings don't expire
+    static bool HasProtocolTTL(const CStdString& strPath);
     /* END PLEX */
   protected:
     void InitCache(std::set<CStdString>& dirs);
@@ -84,6 +113,18 @@ namespace XFILE
 
     /* PLEX */
     CStdString DirPathOfFile(const CStdString &strPath);
+    void CheckIfFull(unsigned int newSize);
+    void LogStats() const;
+    static bool HasChanged(const CFileItemList& before, const CFileItemList& after);
+
+    // allow override for tests.
+    virtual unsigned int GetTime() const;
+
+    unsigned int m_size;
+    unsigned int m_hits;
+    unsigned int m_staleHits;
+    unsigned int m_misses;
+    std::set<CStdString> m_refreshing;
     /* END PLEX */
   };
 }
@@ -46,6 +46,9 @@ namespace XFILE
     DIR_FLAG_GET_HIDDEN    = (2 << 3), ///< Get hidden files
     DIR_FLAG_READ_CACHE    = (2 << 4), ///< Force reading from the directory cache (if available)
     DIR_FLAG_BYPASS_CACHE  = (2 << 5)  ///< Completely bypass the directory cache (no reading, no writing)
+    /* PLEX */
+    , DIR_FLAG_READ_CACHE_TTL = (2 << 6) ///< Read listings cached once from the directory cache while within their protocol's ttl
+    /* END PLEX */
   };
 /*!
  \ingroup filesystem
@@ -0,0 +1,193 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUIFontGlyphAtlas.h"
+
+const unsigned int CGUIFontGlyphAtlas::NO_PAGE;
+
+CGUIFontGlyphAtlas::CGUIFontGlyphAtlas()
+{
+  m_width = 0;
+  m_pageHeight = 0;
+  m_maxPages = 0;
+  m_clock = 0;
+}
+
+void CGUIFontGlyphAtlas::Reset(unsigned int width, unsigned int pageHeight, unsigned int maxPages)
+{
+  m_pages.clear();
+  m_width = width;
+  m_pageHeight = pageHeight;
+  m_maxPages = maxPages;
+  m_clock = 0;
+}
+
+bool CGUIFontGlyphAtlas::Allocate(unsigned int width, unsigned int height, unsigned int &x, unsigned int &y, unsigned int &page)
+{
+  if (width > m_width || height > m_pageHeight)
+    return false;
+
+  // most recently added pages are the least fragmented, so try those first
+  for (unsigned int i = m_pages.size(); i > 0; i--)
+  {
+    if (AllocateInPage(m_pages[i - 1], width, height, x, y))
+    {
+      page = i - 1;
+      y += page * m_pageHeight;
+      m_pages[page].usedArea += width * height;
+      Touch(page);
+      return true;
+    }
+  }
+  return false;
+}
+
+int CGUIFontGlyphAtlas::Fit(const Page &page, unsigned int node, unsigned int width, unsigned int height) const
+{
+  // the rectangle rests on the highest skyline node it spans
+  if (page.skyline[node].x + width > m_width)
+    return -1;
+
+  unsigned int y = 0;
+  int remaining = width;
+  for (unsigned int i = node; remaining > 0; i++)
+  {
+    if (page.skyline[i].y > y)
+      y = page.skyline[i].y;
+    if (y + height > m_pageHeight)
+      return -1;
+    remaining -= page.skyline[i].width;
+  }
+  return y;
+}
+
+bool CGUIFontGlyphAtlas::AllocateInPage(Page &page, unsigned int width, unsigned int height, unsigned int &x, unsigned int &y)
+{
+  // pick the spot where the bottom of the rectangle ends up lowest, then the narrowest one
+  int best = -1;
+  unsigned int bestBottom = 0;
+  unsigned int bestWidth = 0;
+  for (unsigned int i = 0; i < page.skyline.size(); i++)
+  {
+    int top = Fit(page, i, width, height);
+    if (top < 0)
+      continue;
+    unsigned int bottom = top + height;
+    if (best < 0 || bottom < bestBottom || (bottom == bestBottom && page.skyline[i].width < bestWidth))
+    {
+      best = i;
+      bestBottom = bottom;
+      bestWidth = page.skyline[i].width;
+    }
+  }
+  if (best < 0)
+    return false;
+
+  x = page.skyline[best].x;
+  y = bestBottom - height;
+
+  SkylineNode node;
+  node.x = x;
+  node.y = bestBottom;
+  node.width = width;
+  page.skyline.insert(page.skyline.begin() + best, node);
+
+  // trim the nodes now hidden under the rectangle
+  for (unsigned int i = best + 1; i < page.skyline.size(); )
+  {
+    SkylineNode &previous = page.skyline[i - 1];
+    SkylineNode &current = page.skyline[i];
+    if (current.x >= previous.x + previous.width)
+      break;
+    unsigned int shrink = previous.x + previous.width - current.x;
+    if (current.width > shrink)
+    {
+      current.x += shrink;
+      current.width -= shrink;
+      break;
+    }
+    page.skyline.erase(page.skyline.begin() + i);
+  }
+
+  // and merge neighbours at the same height
+  for (unsigned int i = 0; i + 1 < page.skyline.size(); )
+  {
+    if (page.skyline[i].y == page.skyline[i + 1].y)
+    {
+      page.skyline[i].width += page.skyline[i + 1].width;
+      page.skyline.erase(page.skyline.begin() + i + 1);
+    }
+    else
+      i++;
+  }
+  return true;
+}
+
+void CGUIFontGlyphAtlas::ResetPage(Page &page)
+{
+  SkylineNode node;
+  node.x = 0;
+  node.y = 0;
+  node.width = m_width;
+  page.skyline.assign(1, node);
+  page.usedArea = 0;
+}
+
+bool CGUIFontGlyphAtlas::AddPage()
+{
+  if (m_pages.size() >= m_maxPages)
+    return false;
+
+  m_pages.push_back(Page());
+  ResetPage(m_pages.back());
+  Touch(m_pages.size() - 1);
+  return true;
+}
+
+void CGUIFontGlyphAtlas::ClearPage(unsigned int page)
+{
+  if (page >= m_pages.size())
+    return;
+
+  ResetPage(m_pages[page]);
+  Touch(page);
+}
+
+unsigned int CGUIFontGlyphAtlas::GetLeastRecentlyUsedPage() const
+{
+  unsigned int lru = NO_PAGE;
+  for (unsigned int i = 0; i < m_pages.size(); i++)
+  {
+    if (lru == NO_PAGE || m_pages[i].lastUsed < m_pages[lru].lastUsed)
+      lru = i;
+  }
+  return lru;
+}
+
+float CGUIFontGlyphAtlas::GetOccupancy() const
+{
+  if (m_pages.empty() || !m_width || !m_pageHeight)
+    return 0.0f;
+
+  double used = 0;
+  for (std::vector<Page>::const_iterator it = m_pages.begin(); it != m_pages.end(); ++it)
+    used += it->usedArea;
+  return (float)(used / ((double)m_pages.size() * m_width * m_pageHeight));
+}
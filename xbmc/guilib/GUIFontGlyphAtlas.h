@@ -0,0 +1,112 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <vector>
+
+/*!
+ \ingroup textures
+ \brief Skyline packer for the glyph cache texture of a font.
+
+ The texture is split into fixed-size pages stacked vertically. Each page tracks the
+ skyline formed by the glyphs placed so far, and new glyphs go where their top edge
+ ends up lowest, so short and tall glyphs mix without wasting whole lines. Pages
+ remember when they were last used, so the least recently used page can be emptied
+ and reused when the texture can't grow any further.
+
+ The atlas only does the bookkeeping, it doesn't own any pixels.
+ */
+class CGUIFontGlyphAtlas
+{
+public:
+  static const unsigned int NO_PAGE = (unsigned int)-1;
+
+  CGUIFontGlyphAtlas();
+
+  /*! \brief Drop all pages and set the geometry used for new ones
+   \param width width of each page in pixels
+   \param pageHeight height of each page in pixels
+   \param maxPages maximum number of pages the texture can hold
+   */
+  void Reset(unsigned int width, unsigned int pageHeight, unsigned int maxPages);
+
+  /*! \brief Find room for a rectangle in the existing pages
+   \param width width of the rectangle, including any spacing
+   \param height height of the rectangle, including any spacing
+   \param x [out] left of the rectangle in texture coordinates
+   \param y [out] top of the rectangle in texture coordinates
+   \param page [out] page the rectangle was placed on
+   \return true if the rectangle was placed, false if a page has to be added or evicted first
+   */
+  bool Allocate(unsigned int width, unsigned int height, unsigned int &x, unsigned int &y, unsigned int &page);
+
+  /*! \brief Add an empty page below the existing ones
+   \return false if the atlas already has the maximum number of pages
+   */
+  bool AddPage();
+
+  /*! \brief Empty a page so it can be filled again */
+  void ClearPage(unsigned int page);
+
+  /*! \brief Mark a page as used by the current frame */
+  inline void Touch(unsigned int page)
+  {
+    if (page < m_pages.size())
+      m_pages[page].lastUsed = ++m_clock;
+  }
+
+  /*! \brief Get the page that was used the longest time ago
+   \return the page, or NO_PAGE if there are no pages
+   */
+  unsigned int GetLeastRecentlyUsedPage() const;
+
+  unsigned int GetPageCount() const { return m_pages.size(); };
+  unsigned int GetMaxPages() const { return m_maxPages; };
+  unsigned int GetPageHeight() const { return m_pageHeight; };
+
+  /*! \brief Fraction of the area of all pages covered by allocated rectangles */
+  float GetOccupancy() const;
+
+private:
+  struct SkylineNode
+  {
+    unsigned int x;
+    unsigned int y;      // first free row inside the page from x to x + width
+    unsigned int width;
+  };
+
+  struct Page
+  {
+    std::vector<SkylineNode> skyline;
+    unsigned int usedArea;
+    unsigned int lastUsed;
+  };
+
+  int Fit(const Page &page, unsigned int node, unsigned int width, unsigned int height) const;
+  bool AllocateInPage(Page &page, unsigned int width, unsigned int height, unsigned int &x, unsigned int &y);
+  void ResetPage(Page &page);
+
+  std::vector<Page> m_pages;
+  unsigned int m_width;
+  unsigned int m_pageHeight;
+  unsigned int m_maxPages;
+  unsigned int m_clock;
+};
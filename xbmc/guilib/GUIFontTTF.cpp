@@ -49,7 +49,7 @@ using namespace std;
 
 
 #define CHARS_PER_TEXTURE_LINE 20 // number of characters to cache per texture line
-#define CHAR_CHUNK    64      // 64 chars allocated at a time (1024 bytes)
+#define LINES_PER_TEXTURE_PAGE 4 // number of texture lines in each page of the glyph atlas
 
 int CGUIFontTTFBase::justification_word_weight = 6;   // weight of word spacing over letter spacing when justifying.
                                                   // A larger number means more of the "dead space" is placed between
@@ -141,8 +141,6 @@ XBMC_GLOBAL_REF(CFreeTypeLibrary, g_freeTypeLibrary); // our freetype library
 CGUIFontTTFBase::CGUIFontTTFBase(const CStdString& strFileName)
 {
   m_texture = NULL;
-  m_char = NULL;
-  m_maxChars = 0;
   m_nestedBeginCount = 0;
 
   m_vertex_size   = 4*1024;
@@ -155,8 +153,6 @@ CGUIFontTTFBase::CGUIFontTTFBase(const CStdString& strFileName)
   m_referenceCount = 0;
   m_originX = m_originY = 0.0f;
   m_cellBaseLine = m_cellHeight = 0;
-  m_numChars = 0;
-  m_posX = m_posY = 0;
   m_textureHeight = m_textureWidth = 0;
   m_textureScaleX = m_textureScaleY = 0.0;
   m_ellipsesWidth = m_height = 0.0f;
@@ -191,14 +187,10 @@ void CGUIFontTTFBase::ClearCharacterCache()
   DeleteHardwareTexture();
 
   m_texture = NULL;
-  delete[] m_char;
-  m_char = new Character[CHAR_CHUNK];
+  m_chars.clear();
   memset(m_charquick, 0, sizeof(m_charquick));
-  m_numChars = 0;
-  m_maxChars = CHAR_CHUNK;
-  // set the posX and posY so that our texture will be created on first character write.
-  m_posX = m_textureWidth;
-  m_posY = -(int)GetTextureLineHeight();
+  // empty the atlas so that our texture will be created on first character write.
+  m_atlas.Reset(m_textureWidth, m_atlas.GetPageHeight(), m_atlas.GetMaxPages());
   m_textureHeight = 0;
 }
 
@@ -206,13 +198,9 @@ void CGUIFontTTFBase::Clear()
 {
   delete(m_texture);
   m_texture = NULL;
-  delete[] m_char;
+  m_chars.clear();
   memset(m_charquick, 0, sizeof(m_charquick));
-  m_char = NULL;
-  m_maxChars = 0;
-  m_numChars = 0;
-  m_posX = 0;
-  m_posY = 0;
+  m_atlas.Reset(0, 0, 0);
   m_nestedBeginCount = 0;
 
   if (m_face)
@@ -290,11 +278,8 @@ bool CGUIFontTTFBase::Load(const CStdString& strFilename, float height, float as
 
   delete(m_texture);
   m_texture = NULL;
-  delete[] m_char;
-  m_char = NULL;
-
-  m_maxChars = 0;
-  m_numChars = 0;
+  m_chars.clear();
+  memset(m_charquick, 0, sizeof(m_charquick));
 
   m_strFilename = strFilename;
 
@@ -307,9 +292,12 @@ bool CGUIFontTTFBase::Load(const CStdString& strFilename, float height, float as
     m_textureWidth = g_Windowing.GetMaxTextureSize();
   m_textureScaleX = 1.0f / m_textureWidth;
 
-  // set the posX and posY so that our texture will be created on first character write.
-  m_posX = m_textureWidth;
-  m_posY = -(int)GetTextureLineHeight();
+  // the texture grows a page at a time, up to the maximum texture size.
+  // it is created on first character write.
+  unsigned int pageHeight = CBaseTexture::PadPow2(GetTextureLineHeight() * LINES_PER_TEXTURE_PAGE);
+  if (pageHeight > g_Windowing.GetMaxTextureSize())
+    pageHeight = g_Windowing.GetMaxTextureSize();
+  m_atlas.Reset(m_textureWidth, pageHeight, g_Windowing.GetMaxTextureSize() / pageHeight);
 
   // cache the ellipses width
   Character *ellipse = GetCharacter(L'.');
@@ -487,55 +475,33 @@ CGUIFontTTFBase::Character* CGUIFontTTFBase::GetCharacter(character_t chr)
   {
     character_t ch = (style << 8) | letter;
     if (m_charquick[ch])
+    {
+      m_atlas.Touch(m_charquick[ch]->page);
       return m_charquick[ch];
+    }
   }
 
   // letters are stored based on style and letter
   character_t ch = (style << 16) | letter;
 
-  int low = 0;
-  int high = m_numChars - 1;
-  while (low <= high)
+  CharacterMap::iterator it = m_chars.find(ch);
+  if (it != m_chars.end())
   {
-    int mid = (low + high) >> 1;
-    if (ch > m_char[mid].letterAndStyle)
-      low = mid + 1;
-    else if (ch < m_char[mid].letterAndStyle)
-      high = mid - 1;
-    else
-      return &m_char[mid];
+    m_atlas.Touch(it->second.page);
+    return &it->second;
   }
-  // if we get to here, then low is where we should insert the new character
 
-  // increase the size of the buffer if we need it
-  if (m_numChars >= m_maxChars)
-  { // need to increase the size of the buffer
-    Character *newTable = new Character[m_maxChars + CHAR_CHUNK];
-    if (m_char)
-    {
-      memcpy(newTable, m_char, low * sizeof(Character));
-      memcpy(newTable + low + 1, m_char + low, (m_numChars - low) * sizeof(Character));
-      delete[] m_char;
-    }
-    m_char = newTable;
-    m_maxChars += CHAR_CHUNK;
-
-  }
-  else
-  { // just move the data along as necessary
-    memmove(m_char + low + 1, m_char + low, (m_numChars - low) * sizeof(Character));
-  }
   // render the character to our texture
   // must End() as we can't render text to our texture during a Begin(), End() block
+  Character newChar;
   unsigned int nestedBeginCount = m_nestedBeginCount;
   m_nestedBeginCount = 1;
   if (nestedBeginCount) End();
-  if (!CacheCharacter(letter, style, m_char + low))
+  if (!CacheCharacter(letter, style, &newChar))
   { // unable to cache character - try clearing them all out and starting over
-    CLog::Log(LOGDEBUG, "%s: Unable to cache character.  Clearing character cache of %i characters", __FUNCTION__, m_numChars);
+    CLog::Log(LOGDEBUG, "%s: Unable to cache character.  Clearing character cache of %i characters", __FUNCTION__, (int)m_chars.size());
     ClearCharacterCache();
-    low = 0;
-    if (!CacheCharacter(letter, style, m_char + low))
+    if (!CacheCharacter(letter, style, &newChar))
     {
       CLog::Log(LOGERROR, "%s: Unable to cache character (out of memory?)", __FUNCTION__);
       if (nestedBeginCount) Begin();
@@ -546,18 +512,12 @@ CGUIFontTTFBase::Character* CGUIFontTTFBase::GetCharacter(character_t chr)
   if (nestedBeginCount) Begin();
   m_nestedBeginCount = nestedBeginCount;
 
-  // fixup quick access
-  memset(m_charquick, 0, sizeof(m_charquick));
-  for(int i=0;i<m_numChars;i++)
-  {
-    if ((m_char[i].letterAndStyle & 0xffff) < 255)
-    {
-      character_t ch = ((m_char[i].letterAndStyle & 0xffff0000) >> 8) | (m_char[i].letterAndStyle & 0xff);
-      m_charquick[ch] = m_char+i;
-    }
-  }
+  // map nodes don't move, so quick access can point straight at them
+  Character *character = &m_chars.insert(make_pair(ch, newChar)).first->second;
+  if (letter < 255)
+    m_charquick[(style << 8) | letter] = character;
 
-  return m_char + low;
+  return character;
 }
 
 bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *ch)
@@ -594,47 +554,15 @@ bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *
   FT_Bitmap bitmap = bitGlyph->bitmap;
   bool isEmptyGlyph = (bitmap.width == 0 || bitmap.rows == 0);
 
+  unsigned int x = 0, y = 0, page = CGUIFontGlyphAtlas::NO_PAGE;
   if (!isEmptyGlyph)
   {
-    if (bitGlyph->left < 0)
-      m_posX += -bitGlyph->left;
-
-    // check we have enough room for the character
-    if (m_posX + bitGlyph->left + bitmap.width > (int)m_textureWidth)
-    { // no space - gotta drop to the next line (which means creating a new texture and copying it across)
-      m_posX = 0;
-      m_posY += GetTextureLineHeight();
-      if (bitGlyph->left < 0)
-        m_posX += -bitGlyph->left;
-
-      if(m_posY + GetTextureLineHeight() >= m_textureHeight)
-      {
-        // create the new larger texture
-        unsigned int newHeight = m_posY + GetTextureLineHeight();
-        // check for max height
-        if (newHeight > g_Windowing.GetMaxTextureSize())
-        {
-          CLog::Log(LOGDEBUG, "%s: New cache texture is too large (%u > %u pixels long)", __FUNCTION__, newHeight, g_Windowing.GetMaxTextureSize());
-          FT_Done_Glyph(glyph);
-          return false;
-        }
-
-        CBaseTexture* newTexture = NULL;
-        newTexture = ReallocTexture(newHeight);
-        if(newTexture == NULL)
-        {
-          FT_Done_Glyph(glyph);
-          CLog::Log(LOGDEBUG, "%s: Failed to allocate new texture of height %u", __FUNCTION__, newHeight);
-          return false;
-        }
-        m_texture = newTexture;
-      }
-    }
-
-    if(m_texture == NULL)
+    // find room for the character, keeping a gap so neighbours don't bleed into each other
+    if (!AllocateGlyph(bitmap.width + spacing_between_characters_in_texture,
+                       bitmap.rows + spacing_between_characters_in_texture, x, y, page))
     {
       FT_Done_Glyph(glyph);
-      CLog::Log(LOGDEBUG, "%s: no texture to cache character to", __FUNCTION__);
+      CLog::Log(LOGDEBUG, "%s: no room in the texture to cache character to", __FUNCTION__);
       return false;
     }
   }
@@ -642,25 +570,21 @@ bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *
   ch->letterAndStyle = (style << 16) | letter;
   ch->offsetX = (short)bitGlyph->left;
   ch->offsetY = (short)m_cellBaseLine - bitGlyph->top;
-  ch->left = isEmptyGlyph ? 0 : ((float)m_posX + ch->offsetX);
-  ch->top = isEmptyGlyph ? 0 : ((float)m_posY + ch->offsetY);
+  ch->left = isEmptyGlyph ? 0 : (float)x;
+  ch->top = isEmptyGlyph ? 0 : (float)y;
   ch->right = ch->left + bitmap.width;
   ch->bottom = ch->top + bitmap.rows;
   ch->advance = (float)MathUtils::round_int( (float)m_face->glyph->advance.x / 64 );
+  ch->page = page;
 
   // we need only render if we actually have some pixels
   if (!isEmptyGlyph)
   {
     // ensure our rect will stay inside the texture (it *should* but we need to be certain)
-    unsigned int x1 = max(m_posX + ch->offsetX, 0);
-    unsigned int y1 = max(m_posY + ch->offsetY, 0);
-    unsigned int x2 = min(x1 + bitmap.width, m_textureWidth);
-    unsigned int y2 = min(y1 + bitmap.rows, m_textureHeight);
-    CopyCharToTexture(bitGlyph, x1, y1, x2, y2);
-  
-    m_posX += spacing_between_characters_in_texture + (unsigned short)max(ch->right - ch->left + ch->offsetX, ch->advance);
+    unsigned int x2 = min(x + bitmap.width, m_textureWidth);
+    unsigned int y2 = min(y + bitmap.rows, m_textureHeight);
+    CopyCharToTexture(bitGlyph, x, y, x2, y2);
   }
-  m_numChars++;
 
   // free the glyph
   FT_Done_Glyph(glyph);
@@ -668,6 +592,70 @@ bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *
   return true;
 }
 
+bool CGUIFontTTFBase::AllocateGlyph(unsigned int width, unsigned int height, unsigned int &x, unsigned int &y, unsigned int &page)
+{
+  if (m_atlas.Allocate(width, height, x, y, page))
+    return true;
+
+  // no room in the pages we have - add a page, growing the texture if need be
+  if (m_atlas.GetPageCount() < m_atlas.GetMaxPages())
+  {
+    unsigned int newHeight = (m_atlas.GetPageCount() + 1) * m_atlas.GetPageHeight();
+    if (newHeight > m_textureHeight || !m_texture)
+    {
+      CBaseTexture* newTexture = ReallocTexture(newHeight);
+      if (newTexture)
+        m_texture = newTexture;
+      else
+        CLog::Log(LOGDEBUG, "%s: Failed to allocate new texture of height %u", __FUNCTION__, newHeight);
+    }
+    // the texture may have been padded, so take every page that fits
+    while (m_texture && (m_atlas.GetPageCount() + 1) * m_atlas.GetPageHeight() <= m_textureHeight && m_atlas.AddPage())
+      ;
+    if (m_atlas.Allocate(width, height, x, y, page))
+      return true;
+  }
+
+  // the texture can't grow any further - reuse the page that was used the longest time ago
+  unsigned int lru = m_atlas.GetLeastRecentlyUsedPage();
+  if (lru == CGUIFontGlyphAtlas::NO_PAGE || !m_texture)
+    return false;
+
+  EvictPage(lru);
+  return m_atlas.Allocate(width, height, x, y, page);
+}
+
+void CGUIFontTTFBase::EvictPage(unsigned int page)
+{
+  CLog::Log(LOGDEBUG, "%s: Evicting page %u of %u from the character cache", __FUNCTION__, page, m_atlas.GetPageCount());
+
+  for (CharacterMap::iterator it = m_chars.begin(); it != m_chars.end(); )
+  {
+    if (it->second.page == page)
+    {
+      if ((it->first & 0xffff) < 255)
+        m_charquick[((it->first & 0xffff0000) >> 8) | (it->first & 0xff)] = NULL;
+      it = m_chars.erase(it);
+    }
+    else
+      ++it;
+  }
+
+  // blank the page so old pixels don't show up in the gaps between the new characters
+  unsigned int pageHeight = m_atlas.GetPageHeight();
+  vector<unsigned char> blank(m_textureWidth * pageHeight, 0);
+  FT_BitmapGlyphRec blankGlyph;
+  memset(&blankGlyph, 0, sizeof(blankGlyph));
+  blankGlyph.bitmap.width = m_textureWidth;
+  blankGlyph.bitmap.rows = pageHeight;
+  blankGlyph.bitmap.pitch = m_textureWidth;
+  blankGlyph.bitmap.buffer = &blank[0];
+  unsigned int y1 = page * pageHeight;
+  CopyCharToTexture(&blankGlyph, 0, y1, m_textureWidth, min(y1 + pageHeight, m_textureHeight));
+
+  m_atlas.ClearPage(page);
+}
+
 void CGUIFontTTFBase::RenderCharacter(float posX, float posY, const Character *ch, color_t color, bool roundX)
 {
   // actual image width isn't same as the character width as that is
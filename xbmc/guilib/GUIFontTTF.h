@@ -28,6 +28,9 @@
  */
 
 #include "utils/auto_buffer.h"
+#include "GUIFontGlyphAtlas.h"
+
+#include <boost/unordered_map.hpp>
 
 // forward definition
 class CBaseTexture;
@@ -91,7 +94,9 @@ protected:
     float left, top, right, bottom;
     float advance;
     character_t letterAndStyle;
+    unsigned int page;               // atlas page holding the glyph, NO_PAGE if it has no pixels
   };
+  typedef boost::unordered_map<character_t, Character> CharacterMap;
   void AddReference();
   void RemoveReference();
 
@@ -111,6 +116,8 @@ protected:
   // Stuff for pre-rendering for speed
   inline Character *GetCharacter(character_t letter);
   bool CacheCharacter(wchar_t letter, uint32_t style, Character *ch);
+  bool AllocateGlyph(unsigned int width, unsigned int height, unsigned int &x, unsigned int &y, unsigned int &page);
+  void EvictPage(unsigned int page);
   void RenderCharacter(float posX, float posY, const Character *ch, color_t color, bool roundX);
   void ClearCharacterCache();
 
@@ -126,8 +133,7 @@ protected:
 
   unsigned int m_textureWidth;       // width of our texture
   unsigned int m_textureHeight;      // heigth of our texture
-  int m_posX;                        // current position in the texture
-  int m_posY;
+  CGUIFontGlyphAtlas m_atlas;        // where the glyphs are placed in the texture
 
   /*! \brief the height of each line in the texture.
    Accounts for spacing between lines to avoid characters overlapping.
@@ -137,10 +143,8 @@ protected:
 
   color_t m_color;
 
-  Character *m_char;                 // our characters
+  CharacterMap m_chars;              // our characters, keyed by style and letter
   Character *m_charquick[256*4];     // ascii chars (4 styles) here
-  int m_maxChars;                    // size of character array (can be incremented)
-  int m_numChars;                    // the current number of cached characters
 
   float m_ellipsesWidth;               // this is used every character (width of '.')
 
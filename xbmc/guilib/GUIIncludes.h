@@ -24,6 +24,7 @@
 
 #include <map>
 #include <set>
+#include <vector>
 #include "interfaces/info/InfoBool.h"
 
 // forward definitions
@@ -51,6 +52,11 @@ public:
   void ResolveIncludes(TiXmlElement *node, std::map<INFO::InfoPtr, bool>* xmlIncludeConditions = NULL);
   const INFO::CSkinVariableString* CreateSkinVariable(const CStdString& name, int context);
 
+  /*! \brief Get the include files loaded so far
+   \return paths of includes.xml and any files loaded through <include file="">
+   */
+  const std::vector<CStdString>& GetFiles() const { return m_files; }
+
 private:
   enum ResolveParamsResult
   {
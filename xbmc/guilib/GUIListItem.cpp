@@ -115,6 +115,7 @@ const CStdStringW& CGUIListItem::GetSortLabel() const
 
 void CGUIListItem::SetArt(const std::string &type, const std::string &url)
 {
+  m_lazyArt.erase(type);
   ArtMap::iterator i = m_art.find(type);
   if (i == m_art.end() || i->second != url)
   {
@@ -123,9 +124,17 @@ void CGUIListItem::SetArt(const std::string &type, const std::string &url)
   }
 }
 
+void CGUIListItem::SetArt(const std::string &type, const CGUIListItemArtPtr &art)
+{
+  m_art.erase(type);
+  m_lazyArt[type] = art;
+  SetInvalid();
+}
+
 void CGUIListItem::SetArt(const ArtMap &art)
 {
   m_art = art;
+  m_lazyArt.clear();
   SetInvalid();
 }
 
@@ -137,6 +146,7 @@ void CGUIListItem::SetArtFallback(const std::string &from, const std::string &to
 void CGUIListItem::ClearArt()
 {
   m_art.clear();
+  m_lazyArt.clear();
   m_artFallbacks.clear();
 }
 
@@ -146,28 +156,63 @@ void CGUIListItem::AppendArt(const ArtMap &art, const std::string &prefix)
     SetArt(prefix.empty() ? i->first : prefix + '.' + i->first, i->second);
 }
 
-std::string CGUIListItem::GetArt(const std::string &type) const
+bool CGUIListItem::GetArtURL(const std::string &type, std::string &url) const
 {
   ArtMap::const_iterator i = m_art.find(type);
   if (i != m_art.end())
-    return i->second;
-  i = m_artFallbacks.find(type);
-  if (i != m_artFallbacks.end())
   {
-    ArtMap::const_iterator j = m_art.find(i->second);
-    if (j != m_art.end())
-      return j->second;
+    url = i->second;
+    return true;
   }
+  LazyArtMap::const_iterator j = m_lazyArt.find(type);
+  if (j != m_lazyArt.end())
+  {
+    url = j->second->GetURL();
+    return true;
+  }
+  return false;
+}
+
+std::string CGUIListItem::GetArt(const std::string &type) const
+{
+  std::string url;
+  if (GetArtURL(type, url))
+    return url;
+  ArtMap::const_iterator i = m_artFallbacks.find(type);
+  if (i != m_artFallbacks.end() && GetArtURL(i->second, url))
+    return url;
   return "";
 }
 
-const CGUIListItem::ArtMap &CGUIListItem::GetArt() const
+CGUIListItem::ArtMap CGUIListItem::GetArt() const
+{
+  // built into a copy, items are read from several threads at once
+  ArtMap art = m_art;
+  for (LazyArtMap::const_iterator i = m_lazyArt.begin(); i != m_lazyArt.end(); ++i)
+    art[i->first] = i->second->GetURL();
+  return art;
+}
+
+bool CGUIListItem::HasAnyArt() const
+{
+  return !m_art.empty() || !m_lazyArt.empty();
+}
+
+/* PLEX */
+CGUIListItemArtPtr CGUIListItem::GetLazyArt(const std::string &type) const
 {
-  return m_art;
+  LazyArtMap::const_iterator i = m_lazyArt.find(type);
+  if (i != m_lazyArt.end())
+    return i->second;
+  return CGUIListItemArtPtr();
 }
+/* END PLEX */
 
 bool CGUIListItem::HasArt(const std::string &type) const
 {
+  // lazy art always has a url, no need to build it
+  if (m_lazyArt.find(type) != m_lazyArt.end())
+    return true;
   return !GetArt(type).empty();
 }
 
@@ -255,6 +300,7 @@ CGUIListItem& CGUIListItem::operator =(const CGUIListItem& item)
   m_bIsFolder = item.m_bIsFolder;
   m_mapProperties = item.m_mapProperties;
   m_art = item.m_art;
+  m_lazyArt = item.m_lazyArt;
 
   m_artFallbacks = item.m_artFallbacks;
   SetInvalid();
@@ -278,8 +324,9 @@ void CGUIListItem::Archive(CArchive &ar)
       ar << it->first;
       ar << it->second;
     }
-    ar << (int)m_art.size();
-    for (ArtMap::const_iterator i = m_art.begin(); i != m_art.end(); i++)
+    const ArtMap &art = GetArt();
+    ar << (int)art.size();
+    for (ArtMap::const_iterator i = art.begin(); i != art.end(); i++)
     {
       ar << i->first;
       ar << i->second;
@@ -320,6 +367,7 @@ void CGUIListItem::Archive(CArchive &ar)
       std::string key, value;
       ar >> key;
       ar >> value;
+      m_lazyArt.erase(key);
       m_art.insert(make_pair(key, value));
     }
     ar >> mapSize;
@@ -346,7 +394,8 @@ void CGUIListItem::Serialize(CVariant &value)
   {
     value["properties"][it->first] = it->second;
   }
-  for (ArtMap::const_iterator it = m_art.begin(); it != m_art.end(); it++)
+  const ArtMap &art = GetArt();
+  for (ArtMap::const_iterator it = art.begin(); it != art.end(); it++)
     value["art"][it->first] = it->second;
 }
 
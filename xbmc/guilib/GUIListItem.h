@@ -32,6 +32,7 @@
 
 #include <map>
 #include <string>
+#include <boost/shared_ptr.hpp>
 #include "utils/Variant.h"
 
 //  Forward
@@ -43,6 +44,22 @@ class CVariant;
 #include "PlexTypes.h"
 /* END PLEX */
 
+/*!
+ \ingroup controls
+ \brief Art whose url is only built once something asks for it.
+
+ Items often carry several sizes of the same image, and only one of them is ever shown.
+ Instances may be shared between items, so GetURL() has to be safe to call from any thread.
+ */
+class CGUIListItemArt
+{
+public:
+  virtual ~CGUIListItemArt() {}
+  virtual std::string GetURL() const = 0;
+};
+
+typedef boost::shared_ptr<const CGUIListItemArt> CGUIListItemArtPtr;
+
 /*!
  \ingroup controls
  \brief
@@ -51,6 +68,7 @@ class CGUIListItem
 {
 public:
   typedef std::map<std::string, std::string> ArtMap;
+  typedef std::map<std::string, CGUIListItemArtPtr> LazyArtMap;
 
   enum GUIIconOverlay { ICON_OVERLAY_NONE = 0,
                         ICON_OVERLAY_RAR,
@@ -91,6 +109,13 @@ public:
    */
   void SetArt(const std::string &type, const std::string &url);
 
+  /*! \brief Set a particular art type for an item, building its url only when it's asked for
+   \param type type of art to set.
+   \param art the art, which may be shared with other items.
+   \sa GetArt
+   */
+  void SetArt(const std::string &type, const CGUIListItemArtPtr &art);
+
   /*! \brief set artwork for an item
    \param art a type:url map for artwork
    \sa GetArt
@@ -123,11 +148,23 @@ public:
   std::string GetArt(const std::string &type) const;
 
   /*! \brief get artwork for an item
-   Retrieves artwork in a type:url map
+   Retrieves artwork in a type:url map, building the urls of any art set with SetArt(type, art)
    \return a type:url map for artwork
    \sa SetArt
    */
-  const ArtMap &GetArt() const;
+  ArtMap GetArt() const;
+
+  /*! \brief Check whether an item has any art, without building the urls of any
+   Equivalent to !GetArt().empty()
+   */
+  bool HasAnyArt() const;
+
+  /* PLEX */
+  /*! \brief Get art set with SetArt(type, art) without building its url
+   \return the art, or an empty pointer if the type isn't set that way
+   */
+  CGUIListItemArtPtr GetLazyArt(const std::string &type) const;
+  /* END PLEX */
 
   /*! \brief Check whether an item has a particular piece of art
    Equivalent to !GetArt(type).empty()
@@ -233,6 +270,9 @@ public:
 
   int GetOverlayImageID() const { return m_overlayIcon; }
   const PropertyMap& GetAllProperties() const { return m_mapProperties; }
+
+  /*! \brief Release the memory the properties kept for growing, once the item is filled in */
+  void CompactProperties() { m_mapProperties.compact(); }
   /* END PLEX */
 
 protected:
@@ -257,10 +297,13 @@ protected:
 
 
 private:
+  bool GetArtURL(const std::string &type, std::string &url) const;
+
   CStdStringW m_sortLabel;    // text for sorting. Need to be UTF16 for proper sorting
   CStdString m_strLabel;      // text of column1
 
   ArtMap m_art;
+  LazyArtMap m_lazyArt; // art whose url hasn't been asked for, never in m_art too
   ArtMap m_artFallbacks;
 };
 #endif
@@ -0,0 +1,349 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUISkinCache.h"
+#include "GUIInfoManager.h"
+#include "filesystem/File.h"
+#include "Util.h"
+#include "utils/Crc32.h"
+#include "utils/log.h"
+#include "utils/URIUtils.h"
+#include "utils/XBMCTinyXML.h"
+
+#include <string.h>
+
+using namespace std;
+using namespace XFILE;
+
+// bump whenever the layout below changes
+#define SKIN_CACHE_MAGIC   0x43534258 // "XBSC"
+#define SKIN_CACHE_VERSION 1
+
+// deepest nesting accepted from a cache file, real windows stay far below it
+#define SKIN_CACHE_MAX_DEPTH 256
+
+enum SkinCacheNodeType
+{
+  SKIN_CACHE_ELEMENT = 1,
+  SKIN_CACHE_TEXT    = 2,
+  SKIN_CACHE_CDATA   = 3
+};
+
+static void WriteUInt32(string &out, uint32_t value)
+{
+  out.append((const char *)&value, sizeof(value));
+}
+
+static void WriteInt64(string &out, int64_t value)
+{
+  out.append((const char *)&value, sizeof(value));
+}
+
+static void WriteString(string &out, const char *value)
+{
+  uint32_t length = value ? strlen(value) : 0;
+  WriteUInt32(out, length);
+  out.append(value ? value : "", length);
+}
+
+static bool ReadUInt32(const char *data, size_t size, size_t &pos, uint32_t &value)
+{
+  if (pos + sizeof(value) > size)
+    return false;
+  memcpy(&value, data + pos, sizeof(value));
+  pos += sizeof(value);
+  return true;
+}
+
+static bool ReadInt64(const char *data, size_t size, size_t &pos, int64_t &value)
+{
+  if (pos + sizeof(value) > size)
+    return false;
+  memcpy(&value, data + pos, sizeof(value));
+  pos += sizeof(value);
+  return true;
+}
+
+static bool ReadString(const char *data, size_t size, size_t &pos, string &value)
+{
+  uint32_t length;
+  if (!ReadUInt32(data, size, pos, length) || pos + length > size)
+    return false;
+  value.assign(data + pos, length);
+  pos += length;
+  return true;
+}
+
+static bool StatFile(const CStdString &file, int64_t &mtime, int64_t &size)
+{
+  struct __stat64 st;
+  if (CFile::Stat(file, &st) != 0)
+    return false;
+  mtime = st.st_mtime;
+  size = st.st_size;
+  return true;
+}
+
+CGUISkinCache::CGUISkinCache()
+{
+}
+
+void CGUISkinCache::SetCachePath(const CStdString &path)
+{
+  m_cachePath = path;
+  if (!m_cachePath.IsEmpty() && !CUtil::CreateDirectoryEx(m_cachePath))
+  {
+    CLog::Log(LOGWARNING, "%s - unable to create %s, precompiled skin cache disabled", __FUNCTION__, m_cachePath.c_str());
+    m_cachePath.clear();
+  }
+}
+
+CStdString CGUISkinCache::GetCacheFile(const CStdString &xmlFile, const RESOLUTION_INFO &res) const
+{
+  Crc32 crc;
+  crc.ComputeFromLowerCase(xmlFile);
+  CStdString file;
+  file.Format("%08x_%dx%d.bin", (unsigned int)crc, res.iWidth, res.iHeight);
+  return URIUtils::AddFileToFolder(m_cachePath, file);
+}
+
+TiXmlElement *CGUISkinCache::Load(const CStdString &xmlFile, const RESOLUTION_INFO &res, double skinVersion,
+                                  map<INFO::InfoPtr, bool> &xmlIncludeConditions, vector<CStdString> &includeFiles) const
+{
+  if (m_cachePath.IsEmpty())
+    return NULL;
+
+  CFile file;
+  if (!file.Open(GetCacheFile(xmlFile, res)))
+    return NULL;
+
+  int64_t length = file.GetLength();
+  if (length <= 0)
+    return NULL;
+
+  string buffer;
+  buffer.resize((size_t)length);
+  if (file.Read(&buffer[0], length) != length)
+    return NULL;
+  file.Close();
+
+  const char *data = buffer.c_str();
+  size_t size = buffer.size();
+  size_t pos = 0;
+
+  uint32_t magic, version, width, height;
+  int64_t version64;
+  string path;
+  if (!ReadUInt32(data, size, pos, magic) || magic != SKIN_CACHE_MAGIC ||
+      !ReadUInt32(data, size, pos, version) || version != SKIN_CACHE_VERSION ||
+      !ReadInt64(data, size, pos, version64) || version64 != (int64_t)(skinVersion * 1000) ||
+      !ReadUInt32(data, size, pos, width) || width != (uint32_t)res.iWidth ||
+      !ReadUInt32(data, size, pos, height) || height != (uint32_t)res.iHeight ||
+      !ReadString(data, size, pos, path) || !xmlFile.Equals(path.c_str()))
+    return NULL;
+
+  // the window file comes first, followed by any include files
+  uint32_t count;
+  if (!ReadUInt32(data, size, pos, count))
+    return NULL;
+  vector<CStdString> files;
+  for (uint32_t i = 0; i < count; i++)
+  {
+    int64_t mtime, fileSize, currentTime, currentSize;
+    if (!ReadString(data, size, pos, path) || !ReadInt64(data, size, pos, mtime) || !ReadInt64(data, size, pos, fileSize))
+      return NULL;
+    if (!StatFile(path, currentTime, currentSize) || currentTime != mtime || currentSize != fileSize)
+    {
+      CLog::Log(LOGDEBUG, "%s - %s changed, not using precompiled %s", __FUNCTION__, path.c_str(), xmlFile.c_str());
+      return NULL;
+    }
+    if (i > 0)
+      files.push_back(path);
+  }
+
+  // conditional includes must resolve the same way they did when stored
+  map<INFO::InfoPtr, bool> conditions;
+  if (!ReadUInt32(data, size, pos, count))
+    return NULL;
+  for (uint32_t i = 0; i < count; i++)
+  {
+    uint32_t context, value;
+    if (!ReadString(data, size, pos, path) || !ReadUInt32(data, size, pos, context) || !ReadUInt32(data, size, pos, value))
+      return NULL;
+    INFO::InfoPtr condition = g_infoManager.Register(path, context);
+    if (!condition || condition->Get() != (value != 0))
+      return NULL;
+    conditions[condition] = value != 0;
+  }
+
+  TiXmlNode *root = Deserialize(data, size, pos);
+  if (!root || !root->ToElement())
+  {
+    CLog::Log(LOGWARNING, "%s - invalid precompiled skin file for %s", __FUNCTION__, xmlFile.c_str());
+    delete root;
+    return NULL;
+  }
+
+  xmlIncludeConditions.swap(conditions);
+  includeFiles.swap(files);
+  return root->ToElement();
+}
+
+bool CGUISkinCache::Store(const CStdString &xmlFile, const RESOLUTION_INFO &res, double skinVersion, const TiXmlElement *root,
+                          const map<INFO::InfoPtr, bool> &xmlIncludeConditions, const vector<CStdString> &includeFiles) const
+{
+  if (m_cachePath.IsEmpty() || !root)
+    return false;
+
+  string out;
+  WriteUInt32(out, SKIN_CACHE_MAGIC);
+  WriteUInt32(out, SKIN_CACHE_VERSION);
+  WriteInt64(out, (int64_t)(skinVersion * 1000));
+  WriteUInt32(out, res.iWidth);
+  WriteUInt32(out, res.iHeight);
+  WriteString(out, xmlFile.c_str());
+
+  vector<CStdString> files;
+  files.push_back(xmlFile);
+  files.insert(files.end(), includeFiles.begin(), includeFiles.end());
+  WriteUInt32(out, files.size());
+  for (vector<CStdString>::const_iterator it = files.begin(); it != files.end(); ++it)
+  {
+    int64_t mtime, size;
+    if (!StatFile(*it, mtime, size))
+      return false;
+    WriteString(out, it->c_str());
+    WriteInt64(out, mtime);
+    WriteInt64(out, size);
+  }
+
+  WriteUInt32(out, xmlIncludeConditions.size());
+  for (map<INFO::InfoPtr, bool>::const_iterator it = xmlIncludeConditions.begin(); it != xmlIncludeConditions.end(); ++it)
+  {
+    WriteString(out, it->first->GetExpression().c_str());
+    WriteUInt32(out, it->first->GetContext());
+    WriteUInt32(out, it->second ? 1 : 0);
+  }
+
+  Serialize(root, out);
+
+  // write to a temporary file first so a concurrent or interrupted write never leaves a partial entry
+  CStdString cacheFile = GetCacheFile(xmlFile, res);
+  CStdString tempFile = cacheFile + ".tmp";
+  CFile file;
+  if (!file.OpenForWrite(tempFile, true))
+    return false;
+  bool written = file.Write(out.c_str(), out.size()) == (int)out.size();
+  file.Close();
+
+  if (!written || (CFile::Exists(cacheFile, false) && !CFile::Delete(cacheFile)) || !CFile::Rename(tempFile, cacheFile))
+  {
+    CLog::Log(LOGWARNING, "%s - unable to write %s", __FUNCTION__, cacheFile.c_str());
+    CFile::Delete(tempFile);
+    return false;
+  }
+  return true;
+}
+
+void CGUISkinCache::Serialize(const TiXmlNode *node, string &out)
+{
+  if (const TiXmlElement *element = node->ToElement())
+  {
+    out.push_back(SKIN_CACHE_ELEMENT);
+    WriteString(out, element->Value());
+
+    uint32_t attributes = 0;
+    for (const TiXmlAttribute *attribute = element->FirstAttribute(); attribute; attribute = attribute->Next())
+      attributes++;
+    WriteUInt32(out, attributes);
+    for (const TiXmlAttribute *attribute = element->FirstAttribute(); attribute; attribute = attribute->Next())
+    {
+      WriteString(out, attribute->Name());
+      WriteString(out, attribute->Value());
+    }
+
+    uint32_t children = 0;
+    for (const TiXmlNode *child = element->FirstChild(); child; child = child->NextSibling())
+    {
+      if (child->ToElement() || child->ToText())
+        children++;
+    }
+    WriteUInt32(out, children);
+    for (const TiXmlNode *child = element->FirstChild(); child; child = child->NextSibling())
+    {
+      if (child->ToElement() || child->ToText())
+        Serialize(child, out);
+    }
+  }
+  else if (const TiXmlText *text = node->ToText())
+  {
+    out.push_back(text->CDATA() ? SKIN_CACHE_CDATA : SKIN_CACHE_TEXT);
+    WriteString(out, text->Value());
+  }
+}
+
+TiXmlNode *CGUISkinCache::Deserialize(const char *data, size_t size, size_t &pos, unsigned int depth)
+{
+  if (pos >= size || depth >= SKIN_CACHE_MAX_DEPTH)
+    return NULL;
+
+  char type = data[pos++];
+  string value;
+  if (!ReadString(data, size, pos, value))
+    return NULL;
+
+  if (type == SKIN_CACHE_TEXT || type == SKIN_CACHE_CDATA)
+  {
+    TiXmlText *text = new TiXmlText(value.c_str());
+    text->SetCDATA(type == SKIN_CACHE_CDATA);
+    return text;
+  }
+  if (type != SKIN_CACHE_ELEMENT)
+    return NULL;
+
+  TiXmlElement *element = new TiXmlElement(value.c_str());
+
+  uint32_t count;
+  bool valid = ReadUInt32(data, size, pos, count);
+  for (uint32_t i = 0; valid && i < count; i++)
+  {
+    string name;
+    valid = ReadString(data, size, pos, name) && ReadString(data, size, pos, value);
+    if (valid)
+      element->SetAttribute(name.c_str(), value.c_str());
+  }
+
+  valid = valid && ReadUInt32(data, size, pos, count);
+  for (uint32_t i = 0; valid && i < count; i++)
+  {
+    TiXmlNode *child = Deserialize(data, size, pos, depth + 1);
+    if (child)
+      element->LinkEndChild(child);
+    else
+      valid = false;
+  }
+
+  if (!valid)
+  {
+    delete element;
+    return NULL;
+  }
+  return element;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/StdString.h"
+#include "Resolution.h"
+#include "interfaces/info/InfoBool.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+class TiXmlNode;
+class TiXmlElement;
+
+/*!
+ \ingroup skin
+ \brief Cache of window XML trees with their includes already resolved.
+
+ Entries are stored in a versioned binary form, one file per window and resolution.
+ An entry is only used if the window file and all include files still have the size
+ and modification time they had when it was stored, and all <include condition="">
+ conditions evaluated while resolving still have the same value.
+ */
+class CGUISkinCache
+{
+public:
+  CGUISkinCache();
+
+  /*! \brief Set the folder the cache files are kept in
+   \param path folder for the cache files, an empty path disables the cache
+   */
+  void SetCachePath(const CStdString &path);
+
+  /*! \brief Load a resolved window tree
+   \param xmlFile path of the window XML file
+   \param res resolution the window is loaded in
+   \param skinVersion version of the skin
+   \param xmlIncludeConditions [out] include conditions used while resolving, with their values
+   \param includeFiles [out] include files that were loaded when the entry was stored
+   \return the resolved root element, owned by the caller, or NULL if there is no valid entry
+   */
+  TiXmlElement *Load(const CStdString &xmlFile, const RESOLUTION_INFO &res, double skinVersion,
+                     std::map<INFO::InfoPtr, bool> &xmlIncludeConditions, std::vector<CStdString> &includeFiles) const;
+
+  /*! \brief Store a resolved window tree
+   \param xmlFile path of the window XML file the tree was loaded from
+   \param res resolution the window is loaded in
+   \param skinVersion version of the skin
+   \param root the root element with includes resolved
+   \param xmlIncludeConditions include conditions used while resolving, with their values
+   \param includeFiles include files loaded while resolving
+   \return true if the entry was written
+   */
+  bool Store(const CStdString &xmlFile, const RESOLUTION_INFO &res, double skinVersion, const TiXmlElement *root,
+             const std::map<INFO::InfoPtr, bool> &xmlIncludeConditions, const std::vector<CStdString> &includeFiles) const;
+
+  /*! \brief Append the binary form of an XML node and its children to a buffer
+   Only elements and text nodes are kept, comments and declarations are dropped.
+   */
+  static void Serialize(const TiXmlNode *node, std::string &out);
+
+  /*! \brief Create an XML node from its binary form
+   \param data buffer holding the binary form
+   \param size size of the buffer
+   \param pos [in/out] offset of the node in the buffer, set to the offset following it
+   \param depth nesting depth of the node, nodes nested too deep are rejected as invalid
+   \return the new node, owned by the caller, or NULL if the data is invalid
+   */
+  static TiXmlNode *Deserialize(const char *data, size_t size, size_t &pos, unsigned int depth = 0);
+
+private:
+  CStdString GetCacheFile(const CStdString &xmlFile, const RESOLUTION_INFO &res) const;
+
+  CStdString m_cachePath;
+};
@@ -19,6 +19,7 @@
  */
 
 #include "GUITextLayout.h"
+#include "GUITextLayoutCache.h"
 #include "GUIFont.h"
 #include "GUIControl.h"
 #include "GUIColorManager.h"
@@ -231,6 +232,27 @@ bool CGUITextLayout::UpdateW(const CStdStringW &text, float maxWidth /*= 0*/, bo
   if (text.Equals(m_lastText) && !forceUpdate)
     return false;
 
+  // the same labels are laid out over and over again, so check the cache first
+  CGUITextLayoutCache::Key key;
+  key.text = text;
+  key.font = m_font;
+  key.maxWidth = (m_wrap && maxWidth > 0) ? maxWidth : 0;
+  key.maxHeight = m_maxHeight;
+  key.textColor = m_textColor;
+  key.wrap = m_wrap;
+  key.forceLTRReadingOrder = forceLTRReadingOrder;
+
+  CGUITextLayoutCache::Layout layout;
+  if (m_font && !forceUpdate && CGUITextLayoutCache::GetInstance().Get(key, layout))
+  {
+    m_lines.swap(layout.lines);
+    m_colors.swap(layout.colors);
+    m_textWidth = layout.width;
+    m_textHeight = layout.height;
+    m_lastText = text;
+    return true;
+  }
+
   vecText parsedText;
 
   // empty out our previous string
@@ -256,6 +278,15 @@ bool CGUITextLayout::UpdateW(const CStdStringW &text, float maxWidth /*= 0*/, bo
   // and cache the width and height for later reading
   CalcTextExtent();
 
+  if (m_font)
+  {
+    layout.lines = m_lines;
+    layout.colors = m_colors;
+    layout.width = m_textWidth;
+    layout.height = m_textHeight;
+    CGUITextLayoutCache::GetInstance().Add(key, layout);
+  }
+
   m_lastText = text;
   return true;
 }
@@ -0,0 +1,123 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUITextLayoutCache.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+
+#include <boost/functional/hash.hpp>
+
+using namespace std;
+
+bool CGUITextLayoutCache::Key::operator==(const Key &right) const
+{
+  return font == right.font &&
+         maxWidth == right.maxWidth &&
+         maxHeight == right.maxHeight &&
+         textColor == right.textColor &&
+         wrap == right.wrap &&
+         forceLTRReadingOrder == right.forceLTRReadingOrder &&
+         text == right.text;
+}
+
+size_t CGUITextLayoutCache::KeyHash::operator()(const Key &key) const
+{
+  size_t seed = boost::hash_range(key.text.begin(), key.text.end());
+  boost::hash_combine(seed, key.font);
+  boost::hash_combine(seed, key.maxWidth);
+  boost::hash_combine(seed, key.maxHeight);
+  boost::hash_combine(seed, key.textColor);
+  boost::hash_combine(seed, key.wrap);
+  boost::hash_combine(seed, key.forceLTRReadingOrder);
+  return seed;
+}
+
+CGUITextLayoutCache::CGUITextLayoutCache(unsigned int maxEntries, unsigned int maxTextLength)
+{
+  m_maxEntries = maxEntries;
+  m_maxTextLength = maxTextLength;
+  m_hits = 0;
+  m_misses = 0;
+}
+
+CGUITextLayoutCache &CGUITextLayoutCache::GetInstance()
+{
+  static CGUITextLayoutCache cache;
+  return cache;
+}
+
+bool CGUITextLayoutCache::Get(const Key &key, Layout &layout)
+{
+  CSingleLock lock(m_critSection);
+  EntryMap::iterator it = m_index.find(key);
+  if (it == m_index.end())
+  {
+    m_misses++;
+    return false;
+  }
+
+  // move to the front so it's the last to be dropped
+  m_entries.splice(m_entries.begin(), m_entries, it->second);
+  layout = it->second->second;
+  m_hits++;
+  return true;
+}
+
+void CGUITextLayoutCache::Add(const Key &key, const Layout &layout)
+{
+  if (key.text.size() > m_maxTextLength || !m_maxEntries)
+    return;
+
+  CSingleLock lock(m_critSection);
+  EntryMap::iterator it = m_index.find(key);
+  if (it != m_index.end())
+  {
+    it->second->second = layout;
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return;
+  }
+
+  while (m_entries.size() >= m_maxEntries)
+  {
+    m_index.erase(m_entries.back().first);
+    m_entries.pop_back();
+  }
+
+  m_entries.push_front(make_pair(key, layout));
+  m_index[key] = m_entries.begin();
+}
+
+void CGUITextLayoutCache::Clear()
+{
+  CSingleLock lock(m_critSection);
+  if (m_hits || m_misses)
+    CLog::Log(LOGDEBUG, "%s - dropping %u layouts, %u hits, %u misses", __FUNCTION__, (unsigned int)m_entries.size(), m_hits, m_misses);
+
+  m_index.clear();
+  m_entries.clear();
+  m_hits = 0;
+  m_misses = 0;
+}
+
+unsigned int CGUITextLayoutCache::GetSize() const
+{
+  CSingleLock lock(m_critSection);
+  return m_entries.size();
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUITextLayout.h"
+#include "threads/CriticalSection.h"
+
+#include <list>
+#include <boost/unordered_map.hpp>
+
+/*!
+ \ingroup textures
+ \brief Process wide cache of laid out text.
+
+ List items repeat the same labels ("Season 1", media flags, ...) across items and
+ frames, so CGUITextLayout looks up the parsed, wrapped and measured lines here before
+ doing that work itself. The least recently used layouts are dropped once the cache is
+ full, and the cache is cleared whenever fonts are reloaded or freed.
+ */
+class CGUITextLayoutCache
+{
+public:
+  struct Key
+  {
+    CStdStringW text;
+    const CGUIFont *font;
+    float maxWidth;      // only set when wrapping
+    float maxHeight;
+    color_t textColor;
+    bool wrap;
+    bool forceLTRReadingOrder;
+
+    bool operator==(const Key &right) const;
+  };
+
+  struct Layout
+  {
+    std::vector<CGUIString> lines;
+    vecColors colors;
+    float width;
+    float height;
+  };
+
+  CGUITextLayoutCache(unsigned int maxEntries = 1024, unsigned int maxTextLength = 512);
+
+  static CGUITextLayoutCache &GetInstance();
+
+  /*! \brief Look up a layout
+   \param key the text and the layout parameters
+   \param layout [out] the cached layout
+   \return true if the layout was cached
+   */
+  bool Get(const Key &key, Layout &layout);
+
+  /*! \brief Cache a layout, unless the text is too long to be worth keeping */
+  void Add(const Key &key, const Layout &layout);
+
+  /*! \brief Drop all layouts, eg. because the font metrics changed */
+  void Clear();
+
+  unsigned int GetSize() const;
+  unsigned int GetHits() const { return m_hits; };
+  unsigned int GetMisses() const { return m_misses; };
+
+private:
+  struct KeyHash
+  {
+    std::size_t operator()(const Key &key) const;
+  };
+
+  typedef std::list<std::pair<Key, Layout> > EntryList;
+  typedef boost::unordered_map<Key, EntryList::iterator, KeyHash> EntryMap;
+
+  EntryList m_entries;     // most recently used first
+  EntryMap m_index;
+  unsigned int m_maxEntries;
+  unsigned int m_maxTextLength;
+  unsigned int m_hits;
+  unsigned int m_misses;
+  mutable CCriticalSection m_critSection;
+};
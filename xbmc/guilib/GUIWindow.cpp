@@ -69,6 +69,7 @@ CGUIWindow::CGUIWindow(int id, const CStdString &xmlFile)
   m_exclusiveMouseControl = 0;
   m_clearBackground = 0xff000000; // opaque black -> always clear
   m_windowXMLRootElement = NULL;
+  m_windowXMLResolved = false;
 }
 
 CGUIWindow::~CGUIWindow(void)
@@ -123,7 +124,7 @@ bool CGUIWindow::Load(const CStdString& strFileName, bool bContainsPath)
   int64_t end, freq;
   end = CurrentHostCounter();
   freq = CurrentHostFrequency();
-  CLog::Log(LOGDEBUG,"Load %s: %.2fms", GetProperty("xmlfile").c_str(), 1000.f * (end - start) / freq);
+  CLog::Log(LOGDEBUG,"Load %s: %.2fms%s", GetProperty("xmlfile").c_str(), 1000.f * (end - start) / freq, m_windowXMLResolved ? " (precompiled)" : "");
 #endif
   return ret;
 }
@@ -132,6 +133,13 @@ bool CGUIWindow::LoadXML(const CStdString &strPath, const CStdString &strLowerPa
 {
   // load window xml if we don't have it stored yet
   if (!m_windowXMLRootElement)
+  {
+    // skip parsing and include resolution entirely if the precompiled window is still valid
+    m_windowXMLRootElement = g_SkinInfo->LoadPrecompiledWindow(strPath, m_coordsRes, m_xmlIncludeConditions);
+    m_windowXMLResolved = m_windowXMLRootElement != NULL;
+    m_windowXMLPrecompile.clear();
+  }
+  if (!m_windowXMLRootElement)
   {
     CXBMCTinyXML xmlDoc;
     if ( !xmlDoc.LoadFile(strPath) && !xmlDoc.LoadFile(CStdString(strPath).ToLower()) && !xmlDoc.LoadFile(strLowerPath))
@@ -141,6 +149,7 @@ bool CGUIWindow::LoadXML(const CStdString &strPath, const CStdString &strLowerPa
       return false;
     }
     m_windowXMLRootElement = (TiXmlElement*)xmlDoc.RootElement()->Clone();
+    m_windowXMLPrecompile = strPath;
   }
   else
     CLog::Log(LOGDEBUG, "Using already stored xml root node for %s", strPath.c_str());
@@ -159,6 +168,10 @@ bool CGUIWindow::Load(TiXmlElement* pRootElement)
     return false;
   }
 
+  // the precompiled window already has its includes resolved
+  bool resolved = m_windowXMLResolved && pRootElement == m_windowXMLRootElement;
+  bool precompile = !m_windowXMLPrecompile.IsEmpty() && pRootElement == m_windowXMLRootElement;
+
   // we must create copy of root element as we will manipulate it when resolving includes
   // and we don't want original root element to change
   pRootElement = (TiXmlElement*)pRootElement->Clone();
@@ -167,8 +180,16 @@ bool CGUIWindow::Load(TiXmlElement* pRootElement)
   // be done with respect to the correct aspect ratio
   g_graphicsContext.SetScalingResolution(m_coordsRes, m_needsScaling);
 
-  // Resolve any includes that may be present and save conditions used to do it
-  g_SkinInfo->ResolveIncludes(pRootElement, &m_xmlIncludeConditions);
+  if (!resolved)
+  {
+    // Resolve any includes that may be present and save conditions used to do it
+    g_SkinInfo->ResolveIncludes(pRootElement, &m_xmlIncludeConditions);
+    if (precompile)
+    {
+      g_SkinInfo->StorePrecompiledWindow(m_windowXMLPrecompile, m_coordsRes, pRootElement, m_xmlIncludeConditions);
+      m_windowXMLPrecompile.clear();
+    }
+  }
   // now load in the skin file
   SetDefaults();
 
@@ -484,6 +505,8 @@ EVENT_RESULT CGUIWindow::OnMouseEvent(const CPoint &point, const CMouseEvent &ev
 /// calling the base method.
 void CGUIWindow::OnInitWindow()
 {
+  g_infoManager.NotifyChanged(INFO::DEPENDS_WINDOW);
+
   //  Play the window specific init sound
   if (IsSoundEnabled())
     g_audioManager.PlayWindowSound(GetID(), SOUND_INIT);
@@ -517,6 +540,8 @@ void CGUIWindow::OnInitWindow()
 // Override this function and call the base class before doing any dynamic memory freeing
 void CGUIWindow::OnDeinitWindow(int nextWindowID)
 {
+  g_infoManager.NotifyChanged(INFO::DEPENDS_WINDOW);
+
   if (!m_manualRunActions)
   {
     RunUnloadActions();
@@ -762,6 +787,7 @@ void CGUIWindow::FreeResources(bool forceUnload /*= FALSE */)
   {
     delete m_windowXMLRootElement;
     m_windowXMLRootElement = NULL;
+    m_windowXMLResolved = false;
     m_xmlIncludeConditions.clear();
   }
 }
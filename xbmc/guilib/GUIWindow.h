@@ -276,6 +276,8 @@ protected:
   CGUIAction m_unloadActions;
 
   TiXmlElement* m_windowXMLRootElement;
+  bool m_windowXMLResolved;     ///< \brief m_windowXMLRootElement came from the precompiled skin cache and has its includes resolved
+  CStdString m_windowXMLPrecompile; ///< \brief path to store m_windowXMLRootElement under once its includes are resolved
 
   bool m_manualRunActions;
 
@@ -651,6 +651,7 @@ void CGUIWindowManager::RegisterDialog(CGUIWindow* dialog)
       return;
   }
   m_activeDialogs.push_back(dialog);
+  g_infoManager.NotifyChanged(INFO::DEPENDS_WINDOW);
 }
 
 void CGUIWindowManager::Remove(int id)
@@ -669,6 +670,7 @@ void CGUIWindowManager::Remove(int id)
     }
 
     m_mapWindows.erase(it);
+    g_infoManager.NotifyChanged(INFO::DEPENDS_WINDOW);
   }
   else
   {
@@ -1231,6 +1233,7 @@ void CGUIWindowManager::RemoveDialog(int id)
     if ((*it)->GetID() == id)
     {
       m_activeDialogs.erase(it);
+      g_infoManager.NotifyChanged(INFO::DEPENDS_WINDOW);
       return;
     }
   }
@@ -349,8 +349,11 @@ bool CJpegIO::Read(unsigned char* buffer, unsigned int bufSize, unsigned int min
     test its resulting size.
     If the res is greater than the one desired, use that one since there's no need
     to decode a bigger one just to squish it back down. If the res is greater than
-    the gpu can hold, use the previous one.*/
-    if (minx == 0 || miny == 0)
+    the gpu can hold, use the previous one.
+    Without a size we're decoding for the texture cache, which fits the image inside
+    minx x miny keeping its aspect, so covering either side is enough.*/
+    bool fitInside = (minx == 0 || miny == 0);
+    if (fitInside)
     {
       miny = g_advancedSettings.m_imageRes;
       if (g_advancedSettings.m_fanartRes > g_advancedSettings.m_imageRes)
@@ -376,7 +379,9 @@ bool CJpegIO::Read(unsigned char* buffer, unsigned int bufSize, unsigned int min
         m_cinfo.scale_num--;
         break;
       }
-      if (m_cinfo.output_width >= minx && m_cinfo.output_height >= miny)
+      bool coversWidth = m_cinfo.output_width >= minx;
+      bool coversHeight = m_cinfo.output_height >= miny;
+      if (fitInside ? (coversWidth || coversHeight) : (coversWidth && coversHeight))
         break;
     }
     jpeg_calc_output_dimensions(&m_cinfo);
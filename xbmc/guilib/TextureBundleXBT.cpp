@@ -26,6 +26,8 @@
 #include "utils/log.h"
 #include "addons/Skin.h"
 #include "settings/GUISettings.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/SingleLock.h"
 #include "filesystem/SpecialProtocol.h"
 #include "utils/EndianSwap.h"
 #include "utils/URIUtils.h"
@@ -40,6 +42,7 @@ CTextureBundleXBT::CTextureBundleXBT(void)
 {
   m_themeBundle = false;
   m_TimeStamp = 0;
+  m_cachedSize = 0;
 }
 
 CTextureBundleXBT::~CTextureBundleXBT(void)
@@ -193,56 +196,106 @@ int CTextureBundleXBT::LoadAnim(const CStdString& Filename, CBaseTexture*** ppTe
 
 bool CTextureBundleXBT::ConvertFrameToTexture(const CStdString& name, CXBTFFrame& frame, CBaseTexture** ppTexture)
 {
-  // found texture - allocate the necessary buffers
-  squish::u8 *buffer = new squish::u8[(size_t)frame.GetPackedSize()];
-  if (buffer == NULL)
+  // unpacked by an earlier load?
+  boost::shared_array<unsigned char> buffer = GetCachedFrame(frame.GetOffset());
+  if (buffer)
   {
-    CLog::Log(LOGERROR, "Out of memory loading texture: %s (need %" PRIu64" bytes)", name.c_str(), frame.GetPackedSize());
-    return false;
+    *ppTexture = new CTexture();
+    (*ppTexture)->LoadFromMemory(frame.GetWidth(), frame.GetHeight(), 0, frame.GetFormat(), frame.HasAlpha(), buffer.get());
+    return true;
   }
 
-  // load the compressed texture
-  if (!m_XBTFReader.Load(frame, buffer))
+  // the compressed texture comes straight from the mapped bundle, unless it couldn't be mapped
+  const unsigned char *packed = m_XBTFReader.GetFrameData(frame);
+  size_t bufferSize = 0;
+  if (!packed)
   {
-    CLog::Log(LOGERROR, "Error loading texture: %s", name.c_str());
-    delete[] buffer;
-    return false;
+    bufferSize = (size_t)frame.GetPackedSize();
+    buffer.reset(new squish::u8[bufferSize]);
+    if (!m_XBTFReader.Load(frame, buffer.get()))
+    {
+      CLog::Log(LOGERROR, "Error loading texture: %s", name.c_str());
+      return false;
+    }
+    packed = buffer.get();
   }
 
   // check if it's packed with lzo
+  const unsigned char *pixels = packed;
   if (frame.IsPacked())
   { // unpack
-    squish::u8 *unpacked = new squish::u8[(size_t)frame.GetUnpackedSize()];
-    if (unpacked == NULL)
-    {
-      CLog::Log(LOGERROR, "Out of memory unpacking texture: %s (need %" PRIu64" bytes)", name.c_str(), frame.GetUnpackedSize());
-      delete[] buffer;
-      return false;
-    }
+    boost::shared_array<unsigned char> unpacked(new squish::u8[(size_t)frame.GetUnpackedSize()]);
     lzo_uint s = (lzo_uint)frame.GetUnpackedSize();
-    if (lzo1x_decompress_safe(buffer, (lzo_uint)frame.GetPackedSize(), unpacked, &s, NULL) != LZO_E_OK ||
+    if (lzo1x_decompress_safe(packed, (lzo_uint)frame.GetPackedSize(), unpacked.get(), &s, NULL) != LZO_E_OK ||
         s != frame.GetUnpackedSize())
     {
       CLog::Log(LOGERROR, "Error loading texture: %s: Decompression error", name.c_str());
-      delete[] buffer;
-      delete[] unpacked;
       return false;
     }
-    delete[] buffer;
     buffer = unpacked;
+    bufferSize = (size_t)frame.GetUnpackedSize();
+    pixels = buffer.get();
   }
 
   // create an xbmc texture
   *ppTexture = new CTexture();
-  (*ppTexture)->LoadFromMemory(frame.GetWidth(), frame.GetHeight(), 0, frame.GetFormat(), frame.HasAlpha(), buffer);
+  (*ppTexture)->LoadFromMemory(frame.GetWidth(), frame.GetHeight(), 0, frame.GetFormat(), frame.HasAlpha(), pixels);
 
-  delete[] buffer;
+  // frames used as they are mapped cost nothing to load again
+  if (buffer)
+    CacheFrame(frame.GetOffset(), buffer, bufferSize);
 
   return true;
 }
 
+boost::shared_array<unsigned char> CTextureBundleXBT::GetCachedFrame(uint64_t offset)
+{
+  CSingleLock lock(m_cacheSection);
+  FrameMap::iterator it = m_cachedFrameIndex.find(offset);
+  if (it == m_cachedFrameIndex.end())
+    return boost::shared_array<unsigned char>();
+
+  // move to the front so it's the last to be dropped
+  m_cachedFrames.splice(m_cachedFrames.begin(), m_cachedFrames, it->second);
+  return it->second->second.data;
+}
+
+void CTextureBundleXBT::CacheFrame(uint64_t offset, const boost::shared_array<unsigned char> &data, size_t size)
+{
+  size_t budget = (size_t)g_advancedSettings.m_guiTextureBundleCacheSize * 1024 * 1024;
+  if (size > budget)
+    return;
+
+  CSingleLock lock(m_cacheSection);
+  if (m_cachedFrameIndex.find(offset) != m_cachedFrameIndex.end())
+    return;
+
+  while (!m_cachedFrames.empty() && m_cachedSize + size > budget)
+  {
+    m_cachedSize -= m_cachedFrames.back().second.size;
+    m_cachedFrameIndex.erase(m_cachedFrames.back().first);
+    m_cachedFrames.pop_back();
+  }
+
+  CachedFrame frame;
+  frame.data = data;
+  frame.size = size;
+  m_cachedFrames.push_front(std::make_pair(offset, frame));
+  m_cachedFrameIndex[offset] = m_cachedFrames.begin();
+  m_cachedSize += size;
+}
+
+void CTextureBundleXBT::ClearFrameCache()
+{
+  CSingleLock lock(m_cacheSection);
+  m_cachedFrameIndex.clear();
+  m_cachedFrames.clear();
+  m_cachedSize = 0;
+}
+
 void CTextureBundleXBT::Cleanup()
 {
+  ClearFrameCache();
   if (m_XBTFReader.IsOpen())
   {
     m_XBTFReader.Close();
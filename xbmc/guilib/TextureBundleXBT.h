@@ -21,7 +21,11 @@
  */
 
 #include <map>
+#include <list>
+#include <boost/shared_array.hpp>
+#include <boost/unordered_map.hpp>
 #include "utils/StdString.h"
+#include "threads/CriticalSection.h"
 #include "XBTFReader.h"
 
 class CBaseTexture;
@@ -48,10 +52,35 @@ private:
   bool OpenBundle();
   bool ConvertFrameToTexture(const CStdString& name, CXBTFFrame& frame, CBaseTexture** ppTexture);
 
+  /*! \brief Get the unpacked data of a frame loaded before
+   \param offset offset of the frame within the bundle
+   \return the data, or an empty array if it isn't cached
+   */
+  boost::shared_array<unsigned char> GetCachedFrame(uint64_t offset);
+
+  /*! \brief Keep the unpacked data of a frame, dropping the least recently used frames
+   to stay within the budget set by the texturebundlecache advanced setting
+   */
+  void CacheFrame(uint64_t offset, const boost::shared_array<unsigned char> &data, size_t size);
+  void ClearFrameCache();
+
   time_t m_TimeStamp;
 
   bool m_themeBundle;
   CXBTFReader m_XBTFReader;
+
+  struct CachedFrame
+  {
+    boost::shared_array<unsigned char> data;
+    size_t size;
+  };
+  typedef std::list<std::pair<uint64_t, CachedFrame> > FrameList;
+  typedef boost::unordered_map<uint64_t, FrameList::iterator> FrameMap;
+
+  FrameList m_cachedFrames;      // most recently used first
+  FrameMap m_cachedFrameIndex;
+  size_t m_cachedSize;
+  CCriticalSection m_cacheSection;
 };
 
 
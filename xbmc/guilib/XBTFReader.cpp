@@ -28,6 +28,14 @@
 
 #include <string.h>
 #include "PlatformDefs.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <sys/mman.h>
+#endif
 
 #define READ_STR(str, size, file) \
   if (!fread(str, size, 1, file)) \
@@ -46,6 +54,16 @@
 CXBTFReader::CXBTFReader()
 {
   m_file = NULL;
+  m_mapped = NULL;
+  m_mappedSize = 0;
+#ifdef _WIN32
+  m_mapping = NULL;
+#endif
+}
+
+CXBTFReader::~CXBTFReader()
+{
+  Close();
 }
 
 bool CXBTFReader::IsOpen() const
@@ -122,9 +140,8 @@ bool CXBTFReader::Open(const CStdString& fileName)
       file.GetFrames().push_back(frame);
     }
 
+    m_filesMap[file.GetPath()] = m_xbtf.GetFiles().size();
     m_xbtf.GetFiles().push_back(file);
-
-    m_filesMap[file.GetPath()] = file;
   }
 
   // Sanity check
@@ -135,11 +152,65 @@ bool CXBTFReader::Open(const CStdString& fileName)
     return false;
   }
 
+  if (!Map())
+    CLog::Log(LOGWARNING, "%s - unable to map %s, reading from the file instead", __FUNCTION__, m_fileName.c_str());
+
+  return true;
+}
+
+bool CXBTFReader::Map()
+{
+  struct stat fileStat;
+  if (fstat(fileno(m_file), &fileStat) == -1 || fileStat.st_size <= 0)
+    return false;
+
+  // the whole bundle has to fit into the address space
+  if ((uint64_t)fileStat.st_size != (uint64_t)(size_t)fileStat.st_size)
+    return false;
+
+#ifdef _WIN32
+  HANDLE file = (HANDLE)_get_osfhandle(fileno(m_file));
+  m_mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (m_mapping == NULL)
+    return false;
+  m_mapped = (unsigned char*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+  if (m_mapped == NULL)
+  {
+    CloseHandle(m_mapping);
+    m_mapping = NULL;
+    return false;
+  }
+#else
+  void* mapped = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_SHARED, fileno(m_file), 0);
+  if (mapped == MAP_FAILED)
+    return false;
+  m_mapped = (unsigned char*)mapped;
+#endif
+
+  m_mappedSize = fileStat.st_size;
   return true;
 }
 
+void CXBTFReader::Unmap()
+{
+  if (!m_mapped)
+    return;
+
+#ifdef _WIN32
+  UnmapViewOfFile(m_mapped);
+  CloseHandle(m_mapping);
+  m_mapping = NULL;
+#else
+  munmap(m_mapped, (size_t)m_mappedSize);
+#endif
+  m_mapped = NULL;
+  m_mappedSize = 0;
+}
+
 void CXBTFReader::Close()
 {
+  Unmap();
+
   if (m_file)
   {
     fclose(m_file);
@@ -173,13 +244,25 @@ bool CXBTFReader::Exists(const CStdString& name)
 
 CXBTFFile* CXBTFReader::Find(const CStdString& name)
 {
-  std::map<CStdString, CXBTFFile>::iterator iter = m_filesMap.find(name);
+  boost::unordered_map<std::string, size_t>::const_iterator iter = m_filesMap.find(name);
   if (iter == m_filesMap.end())
   {
     return NULL;
   }
 
-  return &(iter->second);
+  return &m_xbtf.GetFiles()[iter->second];
+}
+
+const unsigned char* CXBTFReader::GetFrameData(const CXBTFFrame& frame) const
+{
+  if (!m_mapped)
+    return NULL;
+
+  // don't trust the header to stay within the file
+  if (frame.GetOffset() > m_mappedSize || frame.GetPackedSize() > m_mappedSize - frame.GetOffset())
+    return NULL;
+
+  return m_mapped + frame.GetOffset();
 }
 
 bool CXBTFReader::Load(const CXBTFFrame& frame, unsigned char* buffer)
@@ -188,6 +271,17 @@ bool CXBTFReader::Load(const CXBTFFrame& frame, unsigned char* buffer)
   {
     return false;
   }
+
+  if (m_mapped)
+  {
+    const unsigned char* data = GetFrameData(frame);
+    if (!data)
+      return false;
+    memcpy(buffer, data, (size_t)frame.GetPackedSize());
+    return true;
+  }
+
+  CSingleLock lock(m_fileSection);
 #if defined(TARGET_DARWIN) || defined(__FreeBSD__) || defined(__ANDROID__)
     if (fseeko(m_file, (off_t)frame.GetOffset(), SEEK_SET) == -1)
 #else
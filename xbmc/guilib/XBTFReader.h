@@ -22,14 +22,23 @@
 #define XBTFREADER_H_
 
 #include <vector>
-#include <map>
+#include <boost/unordered_map.hpp>
 #include "utils/StdString.h"
+#include "threads/CriticalSection.h"
 #include "XBTF.h"
 
+/*!
+ \brief Reader for XBT texture bundles.
+
+ The bundle is mapped into memory when it's opened, so frames are read straight from the
+ mapping without seeking a shared file position and Load() may be called from several
+ threads at once. If the bundle can't be mapped, frames are read from the file under a lock.
+ */
 class CXBTFReader
 {
 public:
   CXBTFReader();
+  ~CXBTFReader();
   bool IsOpen() const;
   bool Open(const CStdString& fileName);
   void Close();
@@ -37,13 +46,29 @@ public:
   bool Exists(const CStdString& name);
   CXBTFFile* Find(const CStdString& name);
   bool Load(const CXBTFFrame& frame, unsigned char* buffer);
+
+  /*! \brief Get the packed data of a frame without copying it
+   \param frame the frame to get the data of
+   \return the data inside the mapped bundle, or NULL if the bundle isn't mapped
+   */
+  const unsigned char* GetFrameData(const CXBTFFrame& frame) const;
+
   std::vector<CXBTFFile>&  GetFiles();
 
 private:
+  bool Map();
+  void Unmap();
+
   CXBTF      m_xbtf;
   CStdString m_fileName;
   FILE*      m_file;
-  std::map<CStdString, CXBTFFile> m_filesMap;
+  boost::unordered_map<std::string, size_t> m_filesMap; // path -> index into the files of m_xbtf
+  unsigned char* m_mapped;
+  uint64_t   m_mappedSize;
+#ifdef _WIN32
+  void*      m_mapping;
+#endif
+  CCriticalSection m_fileSection; // guards the file position when not mapped
 };
 
 #endif
@@ -95,6 +95,7 @@
 /* PLEX */
 #include "PlexApplication.h"
 #include "AutoUpdate/PlexAutoUpdate.h"
+#include "Utility/PlexTracer.h"
 /* END PLEX */
 
 using namespace std;
@@ -123,6 +124,7 @@ const BUILT_IN commands[] = {
   { "NextItem",                   false,  "Move to the next item. Good for preplay" },
   { "PrevItem",                   false,  "Move to previous item, good for preplay" },
   { "PlayFromHere",               false,  "Start playback from curretn selected item" },
+  { "SavePlaybackTrace",          false,  "Save the playback startup trace as Chrome trace JSON, optionally to the given file" },
   /* END PLEX */
   { "Help",                       false,  "This help message" },
   { "Reboot",                     false,  "Reboot the system" },
@@ -1719,6 +1721,8 @@ int CBuiltins::Execute(const CStdString& execString)
     g_application.OnAction(CAction(ACTION_PLEX_MOVE_PREV_ITEM));
   else if (execute.Equals("playfromhere"))
     g_application.OnAction(CAction(ACTION_PLEX_PQ_PLAYFROMHERE));
+  else if (execute.Equals("saveplaybacktrace"))
+    CPlexTracer::GetInstance().SaveChromeTrace(params.size() ? params[0] : "special://temp/playbacktrace.json");
 
   /* PLEX */
     return -1;
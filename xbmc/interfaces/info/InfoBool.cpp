@@ -27,6 +27,7 @@ namespace INFO
     : m_value(false),
       m_context(context),
       m_listItemDependent(false),
+      m_dependencies(DEPENDS_ALWAYS),
       m_expression(expression),
       m_dirty(true)
   {
@@ -27,6 +27,22 @@ class CGUIListItem;
 
 namespace INFO
 {
+/*!
+ \ingroup info
+ \brief State an info bool depends on.
+ Bools are only marked dirty when one of their dependencies has changed, see CGUIInfoManager::NotifyChanged.
+ */
+enum InfoDependency
+{
+  DEPENDS_NONE    = 0,       ///< constant for the lifetime of the application
+  DEPENDS_PLAYER  = 1 << 0,  ///< player state (playing, paused, speed)
+  DEPENDS_ITEM    = 1 << 1,  ///< currently playing item
+  DEPENDS_WINDOW  = 1 << 2,  ///< active window and dialogs
+  DEPENDS_SETTING = 1 << 3,  ///< gui and skin settings
+  DEPENDS_TIME    = 1 << 4,  ///< wall clock time
+  DEPENDS_ALWAYS  = 1 << 30  ///< unknown, re-evaluated every frame
+};
+
 /*!
  \ingroup info
  \brief Base class, wrapping boolean conditions and expressions
@@ -72,12 +88,16 @@ public:
   virtual void Update(const CGUIListItem *item) {};
 
   const std::string &GetExpression() const { return m_expression; }
+  int GetContext() const { return m_context; }
   bool ListItemDependent() const { return m_listItemDependent; }
+  unsigned int GetDependencies() const { return m_dependencies; }
+  bool IsDirty() const { return m_dirty; }
 protected:
 
   bool m_value;                ///< current value
   int m_context;               ///< contextual information to go with the condition
   bool m_listItemDependent;    ///< do not cache if a listitem pointer is given
+  unsigned int m_dependencies; ///< InfoDependency flags of the state this bool is evaluated from
 
 private:
   CStdString   m_expression;   ///< original expression
@@ -33,6 +33,7 @@ InfoSingle::InfoSingle(const CStdString &expression, int context)
 : InfoBool(expression, context)
 {
   m_condition = g_infoManager.TranslateSingleString(expression, m_listItemDependent);
+  m_dependencies = g_infoManager.GetInfoDependencies(m_condition);
 }
 
 void InfoSingle::Update(const CGUIListItem *item)
@@ -43,10 +44,13 @@ void InfoSingle::Update(const CGUIListItem *item)
 InfoExpression::InfoExpression(const CStdString &expression, int context)
 : InfoBool(expression, context)
 {
+  // accumulated from the operands while parsing
+  m_dependencies = DEPENDS_NONE;
   if (!Parse(expression))
   {
     CLog::Log(LOGERROR, "Error parsing boolean expression %s", expression.c_str());
     m_expression_tree = boost::make_shared<InfoLeaf>(g_infoManager.Register("false", 0), false);
+    m_dependencies = DEPENDS_NONE;
   }
 }
 
@@ -250,8 +254,9 @@ bool InfoExpression::Parse(const CStdString &expression)
           CLog::Log(LOGERROR, "Bad operand '%s'", operand.c_str());
           return false;
         }
-        /* Propagate any listItem dependency from the operand to the expression */
+        /* Propagate any listItem and state dependencies from the operand to the expression */
         m_listItemDependent |= info->ListItemDependent();
+        m_dependencies |= info->GetDependencies();
         nodes.push(boost::make_shared<InfoLeaf>(info, invert));
         /* Reuse operand string for next operand */
         operand.clear();
@@ -301,8 +306,9 @@ bool InfoExpression::Parse(const CStdString &expression)
       CLog::Log(LOGERROR, "Bad operand '%s'", operand.c_str());
       return false;
     }
-    /* Propagate any listItem dependency from the operand to the expression */
+    /* Propagate any listItem and state dependencies from the operand to the expression */
     m_listItemDependent |= info->ListItemDependent();
+    m_dependencies |= info->GetDependencies();
     nodes.push(boost::make_shared<InfoLeaf>(info, invert));
   }
   while (!operator_stack.empty())
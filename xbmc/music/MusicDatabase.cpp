@@ -606,20 +606,47 @@ int CMusicDatabase::AddArtist(const CStdString& strArtist1)
   return -1;
 }
 
+// the link tables are written for every song of a scan, so these use cached prepared statements
 bool CMusicDatabase::AddSongArtist(int idArtist, int idSong, bool featured, int iOrder)
 {
-  CStdString strSQL;
-  strSQL=PrepareSQL("replace into song_artist (idArtist, idSong, boolFeatured, iOrder) values(%i,%i,%i,%i)",
-                    idArtist, idSong, featured == true ? 1 : 0, iOrder);
-  return ExecuteQuery(strSQL);
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+
+    std::auto_ptr<dbiplus::Cursor> cursor(m_pDB->CreateCursor("replace into song_artist (idArtist, idSong, boolFeatured, iOrder) values(?,?,?,?)"));
+    cursor->bind(1, idArtist);
+    cursor->bind(2, idSong);
+    cursor->bind(3, featured == true ? 1 : 0);
+    cursor->bind(4, iOrder);
+    cursor->exec();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed on song %i, artist %i", __FUNCTION__, idSong, idArtist);
+  }
+  return false;
 };
 
 bool CMusicDatabase::AddAlbumArtist(int idArtist, int idAlbum, bool featured, int iOrder)
 {
-  CStdString strSQL;
-  strSQL=PrepareSQL("replace into album_artist (idArtist, idAlbum, boolFeatured, iOrder) values(%i,%i,%i,%i)",
-                    idArtist, idAlbum, featured == true ? 1 : 0, iOrder);
-  return ExecuteQuery(strSQL);
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+
+    std::auto_ptr<dbiplus::Cursor> cursor(m_pDB->CreateCursor("replace into album_artist (idArtist, idAlbum, boolFeatured, iOrder) values(?,?,?,?)"));
+    cursor->bind(1, idArtist);
+    cursor->bind(2, idAlbum);
+    cursor->bind(3, featured == true ? 1 : 0);
+    cursor->bind(4, iOrder);
+    cursor->exec();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed on album %i, artist %i", __FUNCTION__, idAlbum, idArtist);
+  }
+  return false;
 };
 
 bool CMusicDatabase::AddSongGenre(int idGenre, int idSong, int iOrder)
@@ -627,20 +654,45 @@ bool CMusicDatabase::AddSongGenre(int idGenre, int idSong, int iOrder)
   if (idGenre == -1 || idSong == -1)
     return true;
 
-  CStdString strSQL;
-  strSQL=PrepareSQL("replace into song_genre (idGenre, idSong, iOrder) values(%i,%i,%i)",
-                    idGenre, idSong, iOrder);
-  return ExecuteQuery(strSQL);};
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+
+    std::auto_ptr<dbiplus::Cursor> cursor(m_pDB->CreateCursor("replace into song_genre (idGenre, idSong, iOrder) values(?,?,?)"));
+    cursor->bind(1, idGenre);
+    cursor->bind(2, idSong);
+    cursor->bind(3, iOrder);
+    cursor->exec();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed on song %i, genre %i", __FUNCTION__, idSong, idGenre);
+  }
+  return false;
+};
 
 bool CMusicDatabase::AddAlbumGenre(int idGenre, int idAlbum, int iOrder)
 {
   if (idGenre == -1 || idAlbum == -1)
     return true;
-  
-  CStdString strSQL;
-  strSQL=PrepareSQL("replace into album_genre (idGenre, idAlbum, iOrder) values(%i,%i,%i)",
-                    idGenre, idAlbum, iOrder);
-  return ExecuteQuery(strSQL);
+
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+
+    std::auto_ptr<dbiplus::Cursor> cursor(m_pDB->CreateCursor("replace into album_genre (idGenre, idAlbum, iOrder) values(?,?,?)"));
+    cursor->bind(1, idGenre);
+    cursor->bind(2, idAlbum);
+    cursor->bind(3, iOrder);
+    cursor->exec();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed on album %i, genre %i", __FUNCTION__, idAlbum, idGenre);
+  }
+  return false;
 };
 
 bool CMusicDatabase::GetAlbumsByArtist(int idArtist, bool includeFeatured, std::vector<int> &albums)
@@ -855,11 +907,15 @@ int CMusicDatabase::AddPath(const CStdString& strPath1)
     if (it != m_pathCache.end())
       return it->second;
 
-    strSQL=PrepareSQL( "select * from path where strPath='%s'", strPath.c_str());
-    m_pDS->query(strSQL.c_str());
-    if (m_pDS->num_rows() == 0)
+    /* PLEX */
+    // looked up for every folder scanned, so use a cached statement rather than a dataset
+    strSQL = "select idPath from path where strPath=?";
+    std::auto_ptr<dbiplus::Cursor> cursor(m_pDB->CreateCursor(strSQL));
+    cursor->bind(1, strPath);
+    if (!cursor->step())
     {
-      m_pDS->close();
+      cursor.reset();
+      /* END PLEX */
       // doesnt exists, add it
       strSQL=PrepareSQL("insert into path (idPath, strPath) values( NULL, '%s' )", strPath.c_str());
       m_pDS->exec(strSQL.c_str());
@@ -870,9 +926,10 @@ int CMusicDatabase::AddPath(const CStdString& strPath1)
     }
     else
     {
-      int idPath = m_pDS->fv("idPath").get_asInt();
+      /* PLEX */
+      int idPath = cursor->getInt(0);
+      /* END PLEX */
       m_pathCache.insert(pair<CStdString, int>(strPath, idPath));
-      m_pDS->close();
       return idPath;
     }
   }
@@ -3256,36 +3313,19 @@ bool CMusicDatabase::GetSongsByWhere(const CStdString &baseDir, const Filter &fi
     strSQL = PrepareSQL(strSQL, !filter.fields.empty() && filter.fields.compare("*") != 0 ? filter.fields.c_str() : "songview.*") + strSQLExtra;
 
     CLog::Log(LOGDEBUG, "%s query = %s", __FUNCTION__, strSQL.c_str());
-    // run query
-    if (!m_pDS->query(strSQL.c_str()))
-      return false;
-
-    int iRowsFound = m_pDS->num_rows();
-    if (iRowsFound == 0)
-    {
-      m_pDS->close();
-      return true;
-    }
-
-    // store the total value of items as a property
-    if (total < iRowsFound)
-      total = iRowsFound;
-    items.SetProperty("total", total);
-    
-    DatabaseResults results;
-    results.reserve(iRowsFound);
-    if (!SortUtils::SortFromDataset(sortDescription, MediaTypeSong, m_pDS, results))
+    /* PLEX */
+    // run query, unsorted listings are streamed and only the current row is held
+    CDatabaseRows rows(m_pDB.get(), m_pDS);
+    if (!rows.Open(strSQL, sortDescription, MediaTypeSong))
       return false;
 
     // get data from returned rows
-    items.Reserve(results.size());
-    const dbiplus::query_data &data = m_pDS->get_result_set().records;
+    if (!rows.IsStreaming())
+      items.Reserve(rows.GetRows());
+    const dbiplus::sql_record *record;
     int count = 0;
-    for (DatabaseResults::const_iterator it = results.begin(); it != results.end(); it++)
+    while ((record = rows.Next()) != NULL)
     {
-      unsigned int targetRow = (unsigned int)it->at(FieldRow).asInteger();
-      const dbiplus::sql_record* const record = data.at(targetRow);
-      
       try
       {
         CFileItemPtr item(new CFileItem);
@@ -3296,14 +3336,20 @@ bool CMusicDatabase::GetSongsByWhere(const CStdString &baseDir, const Filter &fi
       }
       catch (...)
       {
-        m_pDS->close();
         CLog::Log(LOGERROR, "%s: out of memory loading query: %s", __FUNCTION__, filter.where.c_str());
         return (items.Size() > 0);
       }
     }
 
-    // cleanup
-    m_pDS->close();
+    if (rows.GetRows() == 0)
+      return true;
+
+    // store the total value of items as a property
+    if (total < (int)rows.GetRows())
+      total = rows.GetRows();
+    items.SetProperty("total", total);
+    /* END PLEX */
+
     CLog::Log(LOGDEBUG, "%s(%s) - took %d ms", __FUNCTION__, filter.where.c_str(), XbmcThreads::SystemClockMillis() - time);
     return true;
   }
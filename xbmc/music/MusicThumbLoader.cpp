@@ -75,7 +75,7 @@ bool CMusicThumbLoader::LoadItem(CFileItem* pItem)
   if (pItem->m_bIsShareOrDrive)
     return true;
 
-  if (pItem->HasMusicInfoTag() && pItem->GetArt().empty())
+  if (pItem->HasMusicInfoTag() && !pItem->HasAnyArt())
   {
     if (FillLibraryArt(*pItem))
       return true;
@@ -179,7 +179,7 @@ bool CMusicThumbLoader::FillLibraryArt(CFileItem &item)
     }
     m_database->Close();
   }
-  return !item.GetArt().empty();
+  return item.HasAnyArt();
 #endif
   return false;
 }
@@ -19,6 +19,7 @@
  */
 
 #include "threads/SystemClock.h"
+#include "threads/Atomics.h"
 #include "MusicInfoScanner.h"
 #include "music/tags/MusicInfoTagLoaderFactory.h"
 #include "MusicAlbumInfo.h"
@@ -59,7 +60,52 @@ using namespace MUSIC_INFO;
 using namespace XFILE;
 using namespace MUSIC_GRABBER;
 
-CMusicInfoScanner::CMusicInfoScanner() : CThread("CMusicInfoScanner")
+// jobs reading the tags of a folder at once
+#define TAG_JOBS 4
+
+// files whose tags are read ahead of the folder being written
+#define TAG_LOOKAHEAD 256
+
+// songs and milliseconds after which the scan's transaction is committed
+#define BATCH_SONGS 500
+#define BATCH_TIME 1000
+
+// how often a wait on the tag jobs checks whether the scan was stopped, in ms
+#define TAG_WAIT_INTERVAL 100
+
+class CMusicTagReadJob : public CJob
+{
+public:
+  CMusicTagReadJob(const TagReadBatchPtr &batch) : m_batch(batch)
+  {
+  }
+
+  virtual const char *GetType() const { return "musictagread"; }
+
+  virtual bool DoWork()
+  {
+    long count = m_batch->items.size();
+    long i;
+    while (!m_batch->cancelled && (i = AtomicIncrement(&m_batch->next) - 1) < count)
+    {
+      CFileItemPtr pItem = m_batch->items[i];
+      auto_ptr<IMusicInfoTagLoader> pLoader (CMusicInfoTagLoaderFactory::CreateLoader(pItem->GetPath()));
+      if (NULL != pLoader.get())
+        pLoader->Load(pItem->GetPath(), *pItem->GetMusicInfoTag());
+
+      if (AtomicIncrement(&m_batch->loaded) == count)
+        m_batch->done.Set();
+    }
+    return true;
+  }
+
+private:
+  TagReadBatchPtr m_batch;
+};
+
+CMusicInfoScanner::CMusicInfoScanner() : CThread("CMusicInfoScanner"),
+  m_tagQueue(false, TAG_JOBS, CJob::PRIORITY_LOW),
+  m_batch(m_musicDatabase, BATCH_SONGS, BATCH_TIME)
 {
   m_bRunning = false;
   m_showDialog = false;
@@ -68,6 +114,7 @@ CMusicInfoScanner::CMusicInfoScanner() : CThread("CMusicInfoScanner")
   m_currentItem=0;
   m_itemCount=0;
   m_flags = 0;
+  m_queuedFiles = 0;
 }
 
 CMusicInfoScanner::~CMusicInfoScanner()
@@ -115,6 +162,9 @@ void CMusicInfoScanner::Process()
       m_bCanInterrupt = false;
       m_needsCleanup = false;
 
+      // commit the scan in batches rather than folder by folder
+      m_batch.Start();
+
       bool commit = false;
       bool cancelled = false;
       while (!cancelled && m_pathsToScan.size())
@@ -128,9 +178,20 @@ void CMusicInfoScanner::Process()
         CStdString directory = *m_pathsToScan.begin();
         if (!DoScan(directory))
           cancelled = true;
+        else
+        { // write whatever is still having its tags read
+          FinishFolders(0);
+          cancelled = m_bStop;
+        }
         commit = !cancelled;
       }
 
+      if (cancelled)
+        CancelQueued();
+
+      // cleaning and compressing can't run inside a transaction
+      m_batch.End();
+
       if (commit)
       {
         g_infoManager.ResetLibraryBools();
@@ -203,6 +264,8 @@ void CMusicInfoScanner::Process()
   catch (...)
   {
     CLog::Log(LOGERROR, "MusicInfoScanner: Exception while scanning.");
+    CancelQueued();
+    m_batch.End();
   }
 
   m_bRunning = false;
@@ -414,15 +477,9 @@ bool CMusicInfoScanner::DoScan(const CStdString& strDirectory)
     items.FilterCueItems();
     items.Sort(SORT_METHOD_LABEL, SortOrderAscending);
 
-    // and then scan in the new information
-    if (RetrieveMusicInfo(items, strDirectory) > 0)
-    {
-      if (m_handle)
-        OnDirectoryScanned(strDirectory);
-    }
-
-    // save information about this folder
-    m_musicDatabase.SetPathHash(strDirectory, hash);
+    // and then scan in the new information once the tags are read
+    QueueFolder(items, strDirectory, hash);
+    FinishFolders(TAG_LOOKAHEAD);
   }
   else
   { // path is the same - no need to rescan
@@ -494,13 +551,8 @@ int CMusicInfoScanner::RetrieveMusicInfo(CFileItemList& items, const CStdString&
       // grab info from the song
       CSong *dbSong = songsMap.Find(pItem->GetPath());
 
+      // the tag was read by the tag jobs queued in QueueFolder()
       CMusicInfoTag& tag = *pItem->GetMusicInfoTag();
-      if (!tag.Loaded() )
-      { // read the tag from a file
-        auto_ptr<IMusicInfoTagLoader> pLoader (CMusicInfoTagLoaderFactory::CreateLoader(pItem->GetPath()));
-        if (NULL != pLoader.get())
-          pLoader->Load(pItem->GetPath(), tag);
-      }
 
       // if we have the itemcount, update our
       // dialog with the progress we made
@@ -580,6 +632,11 @@ int CMusicInfoScanner::RetrieveMusicInfo(CFileItemList& items, const CStdString&
     artistsToScan.insert(albumArtists.begin(), albumArtists.end());
   }
   m_musicDatabase.CommitTransaction();
+  m_batch.AddWrites(numAdded);
+
+  // don't keep the database locked while the scrapers are busy
+  if (m_flags & SCAN_ONLINE)
+    m_batch.Commit(true);
 
   // Download info & artwork
   bool bCanceled;
@@ -633,6 +690,94 @@ int CMusicInfoScanner::RetrieveMusicInfo(CFileItemList& items, const CStdString&
   return songsToAdd.size();
 }
 
+void CMusicInfoScanner::QueueFolder(const CFileItemList& items, const CStdString& strDirectory, const CStdString& hash)
+{
+  ScanFolder folder;
+  folder.path = strDirectory;
+  folder.hash = hash;
+  folder.items.reset(new CFileItemList);
+  folder.items->Assign(items);
+  folder.tags.reset(new CTagReadBatch);
+
+  CStdStringArray regexps = g_advancedSettings.m_audioExcludeFromScanRegExps;
+  for (int i = 0; i < folder.items->Size(); ++i)
+  {
+    CFileItemPtr pItem = folder.items->Get(i);
+    if (pItem->m_bIsFolder || pItem->IsPlayList() || pItem->IsPicture() || pItem->IsLyrics())
+      continue;
+    if (CUtil::ExcludeFileOrFolder(pItem->GetPath(), regexps))
+      continue;
+    // create the tag here, so the jobs never have to
+    if (!pItem->GetMusicInfoTag()->Loaded())
+      folder.tags->items.push_back(pItem);
+  }
+
+  size_t files = folder.tags->items.size();
+  if (files)
+  {
+    for (size_t i = 0; i < std::min((size_t)TAG_JOBS, files); i++)
+      m_tagQueue.AddJob(new CMusicTagReadJob(folder.tags));
+  }
+  else
+    folder.tags->done.Set();
+
+  m_queuedFiles += files;
+  m_queuedFolders.push_back(folder);
+}
+
+void CMusicInfoScanner::FinishFolder()
+{
+  ScanFolder folder = m_queuedFolders.front();
+  m_queuedFolders.pop_front();
+  m_queuedFiles -= folder.tags->items.size();
+
+  if (!folder.tags->done.WaitMSec(0))
+  { // don't hold the database while waiting on the tags
+    m_batch.Commit(true);
+
+    // jobs dropped by CJobManager::CancelJobs() on exit never finish the folder, so don't wait past Stop()
+    while (!folder.tags->done.WaitMSec(TAG_WAIT_INTERVAL))
+    {
+      if (m_bStop)
+      {
+        folder.tags->cancelled = true;
+        return;
+      }
+    }
+  }
+
+  m_batch.Open();
+  if (RetrieveMusicInfo(*folder.items, folder.path) > 0)
+  {
+    if (m_handle)
+      OnDirectoryScanned(folder.path);
+  }
+
+  // save information about this folder
+  if (!m_bStop)
+    m_musicDatabase.SetPathHash(folder.path, folder.hash);
+}
+
+void CMusicInfoScanner::FinishFolders(size_t maxFiles)
+{
+  while (!m_bStop && !m_queuedFolders.empty() &&
+         (m_queuedFiles > maxFiles || m_queuedFolders.front().tags->done.WaitMSec(0)))
+  {
+    FinishFolder();
+    m_batch.Commit(false);
+  }
+}
+
+void CMusicInfoScanner::CancelQueued()
+{
+  // jobs already running stop after their current file
+  for (std::deque<ScanFolder>::iterator it = m_queuedFolders.begin(); it != m_queuedFolders.end(); ++it)
+    it->tags->cancelled = true;
+  m_tagQueue.CancelJobs();
+  m_queuedFolders.clear();
+  m_queuedFiles = 0;
+}
+
 static bool SortSongsByTrack(CSong *song, CSong *song2)
 {
   return song->iTrack < song2->iTrack;
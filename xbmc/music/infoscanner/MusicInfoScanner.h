@@ -19,15 +19,37 @@
  *
  */
 #include "threads/Thread.h"
+#include "threads/Event.h"
+#include "utils/JobManager.h"
+#include "FileItem.h"
 #include "music/MusicDatabase.h"
 #include "MusicAlbumInfo.h"
 
+#include <deque>
+#include <boost/shared_ptr.hpp>
+
 class CAlbum;
 class CArtist;
 class CGUIDialogProgressBarHandle;
 
 namespace MUSIC_INFO
 {
+/*! \brief Files of a folder whose tags are read on the job manager
+ Each job reading the batch takes the next unread file until none are left, so the files of
+ a folder are spread over all jobs and the tags end up on the items in folder order.
+ */
+class CTagReadBatch
+{
+public:
+  CTagReadBatch() : next(0), loaded(0), cancelled(false), done(true) {}
+  std::vector<CFileItemPtr> items;
+  volatile long next;       // next item to read
+  volatile long loaded;     // items read so far
+  volatile bool cancelled;
+  CEvent done;              // set once all items are read
+};
+typedef boost::shared_ptr<CTagReadBatch> TagReadBatchPtr;
+
 class CMusicInfoScanner : CThread, public IRunnable
 {
 public:
@@ -96,7 +118,29 @@ public:
   std::map<std::string, std::string> GetArtistArtwork(long id, const CArtist *artist = NULL);
 protected:
   virtual void Process();
+
+  /*! \brief Add the songs of a folder to the database
+   \param items the folder listing, with the tags read by QueueFolder()
+   \param strDirectory path of the folder
+   \return the number of songs found
+   */
   int RetrieveMusicInfo(CFileItemList& items, const CStdString& strDirectory);
+
+  /*! \brief Start reading the tags of a changed folder on the job manager
+   The folder is written by FinishFolder() once its tags are read, in the order the folders
+   were queued, while the scanner thread carries on listing the next folders.
+   */
+  void QueueFolder(const CFileItemList& items, const CStdString& strDirectory, const CStdString& hash);
+
+  /*! \brief Write the oldest queued folder to the database, waiting for its tags as needed */
+  void FinishFolder();
+
+  /*! \brief Write queued folders until at most maxFiles files are waiting for their tags */
+  void FinishFolders(size_t maxFiles);
+
+  /*! \brief Drop all folders queued for tag reading */
+  void CancelQueued();
+
   int GetPathHash(const CFileItemList &items, CStdString &hash);
   void GetAlbumArtwork(long id, const CAlbum &artist);
 
@@ -124,5 +168,18 @@ protected:
   std::vector<long> m_artistsScanned;
   std::vector<long> m_albumsScanned;
   int m_flags;
+
+  struct ScanFolder
+  {
+    CStdString path;
+    CStdString hash;
+    boost::shared_ptr<CFileItemList> items;
+    TagReadBatchPtr tags;
+  };
+
+  CJobQueue m_tagQueue;
+  std::deque<ScanFolder> m_queuedFolders;
+  size_t m_queuedFiles;
+  CDatabaseBatch m_batch;   // songs written by the scanner thread, committed before it waits on anything
 };
 }
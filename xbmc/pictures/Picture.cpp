@@ -44,6 +44,8 @@ extern "C" {
 #include "libswscale/swscale.h"
 }
 
+#include "threads/SingleLock.h"
+
 /* PLEX */
 #include <boost/lexical_cast.hpp>
 #include "threads/Thread.h"
@@ -53,6 +55,69 @@ extern "C" {
 
 using namespace XFILE;
 
+// swscale contexts are expensive to set up and most images come in a handful of sizes,
+// so the contexts of the last few scales are kept around for the next image of that size
+#define MAX_SCALE_CONTEXTS 8
+
+struct ScaleContext
+{
+  unsigned int in_width;
+  unsigned int in_height;
+  unsigned int out_width;
+  unsigned int out_height;
+  int flags;
+  struct SwsContext *context;
+};
+
+class CScaleContextPool
+{
+public:
+  ~CScaleContextPool()
+  {
+    for (std::vector<ScaleContext>::iterator it = m_contexts.begin(); it != m_contexts.end(); ++it)
+      sws_freeContext(it->context);
+  }
+
+  struct SwsContext *Get(unsigned int in_width, unsigned int in_height, unsigned int out_width, unsigned int out_height, int flags)
+  {
+    {
+      CSingleLock lock(m_section);
+      for (std::vector<ScaleContext>::iterator it = m_contexts.begin(); it != m_contexts.end(); ++it)
+      {
+        if (it->in_width == in_width && it->in_height == in_height &&
+            it->out_width == out_width && it->out_height == out_height && it->flags == flags)
+        {
+          struct SwsContext *context = it->context;
+          m_contexts.erase(it);
+          return context;
+        }
+      }
+    }
+    return sws_getContext(in_width, in_height, PIX_FMT_BGRA, out_width, out_height, PIX_FMT_BGRA,
+                          flags, NULL, NULL, NULL);
+  }
+
+  void Release(unsigned int in_width, unsigned int in_height, unsigned int out_width, unsigned int out_height, int flags,
+               struct SwsContext *context)
+  {
+    ScaleContext entry = { in_width, in_height, out_width, out_height, flags, context };
+
+    CSingleLock lock(m_section);
+    m_contexts.insert(m_contexts.begin(), entry);
+    if (m_contexts.size() > MAX_SCALE_CONTEXTS)
+    { // drop the least recently used
+      sws_freeContext(m_contexts.back().context);
+      m_contexts.pop_back();
+    }
+  }
+
+private:
+  std::vector<ScaleContext> m_contexts; // most recently used first
+  CCriticalSection m_section;
+};
+
+static CScaleContextPool g_scaleContexts;
+
 bool CPicture::CreateThumbnailFromSurface(const unsigned char *buffer, int width, int height, int stride, const CStdString &thumbFile)
 {
   CLog::Log(LOGDEBUG, "cached image '%s' size %dx%d", thumbFile.c_str(), width, height);
@@ -240,9 +305,8 @@ bool CPicture::ScaleImage(uint8_t *in_pixels, unsigned int in_width, unsigned in
                           uint8_t *out_pixels, unsigned int out_width, unsigned int out_height, unsigned int out_pitch,
                           CPictureScalingAlgorithm::Algorithm scalingAlgorithm /* = CPictureScalingAlgorithm::NoAlgorithm */)
 {
-  struct SwsContext *context = sws_getContext(in_width, in_height, PIX_FMT_BGRA,
-                                                         out_width, out_height, PIX_FMT_BGRA,
-                                                         CPictureScalingAlgorithm::ToSwscale(scalingAlgorithm) | SwScaleCPUFlags(), NULL, NULL, NULL);
+  int flags = CPictureScalingAlgorithm::ToSwscale(scalingAlgorithm) | SwScaleCPUFlags();
+  struct SwsContext *context = g_scaleContexts.Get(in_width, in_height, out_width, out_height, flags);
 
   uint8_t *src[] = { in_pixels, 0, 0, 0 };
   int     srcStride[] = { (int)in_pitch, 0, 0, 0 };
@@ -252,7 +316,7 @@ bool CPicture::ScaleImage(uint8_t *in_pixels, unsigned int in_width, unsigned in
   if (context)
   {
     sws_scale(context, src, srcStride, 0, in_height, dst, dstStride);
-    sws_freeContext(context);
+    g_scaleContexts.Release(in_width, in_height, out_width, out_height, flags, context);
     return true;
   }
   return false;
@@ -333,6 +333,7 @@ void CAdvancedSettings::Initialize()
   m_guiVisualizeDirtyRegions = false;
   m_guiAlgorithmDirtyRegions = 3;
   m_guiDirtyRegionNoFlipTimeout = 0;
+  m_guiTextureBundleCacheSize = 0;
   m_logEnableAirtunes = false;
   m_airTunesPort = 36666;
   m_airPlayPort = 36667;
@@ -346,6 +347,9 @@ void CAdvancedSettings::Initialize()
   m_stereoscopicregex_mvc = "[-. _]h?mvc[-. _]";
 
   m_videoAssFixedWorks = false;
+  /* PLEX */
+  m_videoAssRenderAhead = 4;
+  /* END PLEX */
 
   m_logLevelHint = m_logLevel = LOG_LEVEL_NORMAL;
 
@@ -393,6 +397,17 @@ void CAdvancedSettings::Initialize()
 
   m_bForceJpegImageFormat = false;
   m_bUseMatroskaTranscodes = true;
+  m_playQueueLookahead = 2;
+  m_directoryCacheSize = 16 * 1024;
+  m_directoryCacheTTL = 300;
+  m_directoryCacheTTLs.clear();
+  m_directoryCacheTTLs["smb"] = 60;
+  m_directoryCacheTTLs["nfs"] = 60;
+  m_directoryCacheTTLs["afp"] = 60;
+  m_directoryCacheTTLs["upnp"] = 60;
+  m_directoryCacheTTLs["plugin"] = 30;
+  m_directoryCacheTTLs["zip"] = 3600;
+  m_directoryCacheTTLs["rar"] = 3600;
   m_bRequireEncryptedConnection = false;
   m_bEnableBetaChannel = false;
   m_videoSeekSteps = "-300,-180,-120,-60,-30,-15,+30,+60,+120,+180,+300";
@@ -524,6 +539,9 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
   if (pElement)
   {
     XMLUtils::GetBoolean(pElement, "assfixedworks", m_videoAssFixedWorks);
+    /* PLEX */
+    XMLUtils::GetInt(pElement, "assrenderahead", m_videoAssRenderAhead, 0, 25);
+    /* END PLEX */
     XMLUtils::GetString(pElement, "stereoscopicregex3d", m_stereoscopicregex_3d);
     XMLUtils::GetString(pElement, "stereoscopicregexsbs", m_stereoscopicregex_sbs);
     XMLUtils::GetString(pElement, "stereoscopicregextab", m_stereoscopicregex_tab);
@@ -1153,6 +1171,7 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetBoolean(pElement, "visualizedirtyregions", m_guiVisualizeDirtyRegions);
     XMLUtils::GetInt(pElement, "algorithmdirtyregions",     m_guiAlgorithmDirtyRegions);
     XMLUtils::GetInt(pElement, "nofliptimeout",             m_guiDirtyRegionNoFlipTimeout);
+    XMLUtils::GetInt(pElement, "texturebundlecache",        m_guiTextureBundleCacheSize, 0, 256);
     
     /* PLEX */
     // If these are set manually in advancedsettings.xml, hide them from the UI since they won't be persisted.
@@ -1224,6 +1243,24 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
   XMLUtils::GetBoolean(pRootElement, "hidefanouts", m_bHideFanouts);
   XMLUtils::GetBoolean(pRootElement, "forcejpegimageformat", m_bForceJpegImageFormat);
   XMLUtils::GetBoolean(pRootElement, "usematroskatranscode", m_bUseMatroskaTranscodes);
+  XMLUtils::GetInt(pRootElement, "playqueuelookahead", m_playQueueLookahead, 0, 10);
+
+  pElement = pRootElement->FirstChildElement("directorycache");
+  if (pElement)
+  {
+    XMLUtils::GetInt(pElement, "size", m_directoryCacheSize, 0, 1024 * 1024);
+    XMLUtils::GetInt(pElement, "ttl", m_directoryCacheTTL, 0, 24 * 3600);
+
+    // <protocol name="smb" ttl="60"/>
+    for (TiXmlElement* pProtocol = pElement->FirstChildElement("protocol"); pProtocol; pProtocol = pProtocol->NextSiblingElement("protocol"))
+    {
+      const char* name = pProtocol->Attribute("name");
+      int ttl;
+      if (name && pProtocol->QueryIntAttribute("ttl", &ttl) == TIXML_SUCCESS)
+        m_directoryCacheTTLs[name] = std::max(0, ttl);
+    }
+  }
+
   XMLUtils::GetBoolean(pRootElement, "requireencryptedconnection", m_bRequireEncryptedConnection);
   XMLUtils::GetBoolean(pRootElement, "enablebetachannel", m_bEnableBetaChannel);
   XMLUtils::GetString(pRootElement, "videoseeksteps", m_videoSeekSteps);
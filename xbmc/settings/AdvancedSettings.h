@@ -21,6 +21,9 @@
 
 #include "utils/StdString.h"
 #include <vector>
+/* PLEX */
+#include <map>
+/* END PLEX */
 
 #include "pictures/PictureScalingAlgorithm.h"
 #include "utils/GlobalsHandling.h"
@@ -351,6 +354,7 @@ class CAdvancedSettings
     bool m_guiVisualizeDirtyRegions;
     int  m_guiAlgorithmDirtyRegions;
     int  m_guiDirtyRegionNoFlipTimeout;
+    int  m_guiTextureBundleCacheSize; // MB of unpacked skin textures kept by the texture bundles, 0 to disable
     unsigned int m_addonPackageFolderSize;
 
     unsigned int m_cacheMemBufferSize;
@@ -379,6 +383,9 @@ class CAdvancedSettings
     bool m_videoAssFixedWorks;
 
     /* PLEX */
+    /*!< @brief number of video frames ass subtitles are rendered ahead of the one shown, 0 to render them when shown */
+    int m_videoAssRenderAhead;
+
     CStdString m_language;
     CStdString m_units;
 
@@ -413,6 +420,10 @@ class CAdvancedSettings
     void SetDirtyRegionsAlgorithm(int algorithm);
     void SetDirtyRegionsNoFlipTimeout(int timeout);
     bool m_bUseMatroskaTranscodes;
+    int m_playQueueLookahead; // play queue items resolved while the one before them plays, 0 to disable
+    int m_directoryCacheSize; // KB of listings the directory cache keeps in memory
+    int m_directoryCacheTTL;  // seconds a cached listing is served without being refreshed, 0 never refreshes
+    std::map<std::string, int> m_directoryCacheTTLs; // per protocol, overrides m_directoryCacheTTL and lets windows browse listings cached once
     /* END PLEX */
 };
 
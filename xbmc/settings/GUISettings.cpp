@@ -23,6 +23,7 @@
 #include <limits.h>
 #include <float.h>
 #include "Settings.h"
+#include "GUIInfoManager.h"
 #include "dialogs/GUIDialogFileBrowser.h"
 #include "storage/MediaManager.h"
 #ifdef _LINUX
@@ -1091,6 +1092,7 @@ void CGUISettings::SetBool(const char *strSetting, bool bSetting)
     ((CSettingBool*)(*it).second)->SetData(bSetting);
 
     SetChanged();
+    g_infoManager.NotifyChanged(INFO::DEPENDS_SETTING);
 
     return ;
   }
@@ -1107,6 +1109,7 @@ void CGUISettings::ToggleBool(const char *strSetting)
     ((CSettingBool*)(*it).second)->SetData(!((CSettingBool *)(*it).second)->GetData());
 
     SetChanged();
+    g_infoManager.NotifyChanged(INFO::DEPENDS_SETTING);
 
     return ;
   }
@@ -1293,6 +1296,7 @@ void CGUISettings::SetString(const char *strSetting, const char *strData)
     ((CSettingString *)(*it).second)->SetData(strData);
 
     SetChanged();
+    g_infoManager.NotifyChanged(INFO::DEPENDS_SETTING);
 
     return ;
   }
@@ -1356,6 +1356,11 @@ void CGUIWindowSettingsCategory::OnSettingChanged(BaseSettingControlPtr pSetting
 {
   CStdString strSetting = pSettingControl->GetSetting()->GetSetting();
 
+  /* PLEX */
+  // the controls and the handling below mostly set the data directly rather than through g_guiSettings
+  g_infoManager.NotifyChanged(INFO::DEPENDS_SETTING);
+  /* END PLEX */
+
   // ok, now check the various special things we need to do
   if (pSettingControl->GetSetting()->GetType() == SETTINGS_TYPE_ADDON)
   {
@@ -1583,6 +1583,7 @@ void CSettings::SetSkinString(int setting, const CStdString &label)
   if (it != m_skinStrings.end())
   {
     (*it).second.value = label;
+    g_infoManager.NotifyChanged(INFO::DEPENDS_SETTING);
     return;
   }
   assert(false);
@@ -1599,6 +1600,7 @@ void CSettings::ResetSkinSetting(const CStdString &setting)
     if (settingName.Equals((*it).second.name))
     {
       (*it).second.value = "";
+      g_infoManager.NotifyChanged(INFO::DEPENDS_SETTING);
       return;
     }
   }
@@ -1608,6 +1610,7 @@ void CSettings::ResetSkinSetting(const CStdString &setting)
     if (settingName.Equals((*it).second.name))
     {
       (*it).second.value = false;
+      g_infoManager.NotifyChanged(INFO::DEPENDS_SETTING);
       return;
     }
   }
@@ -1648,6 +1651,7 @@ void CSettings::SetSkinBool(int setting, bool set)
   if (it != m_skinBools.end())
   {
     (*it).second.value = set;
+    g_infoManager.NotifyChanged(INFO::DEPENDS_SETTING);
     return;
   }
   assert(false);
@@ -49,7 +49,10 @@ CRadioButtonSettingControl::~CRadioButtonSettingControl()
 
 bool CRadioButtonSettingControl::OnClick()
 {
-  ((CSettingBool *)m_pSetting)->SetData(!((CSettingBool *)m_pSetting)->GetData());
+  /* PLEX */
+  // through g_guiSettings, so conditions on the setting are evaluated again
+  g_guiSettings.SetBool(m_pSetting->GetSetting(), !((CSettingBool *)m_pSetting)->GetData());
+  /* END PLEX */
   return true;
 }
 
@@ -273,6 +273,233 @@ static void convert(iconv_t& type, int multiplier, const CStdString& strFromChar
 
 using namespace std;
 
+/* Conversions between UTF-8 and wchar_t are the bulk of all conversions (every label
+   shown, every sort key), so they are done here rather than by iconv. They need neither
+   the shared iconv handles nor m_critSection, so they don't serialize the GUI, the
+   scanners and the sorting jobs. Anything that isn't well formed is left to iconv, which
+   knows how to skip invalid sequences. */
+
+// true if no byte has the high bit set, checked a machine word at a time
+static bool isAscii(const char* buf, size_t len)
+{
+  static const size_t highBits = (size_t)-1 / 0xff * 0x80;
+  const char* end = buf + len;
+
+  for (; buf + sizeof(size_t) <= end; buf += sizeof(size_t))
+  {
+    size_t word;
+    memcpy(&word, buf, sizeof(word));
+    if (word & highBits)
+      return false;
+  }
+  for (; buf < end; buf++)
+  {
+    if (*buf & 0x80)
+      return false;
+  }
+  return true;
+}
+
+// right to left scripts and explicit bidi marks, which fribidi reorders or removes
+static bool isBidiCodepoint(uint32_t c)
+{
+  return (c >= 0x0590 && c <= 0x08ff) ||   // hebrew, arabic, syriac, thaana, nko, ...
+         (c >= 0x200e && c <= 0x200f) ||   // LRM, RLM
+         (c >= 0x202a && c <= 0x202e) ||   // embeddings and overrides
+         (c >= 0x2066 && c <= 0x2069) ||   // isolates
+         (c >= 0xfb1d && c <= 0xfdff) ||   // hebrew and arabic presentation forms
+         (c >= 0xfe70 && c <= 0xfeff) ||
+         (c >= 0x10800 && c <= 0x10fff) ||
+         (c >= 0x1e800 && c <= 0x1efff);
+}
+
+// boundary neutrals, which fribidi_remove_bidi_marks() drops as well: controls other than
+// whitespace and line breaks, the soft hyphen and the zero width and invisible characters
+static bool isBoundaryNeutral(uint32_t c)
+{
+  return c <= 0x08 ||
+         (c >= 0x0e && c <= 0x1b) ||
+         (c >= 0x7f && c <= 0x84) ||
+         (c >= 0x86 && c <= 0x9f) ||
+         c == 0xad ||
+         c == 0x180e ||
+         (c >= 0x200b && c <= 0x200d) ||
+         (c >= 0x2060 && c <= 0x206f) ||
+         (c >= 0xfff0 && c <= 0xfff8) ||
+         (c >= 0x1bca0 && c <= 0x1bca3) ||
+         (c >= 0x1d173 && c <= 0x1d17a) ||
+         (c >= 0xe0000 && c <= 0xe0fff);
+}
+
+// true if fribidi would leave the ascii text as it is, apart from its line breaks
+static bool isVisualAscii(const char* buf, size_t len)
+{
+  for (const char* end = buf + len; buf < end; buf++)
+  {
+    if (isBoundaryNeutral((unsigned char)*buf))
+      return false;
+  }
+  return true;
+}
+
+/*!
+ \brief Decode well formed UTF-8 without iconv
+ \param visual true to give what logicalToVisualBiDi() followed by the conversion would,
+ which for text without right to left characters or boundary neutrals is the text without its
+ line breaks
+ \return false if the text has to go through iconv (and fribidi) instead
+ */
+static bool utf8ToWFast(const CStdStringA& utf8String, CStdStringW& wString, bool visual)
+{
+  const unsigned char* src = (const unsigned char*)utf8String.c_str();
+  const unsigned char* end = src + utf8String.size();
+
+  if (isAscii(utf8String.c_str(), utf8String.size()) &&
+      (!visual || (utf8String.find('\n') == string::npos && isVisualAscii(utf8String.c_str(), utf8String.size()))))
+  {
+    wString.assign(src, end);
+    return true;
+  }
+
+#if defined(TARGET_DARWIN)
+  // UTF-8-MAC also composes decomposed characters, leave that to iconv
+  return false;
+#endif
+
+  // there are never more UTF-16 or UTF-32 units than UTF-8 bytes
+  wchar_t* dest = wString.GetBuffer(utf8String.size() + 1);
+  size_t length = 0;
+  bool valid = true;
+  while (valid && src < end)
+  {
+    uint32_t c = *src++;
+    if (c < 0x80)
+    {
+      if (visual && c == '\n')
+        continue;
+      if (visual && isBoundaryNeutral(c))
+      {
+        valid = false;
+        break;
+      }
+    }
+    else
+    {
+      int trailing;
+      uint32_t minimum;
+      if ((c & 0xe0) == 0xc0)
+      {
+        c &= 0x1f;
+        trailing = 1;
+        minimum = 0x80;
+      }
+      else if ((c & 0xf0) == 0xe0)
+      {
+        c &= 0x0f;
+        trailing = 2;
+        minimum = 0x800;
+      }
+      else if ((c & 0xf8) == 0xf0)
+      {
+        c &= 0x07;
+        trailing = 3;
+        minimum = 0x10000;
+      }
+      else
+      {
+        valid = false;
+        break;
+      }
+
+      if (end - src < trailing)
+      {
+        valid = false;
+        break;
+      }
+      for (; trailing; trailing--)
+      {
+        if ((*src & 0xc0) != 0x80)
+          break;
+        c = (c << 6) | (*src++ & 0x3f);
+      }
+
+      // truncated, overlong, surrogates and out of range code points are left to iconv
+      if (trailing || c < minimum || c > 0x10ffff || (c >= 0xd800 && c <= 0xdfff) ||
+          (visual && (isBidiCodepoint(c) || isBoundaryNeutral(c))))
+      {
+        valid = false;
+        break;
+      }
+
+      if (sizeof(wchar_t) == 2 && c >= 0x10000)
+      {
+        c -= 0x10000;
+        dest[length++] = (wchar_t)(0xd800 + (c >> 10));
+        c = 0xdc00 + (c & 0x3ff);
+      }
+    }
+    dest[length++] = (wchar_t)c;
+  }
+
+  wString.ReleaseBuffer(valid ? length : 0);
+  return valid;
+}
+
+/*!
+ \brief Encode wchar_t to UTF-8 without iconv
+ \return false if the text has invalid code points that have to go through iconv instead
+ */
+static bool wToUTF8Fast(const CStdStringW& wString, CStdStringA& utf8String)
+{
+  const wchar_t* src = wString.c_str();
+  const wchar_t* end = src + wString.size();
+
+  char* dest = utf8String.GetBuffer(wString.size() * 4 + 1);
+  size_t length = 0;
+  bool valid = true;
+  while (valid && src < end)
+  {
+    uint32_t c = (uint32_t)*src++;
+    if (sizeof(wchar_t) == 2)
+    {
+      c &= 0xffff;
+      if (c >= 0xd800 && c <= 0xdbff && src < end && ((uint32_t)*src & 0xfc00) == 0xdc00)
+        c = 0x10000 + ((c - 0xd800) << 10) + ((uint32_t)*src++ & 0x3ff);
+    }
+
+    if (c < 0x80)
+      dest[length++] = (char)c;
+    else if (c < 0x800)
+    {
+      dest[length++] = (char)(0xc0 | (c >> 6));
+      dest[length++] = (char)(0x80 | (c & 0x3f));
+    }
+    else if (c < 0x10000)
+    {
+      if (c >= 0xd800 && c <= 0xdfff)
+      {
+        valid = false;
+        break;
+      }
+      dest[length++] = (char)(0xe0 | (c >> 12));
+      dest[length++] = (char)(0x80 | ((c >> 6) & 0x3f));
+      dest[length++] = (char)(0x80 | (c & 0x3f));
+    }
+    else if (c <= 0x10ffff)
+    {
+      dest[length++] = (char)(0xf0 | (c >> 18));
+      dest[length++] = (char)(0x80 | ((c >> 12) & 0x3f));
+      dest[length++] = (char)(0x80 | ((c >> 6) & 0x3f));
+      dest[length++] = (char)(0x80 | (c & 0x3f));
+    }
+    else
+      valid = false;
+  }
+
+  utf8String.ReleaseBuffer(valid ? length : 0);
+  return valid;
+}
+
 static void logicalToVisualBiDi(const CStdStringA& strSource, CStdStringA& strDest, FriBidiCharSet fribidiCharset, FriBidiCharType base = FRIBIDI_TYPE_LTR, bool* bWasFlipped =NULL)
 {
   // libfribidi is not threadsafe, so make sure we make it so
@@ -418,14 +645,26 @@ void CCharsetConverter::utf8ToW(const CStdStringA& utf8String, CStdStringW &wStr
   // Try to flip hebrew/arabic characters, if any
   if (bVisualBiDiFlip)
   {
+    // nothing to flip, so no need for fribidi
+    if (utf8ToWFast(utf8String, wString, true))
+    {
+      if (bWasFlipped)
+        *bWasFlipped = false;
+      return;
+    }
+
     CStdStringA strFlipped;
     FriBidiCharType charset = forceLTRReadingOrder ? FRIBIDI_TYPE_LTR : FRIBIDI_TYPE_PDF;
     logicalToVisualBiDi(utf8String, strFlipped, FRIBIDI_UTF8, charset, bWasFlipped);
+    if (utf8ToWFast(strFlipped, wString, false))
+      return;
     CSingleLock lock(m_critSection);
     convert(m_iconvUtf8toW,sizeof(wchar_t),UTF8_SOURCE,WCHAR_CHARSET,strFlipped,wString);
   }
   else
   {
+    if (utf8ToWFast(utf8String, wString, false))
+      return;
     CSingleLock lock(m_critSection);
     convert(m_iconvUtf8toW,sizeof(wchar_t),UTF8_SOURCE,WCHAR_CHARSET,utf8String,wString);
   }
@@ -528,6 +767,9 @@ void CCharsetConverter::unknownToUTF8(const CStdStringA &source, CStdStringA &de
 
 void CCharsetConverter::wToUTF8(const CStdStringW& strSource, CStdStringA &strDest)
 {
+  if (wToUTF8Fast(strSource, strDest))
+    return;
+
   CSingleLock lock(m_critSection);
   convert(m_iconvWtoUtf8,UTF8_DEST_MULTIPLIER,WCHAR_CHARSET,"UTF-8",strSource,strDest);
 }
@@ -22,6 +22,7 @@
 class CJob;
 
 #include <stddef.h>
+#include <string>
 
 /*!
  \ingroup jobs
@@ -106,7 +107,7 @@ public:
     PRIORITY_NORMAL,
     PRIORITY_HIGH
   };
-  CJob() { m_callback = NULL; };
+  CJob() { m_callback = NULL; m_jobID = 0; };
 
   /*!
    \brief Destructor for job objects.
@@ -146,6 +147,19 @@ public:
     return false;
   }
 
+  /*!
+   \brief Function that returns a key identifying the work done by the job.
+
+   Used by CJobQueue to find duplicate jobs without comparing against every queued job,
+   so only jobs with the same identity are checked with operator==.  CJob subclasses that
+   implement operator== should implement this function as well, returning the same
+   identity for any two jobs that compare equal (eg. the path of the item they work on).
+
+   \return the identity of the job, empty by default.
+   \sa CJobQueue
+   */
+  virtual std::string GetIdentity() const { return ""; }
+
   /*!
    \brief Function for longer jobs to report progress and check whether they have been cancelled.
    
@@ -167,4 +181,5 @@ public:
 private:
   friend class CJobManager;
   CJobManager *m_callback;
+  unsigned int m_jobID;
 };
@@ -21,6 +21,7 @@
 #include "JobManager.h"
 #include <algorithm>
 #include "threads/SingleLock.h"
+#include "threads/Atomics.h"
 #include "utils/log.h"
 
 #include "system.h"
@@ -35,9 +36,10 @@ bool CJob::ShouldCancel(unsigned int progress, unsigned int total) const
   return false;
 }
 
-CJobWorker::CJobWorker(CJobManager *manager) : CThread("Jobworker")
+CJobWorker::CJobWorker(CJobManager *manager, unsigned int index) : CThread("Jobworker")
 {
   m_jobManager = manager;
+  m_index = index;
   Create(true); // start work immediately, and kill ourselves when we're done
 }
 
@@ -90,13 +92,31 @@ CJobQueue::~CJobQueue()
   CancelJobs();
 }
 
+CJobQueue::JobIndex::iterator CJobQueue::FindJob(const CJob *job, bool sameJob)
+{
+  // only jobs with the same identity can be equal
+  std::pair<JobIndex::iterator, JobIndex::iterator> range = m_index.equal_range(job->GetIdentity());
+  for (JobIndex::iterator i = range.first; i != range.second; ++i)
+  {
+    const CJobPointer &pointer = *i->second.job;
+    if (sameJob ? pointer.m_job == job : pointer == job)
+      return i;
+  }
+  return m_index.end();
+}
+
 void CJobQueue::OnJobComplete(unsigned int jobID, bool success, CJob *job)
 {
   CSingleLock lock(m_section);
   // check if this job is in our processing list
-  Processing::iterator i = find(m_processing.begin(), m_processing.end(), job);
-  if (i != m_processing.end())
-    m_processing.erase(i);
+  JobIndex::iterator i = FindJob(job, true);
+  if (i == m_index.end())
+    i = FindJob(job);
+  if (i != m_index.end() && i->second.processing)
+  {
+    m_processing.erase(i->second.job);
+    m_index.erase(i);
+  }
   // request a new job be queued
   QueueNextJob();
 }
@@ -104,48 +124,51 @@ void CJobQueue::OnJobComplete(unsigned int jobID, bool success, CJob *job)
 void CJobQueue::CancelJob(const CJob *job)
 {
   CSingleLock lock(m_section);
-  Processing::iterator i = find(m_processing.begin(), m_processing.end(), job);
-  if (i != m_processing.end())
-  {
-    i->CancelJob();
-    m_processing.erase(i);
+  JobIndex::iterator i = FindJob(job);
+  if (i == m_index.end())
     return;
+
+  if (i->second.processing)
+  {
+    i->second.job->CancelJob();
+    m_processing.erase(i->second.job);
   }
-  Queue::iterator j = find(m_jobQueue.begin(), m_jobQueue.end(), job);
-  if (j != m_jobQueue.end())
+  else
   {
-    j->FreeJob();
-    m_jobQueue.erase(j);
+    i->second.job->FreeJob();
+    m_jobQueue.erase(i->second.job);
   }
+  m_index.erase(i);
 }
 
 void CJobQueue::AddJob(CJob *job)
 {
   CSingleLock lock(m_section);
   // check if we have this job already.  If so, we're done.
-  if (find(m_jobQueue.begin(), m_jobQueue.end(), job) != m_jobQueue.end() ||
-      find(m_processing.begin(), m_processing.end(), job) != m_processing.end())
+  if (FindJob(job) != m_index.end())
   {
     delete job;
     return;
   }
 
-  if (m_lifo)
-    m_jobQueue.push_back(CJobPointer(job));
-  else
-    m_jobQueue.push_front(CJobPointer(job));
+  CJobLocation location;
+  location.job = m_jobQueue.insert(m_lifo ? m_jobQueue.end() : m_jobQueue.begin(), CJobPointer(job));
+  location.processing = false;
+  m_index.insert(make_pair(job->GetIdentity(), location));
   QueueNextJob();
 }
 
 void CJobQueue::QueueNextJob()
 {
   CSingleLock lock(m_section);
-  if (m_jobQueue.size() && m_processing.size() < m_jobsAtOnce)
+  if (!m_jobQueue.empty() && m_processing.size() < m_jobsAtOnce)
   {
-    CJobPointer &job = m_jobQueue.back();
-    job.m_id = CJobManager::GetInstance().AddJob(job.m_job, this, m_priority);
-    m_processing.push_back(job);
-    m_jobQueue.pop_back();
+    Queue::iterator job = --m_jobQueue.end();
+    JobIndex::iterator i = FindJob(job->m_job, true);
+    job->m_id = CJobManager::GetInstance().AddJob(job->m_job, this, m_priority);
+    m_processing.splice(m_processing.end(), m_jobQueue, job);
+    if (i != m_index.end())
+      i->second.processing = true;
   }
 }
 
@@ -156,6 +179,7 @@ void CJobQueue::CancelJobs()
   for_each(m_jobQueue.begin(), m_jobQueue.end(), mem_fun_ref(&CJobPointer::FreeJob));
   m_jobQueue.clear();
   m_processing.clear();
+  m_index.clear();
 }
 
 CJobManager &CJobManager::GetInstance()
@@ -167,7 +191,17 @@ CJobManager &CJobManager::GetInstance()
 CJobManager::CJobManager()
 {
   m_jobCounter = 0;
+  m_nextQueue = 0;
+  for (unsigned int priority = CJob::PRIORITY_LOW; priority <= CJob::PRIORITY_HIGH; ++priority)
+    m_queued[priority] = 0;
+  m_processing = 0;
+  m_idleWorkers = 0;
+  m_numWorkers = 0;
   m_running = true;
+
+  // one queue for each worker we may start
+  for (unsigned int i = 0; i < GetMaxWorkers(CJob::PRIORITY_HIGH); i++)
+    m_queues.push_back(new CWorkQueue);
 }
 
 void CJobManager::CancelJobs()
@@ -176,20 +210,41 @@ void CJobManager::CancelJobs()
   m_running = false;
 
   // clear any pending jobs
-  for (unsigned int priority = CJob::PRIORITY_LOW; priority <= CJob::PRIORITY_HIGH; ++priority)
+  for (unsigned int i = 0; i < m_queues.size(); i++)
   {
-    for_each(m_jobQueue[priority].begin(), m_jobQueue[priority].end(), mem_fun_ref(&CWorkItem::FreeJob));
-    m_jobQueue[priority].clear();
+    CSingleLock queueLock(m_queues[i]->m_section);
+    for (unsigned int priority = CJob::PRIORITY_LOW; priority <= CJob::PRIORITY_HIGH; ++priority)
+    {
+      std::deque<CWorkItem*> &jobs = m_queues[i]->m_jobs[priority];
+      for (std::deque<CWorkItem*>::iterator it = jobs.begin(); it != jobs.end(); ++it)
+      {
+        CWorkShard &shard = GetShard((*it)->m_id);
+        CSingleLock shardLock(shard.m_section);
+        shard.m_items.erase((*it)->m_id);
+        (*it)->FreeJob();
+        delete *it;
+        AtomicDecrement(&m_queued[priority]);
+      }
+      jobs.clear();
+    }
   }
 
   // cancel any callbacks on jobs still processing
-  for_each(m_processing.begin(), m_processing.end(), mem_fun_ref(&CWorkItem::Cancel));
+  for (unsigned int i = 0; i < NUM_SHARDS; i++)
+  {
+    CSingleLock shardLock(m_shards[i].m_section);
+    for (boost::unordered_map<unsigned int, CWorkItem*>::iterator it = m_shards[i].m_items.begin(); it != m_shards[i].m_items.end(); ++it)
+    {
+      if (it->second->m_processing)
+        it->second->Cancel();
+    }
+  }
 
   // tell our workers to finish
   while (m_workers.size())
   {
     lock.Leave();
-    m_jobEvent.Set();
+    WakeAllWorkers();
     Sleep(0); // yield after setting the event to give the workers some time to die
     lock.Enter();
   }
@@ -197,98 +252,175 @@ void CJobManager::CancelJobs()
 
 CJobManager::~CJobManager()
 {
+  for (unsigned int i = 0; i < m_queues.size(); i++)
+    delete m_queues[i];
 }
 
 unsigned int CJobManager::AddJob(CJob *job, IJobCallback *callback, CJob::PRIORITY priority)
 {
-  CSingleLock lock(m_section);
-
   if (!m_running)
     return 0;
 
   // increment the job counter, ensuring 0 (invalid job) is never hit
-  m_jobCounter++;
-  if (m_jobCounter == 0)
-    m_jobCounter++;
+  unsigned int id = (unsigned int)AtomicIncrement(&m_jobCounter);
+  if (id == 0)
+    id = (unsigned int)AtomicIncrement(&m_jobCounter);
 
   // create a work item for this job
-  CWorkItem work(job, m_jobCounter, callback);
-  m_jobQueue[priority].push_back(work);
+  CWorkItem *work = new CWorkItem(job, id, callback);
+  job->m_jobID = id;
+  {
+    CWorkShard &shard = GetShard(id);
+    CSingleLock lock(shard.m_section);
+    shard.m_items[id] = work;
+  }
+
+  // spread the jobs over the worker queues
+  CWorkQueue &queue = *m_queues[(unsigned long)AtomicIncrement(&m_nextQueue) % m_queues.size()];
+  {
+    CSingleLock lock(queue.m_section);
+    queue.m_jobs[priority].push_back(work);
+    AtomicIncrement(&m_queued[priority]);
+  }
 
-  StartWorkers(priority);
-  return work.m_id;
+  StartWorkers();
+  return id;
 }
 
 void CJobManager::CancelJob(unsigned int jobID)
 {
-  CSingleLock lock(m_section);
+  CWorkShard &shard = GetShard(jobID);
+  CSingleLock lock(shard.m_section);
 
-  // check whether we have this job in the queue
-  for (unsigned int priority = CJob::PRIORITY_LOW; priority <= CJob::PRIORITY_HIGH; ++priority)
+  boost::unordered_map<unsigned int, CWorkItem*>::iterator i = shard.m_items.find(jobID);
+  if (i == shard.m_items.end())
+    return;
+
+  CWorkItem *item = i->second;
+  if (!item->m_processing)
   {
-    JobQueue::iterator i = find(m_jobQueue[priority].begin(), m_jobQueue[priority].end(), jobID);
-    if (i != m_jobQueue[priority].end())
-    {
-      delete i->m_job;
-      m_jobQueue[priority].erase(i);
-      return;
-    }
+    // the job is still queued, so delete it now. The work item is dropped
+    // from the queue and freed once a worker comes across it.
+    item->FreeJob();
+    item->m_callback = NULL;
   }
-  // or if we're processing it
-  Processing::iterator it = find(m_processing.begin(), m_processing.end(), jobID);
-  if (it != m_processing.end())
+  else if (item->m_job)
   {
-    /* PLEX */ it->Cancel(); /* END PLEX */
-    it->m_callback = NULL; // job is in progress, so only thing to do is to remove callback
+    /* PLEX */ item->Cancel(); /* END PLEX */
+    item->m_callback = NULL; // job is in progress, so only thing to do is to remove callback
   }
 }
 
-void CJobManager::StartWorkers(CJob::PRIORITY priority)
+void CJobManager::StartWorkers()
 {
-  CSingleLock lock(m_section);
+  // do we have any sleeping threads? one that's just waking up can't be woken anymore
+  if (m_idleWorkers > 0 && WakeWorker())
+    return;
 
-  // check how many free threads we have
-  if (m_processing.size() >= GetMaxWorkers(priority))
+  // everyone is busy - we need more workers, unless the pool is complete
+  if ((unsigned long)m_numWorkers >= m_queues.size())
     return;
 
-  // do we have any sleeping threads?
-  if (m_processing.size() < m_workers.size())
+  CSingleLock lock(m_section);
+  if (m_running && m_workers.size() < m_queues.size())
   {
-    m_jobEvent.Set();
-    return;
+    m_workers.push_back(new CJobWorker(this, m_workers.size()));
+    AtomicIncrement(&m_numWorkers);
   }
-
-  // everyone is busy - we need more workers
-  m_workers.push_back(new CJobWorker(this));
 }
 
-CJob *CJobManager::PopJob()
+CJob *CJobManager::PopJob(unsigned int queue)
 {
-  CSingleLock lock(m_section);
   for (int priority = CJob::PRIORITY_HIGH; priority >= CJob::PRIORITY_LOW; --priority)
   {
-    if (m_jobQueue[priority].size() && m_processing.size() < GetMaxWorkers(CJob::PRIORITY(priority)))
+    if (m_queued[priority] <= 0)
+      continue;
+
+    // try our own queue first, then steal from the others
+    for (unsigned int i = 0; i < m_queues.size(); i++)
     {
-      // skip adding any paused types
-      if (!SkipPausedJobs((CJob::PRIORITY)priority))
-        return NULL;
-
-      // pop the job off the queue
-      CWorkItem job = m_jobQueue[priority].front();
-      m_jobQueue[priority].pop_front();
-
-      // add to the processing vector
-      m_processing.push_back(job);
-      job.m_job->m_callback = this;
-      return job.m_job;
+      CWorkQueue &workQueue = *m_queues[(queue + i) % m_queues.size()];
+      CWorkItem *item;
+      while ((item = PopQueue(workQueue, CJob::PRIORITY(priority))) != NULL)
+      {
+        // reserve a worker for this job, leaving room for higher priority jobs that may arise.
+        // Only workers holding a job reserve one, so if this fails the workers counted will
+        // look for more jobs once they are done, and the job can wait in the queue.
+        if ((unsigned long)AtomicIncrement(&m_processing) > GetMaxWorkers(CJob::PRIORITY(priority)))
+        {
+          AtomicDecrement(&m_processing);
+          CSingleLock lock(workQueue.m_section);
+          workQueue.m_jobs[priority].push_front(item);
+          return NULL;
+        }
+        AtomicDecrement(&m_queued[priority]);
+
+        CWorkShard &shard = GetShard(item->m_id);
+        CSingleLock lock(shard.m_section);
+        if (!item->m_job)
+        {
+          // cancelled while queued
+          shard.m_items.erase(item->m_id);
+          delete item;
+          AtomicDecrement(&m_processing);
+          continue;
+        }
+        CJob *job = item->m_job;
+        item->m_processing = true;
+        job->m_callback = this;
+        lock.Leave();
+
+        // more jobs are waiting, so get some help
+        if (m_idleWorkers > 0 && m_queued[priority] > 0)
+          WakeWorker();
+        return job;
+      }
     }
   }
   return NULL;
 }
 
+CJobManager::CWorkItem *CJobManager::PopQueue(CWorkQueue &queue, CJob::PRIORITY priority)
+{
+  CSingleLock lock(queue.m_section);
+  std::deque<CWorkItem*> &jobs = queue.m_jobs[priority];
+  if (jobs.empty())
+    return NULL;
+
+  // skip adding any paused types
+  if (priority == CJob::PRIORITY_LOW)
+  {
+    CSingleLock pausedLock(m_pausedSection);
+    if (!m_pausedTypes.empty())
+    {
+      // find the first unpaused job
+      std::deque<CWorkItem*>::iterator first_job = jobs.begin();
+      for (; first_job != jobs.end(); ++first_job)
+      {
+        if (find(m_pausedTypes.begin(), m_pausedTypes.end(), (*first_job)->m_type) == m_pausedTypes.end())
+          break; // found a job that can be performed
+      }
+      if (first_job == jobs.end())
+        return NULL; // no jobs ready to go
+
+      // shunt all the paused ones to the back of the queue
+      size_t paused = first_job - jobs.begin();
+      for (size_t i = 0; i < paused; i++)
+      {
+        jobs.push_back(jobs.front());
+        jobs.pop_front();
+      }
+    }
+  }
+
+  CWorkItem *item = jobs.front();
+  jobs.pop_front();
+  return item;
+}
+
 void CJobManager::Pause(const std::string &pausedType)
 {
-  CSingleLock lock(m_section);
+  CSingleLock lock(m_pausedSection);
   // just push it in so we get ref counting,
   // the queue will resume when all Pause requests
   // for a given type have been UnPaused.
@@ -297,77 +429,60 @@ void CJobManager::Pause(const std::string &pausedType)
 
 void CJobManager::UnPause(const std::string &pausedType)
 {
-  CSingleLock lock(m_section);
+  CSingleLock lock(m_pausedSection);
   std::vector<std::string>::iterator i = find(m_pausedTypes.begin(), m_pausedTypes.end(), pausedType);
   if (i != m_pausedTypes.end())
+  {
     m_pausedTypes.erase(i);
+    // wake the workers for any jobs that were held back
+    lock.Leave();
+    WakeAllWorkers();
+  }
 }
 
 bool CJobManager::IsPaused(const std::string &pausedType)
 {
-  CSingleLock lock(m_section);
+  CSingleLock lock(m_pausedSection);
   std::vector<std::string>::iterator i = find(m_pausedTypes.begin(), m_pausedTypes.end(), pausedType);
   return (i != m_pausedTypes.end());
 }
 
-bool CJobManager::SkipPausedJobs(CJob::PRIORITY priority)
-{
-  if (priority > CJob::PRIORITY_LOW)
-    return true;
-
-  // find the first unpaused job
-  JobQueue::iterator first_job = m_jobQueue[priority].begin();
-  for (; first_job != m_jobQueue[priority].end(); ++first_job)
-  {
-    std::vector<std::string>::iterator i = find(m_pausedTypes.begin(), m_pausedTypes.end(), first_job->m_job->GetType());
-    if (i == m_pausedTypes.end())
-      break; // found a job that can be performed
-  }
-  if (first_job == m_jobQueue[priority].end())
-    return false; // no jobs ready to go
-
-  // shunt all the paused ones to the back of the queue
-  for (JobQueue::iterator i = m_jobQueue[priority].begin(); i != first_job; i++)
-  {
-    m_jobQueue[priority].push_back(*i);
-    m_jobQueue[priority].pop_front();
-  }
-  return true;
-}
-
 int CJobManager::IsProcessing(const std::string &pausedType)
 {
   int jobsMatched = 0;
-  CSingleLock lock(m_section);
-  for(Processing::iterator it = m_processing.begin(); it < m_processing.end(); it++)
+  for (unsigned int i = 0; i < NUM_SHARDS; i++)
   {
-    if (pausedType == std::string(it->m_job->GetType()))
-      jobsMatched++;
+    CSingleLock lock(m_shards[i].m_section);
+    for (boost::unordered_map<unsigned int, CWorkItem*>::iterator it = m_shards[i].m_items.begin(); it != m_shards[i].m_items.end(); ++it)
+    {
+      if (it->second->m_processing && pausedType == it->second->m_type)
+        jobsMatched++;
+    }
   }
   return jobsMatched;
 }
 
 CJob *CJobManager::GetNextJob(const CJobWorker *worker)
 {
-  CSingleLock lock(m_section);
+  CWorkQueue &queue = *m_queues[worker->GetIndex()];
   while (m_running)
   {
-    // grab a job off the queue if we have one
-    CJob *job = PopJob();
+    // grab a job off the queues if we have one
+    CJob *job = PopJob(worker->GetIndex());
+    if (job)
+      return job;
+
+    // let AddJob know we need waking, then make sure no job came in meanwhile
+    cas(&queue.m_idle, 0, 1);
+    AtomicIncrement(&m_idleWorkers);
+    job = PopJob(worker->GetIndex());
+    if (!job)
+      queue.m_wakeEvent.WaitMSec(30000);
+    cas(&queue.m_idle, 1, 0);
+    AtomicDecrement(&m_idleWorkers);
     if (job)
       return job;
-    // no jobs are left - sleep for 30 seconds to allow new jobs to come in
-    lock.Leave();
-    bool newJob = m_jobEvent.WaitMSec(30000);
-    lock.Enter();
-    if (!newJob)
-      break;
   }
-  // ensure no jobs have come in during the period after
-  // timeout and before we held the lock
-  CJob *job = PopJob();
-  if (job)
-    return job;
   // have no jobs
   RemoveWorker(worker);
   return NULL;
@@ -375,12 +490,13 @@ CJob *CJobManager::GetNextJob(const CJobWorker *worker)
 
 bool CJobManager::OnJobProgress(unsigned int progress, unsigned int total, const CJob *job) const
 {
-  CSingleLock lock(m_section);
-  // find the job in the processing queue, and check whether it's cancelled (no callback)
-  Processing::const_iterator i = find(m_processing.begin(), m_processing.end(), job);
-  if (i != m_processing.end())
+  CWorkShard &shard = GetShard(job->m_jobID);
+  CSingleLock lock(shard.m_section);
+  // find the job in the processing registry, and check whether it's cancelled (no callback)
+  boost::unordered_map<unsigned int, CWorkItem*>::const_iterator i = shard.m_items.find(job->m_jobID);
+  if (i != shard.m_items.end() && i->second->m_job == job)
   {
-    CWorkItem item(*i);
+    CWorkItem item(*i->second);
     lock.Leave(); // leave section prior to call
     if (item.m_callback)
     {
@@ -393,13 +509,14 @@ bool CJobManager::OnJobProgress(unsigned int progress, unsigned int total, const
 
 void CJobManager::OnJobComplete(bool success, CJob *job)
 {
-  CSingleLock lock(m_section);
-  // remove the job from the processing queue
-  Processing::iterator i = find(m_processing.begin(), m_processing.end(), job);
-  if (i != m_processing.end())
+  CWorkShard &shard = GetShard(job->m_jobID);
+  CSingleLock lock(shard.m_section);
+  // remove the job from the processing registry
+  boost::unordered_map<unsigned int, CWorkItem*>::iterator i = shard.m_items.find(job->m_jobID);
+  if (i != shard.m_items.end() && i->second->m_job == job)
   {
     // tell any listeners we're done with the job, then delete it
-    CWorkItem item(*i);
+    CWorkItem item(*i->second);
     lock.Leave();
     try
     {
@@ -411,12 +528,36 @@ void CJobManager::OnJobComplete(bool success, CJob *job)
       CLog::Log(LOGERROR, "%s error processing job %s", __FUNCTION__, item.m_job->GetType());
     }
     lock.Enter();
-    Processing::iterator j = find(m_processing.begin(), m_processing.end(), job);
-    if (j != m_processing.end())
-      m_processing.erase(j);
+    i = shard.m_items.find(item.m_id);
+    if (i != shard.m_items.end())
+    {
+      delete i->second;
+      shard.m_items.erase(i);
+    }
     lock.Leave();
     item.FreeJob();
   }
+  AtomicDecrement(&m_processing);
+}
+
+bool CJobManager::WakeWorker()
+{
+  // wake a single worker, it wakes the next one if there are more jobs than it can take
+  for (unsigned int i = 0; i < m_queues.size(); i++)
+  {
+    if (cas(&m_queues[i]->m_idle, 1, 0) == 1)
+    {
+      m_queues[i]->m_wakeEvent.Set();
+      return true;
+    }
+  }
+  return false;
+}
+
+void CJobManager::WakeAllWorkers()
+{
+  for (unsigned int i = 0; i < m_queues.size(); i++)
+    m_queues[i]->m_wakeEvent.Set();
 }
 
 void CJobManager::RemoveWorker(const CJobWorker *worker)
@@ -425,7 +566,15 @@ void CJobManager::RemoveWorker(const CJobWorker *worker)
   // remove our worker
   Workers::iterator i = find(m_workers.begin(), m_workers.end(), worker);
   if (i != m_workers.end())
+  {
     m_workers.erase(i); // workers auto-delete
+    AtomicDecrement(&m_numWorkers);
+  }
+}
+
+CJobManager::CWorkShard &CJobManager::GetShard(unsigned int jobID) const
+{
+  return m_shards[jobID % NUM_SHARDS];
 }
 
 unsigned int CJobManager::GetMaxWorkers(CJob::PRIORITY priority) const
@@ -20,8 +20,10 @@
  */
 
 #include <queue>
+#include <list>
 #include <vector>
 #include <string>
+#include <boost/unordered_map.hpp>
 #include "threads/CriticalSection.h"
 #include "threads/Thread.h"
 #include "Job.h"
@@ -31,12 +33,14 @@ class CJobManager;
 class CJobWorker : public CThread
 {
 public:
-  CJobWorker(CJobManager *manager);
+  CJobWorker(CJobManager *manager, unsigned int index);
   virtual ~CJobWorker();
 
   void Process();
+  unsigned int GetIndex() const { return m_index; };
 private:
   CJobManager  *m_jobManager;
+  unsigned int  m_index;      // the work queue owned by this worker
 };
 
 /*!
@@ -45,7 +49,8 @@ private:
 
  Holds a queue of jobs to be processed sequentially, either first in,first out
  or last in, first out.  Jobs are unique, so queueing multiple copies of the same job
- (based on the CJob::operator==) will not add additional jobs.
+ (based on the CJob::operator==) will not add additional jobs.  Jobs are indexed by
+ CJob::GetIdentity(), so only jobs with the same identity need to be compared.
 
  Classes should subclass this class and override OnJobCallback should they require
  information from the job.
@@ -138,10 +143,28 @@ public:
 private:
   void QueueNextJob();
 
-  typedef std::deque<CJobPointer> Queue;
-  typedef std::vector<CJobPointer> Processing;
+  // lists, so that the iterators held by the index stay valid while jobs are added,
+  // removed or moved from the queue to processing.
+  typedef std::list<CJobPointer> Queue;
+  typedef std::list<CJobPointer> Processing;
+
+  struct CJobLocation
+  {
+    Queue::iterator job;
+    bool processing;
+  };
+  typedef boost::unordered_multimap<std::string, CJobLocation> JobIndex;
+
+  /*! \brief Find a queued or processing job equal to the given one
+   \param job the job to look for
+   \param sameJob only match the job object itself, rather than any job comparing equal
+   \return the index entry of the job, or m_index.end() if there is none
+   */
+  JobIndex::iterator FindJob(const CJob *job, bool sameJob = false);
+
   Queue m_jobQueue;
   Processing m_processing;
+  JobIndex m_index;
 
   unsigned int m_jobsAtOnce;
   CJob::PRIORITY m_priority;
@@ -158,6 +181,12 @@ private:
  priority levels.  Lower priority jobs are executed only if there are sufficient
  spare worker threads free to allow for higher priority jobs that may arise.
 
+ Workers are started as needed up to a fixed pool size and then kept around.  Each
+ worker owns a queue with its own lock, new jobs are spread over the queues, and a
+ worker that has run out of jobs steals from the queues of the others.  Jobs being
+ processed are kept in a registry sharded by job id, so progress and completion
+ callbacks don't contend with jobs being queued.
+
  \sa CJob and IJobCallback
  */
 class CJobManager
@@ -170,15 +199,9 @@ class CJobManager
       m_job = job;
       m_id = id;
       m_callback = callback;
+      m_type = job->GetType();
+      m_processing = false;
     }
-    bool operator==(unsigned int jobID) const
-    {
-      return m_id == jobID;
-    };
-    bool operator==(const CJob *job) const
-    {
-      return m_job == job;
-    };
     void FreeJob()
     {
       delete m_job;
@@ -191,9 +214,32 @@ class CJobManager
       /* END PLEX */
       m_callback = NULL;
     };
-    CJob         *m_job;
+    CJob         *m_job;        // NULL once a queued job has been cancelled
     unsigned int  m_id;
     IJobCallback *m_callback;
+    std::string   m_type;       // copied so paused jobs can be skipped without touching the job
+    bool          m_processing;
+  };
+
+  enum { NUM_SHARDS = 16 };
+
+  /*! \brief Jobs waiting for a worker, one queue per worker */
+  class CWorkQueue
+  {
+  public:
+    CWorkQueue() { m_idle = 0; };
+    CCriticalSection       m_section;
+    std::deque<CWorkItem*> m_jobs[CJob::PRIORITY_HIGH+1];
+    CEvent                 m_wakeEvent;   // the worker owning the queue waits on this
+    volatile long          m_idle;        // the worker is waiting and nobody woke it up yet
+  };
+
+  /*! \brief Part of the registry of queued and processing jobs, keyed by job id */
+  class CWorkShard
+  {
+  public:
+    CCriticalSection m_section;
+    boost::unordered_map<unsigned int, CWorkItem*> m_items;
   };
 
 public:
@@ -298,35 +344,49 @@ private:
   CJobManager const& operator=(CJobManager const&);
   virtual ~CJobManager();
 
-  /*! \brief Pop a job off the job queue and add to the processing queue ready to process
+  /*! \brief Pop a job off the job queues and mark it as processing
+   Takes the job from the queue of the given worker if possible, and otherwise
+   steals one from the queues of the other workers.
+   \param queue the index of the queue owned by the worker asking for a job.
    \return the job to process, NULL if no jobs are available
    */
-  CJob *PopJob();
-
-  void StartWorkers(CJob::PRIORITY priority);
-  void RemoveWorker(const CJobWorker *worker);
-  unsigned int GetMaxWorkers(CJob::PRIORITY priority) const;
+  CJob *PopJob(unsigned int queue);
 
-  /*! \brief skips over any paused jobs of given priority.
+  /*! \brief Take the first job of the given priority off a queue
    Moves any paused jobs at the front of the queue to the back of the
    queue, allowing unpaused jobs to continue processing.
-   \param priority the priority queue to consider.
-   \return true if an unpaused job is available, false if no unpaused jobs are available.
+   \param queue the queue to take the job from.
+   \param priority the priority to consider.
+   \return the work item, NULL if no unpaused jobs are available.
    */
-  bool SkipPausedJobs(CJob::PRIORITY priority);
+  CWorkItem *PopQueue(CWorkQueue &queue, CJob::PRIORITY priority);
 
-  unsigned int m_jobCounter;
+  void StartWorkers();
+  /*! \brief Wake a single idle worker
+   \return false if no worker was waiting to be woken, eg. all of them were just waking up
+   */
+  bool WakeWorker();
+  void WakeAllWorkers();
+  void RemoveWorker(const CJobWorker *worker);
+  unsigned int GetMaxWorkers(CJob::PRIORITY priority) const;
+  CWorkShard &GetShard(unsigned int jobID) const;
+
+  volatile long m_jobCounter;
+  volatile long m_nextQueue;
+  volatile long m_queued[CJob::PRIORITY_HIGH+1]; // jobs waiting or being taken off a queue, per priority
+  volatile long m_processing;                    // jobs handed to a worker
+  volatile long m_idleWorkers;
+  volatile long m_numWorkers;
 
-  typedef std::deque<CWorkItem>    JobQueue;
-  typedef std::vector<CWorkItem>   Processing;
   typedef std::vector<CJobWorker*> Workers;
 
-  JobQueue   m_jobQueue[CJob::PRIORITY_HIGH+1];
-  Processing m_processing;
-  Workers    m_workers;
+  std::vector<CWorkQueue*> m_queues;
+  mutable CWorkShard       m_shards[NUM_SHARDS];
+  Workers                  m_workers;
 
-  CCriticalSection m_section;
-  CEvent           m_jobEvent;
+  CCriticalSection m_section;       // guards m_workers
   bool             m_running;
+
+  CCriticalSection          m_pausedSection;
   std::vector<std::string>  m_pausedTypes;
 };
@@ -28,6 +28,7 @@
 #include "log.h"
 #include "stdio_utf8.h"
 #include "stat_utf8.h"
+#include "threads/Atomics.h"
 #include "threads/CriticalSection.h"
 #include "threads/SingleLock.h"
 #include "threads/Thread.h"
@@ -44,10 +45,49 @@
 #define m_repeatLogLevel XBMC_GLOBAL_USE(CLog::CLogGlobals).m_repeatLogLevel
 #define m_repeatLine XBMC_GLOBAL_USE(CLog::CLogGlobals).m_repeatLine
 #define m_logLevel XBMC_GLOBAL_USE(CLog::CLogGlobals).m_logLevel
+#define m_queue XBMC_GLOBAL_USE(CLog::CLogGlobals).m_queue
+#define m_queueHead XBMC_GLOBAL_USE(CLog::CLogGlobals).m_queueHead
+#define m_queueTail XBMC_GLOBAL_USE(CLog::CLogGlobals).m_queueTail
+#define m_queuedBytes XBMC_GLOBAL_USE(CLog::CLogGlobals).m_queuedBytes
+#define m_dropped XBMC_GLOBAL_USE(CLog::CLogGlobals).m_dropped
+#define m_wakePending XBMC_GLOBAL_USE(CLog::CLogGlobals).m_wakePending
+#define m_queueEvent XBMC_GLOBAL_USE(CLog::CLogGlobals).m_queueEvent
+#define m_writer XBMC_GLOBAL_USE(CLog::CLogGlobals).m_writer
 
 static char levelNames[][8] =
 {"DEBUG", "INFO", "NOTICE", "WARNING", "ERROR", "SEVERE", "FATAL", "NONE"};
 
+static const char* prefixFormat = "%02.2d:%02.2d:%02.2d T:%" PRIu64" %7s: ";
+
+// read a value another thread publishes with an atomic operation
+static inline long AtomicLoad(volatile long* pAddr)
+{
+  return AtomicAdd(pAddr, 0);
+}
+
+/*!
+ \brief Thread that writes the queued log lines to the log file.
+
+ Logging threads only format their line and queue it, so they never wait on each
+ other or on the disk. The writer is woken by the first line queued after its last
+ write, and writes everything queued by then with a single write.
+ */
+class CLogWriter : public CThread
+{
+public:
+  CLogWriter() : CThread("LogWriter") {}
+
+protected:
+  virtual void Process()
+  {
+    while (!m_bStop)
+    {
+      AbortableWait(m_queueEvent, 1000);
+      CLog::Flush();
+    }
+  }
+};
+
 CLog::CLog()
 {}
 
@@ -56,8 +96,22 @@ CLog::~CLog()
 
 void CLog::Close()
 {
-  
+  CLogWriter* writer;
+  {
+    CSingleLock waitLock(critSec);
+    writer = m_writer;
+    m_writer = NULL;
+  }
+
+  // the writer needs critSec to finish its last batch
+  if (writer)
+  {
+    writer->StopThread();
+    delete writer;
+  }
+
   CSingleLock waitLock(critSec);
+  WriteQueue();
   if (m_file)
   {
     fclose(m_file);
@@ -68,8 +122,6 @@ void CLog::Close()
 
 void CLog::Log(int loglevel, const char *format, ... )
 {
-  static const char* prefixFormat = "%02.2d:%02.2d:%02.2d T:%" PRIu64" %7s: ";
-  CSingleLock waitLock(critSec);
 #if !(defined(_DEBUG) || defined(PROFILE))
   if (m_logLevel > LOG_LEVEL_NORMAL ||
      (m_logLevel > LOG_LEVEL_NONE && loglevel >= LOGNOTICE))
@@ -78,10 +130,7 @@ void CLog::Log(int loglevel, const char *format, ... )
     if (!m_file)
       return;
 
-    SYSTEMTIME time;
-    GetLocalTime(&time);
-
-    CStdString strPrefix, strData;
+    CStdString strData;
 
     strData.reserve(16384);
     va_list va;
@@ -100,26 +149,6 @@ void CLog::Log(int loglevel, const char *format, ... )
     }
     /* END PLEX */
 
-    if (m_repeatLogLevel == loglevel && m_repeatLine == strData)
-    {
-      m_repeatCount++;
-      return;
-    }
-    else if (m_repeatCount)
-    {
-      CStdString strData2;
-      strPrefix.Format(prefixFormat, time.wHour, time.wMinute, time.wSecond, (uint64_t)CThread::GetCurrentThreadId(), levelNames[m_repeatLogLevel]);
-
-      strData2.Format("Previous line repeats %d times." LINE_ENDING, m_repeatCount);
-      fputs(strPrefix.c_str(), m_file);
-      fputs(strData2.c_str(), m_file);
-      OutputDebugString(strData2);
-      m_repeatCount = 0;
-    }
-    
-    m_repeatLine      = strData;
-    m_repeatLogLevel  = loglevel;
-
     unsigned int length = 0;
     while ( length != strData.length() )
     {
@@ -130,30 +159,173 @@ void CLog::Log(int loglevel, const char *format, ... )
     }
 
     if (!length) return;
-    
-    OutputDebugString(strData);
 
     /* fixup newline alignment, number of spaces should equal prefix length */
     strData.Replace("\n", LINE_ENDING"                                            ");
-    strData += LINE_ENDING;
 
-    strPrefix.Format(prefixFormat, time.wHour, time.wMinute, time.wSecond, (uint64_t)CThread::GetCurrentThreadId(), levelNames[loglevel]);
+    Queue(loglevel, strData);
+
+    // nothing to wait for when there's no writer, and fatal errors must hit the disk before we go down
+    if (!m_writer || loglevel >= LOGFATAL)
+      Flush();
+  }
+}
+
+void CLog::Queue(int loglevel, const std::string& line)
+{
+  long size = line.size();
+  if (AtomicAdd(&m_queuedBytes, size) > CLogGlobals::QUEUE_MAX_BYTES)
+  {
+    AtomicAdd(&m_queuedBytes, -size);
+    AtomicIncrement(&m_dropped);
+    return;
+  }
+
+  // claim a position, the slot for it is free once the writer moved past it a lap earlier
+  LogEntry* entry;
+  long pos = AtomicLoad(&m_queueHead);
+  for (;;)
+  {
+    entry = &m_queue[pos & (CLogGlobals::QUEUE_SIZE - 1)];
+    long diff = AtomicLoad(&entry->sequence) - pos;
+    if (diff == 0)
+    {
+      long prev = cas(&m_queueHead, pos, pos + 1);
+      if (prev == pos)
+        break;
+      pos = prev;
+    }
+    else if (diff < 0)
+    {
+      // full
+      AtomicAdd(&m_queuedBytes, -size);
+      AtomicIncrement(&m_dropped);
+      return;
+    }
+    else
+      pos = AtomicLoad(&m_queueHead);
+  }
+
+  SYSTEMTIME time;
+  GetLocalTime(&time);
+  entry->level = loglevel;
+  entry->hour = (unsigned char)time.wHour;
+  entry->minute = (unsigned char)time.wMinute;
+  entry->second = (unsigned char)time.wSecond;
+  entry->threadId = (uint64_t)CThread::GetCurrentThreadId();
+  entry->line.assign(line);  // copied rather than swapped, so the slot doesn't keep our 16k buffer
+
+  // publish the slot, then wake the writer unless a wakeup is already on its way
+  AtomicIncrement(&entry->sequence);
+  if (cas(&m_wakePending, 0, 1) == 0)
+    m_queueEvent.Set();
+}
+
+void CLog::Flush(bool wait)
+{
+  if (!wait)
+  {
+    CSingleTryLock waitLock(critSec);
+    if (waitLock.IsOwner())
+      WriteQueue();
+    return;
+  }
+
+  CSingleLock waitLock(critSec);
+  WriteQueue();
+}
+
+void CLog::WriteQueue()
+{
+  // lines queued from here on wake the writer again
+  cas(&m_wakePending, 1, 0);
+
+  std::string buffer;
+  CStdString strPrefix;
+  for (;;)
+  {
+    LogEntry& entry = m_queue[m_queueTail & (CLogGlobals::QUEUE_SIZE - 1)];
+    if (AtomicLoad(&entry.sequence) != m_queueTail + 1)
+      break;
+
+    std::string line;
+    line.swap(entry.line);
+    int loglevel = entry.level;
+    unsigned char hour = entry.hour, minute = entry.minute, second = entry.second;
+    uint64_t threadId = entry.threadId;
+
+    // hand the slot back for the next lap
+    AtomicAdd(&entry.sequence, CLogGlobals::QUEUE_SIZE - 1);
+    AtomicAdd(&m_queuedBytes, -(long)line.size());
+    m_queueTail++;
+
+    if (m_repeatLogLevel == loglevel && m_repeatLine == line)
+    {
+      m_repeatCount++;
+      continue;
+    }
+    else if (m_repeatCount)
+    {
+      CStdString strData2;
+      strPrefix.Format(prefixFormat, hour, minute, second, threadId, levelNames[m_repeatLogLevel]);
+      strData2.Format("Previous line repeats %d times." LINE_ENDING, m_repeatCount);
+      buffer += strPrefix;
+      buffer += strData2;
+      OutputDebugString(strData2);
+      m_repeatCount = 0;
+    }
+
+    m_repeatLine      = line;
+    m_repeatLogLevel  = loglevel;
+
+    OutputDebugString(line);
+
+    strPrefix.Format(prefixFormat, hour, minute, second, threadId, levelNames[loglevel]);
+    line.insert(0, strPrefix);
+    line += LINE_ENDING;
 
 //print to adb
 #if defined(TARGET_ANDROID) && defined(_DEBUG)
-  CXBMCApp::android_printf("%s%s",strPrefix.c_str(), strData.c_str());
+  CXBMCApp::android_printf("%s", line.c_str());
 #endif
 
     /* PLEX */
-    g_plexApplication.sendNetworkLog(loglevel, strPrefix + strData);
+    g_plexApplication.sendNetworkLog(loglevel, line);
     /* END PLEX */
 
-    fputs(strPrefix.c_str(), m_file);
-    fputs(strData.c_str(), m_file);
+    buffer += line;
+  }
+
+  long dropped = AtomicLoad(&m_dropped);
+  while (dropped && cas(&m_dropped, dropped, 0) != dropped)
+    dropped = AtomicLoad(&m_dropped);
+  if (dropped)
+  {
+    SYSTEMTIME time;
+    GetLocalTime(&time);
+    CStdString strData;
+    strPrefix.Format(prefixFormat, time.wHour, time.wMinute, time.wSecond, (uint64_t)CThread::GetCurrentThreadId(), levelNames[LOGWARNING]);
+    strData.Format("%ld lines dropped, the log queue was full." LINE_ENDING, dropped);
+    buffer += strPrefix;
+    buffer += strData;
+  }
+
+  if (!buffer.empty() && m_file)
+  {
+    fwrite(buffer.c_str(), buffer.size(), 1, m_file);
     fflush(m_file);
   }
 }
 
+void CLog::StartWriter()
+{
+  if (!m_writer)
+  {
+    m_writer = new CLogWriter;
+    m_writer->Create();
+  }
+}
+
 /* PLEX */
 bool CLog::InitStdErr()
 {
@@ -162,6 +334,7 @@ bool CLog::InitStdErr()
   {
     m_file = stderr;
   }
+  StartWriter();
   
   return m_file != NULL;
 }
@@ -206,6 +379,7 @@ bool CLog::Init(const char* path)
   {
     unsigned char BOM[3] = {0xEF, 0xBB, 0xBF};
     fwrite(BOM, sizeof(BOM), 1, m_file);
+    StartWriter();
   }
 
   return m_file != NULL;
@@ -21,10 +21,12 @@
  */
 
 #include <stdio.h>
+#include <stdint.h>
 #include <string>
 
 #include "commons/ilog.h"
 #include "threads/CriticalSection.h"
+#include "threads/Event.h"
 #include "utils/GlobalsHandling.h"
 
 #ifdef __GNUC__
@@ -33,20 +35,52 @@
 #define ATTRIB_LOG_FORMAT
 #endif
 
+class CLogWriter;
+
 class CLog
 {
 public:
 
+  /*! \brief A formatted line waiting in the log queue for the writer thread */
+  struct LogEntry
+  {
+    volatile long sequence;    // slot is free for position == sequence, readable when position + 1 == sequence
+    int           level;
+    unsigned char hour;
+    unsigned char minute;
+    unsigned char second;
+    uint64_t      threadId;
+    std::string   line;
+  };
+
   class CLogGlobals
   {
   public:
-    CLogGlobals() : m_file(NULL), m_repeatCount(0), m_repeatLogLevel(-1), m_logLevel(LOG_LEVEL_DEBUG) {}
+    enum { QUEUE_SIZE = 4096, QUEUE_MAX_BYTES = 8 * 1024 * 1024 };
+
+    CLogGlobals() : m_file(NULL), m_repeatCount(0), m_repeatLogLevel(-1), m_logLevel(LOG_LEVEL_DEBUG),
+                    m_queueHead(0), m_queueTail(0), m_queuedBytes(0), m_dropped(0), m_wakePending(0), m_writer(NULL)
+    {
+      for (long i = 0; i < QUEUE_SIZE; i++)
+        m_queue[i].sequence = i;
+    }
     FILE*       m_file;
     int         m_repeatCount;
     int         m_repeatLogLevel;
     std::string m_repeatLine;
     int         m_logLevel;
-    CCriticalSection critSec;
+    CCriticalSection critSec;  // owned by whoever writes to m_file
+
+    /* Lines are queued lock free by the logging threads and written in batches by the
+       writer thread. The queue is bounded, lines that don't fit are counted and dropped. */
+    LogEntry      m_queue[QUEUE_SIZE];
+    volatile long m_queueHead;   // next position to fill, claimed by the logging threads
+    long          m_queueTail;   // next position to write, only used under critSec
+    volatile long m_queuedBytes;
+    volatile long m_dropped;
+    volatile long m_wakePending;
+    CEvent        m_queueEvent;
+    CLogWriter*   m_writer;
   };
 
   CLog();
@@ -55,6 +89,11 @@ public:
   static void Log(int loglevel, const char *format, ... ) ATTRIB_LOG_FORMAT;
   static void MemDump(char *pData, int length);
   static bool Init(const char* path);
+
+  /*! \brief Write out all queued lines before returning
+   \param wait false to give up if another thread is writing, eg. from a crash handler
+   */
+  static void Flush(bool wait = true);
   static void SetLogLevel(int level);
   static int  GetLogLevel();
 
@@ -63,6 +102,9 @@ public:
   static void FatalError(const char* format, ...);
   /* END PLEX */
 private:
+  static void Queue(int loglevel, const std::string& line);
+  static void WriteQueue();
+  static void StartWriter();
   static void OutputDebugString(const std::string& line);
 };
 
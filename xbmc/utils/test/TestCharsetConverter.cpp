@@ -20,9 +20,13 @@
 
 #include "settings/GUISettings.h"
 #include "utils/CharsetConverter.h"
+#include "threads/Thread.h"
+#include "threads/SystemClock.h"
 
 #include "gtest/gtest.h"
 
+#include <stdio.h>
+
 static const uint16_t refutf16LE1[] = { 0xff54, 0xff45, 0xff53, 0xff54,
                                         0xff3f, 0xff55, 0xff54, 0xff46,
                                         0xff11, 0xff16, 0xff2c, 0xff25,
@@ -122,6 +126,94 @@ TEST_F(TestCharsetConverter, utf8ToW)
   EXPECT_STREQ(refstrw1.c_str(), varstrw1.c_str());
 }
 
+TEST_F(TestCharsetConverter, utf8ToW_fastPaths)
+{
+  /* Well formed UTF-8, converted without iconv */
+  refstra1 = "caf\xC3\xA9 \xEF\xBC\x91 \xF0\x9F\x90\xAD";
+  varstrw1.clear();
+  g_charsetConverter.utf8ToW(refstra1, varstrw1, false);
+  ASSERT_EQ(sizeof(wchar_t) == 2 ? 9 : 8, varstrw1.size());
+  EXPECT_EQ(0xE9, varstrw1[3]);
+  EXPECT_EQ(0xFF11, varstrw1[5]);
+  varstra1.clear();
+  g_charsetConverter.wToUTF8(varstrw1, varstra1);
+  EXPECT_STREQ(refstra1.c_str(), varstra1.c_str());
+
+  /* Flipping text without right to left characters only drops the line breaks */
+  bool flipped = true;
+  refstra1 = "Season 1\nEpisode 2";
+  g_charsetConverter.utf8ToW(refstra1, varstrw1, true, false, &flipped);
+  EXPECT_STREQ(L"Season 1Episode 2", varstrw1.c_str());
+  EXPECT_FALSE(flipped);
+
+  /* Boundary neutrals are dropped when flipping, as fribidi does, and kept otherwise */
+  refstra1 = "soft\xC2\xADhyphen zero\xE2\x80\x8Bwidth";
+  g_charsetConverter.utf8ToW(refstra1, varstrw1, true);
+  EXPECT_STREQ(L"softhyphen zerowidth", varstrw1.c_str());
+  g_charsetConverter.utf8ToW(refstra1, varstrw1, false);
+  EXPECT_STREQ(L"soft\x00ADhyphen zero\x200Bwidth", varstrw1.c_str());
+
+  refstra1 = "bell\x07";
+  g_charsetConverter.utf8ToW(refstra1, varstrw1, true);
+  EXPECT_STREQ(L"bell", varstrw1.c_str());
+
+  /* Invalid bytes are still skipped by iconv */
+  refstra1 = "a\xFF" "b";
+  g_charsetConverter.utf8ToW(refstra1, varstrw1, false);
+  EXPECT_STREQ(L"ab", varstrw1.c_str());
+}
+
+class TestCharsetConverterThread : public CThread
+{
+public:
+  TestCharsetConverterThread(unsigned int count) : CThread("TestCharsetConverter"), m_count(count), m_failures(0) {}
+
+  unsigned int m_count;
+  unsigned int m_failures;
+
+protected:
+  virtual void Process()
+  {
+    static const char* labels[] = { "Season 1", "Breaking Bad", "Am\xC3\xA9lie", "\xE5\x8D\x83\xE3\x81\xA8\xE5\x8D\x83\xE5\xB0\x8B" };
+    CStdStringW wide;
+    CStdStringA utf8;
+    for (unsigned int i = 0; i < m_count; i++)
+    {
+      const char* label = labels[i % 4];
+      g_charsetConverter.utf8ToW(label, wide, (i & 4) != 0);
+      g_charsetConverter.wToUTF8(wide, utf8);
+      if (utf8 != label)
+        m_failures++;
+    }
+  }
+};
+
+TEST_F(TestCharsetConverter, Throughput)
+{
+  static const unsigned int totalConversions = 400000;
+
+  for (unsigned int threads = 1; threads <= 8; threads *= 8)
+  {
+    std::vector<TestCharsetConverterThread*> workers;
+    unsigned int start = XbmcThreads::SystemClockMillis();
+
+    for (unsigned int i = 0; i < threads; i++)
+    {
+      workers.push_back(new TestCharsetConverterThread(totalConversions / threads));
+      workers.back()->Create();
+    }
+    for (unsigned int i = 0; i < threads; i++)
+    {
+      workers[i]->StopThread();
+      EXPECT_EQ(0, workers[i]->m_failures);
+      delete workers[i];
+    }
+
+    unsigned int elapsed = XbmcThreads::SystemClockMillis() - start;
+    printf("%u threads: %u conversions in %u ms\n", threads, totalConversions, elapsed);
+  }
+}
+
 TEST_F(TestCharsetConverter, utf16LEtoW)
 {
   refstrw1 = L"ｔｅｓｔ＿ｕｔｆ１６ＬＥｔｏｗ";
@@ -21,9 +21,14 @@
 #include "utils/JobManager.h"
 #include "settings/GUISettings.h"
 #include "utils/SystemInfo.h"
+#include "threads/Atomics.h"
+#include "threads/Event.h"
+#include "threads/SystemClock.h"
 
 #include "gtest/gtest.h"
 
+#include <stdio.h>
+
 /* CSysInfoJob::GetInternetState() will test for network connectivity. */
 class TestJobManager : public testing::Test
 {
@@ -50,6 +55,71 @@ protected:
   }
 };
 
+class TestJobManagerTrivialJob : public CJob
+{
+public:
+  virtual bool DoWork() { return true; }
+};
+
+class TestJobManagerCounter : public IJobCallback
+{
+public:
+  TestJobManagerCounter(long expected) : m_completed(0), m_expected(expected) {}
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job)
+  {
+    if (AtomicIncrement(&m_completed) == m_expected)
+      m_done.Set();
+  }
+  volatile long m_completed;
+  long m_expected;
+  CEvent m_done;
+};
+
+class TestJobManagerProducer : public CThread
+{
+public:
+  TestJobManagerProducer(IJobCallback *callback, unsigned int jobs)
+    : CThread("TestJobManagerProducer"), m_callback(callback), m_jobs(jobs) {}
+  virtual void Process()
+  {
+    for (unsigned int i = 0; i < m_jobs; i++)
+      CJobManager::GetInstance().AddJob(new TestJobManagerTrivialJob, m_callback);
+  }
+private:
+  IJobCallback *m_callback;
+  unsigned int m_jobs;
+};
+
+/* Runs before the tests below, as CancelJobs() stops the job manager for good. */
+TEST_F(TestJobManager, Throughput)
+{
+  static const unsigned int totalJobs = 100000;
+
+  for (unsigned int producers = 1; producers <= 8; producers *= 2)
+  {
+    TestJobManagerCounter counter(totalJobs);
+    std::vector<TestJobManagerProducer*> threads;
+    unsigned int start = XbmcThreads::SystemClockMillis();
+
+    for (unsigned int i = 0; i < producers; i++)
+    {
+      threads.push_back(new TestJobManagerProducer(&counter, totalJobs / producers));
+      threads.back()->Create();
+    }
+    for (unsigned int i = 0; i < producers; i++)
+    {
+      threads[i]->StopThread();
+      delete threads[i];
+    }
+
+    counter.m_done.WaitMSec(60000);
+    unsigned int elapsed = XbmcThreads::SystemClockMillis() - start;
+
+    EXPECT_EQ((long)totalJobs, counter.m_completed);
+    printf("%u producers: %u jobs in %u ms\n", producers, totalJobs, elapsed);
+  }
+}
+
 TEST_F(TestJobManager, AddJob)
 {
   CJob* job = new CSysInfoJob();
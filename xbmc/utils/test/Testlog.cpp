@@ -22,6 +22,7 @@
 #include "utils/RegExp.h"
 #include "filesystem/File.h"
 #include "filesystem/SpecialProtocol.h"
+#include "threads/Thread.h"
 
 #include "test/TestUtils.h"
 
@@ -131,6 +132,65 @@ TEST_F(Testlog, MemDump)
   EXPECT_TRUE(XFILE::CFile::Delete(logfile));
 }
 
+class TestlogRunnable : public IRunnable
+{
+public:
+  int id;
+  void Run()
+  {
+    for (int i = 0; i < 500; i++)
+      CLog::Log(LOGDEBUG, "thread %d line %d", id, i);
+  }
+};
+
+TEST_F(Testlog, Threads)
+{
+  CStdString logfile, logstring;
+  char buf[100];
+  unsigned int bytesread;
+  XFILE::CFile file;
+
+  logfile = CSpecialProtocol::TranslatePath("special://temp/") + "xbmc.log";
+  EXPECT_TRUE(CLog::Init(CSpecialProtocol::TranslatePath("special://temp/")));
+
+  TestlogRunnable runnables[4];
+  CThread* threads[4];
+  for (int i = 0; i < 4; i++)
+  {
+    runnables[i].id = i;
+    threads[i] = new CThread(&runnables[i], "TestlogThread");
+    threads[i]->Create();
+  }
+  for (int i = 0; i < 4; i++)
+  {
+    threads[i]->StopThread();
+    delete threads[i];
+  }
+
+  /* Close has to write out everything still queued */
+  CLog::Close();
+
+  EXPECT_TRUE(file.Open(logfile));
+  while ((bytesread = file.Read(buf, sizeof(buf) - 1)) > 0)
+  {
+    buf[bytesread] = '\0';
+    logstring.append(buf);
+  }
+  file.Close();
+
+  for (int i = 0; i < 4; i++)
+  {
+    CStdString line;
+    line.Format("DEBUG: thread %d line 0", i);
+    EXPECT_NE(std::string::npos, logstring.find(line));
+    line.Format("DEBUG: thread %d line 499", i);
+    EXPECT_NE(std::string::npos, logstring.find(line));
+  }
+  EXPECT_EQ(std::string::npos, logstring.find("dropped"));
+
+  EXPECT_TRUE(XFILE::CFile::Delete(logfile));
+}
+
 TEST_F(Testlog, SetLogLevel)
 {
   CStdString logfile;
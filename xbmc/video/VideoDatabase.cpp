@@ -477,12 +477,15 @@ int CVideoDatabase::GetPathId(const CStdString& strPath)
 
     URIUtils::AddSlashAtEnd(strPath1);
 
-    strSQL=PrepareSQL("select idPath from path where strPath='%s'",strPath1.c_str());
-    m_pDS->query(strSQL.c_str());
-    if (!m_pDS->eof())
-      idPath = m_pDS->fv("path.idPath").get_asInt();
+    /* PLEX */
+    // looked up for every file listed and scanned, so use a cached statement rather than a dataset
+    strSQL = "select idPath from path where strPath=?";
+    std::auto_ptr<dbiplus::Cursor> cursor(m_pDB->CreateCursor(strSQL));
+    cursor->bind(1, strPath1);
+    if (cursor->step())
+      idPath = cursor->getInt(0);
+    /* END PLEX */
 
-    m_pDS->close();
     return idPath;
   }
   catch (...)
@@ -919,15 +922,13 @@ int CVideoDatabase::GetFileId(const CStdString& strFilenameAndPath)
     int idPath = GetPathId(strPath);
     if (idPath >= 0)
     {
-      CStdString strSQL;
-      strSQL=PrepareSQL("select idFile from files where strFileName='%s' and idPath=%i", strFileName.c_str(),idPath);
-      m_pDS->query(strSQL.c_str());
-      if (m_pDS->num_rows() > 0)
-      {
-        int idFile = m_pDS->fv("files.idFile").get_asInt();
-        m_pDS->close();
-        return idFile;
-      }
+      /* PLEX */
+      std::auto_ptr<dbiplus::Cursor> cursor(m_pDB->CreateCursor("select idFile from files where strFileName=? and idPath=?"));
+      cursor->bind(1, strFileName);
+      cursor->bind(2, idPath);
+      if (cursor->step())
+        return cursor->getInt(0);
+      /* END PLEX */
     }
   }
   catch (...)
@@ -5859,29 +5860,18 @@ bool CVideoDatabase::GetMoviesByWhere(const CStdString& strBaseDir, const Filter
 
     strSQL = PrepareSQL(strSQL, !extFilter.fields.empty() ? extFilter.fields.c_str() : "*") + strSQLExtra;
 
-    int iRowsFound = RunQuery(strSQL);
-    if (iRowsFound <= 0)
-      return iRowsFound == 0;
-
-    // store the total value of items as a property
-    if (total < iRowsFound)
-      total = iRowsFound;
-    items.SetProperty("total", total);
-    
-    DatabaseResults results;
-    results.reserve(iRowsFound);
-
-    if (!SortUtils::SortFromDataset(sortDescription, MediaTypeMovie, m_pDS, results))
+    /* PLEX */
+    // unsorted listings are streamed, only the current row is held
+    CDatabaseRows rows(m_pDB.get(), m_pDS);
+    if (!rows.Open(strSQL, sortDescription, MediaTypeMovie))
       return false;
 
     // get data from returned rows
-    items.Reserve(results.size());
-    const query_data &data = m_pDS->get_result_set().records;
-    for (DatabaseResults::const_iterator it = results.begin(); it != results.end(); it++)
+    if (!rows.IsStreaming())
+      items.Reserve(rows.GetRows());
+    const dbiplus::sql_record *record;
+    while ((record = rows.Next()) != NULL)
     {
-      unsigned int targetRow = (unsigned int)it->at(FieldRow).asInteger();
-      const dbiplus::sql_record* const record = data.at(targetRow);
-
       CVideoInfoTag movie = GetDetailsForMovie(record);
       if (g_settings.GetMasterProfile().getLockMode() == LOCK_MODE_EVERYONE ||
           g_passwordManager.bMasterUser                                   ||
@@ -5899,8 +5889,14 @@ bool CVideoDatabase::GetMoviesByWhere(const CStdString& strBaseDir, const Filter
       }
     }
 
-    // cleanup
-    m_pDS->close();
+    if (rows.GetRows() == 0)
+      return true;
+
+    // store the total value of items as a property
+    if (total < (int)rows.GetRows())
+      total = rows.GetRows();
+    items.SetProperty("total", total);
+    /* END PLEX */
     return true;
   }
   catch (...)
@@ -6284,30 +6280,20 @@ bool CVideoDatabase::GetEpisodesByWhere(const CStdString& strBaseDir, const Filt
 
     strSQL = PrepareSQL(strSQL, !extFilter.fields.empty() ? extFilter.fields.c_str() : "*") + strSQLExtra;
 
-    int iRowsFound = RunQuery(strSQL);
-    if (iRowsFound <= 0)
-      return iRowsFound == 0;
-
-    // store the total value of items as a property
-    if (total < iRowsFound)
-      total = iRowsFound;
-    items.SetProperty("total", total);
-    
-    DatabaseResults results;
-    results.reserve(iRowsFound);
-    if (!SortUtils::SortFromDataset(sorting, MediaTypeEpisode, m_pDS, results))
+    /* PLEX */
+    // unsorted listings are streamed, only the current row is held
+    CDatabaseRows rows(m_pDB.get(), m_pDS);
+    if (!rows.Open(strSQL, sorting, MediaTypeEpisode))
       return false;
-    
+
     // get data from returned rows
-    items.Reserve(results.size());
+    if (!rows.IsStreaming())
+      items.Reserve(rows.GetRows());
     CLabelFormatter formatter("%H. %T", "");
 
-    const query_data &data = m_pDS->get_result_set().records;
-    for (DatabaseResults::const_iterator it = results.begin(); it != results.end(); it++)
+    const dbiplus::sql_record *record;
+    while ((record = rows.Next()) != NULL)
     {
-      unsigned int targetRow = (unsigned int)it->at(FieldRow).asInteger();
-      const dbiplus::sql_record* const record = data.at(targetRow);
-
       CVideoInfoTag movie = GetDetailsForEpisode(record);
       if (g_settings.GetMasterProfile().getLockMode() == LOCK_MODE_EVERYONE ||
           g_passwordManager.bMasterUser                                     ||
@@ -6334,8 +6320,14 @@ bool CVideoDatabase::GetEpisodesByWhere(const CStdString& strBaseDir, const Filt
       }
     }
 
-    // cleanup
-    m_pDS->close();
+    if (rows.GetRows() == 0)
+      return true;
+
+    // store the total value of items as a property
+    if (total < (int)rows.GetRows())
+      total = rows.GetRows();
+    items.SetProperty("total", total);
+    /* END PLEX */
     return true;
   }
   catch (...)
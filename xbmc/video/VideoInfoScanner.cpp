@@ -19,6 +19,7 @@
  */
 
 #include "threads/SystemClock.h"
+#include "threads/Atomics.h"
 #include "FileItem.h"
 #include "VideoInfoScanner.h"
 #include "addons/AddonManager.h"
@@ -57,8 +58,71 @@ using namespace ADDON;
 
 namespace VIDEO
 {
+  // folder listings and item lookups are network bound, so these are sized for shares rather than cores
+  static const unsigned int LISTING_JOBS = 4;
+  static const unsigned int LOOKUP_JOBS = 4;
 
-  CVideoInfoScanner::CVideoInfoScanner() : CThread("CVideoInfoScanner")
+  // subfolders listed ahead of the one being scanned
+  static const size_t LISTING_LOOKAHEAD = 8;
+
+  // lookups queued ahead of the items being written
+  static const size_t LOOKUP_LOOKAHEAD = 32;
+
+  // writes and milliseconds after which the scan's transaction is committed
+  static const unsigned int BATCH_WRITES = 100;
+  static const unsigned int BATCH_TIME = 1000;
+
+  // how often a wait on the job manager checks whether the scan was stopped, in ms
+  static const unsigned int JOB_WAIT_INTERVAL = 100;
+
+  class CVideoScanListingJob : public CJob
+  {
+  public:
+    CVideoScanListingJob(CVideoInfoScanner *scanner, const ScanListingPtr &listing)
+      : m_scanner(scanner), m_listing(listing)
+    {
+    }
+
+    virtual const char *GetType() const { return "videoscanlisting"; }
+
+    virtual bool DoWork()
+    {
+      m_scanner->ListFolder(*m_listing);
+      m_listing->done.Set();
+      return true;
+    }
+
+  private:
+    CVideoInfoScanner *m_scanner;
+    ScanListingPtr m_listing;
+  };
+
+  class CVideoScanLookupJob : public CJob
+  {
+  public:
+    CVideoScanLookupJob(CVideoInfoScanner *scanner, const ScanLookupPtr &lookup)
+      : m_scanner(scanner), m_lookup(lookup)
+    {
+    }
+
+    virtual const char *GetType() const { return "videoscanlookup"; }
+
+    virtual bool DoWork()
+    {
+      m_scanner->LookupItem(*m_lookup);
+      m_lookup->done.Set();
+      return true;
+    }
+
+  private:
+    CVideoInfoScanner *m_scanner;
+    ScanLookupPtr m_lookup;
+  };
+
+  CVideoInfoScanner::CVideoInfoScanner() : CThread("CVideoInfoScanner"),
+    m_listingQueue(false, LISTING_JOBS, CJob::PRIORITY_LOW),
+    m_lookupQueue(false, LOOKUP_JOBS, CJob::PRIORITY_LOW),
+    m_batch(m_database, BATCH_WRITES, BATCH_TIME)
   {
     m_bRunning = false;
     m_handle = NULL;
@@ -68,6 +132,8 @@ namespace VIDEO
     m_itemCount = 0;
     m_bClean = false;
     m_scanAll = false;
+    m_queuedLookups = 0;
+    m_fastHashSkips = 0;
   }
 
   CVideoInfoScanner::~CVideoInfoScanner()
@@ -82,6 +148,12 @@ namespace VIDEO
 
       m_database.Open();
 
+      m_listingStats = SScanStageStats();
+      m_lookupStats = SScanStageStats();
+      m_writeStats = SScanStageStats();
+      m_fastHashSkips = 0;
+      unsigned int commits = m_batch.GetCommits();
+
       if (m_showDialog && !g_guiSettings.GetBool("videolibrary.backgroundupdate"))
       {
         CGUIDialogExtendedProgressBar* dialog =
@@ -106,6 +178,9 @@ namespace VIDEO
       // result in unexpected behaviour.
       m_bCanInterrupt = false;
 
+      // commit the scan in batches rather than item by item
+      m_batch.Start();
+
       bool bCancelled = false;
       while (!bCancelled && m_pathsToScan.size())
       {
@@ -128,8 +203,22 @@ namespace VIDEO
         }
         else if (!DoScan(directory))
           bCancelled = true;
+
+        // write whatever is still being looked up
+        if (!bCancelled)
+        {
+          FinishFolders(0);
+          bCancelled = m_bStop;
+        }
       }
 
+      if (bCancelled)
+        CancelQueued();
+      m_listings.clear();
+
+      // cleaning and compressing can't run inside a transaction
+      m_batch.End();
+
       if (!bCancelled)
       {
         if (m_bClean)
@@ -146,10 +235,17 @@ namespace VIDEO
 
       tick = XbmcThreads::SystemClockMillis() - tick;
       CLog::Log(LOGNOTICE, "VideoInfoScanner: Finished scan. Scanning for video info took %s", StringUtils::SecondsToTimeString(tick / 1000).c_str());
+      CLog::Log(LOGNOTICE, "VideoInfoScanner: Listed %ld folders in %ld ms (%ld unchanged by fast hash), looked up %ld items in %ld ms, wrote %ld items in %ld ms with %ld commits",
+                m_listingStats.items, m_listingStats.time, m_fastHashSkips,
+                m_lookupStats.items, m_lookupStats.time,
+                m_writeStats.items, m_writeStats.time, m_batch.GetCommits() - commits);
     }
     catch (...)
     {
       CLog::Log(LOGERROR, "VideoInfoScanner: Exception while scanning.");
+      CancelQueued();
+      m_listings.clear();
+      m_batch.End();
     }
     
     m_bRunning = false;
@@ -264,19 +360,22 @@ namespace VIDEO
         m_handle->SetTitle(StringUtils::Format(g_localizeStrings.Get(str), info->Name().c_str()));
       }
 
-      CStdString fastHash = GetFastHash(strDirectory);
-      if (m_database.GetPathHash(strDirectory, dbHash) && !fastHash.IsEmpty() && fastHash == dbHash)
+      m_database.GetPathHash(strDirectory, dbHash);
+      ScanListingPtr listing = GetListing(strDirectory, dbHash);
+      if (!listing)
+        return false;
+      CStdString fastHash = listing->fastHash;
+      if (!listing->listed)
       { // fast hashes match - no need to process anything
         CLog::Log(LOGDEBUG, "VideoInfoScanner: Skipping dir '%s' due to no change (fasthash)", strDirectory.c_str());
         hash = fastHash;
         bSkip = true;
+        m_fastHashSkips++;
       }
       if (!bSkip)
-      { // need to fetch the folder
-        CDirectory::GetDirectory(strDirectory, items, g_settings.m_videoExtensions);
-        items.Stack();
-        // compute hash
-        GetPathHash(items, hash);
+      { // the folder has been fetched and hashed
+        items.Assign(listing->items);
+        hash = listing->hash;
         if (hash != dbHash && !hash.IsEmpty())
         {
           if (dbHash.IsEmpty())
@@ -307,6 +406,8 @@ namespace VIDEO
       if (m_handle)
         m_handle->SetTitle(StringUtils::Format(g_localizeStrings.Get(20319), info->Name().c_str()));
 
+      m_batch.Commit(true);
+
       if (foundDirectly && !settings.parent_name_root)
       {
         CDirectory::GetDirectory(strDirectory, items, g_settings.m_videoExtensions);
@@ -331,9 +432,18 @@ namespace VIDEO
       }
     }
 
-    if (!bSkip)
+    if (!bSkip && (content == CONTENT_MOVIES || content == CONTENT_MUSICVIDEOS) &&
+        QueueVideoInfo(items, strDirectory, hash, settings.parent_name_root))
+    { // written by FinishFolder() once looked up
+      FinishFolders(LOOKUP_LOOKAHEAD);
+    }
+    else if (!bSkip)
     {
-      if (RetrieveVideoInfo(items, settings.parent_name_root, content))
+      // looked up here in between the writes, so don't keep the database locked meanwhile
+      m_batch.End();
+      bool foundSomeInfo = RetrieveVideoInfo(items, settings.parent_name_root, content);
+      m_batch.Start();
+      if (foundSomeInfo)
       {
         if (!m_bStop && (content == CONTENT_MOVIES || content == CONTENT_MUSICVIDEOS))
         {
@@ -350,30 +460,319 @@ namespace VIDEO
     }
     else if (hash != dbHash && (content == CONTENT_MOVIES || content == CONTENT_MUSICVIDEOS))
     { // update the hash either way - we may have changed the hash to a fast version
+      m_batch.Open();
       m_database.SetPathHash(strDirectory, hash);
+      m_batch.Commit(false);
     }
 
     if (m_handle)
       OnDirectoryScanned(strDirectory);
 
+    // if we have a directory item (non-playlist) we then recurse into that folder
+    // do not recurse for tv shows - we have already looked recursively for episodes
+    vector<CStdString> folders;
     for (int i = 0; i < items.Size(); ++i)
     {
       CFileItemPtr pItem = items[i];
+      if (pItem->m_bIsFolder && !pItem->IsParentFolder() && !pItem->IsPlayList() && settings.recurse > 0 && content != CONTENT_TVSHOWS)
+        folders.push_back(pItem->GetPath());
+    }
 
+    for (size_t i = 0; i < folders.size(); ++i)
+    {
       if (m_bStop)
         break;
 
-      // if we have a directory item (non-playlist) we then recurse into that folder
-      // do not recurse for tv shows - we have already looked recursively for episodes
-      if (pItem->m_bIsFolder && !pItem->IsParentFolder() && !pItem->IsPlayList() && settings.recurse > 0 && content != CONTENT_TVSHOWS)
+      PrefetchListings(folders, i);
+      if (!DoScan(folders[i]))
       {
-        if (!DoScan(pItem->GetPath()))
+        m_bStop = true;
+      }
+    }
+
+    // drop the listings of subfolders that turned out not to be scanned
+    for (size_t i = 0; i < folders.size(); ++i)
+      m_listings.erase(folders[i]);
+
+    return !m_bStop;
+  }
+
+  void CVideoInfoScanner::PrefetchListings(const vector<CStdString> &folders, size_t first)
+  {
+    for (size_t i = first; i < folders.size() && i < first + LISTING_LOOKAHEAD; ++i)
+    {
+      if (m_listings.find(folders[i]) != m_listings.end() ||
+          CUtil::ExcludeFileOrFolder(folders[i], g_advancedSettings.m_moviesExcludeFromScanRegExps))
+        continue;
+
+      ScanListingPtr listing(new SScanListing);
+      listing->path = folders[i];
+      m_database.GetPathHash(folders[i], listing->dbHash);
+      m_listings[folders[i]] = listing;
+      m_listingQueue.AddJob(new CVideoScanListingJob(this, listing));
+    }
+  }
+
+  ScanListingPtr CVideoInfoScanner::GetListing(const CStdString &strDirectory, const CStdString &dbHash)
+  {
+    map<CStdString, ScanListingPtr>::iterator it = m_listings.find(strDirectory);
+    if (it != m_listings.end())
+    {
+      ScanListingPtr listing = it->second;
+      m_listings.erase(it);
+      if (!WaitForJob(listing->done))
+        return ScanListingPtr();
+      // a listing skipped on an out of date hash has to be done again
+      if (listing->listed || listing->dbHash == dbHash)
+        return listing;
+    }
+
+    m_batch.Commit(true);
+    ScanListingPtr listing(new SScanListing);
+    listing->path = strDirectory;
+    listing->dbHash = dbHash;
+    ListFolder(*listing);
+    return listing;
+  }
+
+  void CVideoInfoScanner::ListFolder(SScanListing &listing)
+  {
+    unsigned int start = XbmcThreads::SystemClockMillis();
+
+    listing.fastHash = GetFastHash(listing.path);
+    if (listing.fastHash.IsEmpty() || listing.fastHash != listing.dbHash)
+    { // need to fetch the folder
+      CDirectory::GetDirectory(listing.path, listing.items, g_settings.m_videoExtensions);
+      listing.items.Stack();
+      // compute hash
+      GetPathHash(listing.items, listing.hash);
+      listing.listed = true;
+    }
+
+    AtomicIncrement(&m_listingStats.items);
+    AtomicAdd(&m_listingStats.time, XbmcThreads::SystemClockMillis() - start);
+  }
+
+  bool CVideoInfoScanner::QueueVideoInfo(CFileItemList &items, const CStdString &strDirectory, const CStdString &hash, bool bDirNames)
+  {
+    // we do this since we may have a override per dir, and overrides to other content can't be queued
+    vector<ScraperPtr> scrapers;
+    for (int i = 0; i < items.Size(); ++i)
+    {
+      ScraperPtr info2 = m_database.GetScraperForPath(items[i]->m_bIsFolder ? items[i]->GetPath() : items.GetPath());
+      if (info2 && info2->Content() != CONTENT_MOVIES && info2->Content() != CONTENT_MUSICVIDEOS)
+        return false;
+      scrapers.push_back(info2);
+    }
+
+    SScanFolder folder;
+    folder.path = strDirectory;
+    folder.hash = hash;
+    folder.foundSomeInfo = false;
+    for (int i = 0; i < items.Size(); ++i)
+    {
+      CFileItemPtr pItem = items[i];
+      ScraperPtr info2 = scrapers[i];
+      if (!info2) // skip
+        continue;
+
+      // Discard all exclude files defined by regExExclude
+      if (CUtil::ExcludeFileOrFolder(pItem->GetPath(), g_advancedSettings.m_moviesExcludeFromScanRegExps))
+        continue;
+
+      if (pItem->m_bIsFolder || !pItem->IsVideo() || pItem->IsNFO() ||
+         (pItem->IsPlayList() && !URIUtils::GetExtension(pItem->GetPath()).Equals(".strm")))
+        continue;
+
+      if (info2->Content() == CONTENT_MOVIES ? m_database.HasMovieInfo(pItem->GetPath())
+                                             : m_database.HasMusicVideoInfo(pItem->GetPath()))
+      {
+        folder.foundSomeInfo = true;
+        continue;
+      }
+
+      // clear our scraper cache
+      info2->ClearCache();
+
+      ScanLookupPtr lookup(new SScanLookup);
+      lookup->item = pItem;
+      lookup->scraper = info2;
+      lookup->dirNames = bDirNames;
+      folder.lookups.push_back(lookup);
+      m_lookupQueue.AddJob(new CVideoScanLookupJob(this, lookup));
+    }
+
+    m_queuedLookups += folder.lookups.size();
+    m_queuedFolders.push_back(folder);
+    return true;
+  }
+
+  void CVideoInfoScanner::LookupItem(SScanLookup &lookup)
+  {
+    if (m_bStop)
+    {
+      lookup.result = INFO_CANCELLED;
+      return;
+    }
+
+    unsigned int start = XbmcThreads::SystemClockMillis();
+    CFileItem *pItem = lookup.item.get();
+    CONTENT_TYPE content = lookup.scraper->Content();
+    lookup.result = INFO_NOT_FOUND;
+
+    // handle .nfo files
+    CNfoFile nfoReader;
+    CScraperUrl scrUrl;
+    CNfoFile::NFOResult result = CheckForNFOFile(pItem, lookup.dirNames, lookup.scraper, scrUrl, nfoReader);
+    if (result == CNfoFile::FULL_NFO)
+    {
+      pItem->GetVideoInfoTag()->Reset();
+      nfoReader.GetDetails(*pItem->GetVideoInfoTag());
+      lookup.result = INFO_ADDED;
+    }
+    else
+    {
+      CScraperUrl url;
+      bool found = false;
+      if (result == CNfoFile::URL_NFO || result == CNfoFile::COMBINED_NFO)
+      {
+        url = scrUrl;
+        found = true;
+      }
+      else
+      { // as FindVideo(), but the scanner thread asks whether to go on after an error
+        MOVIELIST movielist;
+        CVideoInfoDownloader imdb(lookup.scraper);
+        int returncode = imdb.FindMovie(pItem->GetMovieName(lookup.dirNames), movielist);
+        if (returncode < 0)
+          lookup.result = INFO_CANCELLED;
+        else if (returncode == 0)
+          lookup.result = INFO_ERROR;
+        else if (movielist.size())
         {
-          m_bStop = true;
+          url = movielist[0];
+          found = true;
         }
       }
+
+      CVideoInfoTag movieDetails;
+      CVideoInfoDownloader imdb(lookup.scraper);
+      if (found && imdb.GetDetails(url, movieDetails))
+      {
+        if (result == CNfoFile::COMBINED_NFO)
+          nfoReader.GetDetails(movieDetails, NULL, true);
+        *pItem->GetVideoInfoTag() = movieDetails;
+        lookup.result = INFO_ADDED;
+      }
+    }
+
+    if (lookup.result == INFO_ADDED)
+      GetArtwork(pItem, content, lookup.dirNames, true);
+
+    AtomicIncrement(&m_lookupStats.items);
+    AtomicAdd(&m_lookupStats.time, XbmcThreads::SystemClockMillis() - start);
+  }
+
+  bool CVideoInfoScanner::WaitForJob(CEvent &done)
+  {
+    if (done.WaitMSec(0))
+      return true;
+
+    // don't keep the database locked while waiting on the network
+    m_batch.Commit(true);
+
+    // jobs dropped by CJobManager::CancelJobs() on exit never set it, so don't wait past Stop()
+    while (!done.WaitMSec(JOB_WAIT_INTERVAL))
+    {
+      if (m_bStop)
+        return false;
+    }
+    return true;
+  }
+
+  void CVideoInfoScanner::FinishFolder()
+  {
+    SScanFolder folder = m_queuedFolders.front();
+    m_queuedFolders.pop_front();
+    m_queuedLookups -= folder.lookups.size();
+
+    for (size_t i = 0; i < folder.lookups.size(); ++i)
+    {
+      SScanLookup &lookup = *folder.lookups[i];
+      if (!WaitForJob(lookup.done))
+      {
+        folder.foundSomeInfo = false;
+        break;
+      }
+
+      if (m_handle)
+      {
+        m_handle->SetText(lookup.item->GetMovieName(lookup.dirNames));
+        m_handle->SetPercentage(i*100.f/folder.lookups.size());
+      }
+
+      INFO_RET ret = lookup.result;
+      if (ret == INFO_ERROR)
+      { // we had an error, see whether the user wants to cancel the scan
+        if (m_bStop || !DownloadFailed(NULL))
+          ret = INFO_CANCELLED;
+        else
+          ret = INFO_NOT_FOUND;
+      }
+
+      if (ret == INFO_CANCELLED)
+        m_bStop = true;
+      else if (ret == INFO_ADDED && AddVideoToDatabase(lookup.item.get(), lookup.scraper->Content(), lookup.dirNames, true, NULL, false) < 0)
+        ret = INFO_ERROR;
+
+      if (ret == INFO_CANCELLED || ret == INFO_ERROR)
+      {
+        folder.foundSomeInfo = false;
+        break;
+      }
+      if (ret == INFO_ADDED)
+        folder.foundSomeInfo = true;
+      else if (ret == INFO_NOT_FOUND)
+        CLog::Log(LOGWARNING, "No information found for item '%s', it won't be added to the library.", lookup.item->GetPath().c_str());
+    }
+
+    g_infoManager.ResetLibraryBools();
+
+    m_batch.Open();
+    if (folder.foundSomeInfo)
+    {
+      if (!m_bStop)
+      {
+        m_database.SetPathHash(folder.path, folder.hash);
+        m_pathsToClean.insert(m_database.GetPathId(folder.path));
+        CLog::Log(LOGDEBUG, "VideoInfoScanner: Finished adding information from dir %s", folder.path.c_str());
+      }
+    }
+    else
+    {
+      m_pathsToClean.insert(m_database.GetPathId(folder.path));
+      CLog::Log(LOGDEBUG, "VideoInfoScanner: No (new) information was found in dir %s", folder.path.c_str());
     }
-    return !m_bStop;
+  }
+
+  void CVideoInfoScanner::FinishFolders(size_t maxLookups)
+  {
+    while (!m_bStop && !m_queuedFolders.empty() &&
+           (m_queuedLookups > maxLookups || m_queuedFolders.front().lookups.empty()))
+    {
+      FinishFolder();
+      m_batch.Commit(false);
+    }
+  }
+
+  void CVideoInfoScanner::CancelQueued()
+  {
+    // jobs already running finish on their own, as they hold on to what they work on
+    m_listingQueue.CancelJobs();
+    m_lookupQueue.CancelJobs();
+    m_listings.clear();
+    m_queuedFolders.clear();
+    m_queuedLookups = 0;
   }
 
   bool CVideoInfoScanner::RetrieveVideoInfo(CFileItemList& items, bool bDirNames, CONTENT_TYPE content, bool useLocal, CScraperUrl* pURL, bool fetchEpisodes, CGUIDialogProgress* pDlgProgress)
@@ -1052,6 +1451,17 @@ namespace VIDEO
     if (!libraryImport)
       GetArtwork(pItem, content, videoFolder, useLocal, showInfo ? showInfo->m_strPath : "");
 
+    long lResult = AddVideoToDatabase(pItem, content, videoFolder, useLocal, showInfo, libraryImport);
+
+    m_database.Close();
+    return lResult;
+  }
+
+  long CVideoInfoScanner::AddVideoToDatabase(CFileItem *pItem, const CONTENT_TYPE &content, bool videoFolder, bool useLocal, const CVideoInfoTag *showInfo, bool libraryImport)
+  {
+    unsigned int start = XbmcThreads::SystemClockMillis();
+    m_batch.Open();
+
     // ensure the art map isn't completely empty by specifying an empty thumb
     map<string, string> art = pItem->GetArt();
     if (art.empty())
@@ -1150,7 +1560,11 @@ namespace VIDEO
         movieDetails.m_resumePoint.IsSet())
       m_database.AddBookMarkToFile(pItem->GetPath(), movieDetails.m_resumePoint, CBookmark::RESUME);
 
-    m_database.Close();
+    m_batch.AddWrites();
+    m_batch.Commit(false);
+
+    m_writeStats.items++;
+    m_writeStats.time += XbmcThreads::SystemClockMillis() - start;
 
     CFileItemPtr itemCopy = CFileItemPtr(new CFileItem(*pItem));
     ANNOUNCEMENT::CAnnouncementManager::Announce(ANNOUNCEMENT::VideoLibrary, "xbmc", "OnUpdate", itemCopy);
@@ -1803,6 +2217,11 @@ namespace VIDEO
   }
 
   CNfoFile::NFOResult CVideoInfoScanner::CheckForNFOFile(CFileItem* pItem, bool bGrabAny, ScraperPtr& info, CScraperUrl& scrUrl)
+  {
+    return CheckForNFOFile(pItem, bGrabAny, info, scrUrl, m_nfoReader);
+  }
+
+  CNfoFile::NFOResult CVideoInfoScanner::CheckForNFOFile(CFileItem* pItem, bool bGrabAny, ScraperPtr& info, CScraperUrl& scrUrl, CNfoFile& nfoReader) const
   {
     CStdString strNfoFile;
     if (info->Content() == CONTENT_MOVIES || info->Content() == CONTENT_MUSICVIDEOS
@@ -1815,9 +2234,9 @@ namespace VIDEO
     if (!strNfoFile.IsEmpty() && CFile::Exists(strNfoFile))
     {
       if (info->Content() == CONTENT_TVSHOWS && !pItem->m_bIsFolder)
-        result = m_nfoReader.Create(strNfoFile,info,pItem->GetVideoInfoTag()->m_iEpisode);
+        result = nfoReader.Create(strNfoFile,info,pItem->GetVideoInfoTag()->m_iEpisode);
       else
-        result = m_nfoReader.Create(strNfoFile,info);
+        result = nfoReader.Create(strNfoFile,info);
 
       CStdString type;
       switch(result)
@@ -1842,18 +2261,18 @@ namespace VIDEO
       if (result == CNfoFile::FULL_NFO)
       {
         if (info->Content() == CONTENT_TVSHOWS)
-          info = m_nfoReader.GetScraperInfo();
+          info = nfoReader.GetScraperInfo();
       }
       else if (result != CNfoFile::NO_NFO && result != CNfoFile::ERROR_NFO)
       {
-        scrUrl = m_nfoReader.ScraperUrl();
-        info = m_nfoReader.GetScraperInfo();
+        scrUrl = nfoReader.ScraperUrl();
+        info = nfoReader.GetScraperInfo();
 
         CLog::Log(LOGDEBUG, "VideoInfoScanner: Fetching url '%s' using %s scraper (content: '%s')",
           scrUrl.m_url[0].m_url.c_str(), info->Name().c_str(), TranslateContent(info->Content()).c_str());
 
         if (result == CNfoFile::COMBINED_NFO)
-          m_nfoReader.GetDetails(*pItem->GetVideoInfoTag());
+          nfoReader.GetDetails(*pItem->GetVideoInfoTag());
       }
     }
     else
@@ -19,10 +19,15 @@
  *
  */
 #include "threads/Thread.h"
+#include "threads/Event.h"
+#include "utils/JobManager.h"
 #include "VideoDatabase.h"
 #include "addons/Scraper.h"
 #include "NfoFile.h"
 
+#include <deque>
+#include <boost/shared_ptr.hpp>
+
 class CRegExp;
 class CFileItem;
 class CFileItemList;
@@ -48,8 +53,57 @@ namespace VIDEO
                   INFO_NOT_FOUND,
                   INFO_ADDED };
 
+  /*! \brief A folder listed (or found unchanged) on the job manager ahead of the scanner thread
+   */
+  struct SScanListing
+  {
+    SScanListing() : listed(false), done(true) {}
+    CStdString path;
+    CStdString dbHash;    /* hash in the database when the listing was queued */
+    CStdString fastHash;
+    CStdString hash;
+    CFileItemList items;
+    bool listed;          /* false if the fast hash matched and the folder wasn't listed */
+    CEvent done;
+  };
+  typedef boost::shared_ptr<SScanListing> ScanListingPtr;
+
+  /*! \brief A movie or music video looked up on the job manager ahead of the scanner thread
+   */
+  struct SScanLookup
+  {
+    SScanLookup() : dirNames(false), result(INFO_CANCELLED), done(true) {}
+    CFileItemPtr item;            /* filled in with details and artwork by the lookup */
+    ADDON::ScraperPtr scraper;
+    bool dirNames;
+    INFO_RET result;              /* INFO_ADDED if the item is ready to be written, INFO_ERROR if the download failed */
+    CEvent done;
+  };
+  typedef boost::shared_ptr<SScanLookup> ScanLookupPtr;
+
+  /*! \brief A movie or music video folder waiting for its lookups before it's written
+   */
+  struct SScanFolder
+  {
+    CStdString path;
+    CStdString hash;
+    bool foundSomeInfo;
+    std::vector<ScanLookupPtr> lookups;
+  };
+
+  /*! \brief Items and summed time of one stage of the scan, over all threads
+   */
+  struct SScanStageStats
+  {
+    SScanStageStats() : items(0), time(0) {}
+    volatile long items;
+    volatile long time;   /* in ms */
+  };
+
   class CVideoInfoScanner : CThread
   {
+    friend class CVideoScanListingJob;
+    friend class CVideoScanLookupJob;
   public:
     CVideoInfoScanner();
     virtual ~CVideoInfoScanner();
@@ -92,6 +146,7 @@ namespace VIDEO
     static void ApplyThumbToFolder(const CStdString &folder, const CStdString &imdbThumb);
     static bool DownloadFailed(CGUIDialogProgress* pDlgProgress);
     CNfoFile::NFOResult CheckForNFOFile(CFileItem* pItem, bool bGrabAny, ADDON::ScraperPtr& scraper, CScraperUrl& scrUrl);
+    CNfoFile::NFOResult CheckForNFOFile(CFileItem* pItem, bool bGrabAny, ADDON::ScraperPtr& scraper, CScraperUrl& scrUrl, CNfoFile& nfoReader) const;
 
     /*! \brief Retrieve any artwork associated with an item
      \param pItem item to find artwork for.
@@ -124,6 +179,51 @@ namespace VIDEO
     virtual void Process();
     bool DoScan(const CStdString& strDirectory);
 
+    /*! \brief List folders on the job manager before DoScan() gets to them
+     The listing, fast hashing and stacking of folders is network bound on shares, so the
+     scanner thread keeps the next few subfolders of the folder it's in listing ahead of it.
+     \param folders the folders to list, in the order they will be scanned
+     \param first the folder about to be scanned
+     */
+    void PrefetchListings(const std::vector<CStdString> &folders, size_t first);
+
+    /*! \brief Get the listing of a folder, waiting for a prefetched one or listing it now
+     \param strDirectory folder to get the listing for
+     \param dbHash the hash of the folder in the database
+     \return the listing, or NULL if the scan was stopped while waiting for it
+     */
+    ScanListingPtr GetListing(const CStdString &strDirectory, const CStdString &dbHash);
+
+    /*! \brief Fast hash and, if it changed, list and hash a folder.  Safe to run off the scanner thread. */
+    void ListFolder(SScanListing &listing);
+
+    /*! \brief Queue the online/nfo lookups and artwork retrieval of a movie or music video folder
+     The items are written to the database by FinishFolder() once they're looked up, in order,
+     while the scanner thread moves on to the next folder.
+     \return false if the items need to be retrieved by RetrieveVideoInfo() instead
+     */
+    bool QueueVideoInfo(CFileItemList &items, const CStdString &strDirectory, const CStdString &hash, bool bDirNames);
+
+    /*! \brief Look up an item queued by QueueVideoInfo().  Safe to run off the scanner thread. */
+    void LookupItem(SScanLookup &lookup);
+
+    /*! \brief Wait for a listing or lookup job, committing the scan's writes first
+     \return false if the scan was stopped before the job was done
+     */
+    bool WaitForJob(CEvent &done);
+
+    /*! \brief Write the oldest queued folder to the database, waiting for its lookups as needed */
+    void FinishFolder();
+
+    /*! \brief Write queued folders until at most maxLookups lookups are outstanding */
+    void FinishFolders(size_t maxLookups);
+
+    /*! \brief Drop all listings and lookups queued ahead of the scanner thread */
+    void CancelQueued();
+
+    /*! \brief The database part of AddVideo(), once the artwork has been retrieved */
+    long AddVideoToDatabase(CFileItem *pItem, const CONTENT_TYPE &content, bool videoFolder, bool useLocal, const CVideoInfoTag *showInfo, bool libraryImport);
+
     INFO_RET RetrieveInfoForTvShow(CFileItem *pItem, bool bDirNames, ADDON::ScraperPtr &scraper, bool useLocal, CScraperUrl* pURL, bool fetchEpisodes, CGUIDialogProgress* pDlgProgress);
     INFO_RET RetrieveInfoForMovie(CFileItem *pItem, bool bDirNames, ADDON::ScraperPtr &scraper, bool useLocal, CScraperUrl* pURL, CGUIDialogProgress* pDlgProgress);
     INFO_RET RetrieveInfoForMusicVideo(CFileItem *pItem, bool bDirNames, ADDON::ScraperPtr &scraper, bool useLocal, CScraperUrl* pURL, CGUIDialogProgress* pDlgProgress);
@@ -238,6 +338,17 @@ namespace VIDEO
     std::set<CStdString> m_pathsToCount;
     std::set<int> m_pathsToClean;
     CNfoFile m_nfoReader;
+
+    CJobQueue m_listingQueue;
+    CJobQueue m_lookupQueue;
+    std::map<CStdString, ScanListingPtr> m_listings;  /* prefetched listings by path */
+    std::deque<SScanFolder> m_queuedFolders;
+    size_t m_queuedLookups;
+    CDatabaseBatch m_batch;   /* only the scanner thread batches its writes */
+    SScanStageStats m_listingStats;
+    SScanStageStats m_lookupStats;
+    SScanStageStats m_writeStats;
+    long m_fastHashSkips;
   };
 }
 
@@ -371,7 +371,7 @@ bool CVideoThumbLoader::FillLibraryArt(CFileItem &item)
     }
     m_database->Close();
   }
-  return !item.GetArt().empty();
+  return item.HasAnyArt();
 }
 
 bool CVideoThumbLoader::FillThumb(CFileItem &item)
@@ -61,6 +61,7 @@ public:
   }
 
   virtual bool operator==(const CJob* job) const;
+  virtual std::string GetIdentity() const { return m_listpath; }
 
   CStdString m_target; ///< thumbpath
   CStdString m_listpath; ///< path used in fileitem list
@@ -615,7 +615,8 @@ bool CGUIWindowVideoBase::ShowIMDB(CFileItem *item, const ScraperPtr &info2)
       CTextureDatabase db;
       if (db.Open())
       {
-        for (CGUIListItem::ArtMap::const_iterator i = item->GetArt().begin(); i != item->GetArt().end(); ++i)
+        CGUIListItem::ArtMap art = item->GetArt();
+        for (CGUIListItem::ArtMap::const_iterator i = art.begin(); i != art.end(); ++i)
           db.InvalidateCachedTexture(i->second);
         db.Close();
       }
@@ -118,6 +118,11 @@ CGUIMediaWindow::CGUIMediaWindow(int id, const char *xmlFile)
   m_iSelectedItem = -1;
   m_canFilterAdvanced = false;
 
+  /* PLEX */
+  // shares and plugins listed a moment ago are shown right away, and refreshed if they're getting old
+  m_rootDir.SetFlags(DIR_FLAG_ALLOW_PROMPT | DIR_FLAG_READ_CACHE_TTL);
+  /* END PLEX */
+
   m_guiState.reset(CGUIViewState::GetViewState(GetID(), *m_vecItems));
 }
 